@@ -10,13 +10,27 @@ import (
 	"os"
 	"os/exec"
 	"path/filepath"
+	"runtime"
 	"strings"
 
 	"github.com/seccomp/libseccomp-golang"
 	"golang.org/x/sys/unix"
 )
 
+func init() {
+	// Keep the main goroutine on one thread from setup through exec, so the
+	// per-thread state it sets up (no_new_privs, seccomp) is what the exec sees.
+	runtime.LockOSThread()
+}
+
 func main() {
+	if len(os.Args) == 3 && os.Args[1] == compileSeccompFlag {
+		if err := compileSeccomp(os.Args[2], os.Stdout); err != nil {
+			_, _ = fmt.Fprintln(os.Stderr, err.Error())
+			os.Exit(1)
+		}
+		return
+	}
 	if err := run(); err != nil {
 		_, _ = fmt.Fprintln(os.Stderr, err.Error())
 		os.Exit(1)
@@ -63,11 +77,15 @@ func run() error {
 		return err
 	}
 
-	if err := redirectIO(req.RunSpec); err != nil {
+	if err := redirectIO(req.RunSpec, req.StdoutFD); err != nil {
 		return err
 	}
 
-	if req.EnableSeccomp && req.Isolation.SeccompProfile != "" {
+	if req.EnableSeccomp && req.SeccompFD > 0 {
+		if err := installSeccompProgram(req.SeccompFD); err != nil {
+			return err
+		}
+	} else if req.EnableSeccomp && req.Isolation.SeccompProfile != "" {
 		if err := applySeccomp(req.Isolation.SeccompProfile); err != nil {
 			return err
 		}
@@ -193,7 +211,9 @@ func applyRlimits(limits resourceLimit) error {
 	return nil
 }
 
-func redirectIO(runSpec runSpec) error {
+// redirectIO wires stdin/stdout/stderr. A non-zero stdoutFD is an inherited
+// capture (an engine-owned memfd) used instead of StdoutPath.
+func redirectIO(runSpec runSpec, stdoutFD int) error {
 	stdinPath := runSpec.StdinPath
 	if stdinPath == "" {
 		stdinPath = "/dev/null"
@@ -210,9 +230,14 @@ func redirectIO(runSpec runSpec) error {
 	if err != nil {
 		return fmt.Errorf("open stdin: %w", err)
 	}
-	stdoutFile, err := os.OpenFile(stdoutPath, os.O_CREATE|os.O_WRONLY|os.O_TRUNC, 0644)
-	if err != nil {
-		return fmt.Errorf("open stdout: %w", err)
+	var stdoutFile *os.File
+	if stdoutFD > 0 {
+		stdoutFile = os.NewFile(uintptr(stdoutFD), "stdout")
+	} else {
+		stdoutFile, err = os.OpenFile(stdoutPath, os.O_CREATE|os.O_WRONLY|os.O_TRUNC, 0644)
+		if err != nil {
+			return fmt.Errorf("open stdout: %w", err)
+		}
 	}
 	stderrFile, err := os.OpenFile(stderrPath, os.O_CREATE|os.O_WRONLY|os.O_TRUNC, 0644)
 	if err != nil {
@@ -281,44 +306,56 @@ func mergePath(pathValue, defaultPath string) string {
 }
 
 func applySeccomp(profilePath string) error {
+	filter, err := buildSeccompFilter(profilePath)
+	if err != nil {
+		return err
+	}
+	defer filter.Release()
+	if err := unix.Prctl(unix.PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0); err != nil {
+		return fmt.Errorf("set no new privs: %w", err)
+	}
+	if err := filter.Load(); err != nil {
+		return fmt.Errorf("load seccomp filter: %w", err)
+	}
+	return nil
+}
+
+func buildSeccompFilter(profilePath string) (*seccomp.ScmpFilter, error) {
 	data, err := os.ReadFile(profilePath)
 	if err != nil {
-		return fmt.Errorf("read seccomp profile: %w", err)
+		return nil, fmt.Errorf("read seccomp profile: %w", err)
 	}
 	var cfg seccompConfig
 	if err := json.Unmarshal(data, &cfg); err != nil {
-		return fmt.Errorf("parse seccomp profile: %w", err)
+		return nil, fmt.Errorf("parse seccomp profile: %w", err)
 	}
 	defaultAction, err := parseSeccompAction(cfg.DefaultAction)
 	if err != nil {
-		return err
+		return nil, err
 	}
 	filter, err := seccomp.NewFilter(defaultAction)
 	if err != nil {
-		return fmt.Errorf("create seccomp filter: %w", err)
+		return nil, fmt.Errorf("create seccomp filter: %w", err)
 	}
 	for _, rule := range cfg.Syscalls {
 		action, err := parseSeccompAction(rule.Action)
 		if err != nil {
-			return err
+			filter.Release()
+			return nil, err
 		}
 		for _, name := range rule.Names {
 			syscallID, err := seccomp.GetSyscallFromName(name)
 			if err != nil {
-				return fmt.Errorf("resolve seccomp syscall %s: %w", name, err)
+				filter.Release()
+				return nil, fmt.Errorf("resolve seccomp syscall %s: %w", name, err)
 			}
 			if err := filter.AddRuleExact(syscallID, action); err != nil {
-				return fmt.Errorf("add seccomp rule: %w", err)
+				filter.Release()
+				return nil, fmt.Errorf("add seccomp rule: %w", err)
 			}
 		}
 	}
-	if err := unix.Prctl(unix.PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0); err != nil {
-		return fmt.Errorf("set no new privs: %w", err)
-	}
-	if err := filter.Load(); err != nil {
-		return fmt.Errorf("load seccomp filter: %w", err)
-	}
-	return nil
+	return filter, nil
 }
 
 type seccompConfig struct {
@@ -347,6 +384,8 @@ type initRequest struct {
 	Isolation     isolationProfile `json:"Isolation"`
 	EnableSeccomp bool             `json:"EnableSeccomp"`
 	EnableNs      bool             `json:"EnableNs"`
+	StdoutFD      int              `json:"StdoutFD"`
+	SeccompFD     int              `json:"SeccompFD"`
 }
 
 type runSpec struct {
@@ -0,0 +1,84 @@
+//go:build linux
+
+package main
+
+import (
+	"encoding/binary"
+	"fmt"
+	"os"
+	"unsafe"
+
+	"golang.org/x/sys/unix"
+)
+
+const (
+	compileSeccompFlag = "--compile-seccomp"
+	// sockFilterSize is the size of one struct sock_filter instruction.
+	sockFilterSize     = 8
+	maxBPFInstructions = 4096
+	// seccompFilterFlagTSync is SECCOMP_FILTER_FLAG_TSYNC: the filter is applied to
+	// every thread of the process, not only the calling one.
+	seccompFilterFlagTSync = 1
+)
+
+// compileSeccomp writes the raw BPF program of a JSON profile to out. The engine
+// runs it once per profile version and hands the result to every run as SeccompFD.
+func compileSeccomp(profilePath string, out *os.File) error {
+	filter, err := buildSeccompFilter(profilePath)
+	if err != nil {
+		return err
+	}
+	defer filter.Release()
+	if err := filter.ExportBPF(out); err != nil {
+		return fmt.Errorf("export seccomp filter: %w", err)
+	}
+	return nil
+}
+
+// installSeccompProgram loads a precompiled program from an inherited descriptor.
+// The descriptor is shared with concurrent runs, so it is read with pread and
+// closed before the filter is installed. The filter is synchronized to all
+// threads: the Go runtime may exec from a different thread than this call runs
+// on, and libseccomp did the same for the JSON path.
+func installSeccompProgram(fd int) error {
+	file := os.NewFile(uintptr(fd), "seccomp")
+	info, err := file.Stat()
+	if err != nil {
+		_ = file.Close()
+		return fmt.Errorf("stat seccomp program: %w", err)
+	}
+	size := info.Size()
+	if size == 0 || size%sockFilterSize != 0 || size/sockFilterSize > maxBPFInstructions {
+		_ = file.Close()
+		return fmt.Errorf("invalid seccomp program size %d", size)
+	}
+	data := make([]byte, size)
+	_, err = file.ReadAt(data, 0)
+	_ = file.Close()
+	if err != nil {
+		return fmt.Errorf("read seccomp program: %w", err)
+	}
+
+	insns := make([]unix.SockFilter, size/sockFilterSize)
+	for i := range insns {
+		raw := data[i*sockFilterSize:]
+		insns[i] = unix.SockFilter{
+			Code: binary.NativeEndian.Uint16(raw[0:2]),
+			Jt:   raw[2],
+			Jf:   raw[3],
+			K:    binary.NativeEndian.Uint32(raw[4:8]),
+		}
+	}
+	prog := unix.SockFprog{Len: uint16(len(insns)), Filter: &insns[0]}
+	if err := unix.Prctl(unix.PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0); err != nil {
+		return fmt.Errorf("set no new privs: %w", err)
+	}
+	tid, _, errno := unix.Syscall(unix.SYS_SECCOMP, unix.SECCOMP_SET_MODE_FILTER, seccompFilterFlagTSync, uintptr(unsafe.Pointer(&prog)))
+	if errno != 0 {
+		return fmt.Errorf("load seccomp program: %w", errno)
+	}
+	if tid != 0 {
+		return fmt.Errorf("load seccomp program: thread %d could not be synchronized", tid)
+	}
+	return nil
+}
@@ -0,0 +1,96 @@
+//go:build linux
+
+package main
+
+import (
+	"encoding/binary"
+	"fmt"
+	"os"
+	"os/exec"
+	"runtime"
+	"strings"
+	"testing"
+
+	"golang.org/x/sys/unix"
+)
+
+const seccompChildEnv = "SANDBOX_INIT_SECCOMP_CHILD"
+
+const (
+	seccompRetAllow = 0x7fff0000
+	seccompRetErrno = 0x00050000
+)
+
+func TestMain(m *testing.M) {
+	if os.Getenv(seccompChildEnv) == "1" {
+		if err := runSeccompChild(); err != nil {
+			_, _ = fmt.Fprintln(os.Stderr, err.Error())
+			os.Exit(2)
+		}
+		return
+	}
+	os.Exit(m.Run())
+}
+
+// TestSeccompProgramCoversExecFromAnotherThread installs the filter on one thread
+// and execs from another; the exec'd binary must still be filtered.
+func TestSeccompProgramCoversExecFromAnotherThread(t *testing.T) {
+	if _, err := os.Stat("/bin/uname"); err != nil {
+		t.Skip("/bin/uname is not available")
+	}
+	cmd := exec.Command(os.Args[0], "-test.run=^$")
+	cmd.Env = append(os.Environ(), seccompChildEnv+"=1")
+	output, err := cmd.CombinedOutput()
+	if exitErr, ok := err.(*exec.ExitError); ok && exitErr.ExitCode() == 2 {
+		t.Fatalf("child setup failed: %s", output)
+	}
+	if err == nil {
+		t.Fatalf("expected denied uname to fail after exec, got output %q", output)
+	}
+	if !strings.Contains(string(output), "not permitted") {
+		t.Fatalf("expected EPERM from uname, got %v: %q", err, output)
+	}
+}
+
+// runSeccompChild installs a program denying uname(2) from a goroutine locked to
+// its own thread, then execs uname from the main goroutine, which init locked to
+// the main thread.
+func runSeccompChild() error {
+	fd, err := unix.MemfdCreate("seccomp-test", 0)
+	if err != nil {
+		return fmt.Errorf("create memfd: %w", err)
+	}
+	file := os.NewFile(uintptr(fd), "seccomp-test")
+	if _, err := file.Write(denySyscallProgram(unix.SYS_UNAME)); err != nil {
+		return fmt.Errorf("write program: %w", err)
+	}
+
+	installed := make(chan error, 1)
+	go func() {
+		runtime.LockOSThread()
+		installed <- installSeccompProgram(fd)
+		select {}
+	}()
+	if err := <-installed; err != nil {
+		return err
+	}
+	return unix.Exec("/bin/uname", []string{"uname"}, os.Environ())
+}
+
+// denySyscallProgram encodes a BPF program failing nr with EPERM and allowing
+// everything else.
+func denySyscallProgram(nr uint32) []byte {
+	insns := []unix.SockFilter{
+		{Code: unix.BPF_LD | unix.BPF_W | unix.BPF_ABS, K: 0},
+		{Code: unix.BPF_JMP | unix.BPF_JEQ | unix.BPF_K, Jt: 0, Jf: 1, K: nr},
+		{Code: unix.BPF_RET | unix.BPF_K, K: seccompRetErrno | uint32(unix.EPERM)},
+		{Code: unix.BPF_RET | unix.BPF_K, K: seccompRetAllow},
+	}
+	out := make([]byte, 0, len(insns)*sockFilterSize)
+	for _, insn := range insns {
+		out = binary.NativeEndian.AppendUint16(out, insn.Code)
+		out = append(out, insn.Jt, insn.Jf)
+		out = binary.NativeEndian.AppendUint32(out, insn.K)
+	}
+	return out
+}
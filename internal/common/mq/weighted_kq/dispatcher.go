@@ -0,0 +1,88 @@
+package weighted_kq
+
+import (
+	"context"
+	"errors"
+	"time"
+
+	"github.com/zeromicro/go-queue/kq"
+)
+
+// DispatcherOptions configures a Dispatcher.
+// Weights come from Policy.TopicWeights, with the BuildWeightedKqConfs defaults when empty.
+// MetricsWindow overrides the window wait targets adapt on; zero keeps 5s.
+type DispatcherOptions struct {
+	Topics        []string
+	Workers       int
+	Handler       kq.ConsumeHandler
+	Policy        WeightedQueuePolicy
+	MetricsWindow time.Duration
+}
+
+// Dispatcher is the shared dispatcher behind NewWeightedKqQueuesWithPolicy without
+// the Kafka consumers, for replay harnesses and tests.
+type Dispatcher struct {
+	d *sharedDispatcher
+}
+
+// NewDispatcher creates a standalone dispatcher.
+func NewDispatcher(opts DispatcherOptions) *Dispatcher {
+	workers := maxInt(1, opts.Workers)
+	weights := buildTopicWeights(opts.Topics, opts.Policy.TopicWeights)
+	d := newPolicyDispatcher(opts.Topics, weights, workers, opts.Handler, opts.Policy)
+	if opts.MetricsWindow > 0 {
+		d.window = opts.MetricsWindow
+	}
+	return &Dispatcher{d: d}
+}
+
+// Start starts the dispatch loop and workers.
+func (d *Dispatcher) Start() {
+	d.d.Start()
+}
+
+// Stop stops the dispatch loop and workers.
+func (d *Dispatcher) Stop() {
+	d.d.Stop()
+}
+
+// Submit hands a message to the dispatcher and waits for its handler result.
+func (d *Dispatcher) Submit(ctx context.Context, topic, key, value string) error {
+	return d.d.Submit(ctx, topic, key, value)
+}
+
+// Stats reports backlog, pause state and wait time per topic.
+func (d *Dispatcher) Stats() DispatchStats {
+	return d.d.Stats()
+}
+
+// Enqueue buffers a task of the given cost for topic, bypassing Submit and the CostFunc.
+// Use it with NextTask only while the dispatcher is not started.
+func (d *Dispatcher) Enqueue(topic string, cost int) error {
+	queue, ok := d.d.topicQueues[topic]
+	if !ok {
+		return errors.New("unknown topic")
+	}
+	queue <- &dispatchTask{topic: topic, cost: cost}
+	return nil
+}
+
+// NextTask takes the next buffered task by deficit round robin and returns its topic.
+func (d *Dispatcher) NextTask() (string, bool) {
+	task, ok := d.d.nextTask()
+	if !ok {
+		return "", false
+	}
+	return task.topic, true
+}
+
+// AdjustWeights applies one metrics window in which each topic dispatched tasks with the given waits.
+func (d *Dispatcher) AdjustWeights(waits map[string][]time.Duration) {
+	stats := newDispatcherStats(d.d.topics)
+	for topic, samples := range waits {
+		for _, wait := range samples {
+			stats.recordDispatch(topic, wait)
+		}
+	}
+	d.d.adjustWeights(stats.snapshotAndReset())
+}
@@ -0,0 +1,206 @@
+package weighted_kq
+
+import (
+	"sync/atomic"
+	"time"
+)
+
+// MaxTaskCost caps the cost a CostFunc may assign to one message.
+const MaxTaskCost = 64
+
+const (
+	defaultTaskCost = 1
+	// maxWeightBoost bounds how far wait targets may raise a topic above its configured weight.
+	maxWeightBoost = 8
+	// waitHistBuckets covers waits from 1ms to about 9 minutes in powers of two.
+	waitHistBuckets = 20
+)
+
+// CostFunc estimates how expensive a message is to handle, in the same units the
+// topic weights are expressed in. Values are clamped to [1, MaxTaskCost]; returning 0 means unknown.
+// kq handlers do not see Kafka headers, so cost hints are derived from the key or value.
+type CostFunc func(topic, key, value string) int
+
+// topicLane holds the deficit round-robin state of one topic.
+// head and deficit are owned by the dispatch goroutine.
+type topicLane struct {
+	queue   chan *dispatchTask
+	base    int
+	weight  int64
+	target  time.Duration
+	head    *dispatchTask
+	held    int32
+	deficit int
+}
+
+func newTopicLane(queue chan *dispatchTask, weight int, target time.Duration) *topicLane {
+	weight = maxInt(1, weight)
+	return &topicLane{queue: queue, base: weight, weight: int64(weight), target: target}
+}
+
+func (l *topicLane) currentWeight() int {
+	return int(atomic.LoadInt64(&l.weight))
+}
+
+// peek returns the next task of the topic without dequeuing it.
+func (l *topicLane) peek() *dispatchTask {
+	if l.head != nil {
+		return l.head
+	}
+	select {
+	case task := <-l.queue:
+		l.head = task
+		atomic.StoreInt32(&l.held, 1)
+	default:
+	}
+	return l.head
+}
+
+func (l *topicLane) take() *dispatchTask {
+	task := l.head
+	l.head = nil
+	atomic.StoreInt32(&l.held, 0)
+	return task
+}
+
+func (l *topicLane) backlog() int {
+	return len(l.queue) + int(atomic.LoadInt32(&l.held))
+}
+
+func (d *sharedDispatcher) taskCost(topic, key, value string) int {
+	if d.cost == nil {
+		return defaultTaskCost
+	}
+	cost := d.cost(topic, key, value)
+	if cost <= 0 {
+		return defaultTaskCost
+	}
+	if cost > MaxTaskCost {
+		return MaxTaskCost
+	}
+	return cost
+}
+
+// nextTask picks the next task by deficit round robin: each topic's turn adds its
+// weight to its deficit, and it keeps sending while the head task's cost fits.
+// An expensive rejudge therefore consumes as much of its topic's share as it costs.
+func (d *sharedDispatcher) nextTask() (*dispatchTask, bool) {
+	if len(d.topics) == 0 {
+		return nil, false
+	}
+	for {
+		pending := false
+		for i := 0; i < len(d.topics); i++ {
+			topic := d.topics[d.turn]
+			lane := d.lanes[topic]
+			if d.turnFresh {
+				lane.deficit += lane.currentWeight()
+				d.turnFresh = false
+			}
+			head := lane.peek()
+			if head == nil {
+				// Idle topics do not bank credit.
+				lane.deficit = 0
+				d.endTurn()
+				continue
+			}
+			if d.retryBlocked(topic) {
+				lane.deficit = minInt(lane.deficit, lane.currentWeight())
+				d.endTurn()
+				continue
+			}
+			pending = true
+			if lane.deficit >= head.cost {
+				lane.deficit -= head.cost
+				task := lane.take()
+				if d.retryTopic != "" && topic == d.retryTopic && d.retryCap > 0 {
+					atomic.AddInt64(&d.retryInFlight, 1)
+				}
+				return task, true
+			}
+			d.endTurn()
+		}
+		if !pending {
+			return nil, false
+		}
+	}
+}
+
+func (d *sharedDispatcher) endTurn() {
+	d.turn = (d.turn + 1) % len(d.topics)
+	d.turnFresh = true
+}
+
+func (d *sharedDispatcher) retryBlocked(topic string) bool {
+	return d.retryTopic != "" && topic == d.retryTopic && d.retryCap > 0 && int(atomic.LoadInt64(&d.retryInFlight)) >= d.retryCap
+}
+
+// adjustWeights moves topics with a p99 wait target toward it: a window over
+// target raises the weight by a quarter, one under half the target decays it
+// back toward the configured weight. A backlogged topic that dispatched nothing counts as over target.
+func (d *sharedDispatcher) adjustWeights(window map[string]topicWindowStats) {
+	for _, topic := range d.topics {
+		lane := d.lanes[topic]
+		if lane.target <= 0 {
+			continue
+		}
+		stats := window[topic]
+		over := false
+		under := false
+		if stats.dispatched == 0 {
+			over = lane.backlog() > 0
+		} else {
+			p99 := stats.waitPercentile(0.99)
+			over = p99 > lane.target
+			under = p99 < lane.target/2
+		}
+		weight := lane.currentWeight()
+		next := weight
+		switch {
+		case over:
+			next = minInt(weight+maxInt(1, weight/4), lane.base*maxWeightBoost)
+		case under:
+			next = maxInt(weight-maxInt(1, weight/4), lane.base)
+		}
+		if next != weight {
+			atomic.StoreInt64(&lane.weight, int64(next))
+		}
+	}
+}
+
+func waitBucket(wait time.Duration) int {
+	bucket := 0
+	for limit := time.Millisecond; wait > limit && bucket < waitHistBuckets-1; limit *= 2 {
+		bucket++
+	}
+	return bucket
+}
+
+// waitPercentile returns the upper bound of the histogram bucket holding quantile q.
+func (s topicWindowStats) waitPercentile(q float64) time.Duration {
+	if s.dispatched == 0 {
+		return 0
+	}
+	rank := int64(float64(s.dispatched)*q + 0.5)
+	if rank < 1 {
+		rank = 1
+	}
+	var seen int64
+	for i, count := range s.waitHist {
+		seen += count
+		if seen >= rank {
+			if i == waitHistBuckets-1 {
+				return s.waitMax
+			}
+			return time.Millisecond << uint(i)
+		}
+	}
+	return s.waitMax
+}
+
+func minInt(a, b int) int {
+	if a < b {
+		return a
+	}
+	return b
+}
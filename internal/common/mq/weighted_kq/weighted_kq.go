@@ -37,11 +37,64 @@ type WeightedKqOptions struct {
 	AutoAddRetry     bool
 }
 
+// CreditSource is implemented by consume handlers that bound how much work they
+// accept. FreeCredits reports how many more messages the handler can take right now;
+// while it is exhausted the dispatcher stops handing out messages and pauses intake
+// per topic, so Kafka fetching stalls instead of the handler bouncing messages.
+// SetCreditNotifier registers a callback the handler invokes when credits grow.
+type CreditSource interface {
+	FreeCredits() int
+	SetCreditNotifier(notify func())
+}
+
+// TopicStats is a point-in-time view of one topic in the shared dispatcher.
+// Wait figures cover the last metrics window; Weight is the current DRR quantum.
+type TopicStats struct {
+	Topic      string
+	Backlog    int
+	Paused     bool
+	Weight     int
+	Dispatched int64
+	WaitAvg    time.Duration
+	WaitP99    time.Duration
+	WaitMax    time.Duration
+}
+
+// DispatchStats is a point-in-time view of the shared dispatcher.
+type DispatchStats struct {
+	Credits   int
+	Unclaimed int
+	Topics    []TopicStats
+}
+
+// StatsProvider is implemented by queues created by NewWeightedKqQueuesWithPolicy.
+type StatsProvider interface {
+	Stats() DispatchStats
+}
+
+type creditClaimKey struct{}
+
+// ClaimCredit tells the dispatcher the handler now accounts for the message
+// carried by ctx in its own FreeCredits. Handlers call it once the message holds
+// or waits for handler capacity; otherwise the claim happens when Consume returns.
+func ClaimCredit(ctx context.Context) {
+	if ctx == nil {
+		return
+	}
+	if task, ok := ctx.Value(creditClaimKey{}).(*dispatchTask); ok && task != nil {
+		task.claim()
+	}
+}
+
 // WeightedQueuePolicy defines runtime dispatch behavior.
+// Cost prices each message for deficit round robin; nil treats every message as 1.
+// WaitTargets sets per-topic p99 wait targets that adjust topic weights online.
 type WeightedQueuePolicy struct {
 	TopicWeights     map[string]int
 	RetryTopic       string
 	RetryMaxInFlight int
+	Cost             CostFunc
+	WaitTargets      map[string]time.Duration
 }
 
 // BuildWeightedKqConfs builds kq configs for topics with weights.
@@ -115,19 +168,7 @@ func NewWeightedKqQueuesWithPolicy(confs []kq.KqConf, handler kq.ConsumeHandler,
 	if workers <= 0 {
 		workers = 1
 	}
-	retryCap := policy.RetryMaxInFlight
-	if policy.RetryTopic != "" && retryCap <= 0 {
-		retryCap = maxInt(1, workers/defaultRetryCapDivisor)
-	}
-
-	dispatcher := newSharedDispatcher(sharedDispatcherOptions{
-		topics:     topics,
-		weights:    weights,
-		workers:    workers,
-		retryTopic: policy.RetryTopic,
-		retryCap:   retryCap,
-		handler:    handler,
-	})
+	dispatcher := newPolicyDispatcher(topics, weights, workers, handler, policy)
 
 	queues := make([]queue.MessageQueue, 0, len(confs))
 	for _, conf := range confs {
@@ -141,6 +182,30 @@ func NewWeightedKqQueuesWithPolicy(confs []kq.KqConf, handler kq.ConsumeHandler,
 	return &queueGroup{queues: queues, dispatcher: dispatcher}, nil
 }
 
+// newPolicyDispatcher builds the shared dispatcher for a policy and wires the
+// handler's credits when it implements CreditSource.
+func newPolicyDispatcher(topics []string, weights map[string]int, workers int, handler kq.ConsumeHandler, policy WeightedQueuePolicy) *sharedDispatcher {
+	retryCap := policy.RetryMaxInFlight
+	if policy.RetryTopic != "" && retryCap <= 0 {
+		retryCap = maxInt(1, workers/defaultRetryCapDivisor)
+	}
+	dispatcher := newSharedDispatcher(sharedDispatcherOptions{
+		topics:      topics,
+		weights:     weights,
+		workers:     workers,
+		retryTopic:  policy.RetryTopic,
+		retryCap:    retryCap,
+		handler:     handler,
+		cost:        policy.Cost,
+		waitTargets: policy.WaitTargets,
+	})
+	if credits, ok := handler.(CreditSource); ok {
+		dispatcher.credits = credits
+		credits.SetCreditNotifier(dispatcher.signalWake)
+	}
+	return dispatcher
+}
+
 type queueGroup struct {
 	queues     []queue.MessageQueue
 	dispatcher *sharedDispatcher
@@ -162,6 +227,14 @@ func (g *queueGroup) Start() {
 	wg.Wait()
 }
 
+// Stats reports backlog, pause state and wait time per topic.
+func (g *queueGroup) Stats() DispatchStats {
+	if g.dispatcher == nil {
+		return DispatchStats{}
+	}
+	return g.dispatcher.Stats()
+}
+
 func (g *queueGroup) Stop() {
 	for _, q := range g.queues {
 		q.Stop()
@@ -189,7 +262,50 @@ type dispatchTask struct {
 	key        string
 	value      string
 	enqueuedAt time.Time
+	cost       int
 	done       chan error
+	dispatcher *sharedDispatcher
+	claimed    int32
+}
+
+// claim moves the task's credit from the dispatcher to the handler, at most once.
+func (t *dispatchTask) claim() {
+	if t.dispatcher == nil || !atomic.CompareAndSwapInt32(&t.claimed, 0, 1) {
+		return
+	}
+	atomic.AddInt64(&t.dispatcher.unclaimed, -1)
+}
+
+// topicGate blocks Submit for a topic while the dispatcher has paused its intake.
+type topicGate struct {
+	mu     sync.Mutex
+	resume chan struct{}
+}
+
+func (g *topicGate) wait() <-chan struct{} {
+	if g == nil {
+		return nil
+	}
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	return g.resume
+}
+
+func (g *topicGate) set(paused bool) {
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	if paused && g.resume == nil {
+		g.resume = make(chan struct{})
+		return
+	}
+	if !paused && g.resume != nil {
+		close(g.resume)
+		g.resume = nil
+	}
+}
+
+func (g *topicGate) paused() bool {
+	return g.wait() != nil
 }
 
 type topicWindowStats struct {
@@ -198,11 +314,13 @@ type topicWindowStats struct {
 	failures   int64
 	waitTotal  time.Duration
 	waitMax    time.Duration
+	waitHist   [waitHistBuckets]int64
 }
 
 type dispatcherStats struct {
-	mu      sync.Mutex
-	byTopic map[string]*topicWindowStats
+	mu         sync.Mutex
+	byTopic    map[string]*topicWindowStats
+	lastWindow map[string]topicWindowStats
 }
 
 func newDispatcherStats(topics []string) *dispatcherStats {
@@ -219,6 +337,7 @@ func (s *dispatcherStats) recordDispatch(topic string, wait time.Duration) {
 	item := s.ensureTopic(topic)
 	item.dispatched++
 	item.waitTotal += wait
+	item.waitHist[waitBucket(wait)]++
 	if wait > item.waitMax {
 		item.waitMax = wait
 	}
@@ -243,9 +362,16 @@ func (s *dispatcherStats) snapshotAndReset() map[string]topicWindowStats {
 		out[topic] = *item
 		*item = topicWindowStats{}
 	}
+	s.lastWindow = out
 	return out
 }
 
+func (s *dispatcherStats) previousWindow(topic string) topicWindowStats {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	return s.lastWindow[topic]
+}
+
 func (s *dispatcherStats) ensureTopic(topic string) *topicWindowStats {
 	item, ok := s.byTopic[topic]
 	if ok {
@@ -257,12 +383,14 @@ func (s *dispatcherStats) ensureTopic(topic string) *topicWindowStats {
 }
 
 type sharedDispatcherOptions struct {
-	topics     []string
-	weights    map[string]int
-	workers    int
-	retryTopic string
-	retryCap   int
-	handler    kq.ConsumeHandler
+	topics      []string
+	weights     map[string]int
+	workers     int
+	retryTopic  string
+	retryCap    int
+	handler     kq.ConsumeHandler
+	cost        CostFunc
+	waitTargets map[string]time.Duration
 }
 
 type sharedDispatcher struct {
@@ -271,14 +399,21 @@ type sharedDispatcher struct {
 	retryTopic    string
 	retryCap      int
 	topicQueues   map[string]chan *dispatchTask
-	schedule      []string
+	topics        []string
+	lanes         map[string]*topicLane
+	gates         map[string]*topicGate
+	credits       CreditSource
+	unclaimed     int64
+	cost          CostFunc
+	turn          int
+	turnFresh     bool
+	window        time.Duration
 	wakeCh        chan struct{}
 	jobs          chan *dispatchTask
 	stopCh        chan struct{}
 	startOnce     sync.Once
 	stopOnce      sync.Once
 	wg            sync.WaitGroup
-	cursor        int
 	retryInFlight int64
 	stats         *dispatcherStats
 }
@@ -290,18 +425,24 @@ func newSharedDispatcher(opts sharedDispatcherOptions) *sharedDispatcher {
 	for _, topic := range opts.topics {
 		topicQueues[topic] = make(chan *dispatchTask, queueSize)
 	}
-	weights := make(map[string]int, len(opts.topics))
+	lanes := make(map[string]*topicLane, len(opts.topics))
+	gates := make(map[string]*topicGate, len(opts.topics))
 	for _, topic := range opts.topics {
-		weights[topic] = maxInt(1, opts.weights[topic])
+		lanes[topic] = newTopicLane(topicQueues[topic], opts.weights[topic], opts.waitTargets[topic])
+		gates[topic] = &topicGate{}
 	}
-	schedule := buildDispatchSchedule(opts.topics, weights)
 	return &sharedDispatcher{
 		handler:     opts.handler,
 		workers:     workers,
 		retryTopic:  opts.retryTopic,
 		retryCap:    maxInt(0, opts.retryCap),
 		topicQueues: topicQueues,
-		schedule:    schedule,
+		topics:      append([]string(nil), opts.topics...),
+		lanes:       lanes,
+		gates:       gates,
+		cost:        opts.cost,
+		turnFresh:   true,
+		window:      dispatchMetricsInterval,
 		wakeCh:      make(chan struct{}, 1),
 		jobs:        make(chan *dispatchTask, workers*2),
 		stopCh:      make(chan struct{}),
@@ -319,7 +460,7 @@ func (d *sharedDispatcher) Start() {
 		go d.runDispatch()
 		d.wg.Add(1)
 		go d.runMetrics()
-		logx.Infof("weighted kq dispatcher started workers=%d retry_topic=%s retry_cap=%d", d.workers, d.retryTopic, d.retryCap)
+		logx.Infof("weighted kq dispatcher started workers=%d retry_topic=%s retry_cap=%d credit_flow=%t", d.workers, d.retryTopic, d.retryCap, d.credits != nil)
 	})
 }
 
@@ -327,6 +468,9 @@ func (d *sharedDispatcher) Stop() {
 	d.stopOnce.Do(func() {
 		close(d.stopCh)
 		d.wg.Wait()
+		for _, gate := range d.gates {
+			gate.set(false)
+		}
 		logx.Info("weighted kq dispatcher stopped")
 	})
 }
@@ -336,14 +480,33 @@ func (d *sharedDispatcher) Submit(ctx context.Context, topic, key, value string)
 	if !ok {
 		return fmt.Errorf("unknown topic: %s", topic)
 	}
+	// A paused topic blocks here, which stalls its kq fetch loop.
+	for {
+		resume := d.gates[topic].wait()
+		if resume == nil {
+			break
+		}
+		select {
+		case <-d.stopCh:
+			return errors.New("weighted dispatcher is stopped")
+		case <-resume:
+		}
+	}
 	task := &dispatchTask{
 		ctx:        ctx,
 		topic:      topic,
 		key:        key,
 		value:      value,
 		enqueuedAt: time.Now(),
+		cost:       d.taskCost(topic, key, value),
 		done:       make(chan error, 1),
 	}
+	if d.credits != nil {
+		if task.ctx == nil {
+			task.ctx = context.Background()
+		}
+		task.ctx = context.WithValue(task.ctx, creditClaimKey{}, task)
+	}
 	select {
 	case <-d.stopCh:
 		return errors.New("weighted dispatcher is stopped")
@@ -362,7 +525,9 @@ func (d *sharedDispatcher) Submit(ctx context.Context, topic, key, value string)
 func (d *sharedDispatcher) runDispatch() {
 	defer d.wg.Done()
 	for {
-		if d.dispatchPending() {
+		found := d.dispatchPending()
+		d.refreshGates()
+		if found {
 			continue
 		}
 		select {
@@ -376,11 +541,18 @@ func (d *sharedDispatcher) runDispatch() {
 func (d *sharedDispatcher) dispatchPending() bool {
 	found := false
 	for {
+		if d.freeCredits() <= 0 {
+			return found
+		}
 		task, ok := d.nextTask()
 		if !ok {
 			return found
 		}
 		found = true
+		if d.credits != nil {
+			task.dispatcher = d
+			atomic.AddInt64(&d.unclaimed, 1)
+		}
 		select {
 		case <-d.stopCh:
 			return false
@@ -391,27 +563,62 @@ func (d *sharedDispatcher) dispatchPending() bool {
 	}
 }
 
-func (d *sharedDispatcher) nextTask() (*dispatchTask, bool) {
-	if len(d.schedule) == 0 {
-		return nil, false
+// freeCredits is the handler's advertised capacity minus messages already
+// handed to workers that the handler has not accounted for yet.
+func (d *sharedDispatcher) freeCredits() int {
+	if d.credits == nil {
+		return d.workers
 	}
-	for i := 0; i < len(d.schedule); i++ {
-		topic := d.schedule[d.cursor]
-		d.cursor = (d.cursor + 1) % len(d.schedule)
-		if d.retryTopic != "" && topic == d.retryTopic && d.retryCap > 0 && int(atomic.LoadInt64(&d.retryInFlight)) >= d.retryCap {
-			continue
+	return d.credits.FreeCredits() - int(atomic.LoadInt64(&d.unclaimed))
+}
+
+// refreshGates pauses intake for topics whose buffered backlog already covers
+// their weighted share of free credits, and resumes the rest. Every topic keeps
+// room for at least one buffered message so its weight still counts when credits return.
+func (d *sharedDispatcher) refreshGates() {
+	if d.credits == nil {
+		return
+	}
+	free := maxInt(0, d.freeCredits())
+	weights := make(map[string]int, len(d.topics))
+	weightTotal := 0
+	for _, topic := range d.topics {
+		weights[topic] = d.lanes[topic].currentWeight()
+		weightTotal += weights[topic]
+	}
+	for _, topic := range d.topics {
+		share := 1
+		if weightTotal > 0 {
+			share = maxInt(1, (free*weights[topic]+weightTotal-1)/weightTotal)
 		}
-		ch := d.topicQueues[topic]
-		select {
-		case task := <-ch:
-			if d.retryTopic != "" && topic == d.retryTopic && d.retryCap > 0 {
-				atomic.AddInt64(&d.retryInFlight, 1)
-			}
-			return task, true
-		default:
+		d.gates[topic].set(d.lanes[topic].backlog() >= share)
+	}
+}
+
+// Stats reports the current backlog and pause state with last-window wait times.
+func (d *sharedDispatcher) Stats() DispatchStats {
+	out := DispatchStats{
+		Credits:   d.freeCredits(),
+		Unclaimed: int(atomic.LoadInt64(&d.unclaimed)),
+		Topics:    make([]TopicStats, 0, len(d.topics)),
+	}
+	for _, topic := range d.topics {
+		window := d.stats.previousWindow(topic)
+		item := TopicStats{
+			Topic:      topic,
+			Backlog:    d.lanes[topic].backlog(),
+			Paused:     d.gates[topic].paused(),
+			Weight:     d.lanes[topic].currentWeight(),
+			Dispatched: window.dispatched,
+			WaitP99:    window.waitPercentile(0.99),
+			WaitMax:    window.waitMax,
 		}
+		if window.dispatched > 0 {
+			item.WaitAvg = time.Duration(int64(window.waitTotal) / window.dispatched)
+		}
+		out.Topics = append(out.Topics, item)
 	}
-	return nil, false
+	return out
 }
 
 func (d *sharedDispatcher) runWorker() {
@@ -422,25 +629,27 @@ func (d *sharedDispatcher) runWorker() {
 			return
 		case task := <-d.jobs:
 			err := d.handler.Consume(task.ctx, task.key, task.value)
+			task.claim()
 			if d.retryTopic != "" && task.topic == d.retryTopic && d.retryCap > 0 {
 				atomic.AddInt64(&d.retryInFlight, -1)
 			}
 			d.stats.recordResult(task.topic, err)
 			task.done <- err
+			d.signalWake()
 		}
 	}
 }
 
 func (d *sharedDispatcher) runMetrics() {
 	defer d.wg.Done()
-	ticker := time.NewTicker(dispatchMetricsInterval)
+	ticker := time.NewTicker(d.window)
 	defer ticker.Stop()
 	for {
 		select {
 		case <-d.stopCh:
 			return
 		case <-ticker.C:
-			d.logMetrics(dispatchMetricsInterval)
+			d.logMetrics(d.window)
 		}
 	}
 }
@@ -453,13 +662,18 @@ func (d *sharedDispatcher) logMetrics(window time.Duration) {
 	}
 	for topic, stats := range statsByTopic {
 		attempts := stats.successes + stats.failures
-		backlog := len(d.topicQueues[topic])
+		backlog := 0
+		weight := 0
+		if lane, ok := d.lanes[topic]; ok {
+			backlog = lane.backlog()
+			weight = lane.currentWeight()
+		}
 		avgWait := time.Duration(0)
 		if stats.dispatched > 0 {
 			avgWait = time.Duration(int64(stats.waitTotal) / stats.dispatched)
 		}
 		logx.Infof(
-			"weighted kq topic metrics window=%s topic=%s dispatched=%d attempts=%d successes=%d failures=%d backlog=%d attempt_qps=%.2f success_qps=%.2f wait_avg=%s wait_max=%s retry_inflight=%d retry_cap=%d",
+			"weighted kq topic metrics window=%s topic=%s dispatched=%d attempts=%d successes=%d failures=%d backlog=%d paused=%t credits=%d weight=%d attempt_qps=%.2f success_qps=%.2f wait_avg=%s wait_p99=%s wait_max=%s retry_inflight=%d retry_cap=%d",
 			window,
 			topic,
 			stats.dispatched,
@@ -467,14 +681,20 @@ func (d *sharedDispatcher) logMetrics(window time.Duration) {
 			stats.successes,
 			stats.failures,
 			backlog,
+			d.gates[topic].paused(),
+			d.freeCredits(),
+			weight,
 			float64(attempts)/windowSeconds,
 			float64(stats.successes)/windowSeconds,
 			avgWait,
+			stats.waitPercentile(0.99),
 			stats.waitMax,
 			atomic.LoadInt64(&d.retryInFlight),
 			d.retryCap,
 		)
 	}
+	d.adjustWeights(statsByTopic)
+	d.signalWake()
 }
 
 func (d *sharedDispatcher) signalWake() {
@@ -484,17 +704,6 @@ func (d *sharedDispatcher) signalWake() {
 	}
 }
 
-func buildDispatchSchedule(topics []string, weights map[string]int) []string {
-	schedule := make([]string, 0, len(topics))
-	for _, topic := range topics {
-		weight := maxInt(1, weights[topic])
-		for i := 0; i < weight; i++ {
-			schedule = append(schedule, topic)
-		}
-	}
-	return schedule
-}
-
 func buildTopicWeights(topics []string, explicit map[string]int) map[string]int {
 	weights := make(map[string]int, len(topics))
 	if len(explicit) == 0 {
@@ -12,6 +12,11 @@ type ObjectStorage interface {
 	// Caller must close the returned reader.
 	GetObject(ctx context.Context, bucket, objectKey string) (ObjectReader, error)
 
+	// GetObjectRange opens a reader for length bytes starting at offset.
+	// A non-positive length reads to the end of the object.
+	// Caller must close the returned reader.
+	GetObjectRange(ctx context.Context, bucket, objectKey string, offset, length int64) (ObjectReader, error)
+
 	// PutObject uploads an object from a reader.
 	// sizeBytes is the total size of the reader.
 	PutObject(ctx context.Context, bucket, objectKey string, reader ObjectReader, sizeBytes int64, contentType string) error
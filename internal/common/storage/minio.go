@@ -68,6 +68,25 @@ func (s *MinIOStorage) GetObject(ctx context.Context, bucket, objectKey string)
 	return obj, nil
 }
 
+func (s *MinIOStorage) GetObjectRange(ctx context.Context, bucket, objectKey string, offset, length int64) (ObjectReader, error) {
+	if offset < 0 {
+		return nil, fmt.Errorf("offset must not be negative")
+	}
+	opts := minio.GetObjectOptions{}
+	end := int64(0)
+	if length > 0 {
+		end = offset + length - 1
+	}
+	if err := opts.SetRange(offset, end); err != nil {
+		return nil, fmt.Errorf("minio set range failed: %w", err)
+	}
+	obj, _, _, err := s.core.GetObject(ctx, bucket, objectKey, opts)
+	if err != nil {
+		return nil, fmt.Errorf("minio get object range failed: %w", err)
+	}
+	return obj, nil
+}
+
 func (s *MinIOStorage) PutObject(ctx context.Context, bucket, objectKey string, reader ObjectReader, sizeBytes int64, contentType string) error {
 	if reader == nil {
 		return fmt.Errorf("reader is required")
@@ -0,0 +1,133 @@
+package prefetchpubsub
+
+import (
+	"context"
+	"crypto/sha256"
+	"encoding/hex"
+	"encoding/json"
+	"fmt"
+	"sort"
+	"strings"
+	"time"
+
+	red "github.com/redis/go-redis/v9"
+	"github.com/zeromicro/go-zero/core/stores/redis"
+)
+
+const (
+	channelName = "contest:prefetch:pubsub"
+	plansKey    = "contest:prefetch:plans"
+)
+
+// Problem is one contest problem judge nodes should warm.
+// Version is the version pinned by the contest; 0 means latest.
+type Problem struct {
+	ProblemID int64 `json:"problem_id"`
+	Version   int32 `json:"version"`
+}
+
+// Plan asks judge nodes to warm and pin problem data packs for a contest window.
+type Plan struct {
+	ContestID   string    `json:"contest_id"`
+	StartAt     int64     `json:"start_at"`
+	EndAt       int64     `json:"end_at"`
+	Problems    []Problem `json:"problems"`
+	Fingerprint string    `json:"fingerprint"`
+	UpdatedAt   int64     `json:"updated_at"`
+}
+
+// Active reports whether the contest window has not ended at now.
+func (p Plan) Active(now time.Time) bool {
+	return p.EndAt > now.UnixMilli()
+}
+
+func NewClient(conf redis.RedisConf) *red.Client {
+	if strings.TrimSpace(conf.Host) == "" {
+		return nil
+	}
+	if conf.Type != "" && conf.Type != "node" {
+		return nil
+	}
+	return red.NewClient(&red.Options{
+		Addr:     conf.Host,
+		Username: conf.User,
+		Password: conf.Pass,
+	})
+}
+
+func Channel() string {
+	return channelName
+}
+
+// Fingerprint identifies a plan's window and problem set regardless of problem order.
+func Fingerprint(plan Plan) string {
+	problems := append([]Problem(nil), plan.Problems...)
+	sort.Slice(problems, func(i, j int) bool { return problems[i].ProblemID < problems[j].ProblemID })
+	var b strings.Builder
+	fmt.Fprintf(&b, "%s|%d|%d", plan.ContestID, plan.StartAt, plan.EndAt)
+	for _, p := range problems {
+		fmt.Fprintf(&b, "|%d:%d", p.ProblemID, p.Version)
+	}
+	sum := sha256.Sum256([]byte(b.String()))
+	return hex.EncodeToString(sum[:8])
+}
+
+// Publish stores the plan for nodes that start later and broadcasts it.
+// An unchanged plan is not broadcast again; it returns whether it was published.
+func Publish(ctx context.Context, client *red.Client, plan Plan) (bool, error) {
+	if strings.TrimSpace(plan.ContestID) == "" {
+		return false, fmt.Errorf("contest_id is required")
+	}
+	if client == nil {
+		return false, nil
+	}
+	plan.Fingerprint = Fingerprint(plan)
+	plan.UpdatedAt = time.Now().UnixMilli()
+
+	existing, err := client.HGet(ctx, plansKey, plan.ContestID).Result()
+	if err != nil && err != red.Nil {
+		return false, fmt.Errorf("load contest prefetch plan failed: %w", err)
+	}
+	if existing != "" {
+		var stored Plan
+		if json.Unmarshal([]byte(existing), &stored) == nil && stored.Fingerprint == plan.Fingerprint {
+			return false, nil
+		}
+	}
+	payload, err := json.Marshal(plan)
+	if err != nil {
+		return false, fmt.Errorf("marshal contest prefetch plan failed: %w", err)
+	}
+	if err := client.HSet(ctx, plansKey, plan.ContestID, string(payload)).Err(); err != nil {
+		return false, fmt.Errorf("store contest prefetch plan failed: %w", err)
+	}
+	if err := client.Publish(ctx, Channel(), string(payload)).Err(); err != nil {
+		return false, fmt.Errorf("publish contest prefetch plan failed: %w", err)
+	}
+	return true, nil
+}
+
+// LoadActive returns stored plans whose window has not ended and drops the rest.
+func LoadActive(ctx context.Context, client *red.Client, now time.Time) ([]Plan, error) {
+	if client == nil {
+		return nil, nil
+	}
+	values, err := client.HGetAll(ctx, plansKey).Result()
+	if err != nil {
+		return nil, fmt.Errorf("load contest prefetch plans failed: %w", err)
+	}
+	plans := make([]Plan, 0, len(values))
+	var expired []string
+	for contestID, raw := range values {
+		var plan Plan
+		if err := json.Unmarshal([]byte(raw), &plan); err != nil || !plan.Active(now) {
+			expired = append(expired, contestID)
+			continue
+		}
+		plans = append(plans, plan)
+	}
+	if len(expired) > 0 {
+		_ = client.HDel(ctx, plansKey, expired...).Err()
+	}
+	return plans, nil
+}
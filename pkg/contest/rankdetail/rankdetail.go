@@ -0,0 +1,111 @@
+package rankdetail
+
+import (
+	"encoding/json"
+	"strings"
+)
+
+// CellFieldPrefix prefixes per-problem cell fields in the leaderboard member hash.
+const CellFieldPrefix = "p:"
+
+// ProblemDetail holds per-problem detail for a member.
+type ProblemDetail struct {
+	Solved           bool   `json:"solved"`
+	WrongCount       int    `json:"wrong_count"`
+	FirstACAt        int64  `json:"first_ac_at"`
+	LastSubmissionAt int64  `json:"last_submission_at"`
+	LastSubmissionID string `json:"last_submission_id"`
+	Penalty          int64  `json:"penalty"`
+	Verdict          string `json:"verdict"`
+}
+
+// MemberDetail is the member detail served to clients, assembled from problem cells.
+type MemberDetail struct {
+	Problems  map[string]json.RawMessage `json:"problems"`
+	UpdatedAt int64                      `json:"updated_at"`
+}
+
+// MarshalCell encodes one problem cell.
+func MarshalCell(detail ProblemDetail) string {
+	data, err := json.Marshal(detail)
+	if err != nil {
+		return "{}"
+	}
+	return string(data)
+}
+
+// CellField returns the member hash field holding the cell of a problem.
+func CellField(problemID string) string {
+	return CellFieldPrefix + problemID
+}
+
+// Build assembles the member detail JSON from cells keyed by problem id.
+func Build(cells map[string]string, updatedAt int64) string {
+	if len(cells) == 0 {
+		return ""
+	}
+	problems := make(map[string]json.RawMessage, len(cells))
+	for problemID, cell := range cells {
+		if !json.Valid([]byte(cell)) {
+			continue
+		}
+		problems[problemID] = json.RawMessage(cell)
+	}
+	data, err := json.Marshal(MemberDetail{Problems: problems, UpdatedAt: updatedAt})
+	if err != nil {
+		return ""
+	}
+	return string(data)
+}
+
+// Detail returns the member detail, preferring cells over a detail blob written
+// before cells existed.
+func Detail(cells map[string]string, legacy string, updatedAt int64) string {
+	if len(cells) > 0 {
+		return Build(cells, updatedAt)
+	}
+	return legacy
+}
+
+// Split breaks a member detail JSON into cells keyed by problem id.
+func Split(detailJSON string) map[string]string {
+	if detailJSON == "" {
+		return nil
+	}
+	var detail MemberDetail
+	if err := json.Unmarshal([]byte(detailJSON), &detail); err != nil {
+		return nil
+	}
+	cells := make(map[string]string, len(detail.Problems))
+	for problemID, cell := range detail.Problems {
+		cells[problemID] = string(cell)
+	}
+	return cells
+}
+
+// CellsFromHash extracts the cells of a leaderboard member hash. Fields written
+// before cells existed hold the whole member detail; only their own problem is kept.
+func CellsFromHash(fields map[string]string) map[string]string {
+	var cells map[string]string
+	for field, value := range fields {
+		if !strings.HasPrefix(field, CellFieldPrefix) || value == "" {
+			continue
+		}
+		if cells == nil {
+			cells = make(map[string]string)
+		}
+		problemID := strings.TrimPrefix(field, CellFieldPrefix)
+		cells[problemID] = normalizeCell(problemID, value)
+	}
+	return cells
+}
+
+func normalizeCell(problemID, value string) string {
+	if !strings.Contains(value, `"problems"`) {
+		return value
+	}
+	if cell, ok := Split(value)[problemID]; ok {
+		return cell
+	}
+	return value
+}
@@ -0,0 +1,246 @@
+// Package seekpack defines the seekable data pack format.
+//
+// A seekable pack stores every regular file of a tar.zst data pack as its own
+// zstd frame, followed by a JSON index and a fixed-size trailer:
+//
+//	[frame 0][frame 1]...[frame n-1][index JSON][index length: 8 bytes LE][magic: 8 bytes]
+//
+// Readers fetch the trailer and index with two ranged reads and can then
+// fetch and decode any single file without touching the rest of the object.
+package seekpack
+
+import (
+	"archive/tar"
+	"crypto/sha256"
+	"encoding/binary"
+	"encoding/hex"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"path"
+	"strings"
+
+	"github.com/klauspost/compress/zstd"
+)
+
+const (
+	// FormatVersion is bumped on incompatible index changes.
+	FormatVersion = 1
+	// TrailerSize is the byte length of the fixed trailer.
+	TrailerSize = 16
+	// ObjectSuffix is appended to the data pack key to name the seekable object.
+	ObjectSuffix = ".seekable"
+	// IndexFileName is where judges keep the index inside a lazily cached version.
+	IndexFileName = "seekable-index.json"
+
+	trailerMagic = "FUZSEEK1"
+)
+
+// Index lists every file in the pack.
+// DataPackHash is the SHA-256 of the tar.zst the pack was built from.
+type Index struct {
+	Version      int         `json:"version"`
+	DataPackHash string      `json:"dataPackHash"`
+	Files        []FileEntry `json:"files"`
+
+	// byName maps a file name to its position in Files; set by Build and ParseIndex.
+	byName map[string]int
+}
+
+// FileEntry locates one file's zstd frame within the object.
+type FileEntry struct {
+	Name           string `json:"name"`
+	Offset         int64  `json:"offset"`
+	CompressedSize int64  `json:"compressedSize"`
+	Size           int64  `json:"size"`
+	Mode           int64  `json:"mode"`
+	SHA256         string `json:"sha256"`
+}
+
+// ObjectKey returns the seekable object key for a data pack key.
+func ObjectKey(dataPackKey string) string {
+	return dataPackKey + ObjectSuffix
+}
+
+// Lookup returns the entry for a slash-separated relative name.
+func (idx *Index) Lookup(name string) (FileEntry, bool) {
+	name = path.Clean(strings.TrimPrefix(name, "./"))
+	if idx.byName != nil {
+		i, ok := idx.byName[name]
+		if !ok {
+			return FileEntry{}, false
+		}
+		return idx.Files[i], true
+	}
+	for _, f := range idx.Files {
+		if f.Name == name {
+			return f, true
+		}
+	}
+	return FileEntry{}, false
+}
+
+// indexNames validates every file name and builds the lookup map. Names must be
+// clean, relative, stay inside the pack and be unique, since judges join them
+// onto a cache directory.
+func (idx *Index) indexNames() error {
+	byName := make(map[string]int, len(idx.Files))
+	for i, f := range idx.Files {
+		if !validName(f.Name) {
+			return fmt.Errorf("invalid file name %q in seekable index", f.Name)
+		}
+		if _, ok := byName[f.Name]; ok {
+			return fmt.Errorf("duplicate file name %q in seekable index", f.Name)
+		}
+		byName[f.Name] = i
+	}
+	idx.byName = byName
+	return nil
+}
+
+func validName(name string) bool {
+	if name == "" || name == "." || name == ".." || path.IsAbs(name) {
+		return false
+	}
+	return path.Clean(name) == name && !strings.HasPrefix(name, "../")
+}
+
+type countingWriter struct {
+	w io.Writer
+	n int64
+}
+
+func (c *countingWriter) Write(p []byte) (int, error) {
+	n, err := c.w.Write(p)
+	c.n += int64(n)
+	return n, err
+}
+
+// Build converts a tar.zst data pack read from src into a seekable pack written to dst.
+// It returns the index and the SHA-256 of src so callers can reject mismatched uploads.
+func Build(src io.Reader, dst io.Writer) (Index, string, error) {
+	hasher := sha256.New()
+	zr, err := zstd.NewReader(io.TeeReader(src, hasher))
+	if err != nil {
+		return Index{}, "", fmt.Errorf("create zstd reader failed: %w", err)
+	}
+	defer zr.Close()
+
+	out := &countingWriter{w: dst}
+	enc, err := zstd.NewWriter(nil)
+	if err != nil {
+		return Index{}, "", fmt.Errorf("create zstd writer failed: %w", err)
+	}
+
+	idx := Index{Version: FormatVersion}
+	tr := tar.NewReader(zr)
+	for {
+		hdr, err := tr.Next()
+		if errors.Is(err, io.EOF) {
+			break
+		}
+		if err != nil {
+			return Index{}, "", fmt.Errorf("read tar entry failed: %w", err)
+		}
+		if hdr.Typeflag != tar.TypeReg {
+			continue
+		}
+		name := path.Clean(strings.TrimPrefix(hdr.Name, "./"))
+		if !validName(name) {
+			return Index{}, "", fmt.Errorf("invalid tar entry path %q", hdr.Name)
+		}
+		start := out.n
+		fileHash := sha256.New()
+		enc.Reset(out)
+		size, err := io.Copy(io.MultiWriter(enc, fileHash), tr)
+		if err != nil {
+			return Index{}, "", fmt.Errorf("compress %s failed: %w", name, err)
+		}
+		if err := enc.Close(); err != nil {
+			return Index{}, "", fmt.Errorf("compress %s failed: %w", name, err)
+		}
+		idx.Files = append(idx.Files, FileEntry{
+			Name:           name,
+			Offset:         start,
+			CompressedSize: out.n - start,
+			Size:           size,
+			Mode:           hdr.Mode,
+			SHA256:         hex.EncodeToString(fileHash.Sum(nil)),
+		})
+	}
+	if _, err := io.Copy(io.Discard, zr); err != nil {
+		return Index{}, "", fmt.Errorf("read data pack failed: %w", err)
+	}
+	if _, err := io.Copy(io.Discard, src); err != nil {
+		return Index{}, "", fmt.Errorf("read data pack failed: %w", err)
+	}
+	packHash := hex.EncodeToString(hasher.Sum(nil))
+	idx.DataPackHash = packHash
+	if err := idx.indexNames(); err != nil {
+		return Index{}, "", err
+	}
+
+	indexBytes, err := json.Marshal(idx)
+	if err != nil {
+		return Index{}, "", fmt.Errorf("marshal index failed: %w", err)
+	}
+	if _, err := out.Write(indexBytes); err != nil {
+		return Index{}, "", fmt.Errorf("write index failed: %w", err)
+	}
+	trailer := make([]byte, TrailerSize)
+	binary.LittleEndian.PutUint64(trailer[:8], uint64(len(indexBytes)))
+	copy(trailer[8:], trailerMagic)
+	if _, err := out.Write(trailer); err != nil {
+		return Index{}, "", fmt.Errorf("write trailer failed: %w", err)
+	}
+	return idx, packHash, nil
+}
+
+// ParseTrailer returns the index length recorded in a trailer.
+func ParseTrailer(trailer []byte) (int64, error) {
+	if len(trailer) != TrailerSize || string(trailer[8:]) != trailerMagic {
+		return 0, errors.New("invalid seekable pack trailer")
+	}
+	length := binary.LittleEndian.Uint64(trailer[:8])
+	if length == 0 || length > 1<<31 {
+		return 0, errors.New("invalid seekable pack index length")
+	}
+	return int64(length), nil
+}
+
+// ParseIndex decodes and validates an index, including every file name.
+func ParseIndex(data []byte) (Index, error) {
+	var idx Index
+	if err := json.Unmarshal(data, &idx); err != nil {
+		return Index{}, fmt.Errorf("parse seekable index failed: %w", err)
+	}
+	if idx.Version != FormatVersion {
+		return Index{}, fmt.Errorf("unsupported seekable index version %d", idx.Version)
+	}
+	if err := idx.indexNames(); err != nil {
+		return Index{}, err
+	}
+	return idx, nil
+}
+
+// DecodeFile decompresses one frame from src into dst and verifies its size and hash.
+func DecodeFile(src io.Reader, dst io.Writer, entry FileEntry) error {
+	zr, err := zstd.NewReader(src)
+	if err != nil {
+		return fmt.Errorf("create zstd reader failed: %w", err)
+	}
+	defer zr.Close()
+	hasher := sha256.New()
+	n, err := io.Copy(io.MultiWriter(dst, hasher), zr)
+	if err != nil {
+		return fmt.Errorf("decode %s failed: %w", entry.Name, err)
+	}
+	if n != entry.Size {
+		return fmt.Errorf("size mismatch for %s", entry.Name)
+	}
+	if entry.SHA256 != "" && !strings.EqualFold(hex.EncodeToString(hasher.Sum(nil)), entry.SHA256) {
+		return fmt.Errorf("hash mismatch for %s", entry.Name)
+	}
+	return nil
+}
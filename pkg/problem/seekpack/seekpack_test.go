@@ -0,0 +1,171 @@
+package seekpack
+
+import (
+	"archive/tar"
+	"bytes"
+	"crypto/sha256"
+	"encoding/hex"
+	"strconv"
+	"testing"
+
+	"github.com/klauspost/compress/zstd"
+)
+
+func buildTarZst(t *testing.T, files map[string][]byte) ([]byte, string) {
+	t.Helper()
+	var buf bytes.Buffer
+	zw, err := zstd.NewWriter(&buf)
+	if err != nil {
+		t.Fatalf("create zstd writer: %v", err)
+	}
+	tw := tar.NewWriter(zw)
+	for name, content := range files {
+		if err := tw.WriteHeader(&tar.Header{Name: name, Mode: 0644, Size: int64(len(content)), Typeflag: tar.TypeReg}); err != nil {
+			t.Fatalf("write tar header: %v", err)
+		}
+		if _, err := tw.Write(content); err != nil {
+			t.Fatalf("write tar body: %v", err)
+		}
+	}
+	if err := tw.Close(); err != nil {
+		t.Fatalf("close tar: %v", err)
+	}
+	if err := zw.Close(); err != nil {
+		t.Fatalf("close zstd: %v", err)
+	}
+	sum := sha256.Sum256(buf.Bytes())
+	return buf.Bytes(), hex.EncodeToString(sum[:])
+}
+
+// readIndex parses the trailer and index of a built pack the way judges do.
+func readIndex(t *testing.T, pack []byte) Index {
+	t.Helper()
+	length, err := ParseTrailer(pack[len(pack)-TrailerSize:])
+	if err != nil {
+		t.Fatalf("parse trailer: %v", err)
+	}
+	start := int64(len(pack)) - TrailerSize - length
+	idx, err := ParseIndex(pack[start : len(pack)-TrailerSize])
+	if err != nil {
+		t.Fatalf("parse index: %v", err)
+	}
+	return idx
+}
+
+func TestBuildRoundTrip(t *testing.T) {
+	files := map[string][]byte{
+		"manifest.json":      []byte(`{"tests":[]}`),
+		"./tests/1/in.txt":   []byte("1 2\n"),
+		"tests/1/answer.txt": bytes.Repeat([]byte("3\n"), 4096),
+	}
+	src, srcHash := buildTarZst(t, files)
+	var pack bytes.Buffer
+	built, packHash, err := Build(bytes.NewReader(src), &pack)
+	if err != nil {
+		t.Fatalf("build: %v", err)
+	}
+	if packHash != srcHash || built.DataPackHash != srcHash {
+		t.Fatalf("expected source hash %s, got %s / %s", srcHash, packHash, built.DataPackHash)
+	}
+
+	idx := readIndex(t, pack.Bytes())
+	if len(idx.Files) != len(files) {
+		t.Fatalf("expected %d files, got %d", len(files), len(idx.Files))
+	}
+	for name, want := range files {
+		entry, ok := idx.Lookup(name)
+		if !ok {
+			t.Fatalf("missing %s in index", name)
+		}
+		frame := pack.Bytes()[entry.Offset : entry.Offset+entry.CompressedSize]
+		var got bytes.Buffer
+		if err := DecodeFile(bytes.NewReader(frame), &got, entry); err != nil {
+			t.Fatalf("decode %s: %v", name, err)
+		}
+		if !bytes.Equal(got.Bytes(), want) {
+			t.Fatalf("content mismatch for %s", name)
+		}
+	}
+}
+
+func TestParseRejectsCorruptIndex(t *testing.T) {
+	src, _ := buildTarZst(t, map[string][]byte{"manifest.json": []byte(`{}`)})
+	var pack bytes.Buffer
+	if _, _, err := Build(bytes.NewReader(src), &pack); err != nil {
+		t.Fatalf("build: %v", err)
+	}
+	data := pack.Bytes()
+	trailer := data[len(data)-TrailerSize:]
+
+	badMagic := append([]byte(nil), trailer...)
+	badMagic[len(badMagic)-1] ^= 0xff
+	if _, err := ParseTrailer(badMagic); err == nil {
+		t.Fatalf("expected corrupt trailer magic to be rejected")
+	}
+	zeroLength := append([]byte(nil), trailer...)
+	copy(zeroLength[:8], make([]byte, 8))
+	if _, err := ParseTrailer(zeroLength); err == nil {
+		t.Fatalf("expected zero index length to be rejected")
+	}
+
+	length, err := ParseTrailer(trailer)
+	if err != nil {
+		t.Fatalf("parse trailer: %v", err)
+	}
+	index := append([]byte(nil), data[int64(len(data))-TrailerSize-length:len(data)-TrailerSize]...)
+	if _, err := ParseIndex(index[:len(index)/2]); err == nil {
+		t.Fatalf("expected truncated index to be rejected")
+	}
+	if _, err := ParseIndex(bytes.Replace(index, []byte(`"version":1`), []byte(`"version":9`), 1)); err == nil {
+		t.Fatalf("expected unknown index version to be rejected")
+	}
+}
+
+func TestParseIndexRejectsUnsafeNames(t *testing.T) {
+	for _, name := range []string{"/etc/passwd", "../escape", "tests/../../escape", "tests//1/in.txt", "./manifest.json", ".", ""} {
+		data := []byte(`{"version":1,"files":[{"name":` + strconv.Quote(name) + `}]}`)
+		if _, err := ParseIndex(data); err == nil {
+			t.Fatalf("expected name %q to be rejected", name)
+		}
+	}
+	dup := []byte(`{"version":1,"files":[{"name":"a.txt"},{"name":"a.txt"}]}`)
+	if _, err := ParseIndex(dup); err == nil {
+		t.Fatalf("expected duplicate names to be rejected")
+	}
+	idx, err := ParseIndex([]byte(`{"version":1,"files":[{"name":"tests/1/in.txt","size":4},{"name":"..data/x","size":7}]}`))
+	if err != nil {
+		t.Fatalf("parse index: %v", err)
+	}
+	if entry, ok := idx.Lookup("./tests/1/in.txt"); !ok || entry.Size != 4 {
+		t.Fatalf("expected lookup through the name map, got %+v ok=%v", entry, ok)
+	}
+	if _, ok := idx.Lookup("tests/2/in.txt"); ok {
+		t.Fatalf("expected missing name to miss")
+	}
+}
+
+func TestDecodeFileRejectsTruncatedFrame(t *testing.T) {
+	content := bytes.Repeat([]byte("0123456789"), 1000)
+	src, _ := buildTarZst(t, map[string][]byte{"tests/1/in.txt": content})
+	var pack bytes.Buffer
+	if _, _, err := Build(bytes.NewReader(src), &pack); err != nil {
+		t.Fatalf("build: %v", err)
+	}
+	idx := readIndex(t, pack.Bytes())
+	entry, ok := idx.Lookup("tests/1/in.txt")
+	if !ok {
+		t.Fatalf("missing entry")
+	}
+	frame := pack.Bytes()[entry.Offset : entry.Offset+entry.CompressedSize]
+
+	var out bytes.Buffer
+	if err := DecodeFile(bytes.NewReader(frame[:len(frame)/2]), &out, entry); err == nil {
+		t.Fatalf("expected truncated frame to be rejected")
+	}
+	tampered := entry
+	tampered.SHA256 = hex.EncodeToString(make([]byte, sha256.Size))
+	out.Reset()
+	if err := DecodeFile(bytes.NewReader(frame), &out, tampered); err == nil {
+		t.Fatalf("expected hash mismatch to be rejected")
+	}
+}
@@ -5,6 +5,7 @@ import (
 	"crypto/sha1"
 	"encoding/hex"
 	"errors"
+	"time"
 
 	red "github.com/redis/go-redis/v9"
 	"github.com/zeromicro/go-zero/core/stores/redis"
@@ -86,6 +87,68 @@ func Set(ctx context.Context, cacheClient *redis.Redis, submissionID, value stri
 	return nil
 }
 
+// GetMany is the pipelined Get: it loads several submissions with one round
+// trip and the same primary->legacy fallback. Misses are absent from the result.
+func GetMany(ctx context.Context, cacheClient *redis.Redis, submissionIDs []string) (map[string]string, error) {
+	values := make(map[string]string, len(submissionIDs))
+	if cacheClient == nil || len(submissionIDs) == 0 {
+		return values, nil
+	}
+	primary := make([]*red.StringCmd, len(submissionIDs))
+	legacy := make([]*red.StringCmd, len(submissionIDs))
+	err := cacheClient.PipelinedCtx(ctx, func(pipe redis.Pipeliner) error {
+		for i, id := range submissionIDs {
+			if id == "" {
+				continue
+			}
+			primary[i] = pipe.Get(ctx, PrimaryKey(id))
+			legacy[i] = pipe.Get(ctx, LegacyKey(id))
+		}
+		return nil
+	})
+	if err != nil && !errors.Is(err, red.Nil) {
+		return nil, err
+	}
+	for i, id := range submissionIDs {
+		for _, cmd := range []*red.StringCmd{primary[i], legacy[i]} {
+			if cmd == nil {
+				continue
+			}
+			val, err := cmd.Result()
+			if err != nil && !errors.Is(err, red.Nil) {
+				return nil, err
+			}
+			if val != "" {
+				values[id] = val
+				break
+			}
+		}
+	}
+	return values, nil
+}
+
+// SetMany is the pipelined Set: it writes payloads keyed by submission id to
+// both keys with one round trip.
+func SetMany(ctx context.Context, cacheClient *redis.Redis, values map[string]string, ttlSeconds int) error {
+	if cacheClient == nil || len(values) == 0 {
+		return nil
+	}
+	ttl := time.Duration(0)
+	if ttlSeconds > 0 {
+		ttl = time.Duration(ttlSeconds) * time.Second
+	}
+	return cacheClient.PipelinedCtx(ctx, func(pipe redis.Pipeliner) error {
+		for id, value := range values {
+			if id == "" {
+				continue
+			}
+			pipe.Set(ctx, PrimaryKey(id), value, ttl)
+			pipe.Set(ctx, LegacyKey(id), value, ttl)
+		}
+		return nil
+	})
+}
+
 func shortHash(value string) string {
 	if value == "" {
 		return ""
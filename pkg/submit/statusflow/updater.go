@@ -42,28 +42,16 @@ func (u *Updater) ApplySummary(ctx context.Context, next statuswriter.StatusPayl
 		if err != nil {
 			return false, "", err
 		}
-		if hit && cached != "" && cached != statuscache.NullValue {
-			var current statuswriter.StatusPayload
-			if err := json.Unmarshal([]byte(cached), &current); err == nil {
-				accept, reason := statusmonotonic.ShouldAccept(
-					current.Status,
-					current.Progress.DoneTests,
-					current.Progress.TotalTests,
-					next.Status,
-					next.Progress.DoneTests,
-					next.Progress.TotalTests,
-				)
-				if !accept {
-					return false, reason, nil
-				}
+		if hit {
+			if accept, reason := acceptOver(cached, next); !accept {
+				return false, reason, nil
 			}
 		}
-		summary := statuswriter.BuildSummary(next)
-		payload, err := json.Marshal(summary)
+		payload, err := marshalSummary(next)
 		if err != nil {
-			return false, "", fmt.Errorf("marshal status failed: %w", err)
+			return false, "", err
 		}
-		if err := statuscache.Set(ctx, u.cache, next.SubmissionID, string(payload), statusutil.TTLSeconds(u.ttl)); err != nil {
+		if err := statuscache.Set(ctx, u.cache, next.SubmissionID, payload, statusutil.TTLSeconds(u.ttl)); err != nil {
 			return false, "", err
 		}
 	}
@@ -72,3 +60,75 @@ func (u *Updater) ApplySummary(ctx context.Context, next statuswriter.StatusPayl
 	}
 	return true, "", nil
 }
+
+// ApplySummaries is the batched ApplySummary: one pipeline reads the cached
+// statuses, one writes the accepted summaries and one publishes them. It returns
+// the submission ids that were accepted.
+func (u *Updater) ApplySummaries(ctx context.Context, nexts []statuswriter.StatusPayload) ([]string, error) {
+	ids := make([]string, 0, len(nexts))
+	for _, next := range nexts {
+		if next.SubmissionID == "" {
+			return nil, fmt.Errorf("submission_id is required")
+		}
+		ids = append(ids, next.SubmissionID)
+	}
+	if u.cache == nil {
+		if err := statuspubsub.PublishMany(ctx, u.pubsub, ids); err != nil {
+			return nil, err
+		}
+		return ids, nil
+	}
+	cached, err := statuscache.GetMany(ctx, u.cache, ids)
+	if err != nil {
+		return nil, err
+	}
+	accepted := make([]string, 0, len(nexts))
+	values := make(map[string]string, len(nexts))
+	for _, next := range nexts {
+		if current, hit := cached[next.SubmissionID]; hit {
+			if accept, _ := acceptOver(current, next); !accept {
+				continue
+			}
+		}
+		payload, err := marshalSummary(next)
+		if err != nil {
+			return nil, err
+		}
+		values[next.SubmissionID] = payload
+		accepted = append(accepted, next.SubmissionID)
+	}
+	if err := statuscache.SetMany(ctx, u.cache, values, statusutil.TTLSeconds(u.ttl)); err != nil {
+		return nil, err
+	}
+	if err := statuspubsub.PublishMany(ctx, u.pubsub, accepted); err != nil {
+		return nil, err
+	}
+	return accepted, nil
+}
+
+// acceptOver applies the monotonic check of next against a cached payload.
+func acceptOver(cached string, next statuswriter.StatusPayload) (bool, string) {
+	if cached == "" || cached == statuscache.NullValue {
+		return true, ""
+	}
+	var current statuswriter.StatusPayload
+	if err := json.Unmarshal([]byte(cached), &current); err != nil {
+		return true, ""
+	}
+	return statusmonotonic.ShouldAccept(
+		current.Status,
+		current.Progress.DoneTests,
+		current.Progress.TotalTests,
+		next.Status,
+		next.Progress.DoneTests,
+		next.Progress.TotalTests,
+	)
+}
+
+func marshalSummary(next statuswriter.StatusPayload) (string, error) {
+	payload, err := json.Marshal(statuswriter.BuildSummary(next))
+	if err != nil {
+		return "", fmt.Errorf("marshal status failed: %w", err)
+	}
+	return string(payload), nil
+}
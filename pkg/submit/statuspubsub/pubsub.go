@@ -44,13 +44,46 @@ func Publish(ctx context.Context, client *red.Client, submissionID string) error
 	if client == nil {
 		return nil
 	}
-	event := Event{SubmissionID: id, UpdatedAt: time.Now().UnixMilli()}
-	payload, err := json.Marshal(event)
+	payload, err := eventPayload(id, time.Now().UnixMilli())
 	if err != nil {
-		return fmt.Errorf("marshal status pubsub event failed: %w", err)
+		return err
 	}
-	if err := client.Publish(ctx, Channel(id), string(payload)).Err(); err != nil {
+	if err := client.Publish(ctx, Channel(id), payload).Err(); err != nil {
 		return fmt.Errorf("publish status pubsub event failed: %w", err)
 	}
 	return nil
 }
+
+// PublishMany is the pipelined Publish: one event per submission, one round trip.
+func PublishMany(ctx context.Context, client *red.Client, submissionIDs []string) error {
+	if client == nil || len(submissionIDs) == 0 {
+		return nil
+	}
+	now := time.Now().UnixMilli()
+	_, err := client.Pipelined(ctx, func(pipe red.Pipeliner) error {
+		for _, submissionID := range submissionIDs {
+			id := strings.TrimSpace(submissionID)
+			if id == "" {
+				continue
+			}
+			payload, err := eventPayload(id, now)
+			if err != nil {
+				return err
+			}
+			pipe.Publish(ctx, Channel(id), payload)
+		}
+		return nil
+	})
+	if err != nil {
+		return fmt.Errorf("publish status pubsub events failed: %w", err)
+	}
+	return nil
+}
+
+func eventPayload(submissionID string, updatedAt int64) (string, error) {
+	payload, err := json.Marshal(Event{SubmissionID: submissionID, UpdatedAt: updatedAt})
+	if err != nil {
+		return "", fmt.Errorf("marshal status pubsub event failed: %w", err)
+	}
+	return string(payload), nil
+}
@@ -97,6 +97,8 @@ func main() {
 		defer ctx.ContestDispatchQueue.Stop()
 	}
 	if ctx.JudgeFinalQueue != nil {
+		ctx.JudgeFinalConsumer.Start()
+		defer ctx.JudgeFinalConsumer.Stop()
 		go ctx.JudgeFinalQueue.Start()
 		defer ctx.JudgeFinalQueue.Stop()
 	}
@@ -104,6 +106,10 @@ func main() {
 		ctx.RankOutboxRelay.Start()
 		defer ctx.RankOutboxRelay.Stop()
 	}
+	if ctx.ContestPrefetcher != nil {
+		ctx.ContestPrefetcher.Start()
+		defer ctx.ContestPrefetcher.Stop()
+	}
 	if ctx.JudgePushers.Level0 != nil {
 		defer ctx.JudgePushers.Level0.Close()
 	}
@@ -27,6 +27,7 @@ type Config struct {
 	RankUpdate      RankUpdateConfig      `json:"rankUpdate"`
 	RankOutbox      RankOutboxConfig      `json:"rankOutbox"`
 	Leaderboard     LeaderboardConfig     `json:"leaderboard"`
+	Prefetch        PrefetchConfig        `json:"prefetch,optional"`
 	Timeouts        TimeoutConfig         `json:"timeouts"`
 }
 
@@ -84,6 +85,9 @@ type JudgeFinalConfig struct {
 	DeadLetterTopic string        `json:"deadLetterTopic"`
 	MessageTTL      time.Duration `json:"messageTTL"`
 	IdempotencyTTL  time.Duration `json:"idempotencyTTL"`
+	// BatchSize > 1 scores concurrently consumed messages in one transaction per BatchWindow.
+	BatchSize   int           `json:"batchSize,optional"`
+	BatchWindow time.Duration `json:"batchWindow,optional"`
 }
 
 type RankUpdateConfig struct {
@@ -104,6 +108,14 @@ type RankOutboxConfig struct {
 	RequeueBatchSize    int           `json:"requeueBatchSize"`
 }
 
+// PrefetchConfig controls data pack warm-up plans sent to judge nodes.
+// LeadTime is how long before start a contest is announced; zero disables it.
+type PrefetchConfig struct {
+	LeadTime     time.Duration `json:"leadTime,optional"`
+	ScanInterval time.Duration `json:"scanInterval,optional"`
+	ScanBatch    int           `json:"scanBatch,optional"`
+}
+
 type LeaderboardConfig struct {
 	HotCacheTTL      time.Duration `json:"hotCacheTTL"`
 	PageCacheTTL     time.Duration `json:"pageCacheTTL"`
@@ -0,0 +1,127 @@
+package consumer
+
+import (
+	"context"
+	"sync"
+	"time"
+
+	"fuzoj/pkg/contest/prefetchpubsub"
+	"fuzoj/services/contest_service/internal/repository"
+
+	red "github.com/redis/go-redis/v9"
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+type ContestPrefetcherOptions struct {
+	LeadTime     time.Duration
+	ScanInterval time.Duration
+	ScanBatch    int
+	DBTimeout    time.Duration
+}
+
+// ContestPrefetcher publishes data pack warm-up plans for contests about to start,
+// so judge nodes pull and pin problem data before the first submission.
+type ContestPrefetcher struct {
+	contests repository.ContestRepository
+	problems repository.ContestProblemStore
+	client   *red.Client
+	options  ContestPrefetcherOptions
+	stopCh   chan struct{}
+	done     chan struct{}
+	once     sync.Once
+}
+
+func NewContestPrefetcher(contests repository.ContestRepository, problems repository.ContestProblemStore, client *red.Client, options ContestPrefetcherOptions) *ContestPrefetcher {
+	if options.LeadTime <= 0 {
+		options.LeadTime = 10 * time.Minute
+	}
+	if options.ScanInterval <= 0 {
+		options.ScanInterval = 30 * time.Second
+	}
+	if options.ScanBatch <= 0 {
+		options.ScanBatch = 64
+	}
+	return &ContestPrefetcher{
+		contests: contests,
+		problems: problems,
+		client:   client,
+		options:  options,
+		stopCh:   make(chan struct{}),
+		done:     make(chan struct{}),
+	}
+}
+
+func (p *ContestPrefetcher) Start() {
+	if p == nil {
+		return
+	}
+	logx.Infof("contest prefetcher started, lead=%s", p.options.LeadTime)
+	go p.run(context.Background())
+}
+
+func (p *ContestPrefetcher) Stop() {
+	if p == nil {
+		return
+	}
+	p.once.Do(func() {
+		close(p.stopCh)
+		<-p.done
+	})
+}
+
+func (p *ContestPrefetcher) run(ctx context.Context) {
+	defer close(p.done)
+	ticker := time.NewTicker(p.options.ScanInterval)
+	defer ticker.Stop()
+	for {
+		p.scan(ctx, time.Now())
+		select {
+		case <-p.stopCh:
+			return
+		case <-ticker.C:
+		}
+	}
+}
+
+// scan publishes plans for contests starting within the lead time or already running.
+// Unchanged plans are skipped by the publisher, so each window is announced once
+// unless its problem set or schedule changes.
+func (p *ContestPrefetcher) scan(ctx context.Context, now time.Time) {
+	logger := logx.WithContext(ctx)
+	listCtx := withTimeout(ctx, p.options.DBTimeout)
+	contests, err := p.contests.ListStartingBefore(listCtx.ctx, now, now.Add(p.options.LeadTime), p.options.ScanBatch)
+	listCtx.cancel()
+	if err != nil {
+		logger.Errorf("list upcoming contests failed: %v", err)
+		return
+	}
+	for _, contest := range contests {
+		problemCtx := withTimeout(ctx, p.options.DBTimeout)
+		items, err := p.problems.List(problemCtx.ctx, contest.ContestID)
+		problemCtx.cancel()
+		if err != nil {
+			logger.Errorf("list contest problems failed, contest=%s err=%v", contest.ContestID, err)
+			continue
+		}
+		if len(items) == 0 {
+			continue
+		}
+		plan := prefetchpubsub.Plan{
+			ContestID: contest.ContestID,
+			StartAt:   contest.StartAt.UnixMilli(),
+			EndAt:     contest.EndAt.UnixMilli(),
+			Problems:  make([]prefetchpubsub.Problem, 0, len(items)),
+		}
+		for _, item := range items {
+			plan.Problems = append(plan.Problems, prefetchpubsub.Problem{ProblemID: item.ProblemID, Version: item.Version})
+		}
+		published, err := prefetchpubsub.Publish(ctx, p.client, plan)
+		if err != nil {
+			logger.Errorf("publish contest prefetch plan failed, contest=%s err=%v", contest.ContestID, err)
+			continue
+		}
+		if published {
+			logger.Infof("contest prefetch plan published, contest=%s problems=%d start_at=%s", contest.ContestID, len(plan.Problems), contest.StartAt.Format(time.RFC3339))
+		}
+	}
+}
@@ -0,0 +1,127 @@
+package consumer
+
+import (
+	"context"
+	"sync"
+	"time"
+
+	appErr "fuzoj/pkg/errors"
+)
+
+const defaultJudgeFinalBatchWindow = 10 * time.Millisecond
+
+// judgeFinalBatcher gathers concurrent Consume calls into one scoring pass.
+// Submit blocks until the item's batch is committed, so kq only commits offsets
+// of messages that are durably scored.
+type judgeFinalBatcher struct {
+	size   int
+	window time.Duration
+	flush  func(ctx context.Context, items []*judgeFinalItem)
+
+	mu       sync.Mutex
+	buffer   []*judgeFinalItem
+	stopped  bool
+	signalCh chan struct{}
+	stopCh   chan struct{}
+	doneCh   chan struct{}
+}
+
+func newJudgeFinalBatcher(size int, window time.Duration, flush func(ctx context.Context, items []*judgeFinalItem)) *judgeFinalBatcher {
+	if window <= 0 {
+		window = defaultJudgeFinalBatchWindow
+	}
+	return &judgeFinalBatcher{
+		size:     size,
+		window:   window,
+		flush:    flush,
+		signalCh: make(chan struct{}, 1),
+		stopCh:   make(chan struct{}),
+		doneCh:   make(chan struct{}),
+	}
+}
+
+func (b *judgeFinalBatcher) Start() {
+	go b.run()
+}
+
+func (b *judgeFinalBatcher) Stop() {
+	b.mu.Lock()
+	b.stopped = true
+	b.mu.Unlock()
+	close(b.stopCh)
+	<-b.doneCh
+}
+
+// Submit queues the item for the next flush and waits for its result.
+func (b *judgeFinalBatcher) Submit(ctx context.Context, item *judgeFinalItem) error {
+	item.done = make(chan struct{})
+	b.mu.Lock()
+	if b.stopped {
+		b.mu.Unlock()
+		return appErr.New(appErr.ServiceUnavailable).WithMessage("judge final batcher is stopped")
+	}
+	b.buffer = append(b.buffer, item)
+	full := len(b.buffer) >= b.size
+	b.mu.Unlock()
+	if full {
+		select {
+		case b.signalCh <- struct{}{}:
+		default:
+		}
+	}
+	select {
+	case <-item.done:
+		return item.err
+	case <-ctx.Done():
+		return ctx.Err()
+	}
+}
+
+func (b *judgeFinalBatcher) run() {
+	ticker := time.NewTicker(b.window)
+	defer func() {
+		ticker.Stop()
+		b.flushPending(context.Background())
+		close(b.doneCh)
+	}()
+	for {
+		select {
+		case <-b.stopCh:
+			return
+		case <-ticker.C:
+			b.flushPending(context.Background())
+		case <-b.signalCh:
+			b.flushPending(context.Background())
+		}
+	}
+}
+
+// flushPending scores everything buffered so far in chunks of at most size items.
+func (b *judgeFinalBatcher) flushPending(ctx context.Context) {
+	for {
+		b.mu.Lock()
+		n := len(b.buffer)
+		if n == 0 {
+			b.mu.Unlock()
+			return
+		}
+		if n > b.size {
+			n = b.size
+		}
+		items := make([]*judgeFinalItem, n)
+		copy(items, b.buffer)
+		b.buffer = append(b.buffer[:0], b.buffer[n:]...)
+		b.mu.Unlock()
+
+		b.flush(ctx, items)
+		for _, item := range items {
+			close(item.done)
+		}
+	}
+}
+
+func (b *judgeFinalBatcher) bufferedLen() int {
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	return len(b.buffer)
+}
@@ -0,0 +1,109 @@
+package consumer
+
+import (
+	"context"
+	"errors"
+	"sync"
+	"testing"
+	"time"
+
+	contestRepo "fuzoj/pkg/contest/repository"
+	"fuzoj/services/contest_service/internal/pmodel"
+	"fuzoj/services/contest_service/internal/repository"
+)
+
+func TestJudgeFinalBatcherGroupsConcurrentItems(t *testing.T) {
+	var sizes []int
+	failed := errors.New("score failed")
+	batcher := newJudgeFinalBatcher(8, time.Hour, func(_ context.Context, items []*judgeFinalItem) {
+		sizes = append(sizes, len(items))
+		for _, item := range items {
+			if item.key == "bad" {
+				item.err = failed
+			}
+		}
+	})
+
+	keys := []string{"a", "b", "bad", "c", "d"}
+	errs := make([]error, len(keys))
+	var wg sync.WaitGroup
+	for i, key := range keys {
+		wg.Add(1)
+		go func(i int, key string) {
+			defer wg.Done()
+			errs[i] = batcher.Submit(context.Background(), &judgeFinalItem{key: key})
+		}(i, key)
+	}
+	deadline := time.Now().Add(time.Second)
+	for batcher.bufferedLen() < len(keys) {
+		if time.Now().After(deadline) {
+			t.Fatalf("expected %d buffered items, got %d", len(keys), batcher.bufferedLen())
+		}
+		time.Sleep(time.Millisecond)
+	}
+	batcher.flushPending(context.Background())
+	wg.Wait()
+
+	if len(sizes) != 1 || sizes[0] != len(keys) {
+		t.Fatalf("expected one batch of %d items, got %v", len(keys), sizes)
+	}
+	for i, key := range keys {
+		if key == "bad" {
+			if !errors.Is(errs[i], failed) {
+				t.Fatalf("expected failure for %s, got %v", key, errs[i])
+			}
+			continue
+		}
+		if errs[i] != nil {
+			t.Fatalf("expected success for %s, got %v", key, errs[i])
+		}
+	}
+}
+
+func TestScoringBatchAppliesEventsInOrder(t *testing.T) {
+	start := time.Unix(1_700_000_000, 0)
+	meta := contestRepo.ContestMeta{ContestID: "c1", StartAt: start, PenaltyMinutes: 20}
+	batch := newScoringBatch(meta, map[repository.MemberProblemKey]repository.MemberProblemState{}, map[string]repository.MemberSummarySnapshot{})
+
+	items := []*judgeFinalItem{
+		scoringItem("s1", "10", 1, "WA", start.Add(5*time.Minute)),
+		scoringItem("s2", "10", 1, "AC", start.Add(30*time.Minute)),
+		scoringItem("s3", "10", 1, "WA", start.Add(40*time.Minute)),
+		scoringItem("s4", "11", 2, "AC", start.Add(10*time.Minute)),
+	}
+	for _, item := range items {
+		if err := batch.apply(item); err != nil {
+			t.Fatalf("apply %s failed: %v", item.status.SubmissionID, err)
+		}
+	}
+
+	if len(batch.updates) != 3 {
+		t.Fatalf("expected 3 rank updates, got %d", len(batch.updates))
+	}
+	last := batch.updates[1].event
+	if last.MemberID != "10" || last.ACCount != 1 || last.Penalty != 50*60 || last.Version != "2" {
+		t.Fatalf("unexpected update after AC: %+v", last)
+	}
+	states := batch.dirtyStates()
+	if len(states) != 2 || states[0].MemberID != "10" || states[0].WrongCount != 1 || !states[0].Solved {
+		t.Fatalf("unexpected dirty states: %+v", states)
+	}
+	summaries := batch.dirtySummaries()
+	if len(summaries) != 2 || summaries[0].Version != 2 || summaries[1].Version != 1 {
+		t.Fatalf("unexpected dirty summaries: %+v", summaries)
+	}
+}
+
+func scoringItem(submissionID, userID string, problemID int64, verdict string, submitAt time.Time) *judgeFinalItem {
+	return &judgeFinalItem{
+		status: pmodel.JudgeStatusResponse{
+			SubmissionID: submissionID,
+			ContestID:    "c1",
+			UserID:       userID,
+			ProblemID:    problemID,
+			Verdict:      verdict,
+		},
+		finishedAt: submitAt.Unix(),
+		submitAt:   submitAt,
+	}
+}
@@ -3,13 +3,16 @@ package consumer
 import (
 	"context"
 	"encoding/json"
+	"errors"
 	"fmt"
+	"sort"
 	"strconv"
 	"strings"
 	"time"
 
 	dbutil "fuzoj/internal/common/db"
 	"fuzoj/pkg/contest/eligibility"
+	"fuzoj/pkg/contest/rankdetail"
 	contestRepo "fuzoj/pkg/contest/repository"
 	"fuzoj/pkg/contest/score"
 	appErr "fuzoj/pkg/errors"
@@ -17,6 +20,7 @@ import (
 	"fuzoj/services/contest_service/internal/pmodel"
 	"fuzoj/services/contest_service/internal/repository"
 
+	red "github.com/redis/go-redis/v9"
 	"github.com/zeromicro/go-queue/kq"
 	"github.com/zeromicro/go-zero/core/logx"
 	"github.com/zeromicro/go-zero/core/stores/redis"
@@ -37,19 +41,39 @@ type JudgeFinalConsumer struct {
 	rankOutboxRepo   *repository.RankOutboxRepository
 	statusWriter     *statuswriter.FinalStatusWriter
 	deadLetterPusher *kq.Pusher
+	batcher          *judgeFinalBatcher
 	opts             JudgeFinalOptions
 	timeouts         TimeoutConfig
 }
 
 // JudgeFinalOptions holds consumer options.
+// BatchSize > 1 scores concurrent messages together, flushing every BatchWindow.
 type JudgeFinalOptions struct {
 	IdempotencyTTL  time.Duration
 	MessageTTL      time.Duration
 	MaxRetries      int
 	RetryDelay      time.Duration
 	DeadLetterTopic string
+	BatchSize       int
+	BatchWindow     time.Duration
 }
 
+// judgeFinalItem is one final status message moving through a scoring pass.
+type judgeFinalItem struct {
+	key        string
+	value      string
+	status     pmodel.JudgeStatusResponse
+	userID     int64
+	finishedAt int64
+	submitAt   time.Time
+	idemKey    string
+	claimed    bool
+	err        error
+	done       chan struct{}
+}
+
+var errRankOutboxDuplicate = errors.New("rank outbox event already exists")
+
 // NewJudgeFinalConsumer creates a judge final status consumer.
 func NewJudgeFinalConsumer(
 	conn sqlx.SqlConn,
@@ -72,7 +96,7 @@ func NewJudgeFinalConsumer(
 	if opts.RetryDelay <= 0 {
 		opts.RetryDelay = time.Second
 	}
-	return &JudgeFinalConsumer{
+	c := &JudgeFinalConsumer{
 		conn:           conn,
 		redis:          redisClient,
 		contestRepo:    contestRepository,
@@ -82,6 +106,10 @@ func NewJudgeFinalConsumer(
 		opts:           opts,
 		timeouts:       timeouts,
 	}
+	if opts.BatchSize > 1 {
+		c.batcher = newJudgeFinalBatcher(opts.BatchSize, opts.BatchWindow, c.handleBatch)
+	}
+	return c
 }
 
 // SetDeadLetterPusher configures the dead-letter pusher.
@@ -89,6 +117,20 @@ func (c *JudgeFinalConsumer) SetDeadLetterPusher(pusher *kq.Pusher) {
 	c.deadLetterPusher = pusher
 }
 
+// Start launches the batch flusher when batching is enabled.
+func (c *JudgeFinalConsumer) Start() {
+	if c != nil && c.batcher != nil {
+		c.batcher.Start()
+	}
+}
+
+// Stop flushes buffered messages and stops the batch flusher.
+func (c *JudgeFinalConsumer) Stop() {
+	if c != nil && c.batcher != nil {
+		c.batcher.Stop()
+	}
+}
+
 // Consume handles final status messages.
 func (c *JudgeFinalConsumer) Consume(ctx context.Context, key, value string) error {
 	if value == "" {
@@ -101,7 +143,7 @@ func (c *JudgeFinalConsumer) Consume(ctx context.Context, key, value string) err
 	}
 
 	for attempt := 0; attempt <= c.opts.MaxRetries; attempt++ {
-		if err := c.handle(ctx, key, value); err == nil {
+		if err := c.process(ctx, key, value); err == nil {
 			return nil
 		} else if attempt >= c.opts.MaxRetries {
 			if c.opts.DeadLetterTopic != "" && c.deadLetterPusher != nil {
@@ -120,269 +162,503 @@ func (c *JudgeFinalConsumer) Consume(ctx context.Context, key, value string) err
 	return nil
 }
 
-func (c *JudgeFinalConsumer) handle(ctx context.Context, key, value string) (retErr error) {
+func (c *JudgeFinalConsumer) process(ctx context.Context, key, value string) error {
+	if c.batcher != nil {
+		return c.batcher.Submit(ctx, &judgeFinalItem{key: key, value: value})
+	}
+	return c.handle(ctx, key, value)
+}
+
+func (c *JudgeFinalConsumer) handle(ctx context.Context, key, value string) error {
+	item := &judgeFinalItem{key: key, value: value}
+	c.handleBatch(ctx, []*judgeFinalItem{item})
+	return item.err
+}
+
+// handleBatch scores items in one transaction and records a result per item.
+// Idempotency claims are pipelined, contest meta is loaded once per contest, and
+// a failed multi-item transaction falls back to scoring each item on its own so
+// one bad message cannot fail its neighbours.
+func (c *JudgeFinalConsumer) handleBatch(ctx context.Context, items []*judgeFinalItem) {
 	logger := logx.WithContext(ctx)
-	var (
-		idemKey   string
-		idemKeyOk bool
-	)
-	defer func() {
-		if !idemKeyOk || retErr == nil || c.redis == nil {
+	defer c.releaseIdempotency(ctx, items)
+
+	pending := make([]*judgeFinalItem, 0, len(items))
+	for _, item := range items {
+		ok, err := c.decode(ctx, item)
+		if err != nil {
+			item.err = err
+			continue
+		}
+		if ok {
+			pending = append(pending, item)
+		}
+	}
+	pending = c.claimIdempotency(ctx, pending)
+	pending = c.checkEligibility(ctx, pending)
+	metas := c.loadContestMeta(ctx, pending)
+	scoring := pending[:0]
+	for _, item := range pending {
+		if item.err == nil {
+			scoring = append(scoring, item)
+		}
+	}
+	if len(scoring) == 0 {
+		return
+	}
+
+	err := c.conn.TransactCtx(ctx, func(ctx context.Context, session sqlx.Session) error {
+		return applyScoringBatch(ctx, session, metas, scoring)
+	})
+	if err != nil && !(errors.Is(err, errRankOutboxDuplicate) && len(scoring) == 1) {
+		if len(scoring) == 1 {
+			scoring[0].err = err
 			return
 		}
-		ctxCache := withTimeout(context.Background(), c.timeouts.Cache)
-		if _, delErr := c.redis.DelCtx(ctxCache.ctx, idemKey); delErr != nil {
-			logger.Errorf("clear judge final idempotency key failed: key=%s err=%v", idemKey, delErr)
+		logger.Errorf("judge final batch failed, scoring items one by one: size=%d err=%v", len(scoring), err)
+		for _, item := range scoring {
+			item.err = err
 		}
-		ctxCache.cancel()
-	}()
+		c.releaseIdempotency(ctx, scoring)
+		for _, item := range scoring {
+			item.err = c.handle(ctx, item.key, item.value)
+		}
+		return
+	}
+	if c.statusWriter == nil {
+		return
+	}
+	for _, item := range scoring {
+		status := item.status
+		ctxMQ := withTimeout(ctx, c.timeouts.MQ)
+		item.err = c.statusWriter.WriteFinalStatus(ctxMQ.ctx, statuswriter.StatusPayload{
+			SubmissionID: status.SubmissionID,
+			Status:       status.Status,
+			Verdict:      status.Verdict,
+			Timestamps: statuswriter.Timestamps{
+				ReceivedAt: status.Timestamps.ReceivedAt,
+				FinishedAt: status.Timestamps.FinishedAt,
+			},
+			Progress: statuswriter.Progress{TotalTests: 0, DoneTests: 0},
+		})
+		ctxMQ.cancel()
+	}
+}
 
+// decode parses the message and reports whether it needs scoring.
+func (c *JudgeFinalConsumer) decode(ctx context.Context, item *judgeFinalItem) (bool, error) {
+	logger := logx.WithContext(ctx)
 	var event pmodel.StatusEvent
-	if err := json.Unmarshal([]byte(value), &event); err != nil {
+	if err := json.Unmarshal([]byte(item.value), &event); err != nil {
 		logger.Errorf("decode judge final event failed: %v", err)
-		return appErr.Wrapf(err, appErr.InvalidParams, "decode judge final event failed")
+		return false, appErr.Wrapf(err, appErr.InvalidParams, "decode judge final event failed")
 	}
 	if event.Type != pmodel.StatusEventFinal {
-		return nil
+		return false, nil
 	}
 	status := event.Status
 	if status.SubmissionID == "" || status.ContestID == "" || strings.TrimSpace(status.UserID) == "" || status.ProblemID <= 0 {
-		return nil
+		return false, nil
 	}
 
 	if c.opts.MessageTTL > 0 && event.CreatedAt > 0 {
 		if time.Since(time.Unix(event.CreatedAt, 0)) > c.opts.MessageTTL {
 			logger.Infof("judge final event expired submission_id=%s", status.SubmissionID)
-			return nil
+			return false, nil
 		}
 	}
 
+	userID, err := strconv.ParseInt(status.UserID, 10, 64)
+	if err != nil || userID <= 0 {
+		return false, nil
+	}
 	finishedAt := status.Timestamps.FinishedAt
 	if finishedAt <= 0 {
 		finishedAt = event.CreatedAt
 	}
+	item.status = status
+	item.userID = userID
+	item.finishedAt = finishedAt
+	item.submitAt = submissionTime(status)
+	item.idemKey = rankIdemKeyPrefix + status.SubmissionID + ":" + fmt.Sprint(finishedAt)
+	return true, nil
+}
 
-	if c.redis != nil {
-		idemKey = rankIdemKeyPrefix + status.SubmissionID + ":" + fmt.Sprint(finishedAt)
-		ok, err := c.redis.SetnxExCtx(ctx, idemKey, "1", ttlSeconds(c.opts.IdempotencyTTL))
-		if err != nil {
-			logger.Errorf("judge final idempotency failed: %v", err)
-			return appErr.Wrapf(err, appErr.CacheError, "judge final idempotency failed")
+// claimIdempotency sets the idempotency keys of all items in one pipeline and
+// drops the items another delivery has already claimed.
+func (c *JudgeFinalConsumer) claimIdempotency(ctx context.Context, items []*judgeFinalItem) []*judgeFinalItem {
+	if c.redis == nil || len(items) == 0 {
+		return items
+	}
+	ttl := time.Duration(ttlSeconds(c.opts.IdempotencyTTL)) * time.Second
+	cmds := make([]*red.BoolCmd, len(items))
+	err := c.redis.PipelinedCtx(ctx, func(pipe redis.Pipeliner) error {
+		for i, item := range items {
+			cmds[i] = pipe.SetNX(ctx, item.idemKey, "1", ttl)
+		}
+		return nil
+	})
+	if err != nil {
+		logx.WithContext(ctx).Errorf("judge final idempotency failed: %v", err)
+	}
+	claimed := items[:0]
+	for i, item := range items {
+		if cmds[i] == nil {
+			item.err = appErr.Wrapf(err, appErr.CacheError, "judge final idempotency failed")
+			continue
+		}
+		ok, cmdErr := cmds[i].Result()
+		if cmdErr != nil {
+			item.err = appErr.Wrapf(cmdErr, appErr.CacheError, "judge final idempotency failed")
+			continue
 		}
 		if !ok {
-			return nil
+			continue
 		}
-		idemKeyOk = true
+		item.claimed = true
+		claimed = append(claimed, item)
 	}
+	return claimed
+}
 
-	userID, err := strconv.ParseInt(status.UserID, 10, 64)
-	if err != nil || userID <= 0 {
-		return nil
+// releaseIdempotency clears the keys of claimed items that failed so a retry can score them.
+func (c *JudgeFinalConsumer) releaseIdempotency(ctx context.Context, items []*judgeFinalItem) {
+	if c.redis == nil {
+		return
 	}
-	submitAt := submissionTime(status)
-	ctxMQ := withTimeout(ctx, c.timeouts.MQ)
-	defer ctxMQ.cancel()
-
-	result, err := c.eligibilitySvc.Check(ctxMQ.ctx, eligibility.Request{
-		ContestID: status.ContestID,
-		UserID:    userID,
-		ProblemID: status.ProblemID,
-		Now:       submitAt,
-	})
-	if err != nil {
-		logger.Errorf("contest eligibility check failed: %v", err)
-		return err
+	keys := make([]string, 0, len(items))
+	for _, item := range items {
+		if item.claimed && item.err != nil {
+			keys = append(keys, item.idemKey)
+			item.claimed = false
+		}
 	}
-	if !result.OK {
-		return nil
+	if len(keys) == 0 {
+		return
 	}
-
-	meta, err := c.contestRepo.GetMeta(ctxMQ.ctx, status.ContestID)
-	if err != nil {
-		logger.Errorf("load contest meta failed: %v", err)
-		return err
+	ctxCache := withTimeout(context.Background(), c.timeouts.Cache)
+	defer ctxCache.cancel()
+	if _, err := c.redis.DelCtx(ctxCache.ctx, keys...); err != nil {
+		logx.WithContext(ctx).Errorf("clear judge final idempotency key failed: keys=%v err=%v", keys, err)
 	}
+}
 
-	err = c.conn.TransactCtx(ctx, func(ctx context.Context, session sqlx.Session) error {
-		memberProblemRepo := repository.NewMemberProblemRepository(session)
-		memberSummaryRepo := repository.NewMemberSummaryRepository(session)
-		outboxRepo := repository.NewRankOutboxRepository(session)
-
-		memberID := status.UserID
-		problemID := status.ProblemID
-		problemKey := fmt.Sprint(problemID)
-
-		state, found, err := memberProblemRepo.Get(ctx, status.ContestID, memberID, problemID)
+// checkEligibility drops ineligible items and records check failures per item.
+func (c *JudgeFinalConsumer) checkEligibility(ctx context.Context, items []*judgeFinalItem) []*judgeFinalItem {
+	eligible := items[:0]
+	for _, item := range items {
+		if item.err != nil {
+			continue
+		}
+		ctxMQ := withTimeout(ctx, c.timeouts.MQ)
+		result, err := c.eligibilitySvc.Check(ctxMQ.ctx, eligibility.Request{
+			ContestID: item.status.ContestID,
+			UserID:    item.userID,
+			ProblemID: item.status.ProblemID,
+			Now:       item.submitAt,
+		})
+		ctxMQ.cancel()
 		if err != nil {
-			return err
+			logx.WithContext(ctx).Errorf("contest eligibility check failed: %v", err)
+			item.err = err
+			continue
 		}
-		if found && state.Solved {
-			_, summaryFound, err := memberSummaryRepo.Get(ctx, status.ContestID, memberID)
-			if err != nil {
-				return err
-			}
-			if !summaryFound {
-				return fmt.Errorf("member summary not found for solved state, contest=%s member=%s", status.ContestID, memberID)
-			}
-			return nil
+		if result.OK {
+			eligible = append(eligible, item)
 		}
+	}
+	return eligible
+}
 
-		isAC := strings.EqualFold(status.Verdict, "AC")
-		if !found {
-			state = repository.MemberProblemState{
-				ContestID: status.ContestID,
-				MemberID:  memberID,
-				ProblemID: problemID,
-			}
+// loadContestMeta loads contest meta once per contest; a failure is recorded on every item of that contest.
+func (c *JudgeFinalConsumer) loadContestMeta(ctx context.Context, items []*judgeFinalItem) map[string]contestRepo.ContestMeta {
+	metas := make(map[string]contestRepo.ContestMeta)
+	failed := make(map[string]error)
+	for _, item := range items {
+		contestID := item.status.ContestID
+		if _, ok := metas[contestID]; ok {
+			continue
 		}
-		if !isAC {
-			state.WrongCount++
+		if err, ok := failed[contestID]; ok {
+			item.err = err
+			continue
 		}
-		state.LastSubmissionID = status.SubmissionID
-		state.LastSubmissionAt = submitAt
-		if isAC {
-			state.Solved = true
-			state.FirstACAt = submitAt
-			state.Score = 1
-			state.Penalty = score.ICPCPenaltyWithMinutes(meta.StartAt, submitAt, state.WrongCount, meta.PenaltyMinutes)
+		ctxMQ := withTimeout(ctx, c.timeouts.MQ)
+		meta, err := c.contestRepo.GetMeta(ctxMQ.ctx, contestID)
+		ctxMQ.cancel()
+		if err != nil {
+			logx.WithContext(ctx).Errorf("load contest meta failed: %v", err)
+			failed[contestID] = err
+			item.err = err
+			continue
 		}
-		state.UpdatedAt = time.Now()
+		metas[contestID] = meta
+	}
+	return metas
+}
 
-		if err := memberProblemRepo.Upsert(ctx, state); err != nil {
-			return err
+// applyScoringBatch scores items inside one transaction. Items whose outbox event
+// already exists were committed by an earlier delivery and are skipped.
+func applyScoringBatch(ctx context.Context, session sqlx.Session, metas map[string]contestRepo.ContestMeta, items []*judgeFinalItem) error {
+	memberProblemRepo := repository.NewMemberProblemRepository(session)
+	memberSummaryRepo := repository.NewMemberSummaryRepository(session)
+	outboxRepo := repository.NewRankOutboxRepository(session)
+
+	eventKeys := make([]string, 0, len(items))
+	for _, item := range items {
+		eventKeys = append(eventKeys, item.eventKey())
+	}
+	existing, err := outboxRepo.ExistingEventKeys(ctx, eventKeys)
+	if err != nil {
+		return fmt.Errorf("load rank outbox event keys failed: %w", err)
+	}
+
+	var contests []string
+	groups := make(map[string][]*judgeFinalItem)
+	for _, item := range items {
+		eventKey := item.eventKey()
+		if _, ok := existing[eventKey]; ok {
+			continue
 		}
+		existing[eventKey] = struct{}{}
+		contestID := item.status.ContestID
+		if _, ok := groups[contestID]; !ok {
+			contests = append(contests, contestID)
+		}
+		groups[contestID] = append(groups[contestID], item)
+	}
+	sort.Strings(contests)
 
-		summary, summaryFound, err := memberSummaryRepo.Get(ctx, status.ContestID, memberID)
+	for _, contestID := range contests {
+		group := groups[contestID]
+		keys, memberIDs := scoringKeys(group)
+		states, err := memberProblemRepo.GetBatch(ctx, contestID, keys)
 		if err != nil {
 			return err
 		}
-		if !summaryFound {
-			summary = repository.MemberSummarySnapshot{
-				ContestID: status.ContestID,
-				MemberID:  memberID,
-			}
+		summaries, err := memberSummaryRepo.GetBatch(ctx, contestID, memberIDs)
+		if err != nil {
+			return err
 		}
-
-		detail := parseMemberDetail(summary.DetailJSON)
-		if detail.Problems == nil {
-			detail.Problems = make(map[string]ProblemDetail)
+		batch := newScoringBatch(metas[contestID], states, summaries)
+		for _, item := range group {
+			if err := batch.apply(item); err != nil {
+				return err
+			}
 		}
-		detail.Problems[problemKey] = ProblemDetail{
-			Solved:           state.Solved,
-			WrongCount:       state.WrongCount,
-			FirstACAt:        unixTime(state.FirstACAt),
-			LastSubmissionAt: unixTime(state.LastSubmissionAt),
-			LastSubmissionID: state.LastSubmissionID,
-			Penalty:          state.Penalty,
-			Verdict:          status.Verdict,
+		if len(batch.updates) == 0 {
+			continue
 		}
-		detail.UpdatedAt = time.Now().Unix()
-
-		if isAC {
-			summary.ACCount++
-			summary.ScoreTotal++
-			summary.PenaltyTotal += state.Penalty
+		if err := memberProblemRepo.UpsertBatch(ctx, batch.dirtyStates()); err != nil {
+			return err
 		}
-		summary.Version++
-		summary.DetailJSON = mustMarshalDetail(detail)
-		summary.UpdatedAt = time.Now()
-
-		if err := memberSummaryRepo.Upsert(ctx, summary); err != nil {
+		if err := memberSummaryRepo.UpsertBatch(ctx, batch.dirtySummaries()); err != nil {
 			return err
 		}
 
-		resultID, err := outboxRepo.NextResultIDTx(ctx, status.ContestID)
+		firstID, err := outboxRepo.NextResultIDsTx(ctx, contestID, len(batch.updates))
 		if err != nil {
 			return fmt.Errorf("allocate rank result id failed: %w", err)
 		}
-
-		update := pmodel.RankUpdateEvent{
-			ContestID:  status.ContestID,
-			MemberID:   memberID,
-			ProblemID:  problemKey,
-			SortScore:  score.SortScore(summary.ScoreTotal, summary.PenaltyTotal),
-			ScoreTotal: summary.ScoreTotal,
-			Penalty:    summary.PenaltyTotal,
-			ACCount:    summary.ACCount,
-			DetailJSON: summary.DetailJSON,
-			Version:    fmt.Sprint(summary.Version),
-			ResultID:   resultID,
-			UpdatedAt:  summary.UpdatedAt.Unix(),
-		}
-		payload, err := json.Marshal(update)
-		if err != nil {
-			return fmt.Errorf("marshal rank update failed: %w", err)
-		}
-		outboxEvent := repository.RankOutboxEvent{
-			ContestID: status.ContestID,
-			EventKey:  buildRankOutboxEventKey(status.ContestID, status.SubmissionID, finishedAt),
-			Payload:   string(payload),
+		events := make([]repository.RankOutboxEvent, 0, len(batch.updates))
+		for i, update := range batch.updates {
+			update.event.ResultID = firstID + int64(i)
+			payload, err := json.Marshal(update.event)
+			if err != nil {
+				return fmt.Errorf("marshal rank update failed: %w", err)
+			}
+			events = append(events, repository.RankOutboxEvent{
+				ContestID: contestID,
+				EventKey:  update.eventKey,
+				Payload:   string(payload),
+			})
 		}
-		if err := outboxRepo.Enqueue(ctx, outboxEvent); err != nil {
+		if err := outboxRepo.EnqueueBatch(ctx, events); err != nil {
 			if key, ok := dbutil.UniqueViolation(err); ok && key == "contest_rank_outbox_event_key_uq" {
-				return nil
+				return errRankOutboxDuplicate
 			}
 			return fmt.Errorf("enqueue rank outbox failed: %w", err)
 		}
-		return nil
-	})
-	if err != nil {
-		return err
 	}
-	if c.statusWriter != nil {
-		if err := c.statusWriter.WriteFinalStatus(ctxMQ.ctx, statuswriter.StatusPayload{
-			SubmissionID: status.SubmissionID,
-			Status:       status.Status,
-			Verdict:      status.Verdict,
-			Timestamps: statuswriter.Timestamps{
-				ReceivedAt: status.Timestamps.ReceivedAt,
-				FinishedAt: status.Timestamps.FinishedAt,
-			},
-			Progress: statuswriter.Progress{TotalTests: 0, DoneTests: 0},
-		}); err != nil {
-			return err
+	return nil
+}
+
+// scoringKeys returns the distinct rows touched by items, sorted so concurrent
+// batches lock them in the same order.
+func scoringKeys(items []*judgeFinalItem) ([]repository.MemberProblemKey, []string) {
+	seenKeys := make(map[repository.MemberProblemKey]struct{}, len(items))
+	seenMembers := make(map[string]struct{}, len(items))
+	keys := make([]repository.MemberProblemKey, 0, len(items))
+	memberIDs := make([]string, 0, len(items))
+	for _, item := range items {
+		key := item.problemKey()
+		if _, ok := seenKeys[key]; !ok {
+			seenKeys[key] = struct{}{}
+			keys = append(keys, key)
+		}
+		if _, ok := seenMembers[key.MemberID]; !ok {
+			seenMembers[key.MemberID] = struct{}{}
+			memberIDs = append(memberIDs, key.MemberID)
 		}
 	}
-	return nil
+	sortMemberProblemKeys(keys)
+	sort.Strings(memberIDs)
+	return keys, memberIDs
+}
+
+func sortMemberProblemKeys(keys []repository.MemberProblemKey) {
+	sort.Slice(keys, func(i, j int) bool {
+		if keys[i].MemberID != keys[j].MemberID {
+			return keys[i].MemberID < keys[j].MemberID
+		}
+		return keys[i].ProblemID < keys[j].ProblemID
+	})
 }
 
-// ProblemDetail holds per-problem detail for a member.
-type ProblemDetail struct {
-	Solved           bool   `json:"solved"`
-	WrongCount       int    `json:"wrong_count"`
-	FirstACAt        int64  `json:"first_ac_at"`
-	LastSubmissionAt int64  `json:"last_submission_at"`
-	LastSubmissionID string `json:"last_submission_id"`
-	Penalty          int64  `json:"penalty"`
-	Verdict          string `json:"verdict"`
+type scoredUpdate struct {
+	eventKey string
+	event    pmodel.RankUpdateEvent
 }
 
-// MemberDetail holds aggregated detail for a member.
-type MemberDetail struct {
-	Problems  map[string]ProblemDetail `json:"problems"`
-	UpdatedAt int64                    `json:"updated_at"`
+// scoringBatch applies the events of one contest in order on in-memory rows.
+type scoringBatch struct {
+	meta          contestRepo.ContestMeta
+	states        map[repository.MemberProblemKey]repository.MemberProblemState
+	summaries     map[string]repository.MemberSummarySnapshot
+	changedStates map[repository.MemberProblemKey]struct{}
+	changedMember map[string]struct{}
+	updates       []scoredUpdate
 }
 
-func parseMemberDetail(raw string) MemberDetail {
-	if raw == "" {
-		return MemberDetail{Problems: map[string]ProblemDetail{}}
+func newScoringBatch(meta contestRepo.ContestMeta, states map[repository.MemberProblemKey]repository.MemberProblemState, summaries map[string]repository.MemberSummarySnapshot) *scoringBatch {
+	return &scoringBatch{
+		meta:          meta,
+		states:        states,
+		summaries:     summaries,
+		changedStates: make(map[repository.MemberProblemKey]struct{}),
+		changedMember: make(map[string]struct{}),
 	}
-	var detail MemberDetail
-	if err := json.Unmarshal([]byte(raw), &detail); err != nil {
-		return MemberDetail{Problems: map[string]ProblemDetail{}}
+}
+
+func (b *scoringBatch) apply(item *judgeFinalItem) error {
+	status := item.status
+	key := item.problemKey()
+	memberID := key.MemberID
+	problemKey := fmt.Sprint(key.ProblemID)
+	submitAt := item.submitAt
+
+	state, found := b.states[key]
+	if found && state.Solved {
+		if _, summaryFound := b.summaries[memberID]; !summaryFound {
+			return fmt.Errorf("member summary not found for solved state, contest=%s member=%s", status.ContestID, memberID)
+		}
+		return nil
+	}
+
+	isAC := strings.EqualFold(status.Verdict, "AC")
+	if !found {
+		state = repository.MemberProblemState{
+			ContestID: status.ContestID,
+			MemberID:  memberID,
+			ProblemID: key.ProblemID,
+		}
 	}
-	if detail.Problems == nil {
-		detail.Problems = map[string]ProblemDetail{}
+	if !isAC {
+		state.WrongCount++
 	}
-	return detail
+	state.LastSubmissionID = status.SubmissionID
+	state.LastSubmissionAt = submitAt
+	state.LastVerdict = status.Verdict
+	if isAC {
+		state.Solved = true
+		state.FirstACAt = submitAt
+		state.Score = 1
+		state.Penalty = score.ICPCPenaltyWithMinutes(b.meta.StartAt, submitAt, state.WrongCount, b.meta.PenaltyMinutes)
+	}
+	state.UpdatedAt = time.Now()
+	b.states[key] = state
+	b.changedStates[key] = struct{}{}
+
+	summary, summaryFound := b.summaries[memberID]
+	if !summaryFound {
+		summary = repository.MemberSummarySnapshot{
+			ContestID: status.ContestID,
+			MemberID:  memberID,
+		}
+	}
+
+	cell := rankdetail.MarshalCell(rankdetail.ProblemDetail{
+		Solved:           state.Solved,
+		WrongCount:       state.WrongCount,
+		FirstACAt:        unixTime(state.FirstACAt),
+		LastSubmissionAt: unixTime(state.LastSubmissionAt),
+		LastSubmissionID: state.LastSubmissionID,
+		Penalty:          state.Penalty,
+		Verdict:          state.LastVerdict,
+	})
+
+	if isAC {
+		summary.ACCount++
+		summary.ScoreTotal++
+		summary.PenaltyTotal += state.Penalty
+	}
+	summary.Version++
+	// Problem rows are the source of truth for detail; a legacy blob is cleared on write.
+	summary.DetailJSON = ""
+	summary.UpdatedAt = time.Now()
+	b.summaries[memberID] = summary
+	b.changedMember[memberID] = struct{}{}
+
+	b.updates = append(b.updates, scoredUpdate{
+		eventKey: item.eventKey(),
+		event: pmodel.RankUpdateEvent{
+			ContestID:     status.ContestID,
+			MemberID:      memberID,
+			ProblemID:     problemKey,
+			SortScore:     score.SortScore(summary.ScoreTotal, summary.PenaltyTotal),
+			ScoreTotal:    summary.ScoreTotal,
+			Penalty:       summary.PenaltyTotal,
+			ACCount:       summary.ACCount,
+			ProblemDetail: cell,
+			Version:       fmt.Sprint(summary.Version),
+			UpdatedAt:     summary.UpdatedAt.Unix(),
+		},
+	})
+	return nil
 }
 
-func mustMarshalDetail(detail MemberDetail) string {
-	data, err := json.Marshal(detail)
-	if err != nil {
-		return "{}"
+func (b *scoringBatch) dirtyStates() []repository.MemberProblemState {
+	keys := make([]repository.MemberProblemKey, 0, len(b.changedStates))
+	for key := range b.changedStates {
+		keys = append(keys, key)
 	}
-	return string(data)
+	sortMemberProblemKeys(keys)
+	states := make([]repository.MemberProblemState, 0, len(keys))
+	for _, key := range keys {
+		states = append(states, b.states[key])
+	}
+	return states
+}
+
+func (b *scoringBatch) dirtySummaries() []repository.MemberSummarySnapshot {
+	memberIDs := make([]string, 0, len(b.changedMember))
+	for memberID := range b.changedMember {
+		memberIDs = append(memberIDs, memberID)
+	}
+	sort.Strings(memberIDs)
+	summaries := make([]repository.MemberSummarySnapshot, 0, len(memberIDs))
+	for _, memberID := range memberIDs {
+		summaries = append(summaries, b.summaries[memberID])
+	}
+	return summaries
+}
+
+func (item *judgeFinalItem) problemKey() repository.MemberProblemKey {
+	return repository.MemberProblemKey{MemberID: item.status.UserID, ProblemID: item.status.ProblemID}
+}
+
+func (item *judgeFinalItem) eventKey() string {
+	return buildRankOutboxEventKey(item.status.ContestID, item.status.SubmissionID, item.finishedAt)
 }
 
 func unixTime(t time.Time) int64 {
@@ -9,8 +9,9 @@ type RankUpdateEvent struct {
 	ScoreTotal int64  `json:"score_total"`
 	Penalty    int64  `json:"penalty_total"`
 	ACCount    int64  `json:"ac_count"`
-	DetailJSON string `json:"detail_json"`
-	Version    string `json:"version"`
-	ResultID   int64  `json:"result_id"`
-	UpdatedAt  int64  `json:"updated_at"`
+	// ProblemDetail is the detail cell of the problem this event changed.
+	ProblemDetail string `json:"problem_detail"`
+	Version       string `json:"version"`
+	ResultID      int64  `json:"result_id"`
+	UpdatedAt     int64  `json:"updated_at"`
 }
@@ -79,6 +79,8 @@ type ContestRepository interface {
 	List(ctx context.Context, filter ContestListFilter) ([]ContestListItem, int, error)
 	Update(ctx context.Context, contestID string, update ContestUpdate) error
 	InvalidateDetailCache(ctx context.Context, contestID string) error
+	// ListStartingBefore returns non-draft contests that start before until and have not ended at now.
+	ListStartingBefore(ctx context.Context, now, until time.Time, limit int) ([]ContestListItem, error)
 }
 
 type MySQLContestRepository struct {
@@ -196,6 +198,26 @@ func (r *MySQLContestRepository) List(ctx context.Context, filter ContestListFil
 	return resp, total, nil
 }
 
+func (r *MySQLContestRepository) ListStartingBefore(ctx context.Context, now, until time.Time, limit int) ([]ContestListItem, error) {
+	where := "status not in ('draft', 'ended') and start_at <= ? and end_at > ?"
+	items, err := r.model.List(ctx, where, []any{until, now}, limit, 0)
+	if err != nil {
+		return nil, err
+	}
+	resp := make([]ContestListItem, 0, len(items))
+	for _, item := range items {
+		resp = append(resp, ContestListItem{
+			ContestID: item.ContestId,
+			Title:     item.Title,
+			Status:    item.Status,
+			StartAt:   item.StartAt,
+			EndAt:     item.EndAt,
+			RuleJSON:  item.RuleJSON,
+		})
+	}
+	return resp, nil
+}
+
 func (r *MySQLContestRepository) Update(ctx context.Context, contestID string, update ContestUpdate) error {
 	if strings.TrimSpace(contestID) == "" {
 		return errors.New("contestID is required")
@@ -4,6 +4,7 @@ import (
 	"context"
 	"database/sql"
 	"errors"
+	"strings"
 	"time"
 
 	"github.com/zeromicro/go-zero/core/stores/sqlx"
@@ -23,6 +24,7 @@ type MemberProblemState struct {
 	Penalty          int64
 	LastSubmissionID string
 	LastSubmissionAt time.Time
+	LastVerdict      string
 	UpdatedAt        time.Time
 }
 
@@ -35,24 +37,35 @@ func NewMemberProblemRepository(conn sqlRunner) *MemberProblemRepository {
 	return &MemberProblemRepository{conn: conn}
 }
 
+// MemberProblemKey identifies one member-problem row inside a contest.
+type MemberProblemKey struct {
+	MemberID  string
+	ProblemID int64
+}
+
+type memberProblemRow struct {
+	ContestID        string         `db:"contest_id"`
+	MemberID         string         `db:"member_id"`
+	ProblemID        int64          `db:"problem_id"`
+	Solved           int            `db:"solved"`
+	FirstACAt        sql.NullTime   `db:"first_ac_at"`
+	WrongCount       int            `db:"wrong_count"`
+	Score            int            `db:"score"`
+	Penalty          int64          `db:"penalty"`
+	LastSubmissionID sql.NullString `db:"last_submission_id"`
+	LastSubmissionAt sql.NullTime   `db:"last_submission_at"`
+	LastVerdict      sql.NullString `db:"last_verdict"`
+	UpdatedAt        time.Time      `db:"updated_at"`
+}
+
+const memberProblemColumns = "contest_id, member_id, problem_id, solved, first_ac_at, wrong_count, score, penalty, last_submission_id, last_submission_at, last_verdict, updated_at"
+
 func (r *MemberProblemRepository) Get(ctx context.Context, contestID, memberID string, problemID int64) (MemberProblemState, bool, error) {
 	if r == nil || r.conn == nil {
 		return MemberProblemState{}, false, errors.New("member problem repository is not configured")
 	}
-	var resp struct {
-		ContestID        string         `db:"contest_id"`
-		MemberID         string         `db:"member_id"`
-		ProblemID        int64          `db:"problem_id"`
-		Solved           int            `db:"solved"`
-		FirstACAt        sql.NullTime   `db:"first_ac_at"`
-		WrongCount       int            `db:"wrong_count"`
-		Score            int            `db:"score"`
-		Penalty          int64          `db:"penalty"`
-		LastSubmissionID sql.NullString `db:"last_submission_id"`
-		LastSubmissionAt sql.NullTime   `db:"last_submission_at"`
-		UpdatedAt        time.Time      `db:"updated_at"`
-	}
-	query := "select contest_id, member_id, problem_id, solved, first_ac_at, wrong_count, score, penalty, last_submission_id, last_submission_at, updated_at " +
+	var resp memberProblemRow
+	query := "select " + memberProblemColumns + " " +
 		"from " + contestMemberProblemTable + " where contest_id = ? and member_id = ? and problem_id = ? limit 1"
 	if err := r.conn.QueryRowCtx(ctx, &resp, query, contestID, memberID, problemID); err != nil {
 		if err == sqlx.ErrNotFound {
@@ -60,57 +73,110 @@ func (r *MemberProblemRepository) Get(ctx context.Context, contestID, memberID s
 		}
 		return MemberProblemState{}, false, err
 	}
-	state := MemberProblemState{
-		ContestID:        resp.ContestID,
-		MemberID:         resp.MemberID,
-		ProblemID:        resp.ProblemID,
-		Solved:           resp.Solved == 1,
-		WrongCount:       resp.WrongCount,
-		Score:            resp.Score,
-		Penalty:          resp.Penalty,
-		LastSubmissionID: resp.LastSubmissionID.String,
-		UpdatedAt:        resp.UpdatedAt,
+	return resp.toState(), true, nil
+}
+
+// GetBatch loads the rows of one contest for the given keys in a single query.
+// Missing rows are absent from the result.
+func (r *MemberProblemRepository) GetBatch(ctx context.Context, contestID string, keys []MemberProblemKey) (map[MemberProblemKey]MemberProblemState, error) {
+	if r == nil || r.conn == nil {
+		return nil, errors.New("member problem repository is not configured")
+	}
+	states := make(map[MemberProblemKey]MemberProblemState, len(keys))
+	if len(keys) == 0 {
+		return states, nil
+	}
+	args := make([]any, 0, len(keys)*2+1)
+	args = append(args, contestID)
+	tuples := make([]string, 0, len(keys))
+	for _, key := range keys {
+		tuples = append(tuples, "(?, ?)")
+		args = append(args, key.MemberID, key.ProblemID)
 	}
-	if resp.FirstACAt.Valid {
-		state.FirstACAt = resp.FirstACAt.Time
+	var rows []memberProblemRow
+	query := "select " + memberProblemColumns + " " +
+		"from " + contestMemberProblemTable + " where contest_id = ? and (member_id, problem_id) in (" + strings.Join(tuples, ", ") + ")"
+	if err := r.conn.QueryRowsCtx(ctx, &rows, query, args...); err != nil {
+		if err == sqlx.ErrNotFound {
+			return states, nil
+		}
+		return nil, err
 	}
-	if resp.LastSubmissionAt.Valid {
-		state.LastSubmissionAt = resp.LastSubmissionAt.Time
+	for _, row := range rows {
+		states[MemberProblemKey{MemberID: row.MemberID, ProblemID: row.ProblemID}] = row.toState()
 	}
-	return state, true, nil
+	return states, nil
 }
 
 func (r *MemberProblemRepository) Upsert(ctx context.Context, state MemberProblemState) error {
+	return r.UpsertBatch(ctx, []MemberProblemState{state})
+}
+
+// UpsertBatch writes all states with one multi-row insert.
+func (r *MemberProblemRepository) UpsertBatch(ctx context.Context, states []MemberProblemState) error {
 	if r == nil || r.conn == nil {
 		return errors.New("member problem repository is not configured")
 	}
-	if state.UpdatedAt.IsZero() {
-		state.UpdatedAt = time.Now()
+	if len(states) == 0 {
+		return nil
 	}
-	solved := 0
-	if state.Solved {
-		solved = 1
+	now := time.Now()
+	values := make([]string, 0, len(states))
+	args := make([]any, 0, len(states)*12)
+	for _, state := range states {
+		if state.UpdatedAt.IsZero() {
+			state.UpdatedAt = now
+		}
+		solved := 0
+		if state.Solved {
+			solved = 1
+		}
+		values = append(values, "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)")
+		args = append(args,
+			state.ContestID,
+			state.MemberID,
+			state.ProblemID,
+			solved,
+			nullTime(state.FirstACAt),
+			state.WrongCount,
+			state.Score,
+			state.Penalty,
+			nullString(state.LastSubmissionID),
+			nullTime(state.LastSubmissionAt),
+			nullString(state.LastVerdict),
+			state.UpdatedAt,
+		)
 	}
-	query := "insert into " + contestMemberProblemTable + " (contest_id, member_id, problem_id, solved, first_ac_at, wrong_count, score, penalty, last_submission_id, last_submission_at, updated_at) " +
-		"values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) " +
+	query := "insert into " + contestMemberProblemTable + " (" + memberProblemColumns + ") " +
+		"values " + strings.Join(values, ", ") + " " +
 		"on duplicate key update solved=values(solved), first_ac_at=values(first_ac_at), wrong_count=values(wrong_count), score=values(score), penalty=values(penalty), " +
-		"last_submission_id=values(last_submission_id), last_submission_at=values(last_submission_at), updated_at=values(updated_at)"
-	_, err := r.conn.ExecCtx(ctx, query,
-		state.ContestID,
-		state.MemberID,
-		state.ProblemID,
-		solved,
-		nullTime(state.FirstACAt),
-		state.WrongCount,
-		state.Score,
-		state.Penalty,
-		nullString(state.LastSubmissionID),
-		nullTime(state.LastSubmissionAt),
-		state.UpdatedAt,
-	)
+		"last_submission_id=values(last_submission_id), last_submission_at=values(last_submission_at), last_verdict=values(last_verdict), updated_at=values(updated_at)"
+	_, err := r.conn.ExecCtx(ctx, query, args...)
 	return err
 }
 
+func (row memberProblemRow) toState() MemberProblemState {
+	state := MemberProblemState{
+		ContestID:        row.ContestID,
+		MemberID:         row.MemberID,
+		ProblemID:        row.ProblemID,
+		Solved:           row.Solved == 1,
+		WrongCount:       row.WrongCount,
+		Score:            row.Score,
+		Penalty:          row.Penalty,
+		LastSubmissionID: row.LastSubmissionID.String,
+		LastVerdict:      row.LastVerdict.String,
+		UpdatedAt:        row.UpdatedAt,
+	}
+	if row.FirstACAt.Valid {
+		state.FirstACAt = row.FirstACAt.Time
+	}
+	if row.LastSubmissionAt.Valid {
+		state.LastSubmissionAt = row.LastSubmissionAt.Time
+	}
+	return state
+}
+
 func nullTime(t time.Time) sql.NullTime {
 	if t.IsZero() {
 		return sql.NullTime{}
@@ -4,6 +4,7 @@ import (
 	"context"
 	"database/sql"
 	"errors"
+	"strings"
 	"time"
 
 	"github.com/zeromicro/go-zero/core/stores/sqlx"
@@ -32,21 +33,25 @@ func NewMemberSummaryRepository(conn sqlRunner) *MemberSummaryRepository {
 	return &MemberSummaryRepository{conn: conn}
 }
 
+type memberSummaryRow struct {
+	ContestID    string         `db:"contest_id"`
+	MemberID     string         `db:"member_id"`
+	ScoreTotal   int64          `db:"score_total"`
+	PenaltyTotal int64          `db:"penalty_total"`
+	ACCount      int64          `db:"ac_count"`
+	DetailJSON   sql.NullString `db:"detail_json"`
+	Version      int64          `db:"version"`
+	UpdatedAt    time.Time      `db:"updated_at"`
+}
+
+const memberSummaryColumns = "contest_id, member_id, score_total, penalty_total, ac_count, detail_json, version, updated_at"
+
 func (r *MemberSummaryRepository) Get(ctx context.Context, contestID, memberID string) (MemberSummarySnapshot, bool, error) {
 	if r == nil || r.conn == nil {
 		return MemberSummarySnapshot{}, false, errors.New("member summary repository is not configured")
 	}
-	var resp struct {
-		ContestID    string         `db:"contest_id"`
-		MemberID     string         `db:"member_id"`
-		ScoreTotal   int64          `db:"score_total"`
-		PenaltyTotal int64          `db:"penalty_total"`
-		ACCount      int64          `db:"ac_count"`
-		DetailJSON   sql.NullString `db:"detail_json"`
-		Version      int64          `db:"version"`
-		UpdatedAt    time.Time      `db:"updated_at"`
-	}
-	query := "select contest_id, member_id, score_total, penalty_total, ac_count, detail_json, version, updated_at " +
+	var resp memberSummaryRow
+	query := "select " + memberSummaryColumns + " " +
 		"from " + contestMemberSummaryTable + " where contest_id = ? and member_id = ? limit 1"
 	if err := r.conn.QueryRowCtx(ctx, &resp, query, contestID, memberID); err != nil {
 		if err == sqlx.ErrNotFound {
@@ -54,38 +59,86 @@ func (r *MemberSummaryRepository) Get(ctx context.Context, contestID, memberID s
 		}
 		return MemberSummarySnapshot{}, false, err
 	}
-	snapshot := MemberSummarySnapshot{
-		ContestID:    resp.ContestID,
-		MemberID:     resp.MemberID,
-		ScoreTotal:   resp.ScoreTotal,
-		PenaltyTotal: resp.PenaltyTotal,
-		ACCount:      resp.ACCount,
-		DetailJSON:   resp.DetailJSON.String,
-		Version:      resp.Version,
-		UpdatedAt:    resp.UpdatedAt,
+	return resp.toSnapshot(), true, nil
+}
+
+// GetBatch loads the summaries of the given members in a single query.
+// Missing members are absent from the result.
+func (r *MemberSummaryRepository) GetBatch(ctx context.Context, contestID string, memberIDs []string) (map[string]MemberSummarySnapshot, error) {
+	if r == nil || r.conn == nil {
+		return nil, errors.New("member summary repository is not configured")
+	}
+	snapshots := make(map[string]MemberSummarySnapshot, len(memberIDs))
+	if len(memberIDs) == 0 {
+		return snapshots, nil
+	}
+	args := make([]any, 0, len(memberIDs)+1)
+	args = append(args, contestID)
+	for _, memberID := range memberIDs {
+		args = append(args, memberID)
+	}
+	var rows []memberSummaryRow
+	query := "select " + memberSummaryColumns + " " +
+		"from " + contestMemberSummaryTable + " where contest_id = ? and member_id in (" + placeholders(len(memberIDs)) + ")"
+	if err := r.conn.QueryRowsCtx(ctx, &rows, query, args...); err != nil {
+		if err == sqlx.ErrNotFound {
+			return snapshots, nil
+		}
+		return nil, err
+	}
+	for _, row := range rows {
+		snapshots[row.MemberID] = row.toSnapshot()
 	}
-	return snapshot, true, nil
+	return snapshots, nil
 }
 
 func (r *MemberSummaryRepository) Upsert(ctx context.Context, snapshot MemberSummarySnapshot) error {
+	return r.UpsertBatch(ctx, []MemberSummarySnapshot{snapshot})
+}
+
+// UpsertBatch writes all snapshots with one multi-row insert.
+func (r *MemberSummaryRepository) UpsertBatch(ctx context.Context, snapshots []MemberSummarySnapshot) error {
 	if r == nil || r.conn == nil {
 		return errors.New("member summary repository is not configured")
 	}
-	if snapshot.UpdatedAt.IsZero() {
-		snapshot.UpdatedAt = time.Now()
+	if len(snapshots) == 0 {
+		return nil
 	}
-	query := "insert into " + contestMemberSummaryTable + " (contest_id, member_id, score_total, penalty_total, ac_count, detail_json, version, updated_at) " +
-		"values (?, ?, ?, ?, ?, ?, ?, ?) " +
+	now := time.Now()
+	values := make([]string, 0, len(snapshots))
+	args := make([]any, 0, len(snapshots)*8)
+	for _, snapshot := range snapshots {
+		if snapshot.UpdatedAt.IsZero() {
+			snapshot.UpdatedAt = now
+		}
+		values = append(values, "(?, ?, ?, ?, ?, ?, ?, ?)")
+		args = append(args,
+			snapshot.ContestID,
+			snapshot.MemberID,
+			snapshot.ScoreTotal,
+			snapshot.PenaltyTotal,
+			snapshot.ACCount,
+			nullString(snapshot.DetailJSON),
+			snapshot.Version,
+			snapshot.UpdatedAt,
+		)
+	}
+	query := "insert into " + contestMemberSummaryTable + " (" + memberSummaryColumns + ") " +
+		"values " + strings.Join(values, ", ") + " " +
 		"on duplicate key update score_total=values(score_total), penalty_total=values(penalty_total), ac_count=values(ac_count), detail_json=values(detail_json), version=values(version), updated_at=values(updated_at)"
-	_, err := r.conn.ExecCtx(ctx, query,
-		snapshot.ContestID,
-		snapshot.MemberID,
-		snapshot.ScoreTotal,
-		snapshot.PenaltyTotal,
-		snapshot.ACCount,
-		nullString(snapshot.DetailJSON),
-		snapshot.Version,
-		snapshot.UpdatedAt,
-	)
+	_, err := r.conn.ExecCtx(ctx, query, args...)
 	return err
 }
+
+func (row memberSummaryRow) toSnapshot() MemberSummarySnapshot {
+	return MemberSummarySnapshot{
+		ContestID:    row.ContestID,
+		MemberID:     row.MemberID,
+		ScoreTotal:   row.ScoreTotal,
+		PenaltyTotal: row.PenaltyTotal,
+		ACCount:      row.ACCount,
+		DetailJSON:   row.DetailJSON.String,
+		Version:      row.Version,
+		UpdatedAt:    row.UpdatedAt,
+	}
+}
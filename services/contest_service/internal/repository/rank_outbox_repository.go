@@ -5,6 +5,7 @@ import (
 	"database/sql"
 	"errors"
 	"fmt"
+	"strings"
 	"time"
 
 	"github.com/zeromicro/go-zero/core/stores/sqlx"
@@ -59,50 +60,100 @@ func NewRankOutboxRepository(conn sqlRunner) *RankOutboxRepository {
 }
 
 func (r *RankOutboxRepository) Enqueue(ctx context.Context, event RankOutboxEvent) error {
+	return r.EnqueueBatch(ctx, []RankOutboxEvent{event})
+}
+
+// EnqueueBatch inserts all events with one multi-row insert.
+func (r *RankOutboxRepository) EnqueueBatch(ctx context.Context, events []RankOutboxEvent) error {
 	if r == nil || r.conn == nil {
 		return errors.New("rank outbox repository is not configured")
 	}
-	if event.ContestID == "" {
-		return errors.New("contest id is required")
+	if len(events) == 0 {
+		return nil
 	}
 	now := time.Now()
-	if event.CreatedAt.IsZero() {
-		event.CreatedAt = now
+	values := make([]string, 0, len(events))
+	args := make([]any, 0, len(events)*10)
+	for _, event := range events {
+		if event.ContestID == "" {
+			return errors.New("contest id is required")
+		}
+		if event.CreatedAt.IsZero() {
+			event.CreatedAt = now
+		}
+		if event.UpdatedAt.IsZero() {
+			event.UpdatedAt = now
+		}
+		if event.Status == 0 {
+			event.Status = outboxStatusPending
+		}
+		if event.NextRetryAt.IsZero() {
+			event.NextRetryAt = now
+		}
+		values = append(values, "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)")
+		args = append(args,
+			event.ContestID,
+			event.EventKey,
+			event.Payload,
+			event.Status,
+			event.RetryCount,
+			nullTime(event.NextRetryAt),
+			nullString(event.OwnerID),
+			nullTime(event.LeaseUntil),
+			event.CreatedAt,
+			event.UpdatedAt,
+		)
 	}
-	if event.UpdatedAt.IsZero() {
-		event.UpdatedAt = now
+	query := "insert into " + contestRankOutboxTable + " (contest_id, event_key, payload, status, retry_count, next_retry_at, owner_id, lease_until, created_at, updated_at) " +
+		"values " + strings.Join(values, ", ")
+	_, err := r.conn.ExecCtx(ctx, query, args...)
+	return err
+}
+
+// ExistingEventKeys returns which of the given event keys are already in the outbox.
+func (r *RankOutboxRepository) ExistingEventKeys(ctx context.Context, keys []string) (map[string]struct{}, error) {
+	if r == nil || r.conn == nil {
+		return nil, errors.New("rank outbox repository is not configured")
 	}
-	if event.Status == 0 {
-		event.Status = outboxStatusPending
+	existing := make(map[string]struct{})
+	if len(keys) == 0 {
+		return existing, nil
 	}
-	if event.NextRetryAt.IsZero() {
-		event.NextRetryAt = now
+	args := make([]any, 0, len(keys))
+	for _, key := range keys {
+		args = append(args, key)
 	}
-	query := "insert into " + contestRankOutboxTable + " (contest_id, event_key, payload, status, retry_count, next_retry_at, owner_id, lease_until, created_at, updated_at) " +
-		"values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
-	_, err := r.conn.ExecCtx(ctx, query,
-		event.ContestID,
-		event.EventKey,
-		event.Payload,
-		event.Status,
-		event.RetryCount,
-		nullTime(event.NextRetryAt),
-		nullString(event.OwnerID),
-		nullTime(event.LeaseUntil),
-		event.CreatedAt,
-		event.UpdatedAt,
-	)
-	return err
+	var found []string
+	query := "select event_key from " + contestRankOutboxTable + " where event_key in (" + placeholders(len(keys)) + ")"
+	if err := r.conn.QueryRowsCtx(ctx, &found, query, args...); err != nil {
+		if err == sqlx.ErrNotFound {
+			return existing, nil
+		}
+		return nil, err
+	}
+	for _, key := range found {
+		existing[key] = struct{}{}
+	}
+	return existing, nil
 }
 
 // NextResultIDTx allocates the next per-contest result id in the current transaction.
 func (r *RankOutboxRepository) NextResultIDTx(ctx context.Context, contestID string) (int64, error) {
+	return r.NextResultIDsTx(ctx, contestID, 1)
+}
+
+// NextResultIDsTx allocates count consecutive per-contest result ids in the current
+// transaction and returns the first one.
+func (r *RankOutboxRepository) NextResultIDsTx(ctx context.Context, contestID string, count int) (int64, error) {
 	if r == nil || r.conn == nil {
 		return 0, errors.New("rank outbox repository is not configured")
 	}
 	if contestID == "" {
 		return 0, errors.New("contest id is required")
 	}
+	if count <= 0 {
+		return 0, fmt.Errorf("invalid result id count: %d", count)
+	}
 	now := time.Now()
 	initQuery := "insert ignore into " + contestRankResultSeqTable + " (contest_id, next_result_id, updated_at) values (?, ?, ?)"
 	if _, err := r.conn.ExecCtx(ctx, initQuery, contestID, int64(1), now); err != nil {
@@ -119,7 +170,7 @@ func (r *RankOutboxRepository) NextResultIDTx(ctx context.Context, contestID str
 	}
 
 	updateQuery := "update " + contestRankResultSeqTable + " set next_result_id = ?, updated_at = ? where contest_id = ? and next_result_id = ?"
-	res, err := r.conn.ExecCtx(ctx, updateQuery, nextID+1, now, contestID, nextID)
+	res, err := r.conn.ExecCtx(ctx, updateQuery, nextID+int64(count), now, contestID, nextID)
 	if err != nil {
 		return 0, err
 	}
@@ -110,6 +110,33 @@ func TestNextResultIDTx(t *testing.T) {
 	}
 }
 
+func TestNextResultIDsTxAdvancesByCount(t *testing.T) {
+	var advancedTo int64
+	runner := &stubSQLRunner{
+		queryRowFunc: func(v any, query string, args ...any) error {
+			*(v.(*int64)) = 7
+			return nil
+		},
+		execFunc: func(query string, args ...any) (stubResult, error) {
+			if strings.HasPrefix(strings.ToLower(query), "update") {
+				advancedTo = args[0].(int64)
+			}
+			return stubResult(1), nil
+		},
+	}
+	repo := NewRankOutboxRepository(runner)
+	first, err := repo.NextResultIDsTx(context.Background(), "c1", 5)
+	if err != nil {
+		t.Fatalf("next result ids failed: %v", err)
+	}
+	if first != 7 || advancedTo != 12 {
+		t.Fatalf("expected ids 7..11 and next 12, got first=%d next=%d", first, advancedTo)
+	}
+	if _, err := repo.NextResultIDsTx(context.Background(), "c1", 0); err == nil {
+		t.Fatalf("expected invalid count error")
+	}
+}
+
 func TestNextResultIDTxErrors(t *testing.T) {
 	repo := NewRankOutboxRepository(nil)
 	if _, err := repo.NextResultIDTx(context.Background(), "c1"); err == nil {
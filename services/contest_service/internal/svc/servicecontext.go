@@ -8,6 +8,7 @@ import (
 	"time"
 
 	"fuzoj/pkg/contest/eligibility"
+	"fuzoj/pkg/contest/prefetchpubsub"
 	contestRepo "fuzoj/pkg/contest/repository"
 	"fuzoj/pkg/submit/statusflow"
 	"fuzoj/pkg/submit/statuspubsub"
@@ -47,6 +48,7 @@ type ServiceContext struct {
 	RankOutboxRepo          *rankRepo.RankOutboxRepository
 	RankUpdatePusher        *kq.Pusher
 	RankOutboxRelay         *consumer.RankOutboxRelay
+	ContestPrefetcher       *consumer.ContestPrefetcher
 	JudgeFinalDeadLetter    *kq.Pusher
 	DeadLetterPusher        *kq.Pusher
 	JudgePushers            TopicPushers
@@ -154,6 +156,8 @@ func NewServiceContext(c config.Config) *ServiceContext {
 				MaxRetries:      c.JudgeFinal.MaxRetries,
 				RetryDelay:      c.JudgeFinal.RetryDelay,
 				DeadLetterTopic: c.JudgeFinal.DeadLetterTopic,
+				BatchSize:       c.JudgeFinal.BatchSize,
+				BatchWindow:     c.JudgeFinal.BatchWindow,
 			},
 			consumer.TimeoutConfig{MQ: c.Timeouts.MQ, Cache: c.Timeouts.Cache},
 		)
@@ -192,6 +196,20 @@ func NewServiceContext(c config.Config) *ServiceContext {
 		logx.Infof("rank outbox relay is disabled due to missing redis config")
 	}
 
+	var contestPrefetcher *consumer.ContestPrefetcher
+	if c.Prefetch.LeadTime > 0 {
+		if prefetchClient := prefetchpubsub.NewClient(c.Redis); prefetchClient != nil {
+			contestPrefetcher = consumer.NewContestPrefetcher(contestStoreRepo, contestProblemStore, prefetchClient, consumer.ContestPrefetcherOptions{
+				LeadTime:     c.Prefetch.LeadTime,
+				ScanInterval: c.Prefetch.ScanInterval,
+				ScanBatch:    c.Prefetch.ScanBatch,
+				DBTimeout:    c.Timeouts.DB,
+			})
+		} else {
+			logx.Infof("contest prefetcher is disabled due to missing redis config")
+		}
+	}
+
 	return &ServiceContext{
 		Config:                  c,
 		Conn:                    conn,
@@ -214,6 +232,7 @@ func NewServiceContext(c config.Config) *ServiceContext {
 		RankOutboxRepo:          rankOutboxRepo,
 		RankUpdatePusher:        rankUpdatePusher,
 		RankOutboxRelay:         rankOutboxRelay,
+		ContestPrefetcher:       contestPrefetcher,
 		JudgeFinalDeadLetter:    judgeFinalDeadLetter,
 		DeadLetterPusher:        deadLetterPusher,
 		JudgePushers:            pushers,
@@ -9,6 +9,7 @@ CREATE TABLE IF NOT EXISTS contest_member_problem_state (
   penalty BIGINT NOT NULL DEFAULT 0,
   last_submission_id VARCHAR(64) NULL,
   last_submission_at DATETIME(3) NULL,
+  last_verdict VARCHAR(32) NULL,
   updated_at DATETIME(3) NOT NULL DEFAULT CURRENT_TIMESTAMP(3) ON UPDATE CURRENT_TIMESTAMP(3),
   PRIMARY KEY (contest_id, member_id, problem_id),
   KEY contest_member_idx (contest_id, member_id),
@@ -57,6 +57,10 @@ func (f *fakeContestStoreRepo) InvalidateDetailCache(ctx context.Context, contes
 	return nil
 }
 
+func (f *fakeContestStoreRepo) ListStartingBefore(ctx context.Context, now, until time.Time, limit int) ([]repository.ContestListItem, error) {
+	return nil, nil
+}
+
 func TestContestCreateHandler(t *testing.T) {
 	t.Run("success", func(t *testing.T) {
 		repo := &fakeContestStoreRepo{}
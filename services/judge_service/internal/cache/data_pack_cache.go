@@ -1,59 +1,89 @@
 package cache
 
 import (
-	"archive/tar"
+	"container/list"
 	"context"
-	"crypto/sha256"
-	"encoding/hex"
 	"encoding/json"
 	"errors"
 	"fmt"
-	"io"
 	"io/fs"
 	"os"
 	"path/filepath"
-	"strings"
 	"sync"
 	"time"
 
 	"fuzoj/internal/common/storage"
 	appErr "fuzoj/pkg/errors"
+	"fuzoj/pkg/problem/seekpack"
 	"fuzoj/services/judge_service/internal/pmodel"
 
-	"github.com/klauspost/compress/zstd"
-	"github.com/zeromicro/go-zero/core/logx"
 	"github.com/zeromicro/go-zero/core/stores/redis"
+	"github.com/zeromicro/go-zero/core/syncx"
 )
 
 const (
 	metaFileName  = "meta.json"
-	tempFileName  = "data-pack.tmp"
 	lockKeyPrefix = "judge:datapack:lock:"
 )
 
+// windowShare is the fraction (1/windowShare) of the entry and byte budgets
+// given to the admission window.
+const windowShare = 16
+
 type cacheEntry struct {
 	key       string
 	path      string
 	sizeBytes int64
 	expiresAt time.Time
+	elem      *list.Element
+	inWindow  bool
+	// advertised is the version announced to peers, withdrawn on eviction.
+	advertised   *pmodel.ProblemMeta
+	advertisedAt time.Time
+	// pinnedUntil keeps the entry past its TTL and out of eviction, e.g. for a contest window.
+	pinnedUntil time.Time
+	// refs counts leases from Acquire; an evicted entry keeps its directory
+	// until the last one is released.
+	refs int
+}
+
+func (e *cacheEntry) pinned(now time.Time) bool {
+	return now.Before(e.pinnedUntil)
+}
+
+// storedMeta is the on-disk meta.json; SizeBytes is recorded at extraction time.
+type storedMeta struct {
+	pmodel.ProblemMeta
+	SizeBytes int64 `json:"sizeBytes"`
 }
 
 // DataPackCache manages local data pack caching.
+// Entries follow W-TinyLFU: new versions enter a small LRU window and are only
+// promoted into the main LRU when they are used more often than the main
+// entries they would displace, so one-off misses cannot flush hot versions.
 type DataPackCache struct {
-	rootDir    string
-	ttl        time.Duration
-	lockWait   time.Duration
-	maxEntries int
-	maxBytes   int64
-	bucket     string
-	storage    storage.ObjectStorage
-	lockClient *redis.Redis
-	lockMu     sync.Mutex
-	locks      map[string]*redis.RedisLock
-	mu         sync.Mutex
-	entries    map[string]*cacheEntry
-	lruKeys    []string
-	totalSize  int64
+	rootDir      string
+	ttl          time.Duration
+	lockWait     time.Duration
+	maxEntries   int
+	maxBytes     int64
+	bucket       string
+	storage      storage.ObjectStorage
+	lockClient   *redis.Redis
+	downloadOpts DownloadOptions
+	lazy         *lazyState
+	peers        *peerRegistry
+	flight       syncx.SingleFlight
+	lockMu       sync.Mutex
+	locks        map[string]*redis.RedisLock
+	mu           sync.Mutex
+	entries      map[string]*cacheEntry
+	retired      map[string]*cacheEntry
+	window       *list.List
+	main         *list.List
+	windowSize   int64
+	mainSize     int64
+	sketch       *frequencySketch
 }
 
 // NewDataPackCache creates a new cache.
@@ -65,21 +95,52 @@ func NewDataPackCache(rootDir string, ttl time.Duration, lockWait time.Duration,
 		lockWait = 30 * time.Second
 	}
 	return &DataPackCache{
-		rootDir:    rootDir,
-		ttl:        ttl,
-		lockWait:   lockWait,
-		maxEntries: maxEntries,
-		maxBytes:   maxBytes,
-		bucket:     bucket,
-		storage:    storageClient,
-		lockClient: lockClient,
-		locks:      make(map[string]*redis.RedisLock),
-		entries:    make(map[string]*cacheEntry),
+		rootDir:      rootDir,
+		ttl:          ttl,
+		lockWait:     lockWait,
+		maxEntries:   maxEntries,
+		maxBytes:     maxBytes,
+		bucket:       bucket,
+		storage:      storageClient,
+		lockClient:   lockClient,
+		downloadOpts: DownloadOptions{}.withDefaults(),
+		lazy:         newLazyState(),
+		flight:       syncx.NewSingleFlight(),
+		locks:        make(map[string]*redis.RedisLock),
+		entries:      make(map[string]*cacheEntry),
+		retired:      make(map[string]*cacheEntry),
+		window:       list.New(),
+		main:         list.New(),
+		sketch:       newFrequencySketch(maxEntries),
 	}
 }
 
-// Get returns the local cache path for a problem data pack.
+// SetDownloadOptions configures ranged download and extraction concurrency.
+// Zero fields keep their defaults.
+func (c *DataPackCache) SetDownloadOptions(opts DownloadOptions) {
+	c.downloadOpts = opts.withDefaults()
+}
+
+// Get returns the local cache path for a problem data pack. The directory may
+// be evicted at any time; callers that read from it afterwards use Acquire.
 func (c *DataPackCache) Get(ctx context.Context, meta pmodel.ProblemMeta) (string, error) {
+	return c.get(ctx, meta, false)
+}
+
+// Acquire is Get plus a lease on the version: eviction still drops the entry
+// from the budget, but its directory stays on disk until release is called.
+// release is safe to call more than once.
+func (c *DataPackCache) Acquire(ctx context.Context, meta pmodel.ProblemMeta) (string, func(), error) {
+	path, err := c.get(ctx, meta, true)
+	if err != nil {
+		return "", func() {}, err
+	}
+	key := cacheKey(meta.ProblemID, meta.Version)
+	var once sync.Once
+	return path, func() { once.Do(func() { c.release(key) }) }, nil
+}
+
+func (c *DataPackCache) get(ctx context.Context, meta pmodel.ProblemMeta, lease bool) (string, error) {
 	if meta.ProblemID <= 0 || meta.Version <= 0 {
 		return "", appErr.ValidationError("problem_id", "required")
 	}
@@ -92,297 +153,413 @@ func (c *DataPackCache) Get(ctx context.Context, meta pmodel.ProblemMeta) (strin
 	key := cacheKey(meta.ProblemID, meta.Version)
 	path := filepath.Join(c.rootDir, fmt.Sprintf("%d", meta.ProblemID), fmt.Sprintf("%d", meta.Version))
 
-	if ok := c.hitEntry(key, meta); ok {
+	if ok := c.hitEntry(key, meta, lease); ok {
+		c.advertise(ctx, key, meta)
 		return path, nil
 	}
 
-	if ok := c.checkDisk(path, meta); ok {
-		c.addEntry(key, path)
+	if size, ok := c.checkDisk(path, meta); ok {
+		c.addEntry(key, path, size, lease)
+		c.advertise(ctx, key, meta)
 		return path, nil
 	}
 
-	if err := c.fetchAndExtract(ctx, meta, path); err != nil {
+	// Concurrent misses on this node share one fetch; other nodes are
+	// serialized by the Redis lock in fetchAndExtract.
+	val, err := c.flight.Do(key, func() (any, error) {
+		return c.fetchAndExtract(ctx, meta, path)
+	})
+	if err != nil {
 		return "", err
 	}
-	c.addEntry(key, path)
+	c.addEntry(key, path, val.(int64), lease)
+	c.advertise(ctx, key, meta)
 	return path, nil
 }
 
-func (c *DataPackCache) hitEntry(key string, meta pmodel.ProblemMeta) bool {
+func (c *DataPackCache) hitEntry(key string, meta pmodel.ProblemMeta, lease bool) bool {
 	c.mu.Lock()
+	c.sketch.increment(key)
 	entry, ok := c.entries[key]
 	if !ok {
 		c.mu.Unlock()
 		return false
 	}
-	if time.Now().After(entry.expiresAt) {
+	now := time.Now()
+	if now.After(entry.expiresAt) && !entry.pinned(now) {
 		c.removeEntryLocked(key)
 		c.mu.Unlock()
 		return false
 	}
-	entry.expiresAt = time.Now().Add(c.ttl)
-	c.touchLocked(key)
+	entry.expiresAt = now.Add(c.ttl)
+	if lease {
+		entry.refs++
+	}
+	c.touchLocked(entry)
 	c.mu.Unlock()
 	return true
 }
 
-func (c *DataPackCache) checkDisk(path string, meta pmodel.ProblemMeta) bool {
+// checkDisk reports whether path holds meta's version and returns its size.
+// Directories written before sizes were recorded are walked once.
+func (c *DataPackCache) checkDisk(path string, meta pmodel.ProblemMeta) (int64, bool) {
 	metaPath := filepath.Join(path, metaFileName)
 	data, err := os.ReadFile(metaPath)
 	if err != nil {
-		return false
+		return 0, false
 	}
-	var stored pmodel.ProblemMeta
+	var stored storedMeta
 	if err := json.Unmarshal(data, &stored); err != nil {
-		return false
+		return 0, false
 	}
 	if stored.ManifestHash != meta.ManifestHash || stored.DataPackHash != meta.DataPackHash {
-		return false
+		return 0, false
 	}
 	if _, err := os.Stat(filepath.Join(path, "manifest.json")); err != nil {
-		return false
+		return 0, false
 	}
-	return true
+	if stored.SizeBytes <= 0 {
+		return dirSize(path), true
+	}
+	if _, err := os.Stat(filepath.Join(path, seekpack.IndexFileName)); err == nil {
+		// Lazy versions grow after meta.json is written.
+		return dirSize(path), true
+	}
+	return stored.SizeBytes, true
 }
 
-func (c *DataPackCache) fetchAndExtract(ctx context.Context, meta pmodel.ProblemMeta, path string) error {
+func (c *DataPackCache) fetchAndExtract(ctx context.Context, meta pmodel.ProblemMeta, path string) (int64, error) {
 	if c.lockClient == nil {
-		return appErr.New(appErr.CacheError).WithMessage("lock client is not initialized")
+		return 0, appErr.New(appErr.CacheError).WithMessage("lock client is not initialized")
 	}
 	lockKey := lockKeyPrefix + cacheKey(meta.ProblemID, meta.Version)
 	lock := redis.NewRedisLock(c.lockClient, lockKey)
 	lock.SetExpire(durationSeconds(5 * time.Minute))
-	locked, err := lock.AcquireCtx(ctx)
-	if err != nil {
-		return appErr.Wrapf(err, appErr.LockFailed, "acquire data pack lock failed")
-	}
-	if !locked {
-		return c.waitForCache(ctx, meta, path)
+	for {
+		locked, err := lock.AcquireCtx(ctx)
+		if err != nil {
+			return 0, appErr.Wrapf(err, appErr.LockFailed, "acquire data pack lock failed")
+		}
+		if locked {
+			break
+		}
+		size, err := c.waitForCache(ctx, meta, path)
+		if !errors.Is(err, errLockWaitTimeout) {
+			return size, err
+		}
+		if c.peers == nil {
+			return 0, appErr.New(appErr.Timeout).WithMessage("wait for data pack cache timeout")
+		}
+		// Node-local disks never see the holder's files. Retake the lock: it
+		// only succeeds once the holder released it or died and it expired,
+		// so a slow fill elsewhere keeps this node waiting instead of pulling
+		// the pack from storage a second time.
 	}
 	c.storeLock(lockKey, lock)
 	defer func() {
 		_ = c.releaseLock(ctx, lockKey)
 	}()
 
-	if ok := c.checkDisk(path, meta); ok {
-		return nil
+	if size, ok := c.checkDisk(path, meta); ok {
+		return size, nil
 	}
 
-	if err := os.RemoveAll(path); err != nil {
-		return appErr.Wrapf(err, appErr.CacheError, "cleanup cache dir failed")
-	}
-	if err := os.MkdirAll(path, 0755); err != nil {
-		return appErr.Wrapf(err, appErr.CacheError, "create cache dir failed")
+	// A warm peer is cheaper than object storage even while holding the lock.
+	if size, ok := c.fetchFromPeers(ctx, meta, path); ok {
+		return c.commitVersion(meta, path, size)
 	}
+	return c.fillFromStorage(ctx, meta, path)
+}
 
-	tempPath := filepath.Join(path, tempFileName)
-	if err := c.downloadDataPack(ctx, meta, tempPath); err != nil {
-		return err
+// fillFromStorage rebuilds path from object storage and commits it.
+func (c *DataPackCache) fillFromStorage(ctx context.Context, meta pmodel.ProblemMeta, path string) (int64, error) {
+	c.forgetIndex(cacheKey(meta.ProblemID, meta.Version))
+	if err := resetDir(path); err != nil {
+		return 0, err
 	}
-	if err := extractDataPack(tempPath, path); err != nil {
-		return err
+	size, err := c.populate(ctx, meta, path)
+	if err != nil {
+		c.forgetIndex(cacheKey(meta.ProblemID, meta.Version))
+		_ = os.RemoveAll(path)
+		return 0, err
 	}
-	_ = os.Remove(tempPath)
+	return c.commitVersion(meta, path, size)
+}
 
-	metaBytes, _ := json.Marshal(meta)
+// commitVersion writes meta.json, which marks path as a complete version.
+func (c *DataPackCache) commitVersion(meta pmodel.ProblemMeta, path string, size int64) (int64, error) {
+	metaBytes, _ := json.Marshal(storedMeta{ProblemMeta: meta, SizeBytes: size})
 	if err := os.WriteFile(filepath.Join(path, metaFileName), metaBytes, 0644); err != nil {
-		return appErr.Wrapf(err, appErr.CacheError, "write meta failed")
+		return 0, appErr.Wrapf(err, appErr.CacheError, "write meta failed")
 	}
-	return nil
+	return size, nil
+}
+
+// populate fills an empty version dir, lazily when a seekable pack exists and
+// lazy mode is enabled, otherwise by streaming the whole tar.zst.
+// It returns the number of bytes written.
+func (c *DataPackCache) populate(ctx context.Context, meta pmodel.ProblemMeta, path string) (int64, error) {
+	if c.downloadOpts.Lazy {
+		size, err := c.openSeekable(ctx, meta, path)
+		if err == nil {
+			return size, nil
+		}
+		if !errors.Is(err, errSeekableUnavailable) {
+			return 0, err
+		}
+		// A failed probe may leave eager files behind; start from an empty dir.
+		if err := os.RemoveAll(path); err != nil {
+			return 0, appErr.Wrapf(err, appErr.CacheError, "cleanup cache dir failed")
+		}
+		if err := os.MkdirAll(path, 0755); err != nil {
+			return 0, appErr.Wrapf(err, appErr.CacheError, "create cache dir failed")
+		}
+	}
+	return c.streamDataPack(ctx, meta, path)
 }
 
-func (c *DataPackCache) waitForCache(ctx context.Context, meta pmodel.ProblemMeta, path string) error {
+// errLockWaitTimeout reports that lockWait passed while another node held the lock.
+var errLockWaitTimeout = errors.New("data pack lock wait timeout")
+
+// waitForCache waits up to lockWait while another node holds the version lock.
+// With peer distribution enabled, the version is pulled from the first peer
+// that advertises it instead of waiting for a shared disk.
+func (c *DataPackCache) waitForCache(ctx context.Context, meta pmodel.ProblemMeta, path string) (int64, error) {
 	deadline := time.Now().Add(c.lockWait)
 	for {
-		if ok := c.checkDisk(path, meta); ok {
-			return nil
+		if size, ok := c.checkDisk(path, meta); ok {
+			return size, nil
+		}
+		if size, ok := c.fetchFromPeers(ctx, meta, path); ok {
+			return c.commitVersion(meta, path, size)
 		}
 		if time.Now().After(deadline) {
-			return appErr.New(appErr.Timeout).WithMessage("wait for data pack cache timeout")
+			return 0, errLockWaitTimeout
 		}
 		select {
 		case <-ctx.Done():
-			return ctx.Err()
+			return 0, ctx.Err()
 		case <-time.After(200 * time.Millisecond):
 		}
 	}
 }
 
-func (c *DataPackCache) downloadDataPack(ctx context.Context, meta pmodel.ProblemMeta, dstPath string) error {
-	if meta.DataPackKey == "" {
-		return appErr.ValidationError("data_pack_key", "required")
+func (c *DataPackCache) addEntry(key, path string, size int64, lease bool) {
+	c.mu.Lock()
+	var pinnedUntil time.Time
+	refs := 0
+	if existing, ok := c.entries[key]; ok {
+		pinnedUntil = existing.pinnedUntil
+		refs = existing.refs
+		c.unlinkLocked(existing)
+	}
+	// An evicted version still leased by a running judge is adopted again
+	// rather than deleted under the new entry when that judge releases it.
+	if retired, ok := c.retired[key]; ok {
+		refs += retired.refs
+		delete(c.retired, key)
+	}
+	if lease {
+		refs++
+	}
+	entry := &cacheEntry{
+		key:         key,
+		path:        path,
+		sizeBytes:   size,
+		expiresAt:   time.Now().Add(c.ttl),
+		inWindow:    true,
+		pinnedUntil: pinnedUntil,
+		refs:        refs,
+	}
+	entry.elem = c.window.PushFront(entry)
+	c.windowSize += size
+	c.entries[key] = entry
+	c.rebalanceLocked(key)
+	c.mu.Unlock()
+}
+
+// Pin keeps a cached version until the given time regardless of TTL and eviction.
+// It returns false when the version is not cached. Pins only extend, never shorten.
+func (c *DataPackCache) Pin(meta pmodel.ProblemMeta, until time.Time) bool {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	entry, ok := c.entries[cacheKey(meta.ProblemID, meta.Version)]
+	if !ok {
+		return false
 	}
-	logx.WithContext(ctx).Infof(
-		"download data pack start bucket=%s key=%s dst=%s",
-		c.bucket,
-		meta.DataPackKey,
-		dstPath,
-	)
-	reader, err := c.storage.GetObject(ctx, c.bucket, meta.DataPackKey)
-	if err != nil {
-		logx.WithContext(ctx).Errorf(
-			"download data pack failed bucket=%s key=%s dst=%s err=%v",
-			c.bucket,
-			meta.DataPackKey,
-			dstPath,
-			err,
-		)
-		return appErr.Wrapf(err, appErr.CacheError, "download data pack failed")
-	}
-	defer reader.Close()
-
-	file, err := os.Create(dstPath)
-	if err != nil {
-		logx.WithContext(ctx).Errorf(
-			"create data pack file failed dst=%s err=%v",
-			dstPath,
-			err,
-		)
-		return appErr.Wrapf(err, appErr.CacheError, "create data pack file failed")
-	}
-	defer file.Close()
-
-	hasher := sha256.New()
-	tee := io.TeeReader(reader, hasher)
-	if _, err := io.Copy(file, tee); err != nil {
-		logx.WithContext(ctx).Errorf(
-			"write data pack file failed dst=%s err=%v",
-			dstPath,
-			err,
-		)
-		return appErr.Wrapf(err, appErr.CacheError, "write data pack file failed")
-	}
-	if meta.DataPackHash != "" {
-		actual := hex.EncodeToString(hasher.Sum(nil))
-		if !strings.EqualFold(actual, meta.DataPackHash) {
-			logx.WithContext(ctx).Errorf(
-				"data pack hash mismatch dst=%s expected=%s actual=%s",
-				dstPath,
-				meta.DataPackHash,
-				actual,
-			)
-			return appErr.New(appErr.CacheError).WithMessage("data pack hash mismatch")
-		}
+	if until.After(entry.pinnedUntil) {
+		entry.pinnedUntil = until
 	}
-	logx.WithContext(ctx).Infof(
-		"download data pack success bucket=%s key=%s dst=%s",
-		c.bucket,
-		meta.DataPackKey,
-		dstPath,
-	)
-	return nil
+	return true
 }
 
-func extractDataPack(srcPath, dstDir string) error {
-	file, err := os.Open(srcPath)
-	if err != nil {
-		return appErr.Wrapf(err, appErr.CacheError, "open data pack failed")
+// release drops one lease taken by Acquire and deletes the directory of an
+// evicted version once nothing holds it.
+func (c *DataPackCache) release(key string) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if entry, ok := c.entries[key]; ok {
+		if entry.refs > 0 {
+			entry.refs--
+		}
+		return
 	}
-	defer file.Close()
-
-	zstdReader, err := zstd.NewReader(file)
-	if err != nil {
-		return appErr.Wrapf(err, appErr.CacheError, "create zstd reader failed")
+	entry, ok := c.retired[key]
+	if !ok {
+		return
+	}
+	entry.refs--
+	if entry.refs > 0 {
+		return
 	}
-	defer zstdReader.Close()
+	delete(c.retired, key)
+	_ = os.RemoveAll(entry.path)
+}
 
-	tr := tar.NewReader(zstdReader)
-	for {
-		hdr, err := tr.Next()
-		if errors.Is(err, io.EOF) {
-			break
-		}
-		if err != nil {
-			return appErr.Wrapf(err, appErr.CacheError, "read tar entry failed")
-		}
-		if hdr.Name == "" {
-			continue
-		}
-		cleanName := filepath.Clean(hdr.Name)
-		if cleanName == "." {
-			continue
-		}
-		if strings.HasPrefix(cleanName, "..") || filepath.IsAbs(cleanName) {
-			return appErr.New(appErr.CacheError).WithMessage("invalid tar entry path")
-		}
-		target := filepath.Join(dstDir, cleanName)
-		if !strings.HasPrefix(target, filepath.Clean(dstDir)+string(filepath.Separator)) {
-			return appErr.New(appErr.CacheError).WithMessage("tar entry escape detected")
-		}
-		switch hdr.Typeflag {
-		case tar.TypeDir:
-			if err := os.MkdirAll(target, 0755); err != nil {
-				return appErr.Wrapf(err, appErr.CacheError, "create dir failed")
-			}
-		case tar.TypeReg:
-			if err := os.MkdirAll(filepath.Dir(target), 0755); err != nil {
-				return appErr.Wrapf(err, appErr.CacheError, "create parent dir failed")
-			}
-			file, err := os.OpenFile(target, os.O_CREATE|os.O_TRUNC|os.O_WRONLY, fs.FileMode(hdr.Mode))
-			if err != nil {
-				return appErr.Wrapf(err, appErr.CacheError, "create file failed")
-			}
-			if _, err := io.Copy(file, tr); err != nil {
-				_ = file.Close()
-				return appErr.Wrapf(err, appErr.CacheError, "write file failed")
-			}
-			_ = file.Close()
-		default:
-			// skip other types
+// growEntry accounts bytes materialized after the entry was added.
+func (c *DataPackCache) growEntry(key string, delta int64) {
+	c.mu.Lock()
+	if entry, ok := c.entries[key]; ok {
+		entry.sizeBytes += delta
+		if entry.inWindow {
+			c.windowSize += delta
+		} else {
+			c.mainSize += delta
 		}
+		c.rebalanceLocked(key)
 	}
-	return nil
+	c.mu.Unlock()
 }
 
-func (c *DataPackCache) addEntry(key, path string) {
-	size := dirSize(path)
-	c.mu.Lock()
-	if existing, ok := c.entries[key]; ok {
-		c.totalSize -= existing.sizeBytes
+func (c *DataPackCache) forgetIndex(key string) {
+	c.lazy.mu.Lock()
+	delete(c.lazy.indexes, key)
+	c.lazy.mu.Unlock()
+}
+
+func (c *DataPackCache) touchLocked(entry *cacheEntry) {
+	if entry.inWindow {
+		c.window.MoveToFront(entry.elem)
+		return
+	}
+	c.main.MoveToFront(entry.elem)
+}
+
+func (c *DataPackCache) windowLimits() (int, int64) {
+	entries := c.maxEntries / windowShare
+	if entries < 1 {
+		entries = 1
 	}
-	c.entries[key] = &cacheEntry{
-		key:       key,
-		path:      path,
-		sizeBytes: size,
-		expiresAt: time.Now().Add(c.ttl),
+	return entries, c.maxBytes / windowShare
+}
+
+func (c *DataPackCache) mainLimits() (int, int64) {
+	windowEntries, windowBytes := c.windowLimits()
+	entries := c.maxEntries - windowEntries
+	if entries < 1 {
+		entries = 1
 	}
-	c.totalSize += size
-	c.touchLocked(key)
-	c.evictLocked()
-	c.mu.Unlock()
+	return entries, c.maxBytes - windowBytes
+}
+
+func (c *DataPackCache) windowOverLocked() bool {
+	maxEntries, maxBytes := c.windowLimits()
+	return c.window.Len() > maxEntries || (c.maxBytes > 0 && c.windowSize > maxBytes)
+}
+
+func (c *DataPackCache) mainOverLocked() bool {
+	maxEntries, maxBytes := c.mainLimits()
+	return c.main.Len() > maxEntries || (c.maxBytes > 0 && c.mainSize > maxBytes)
 }
 
-func (c *DataPackCache) touchLocked(key string) {
-	for i, k := range c.lruKeys {
-		if k == key {
-			c.lruKeys = append(c.lruKeys[:i], c.lruKeys[i+1:]...)
+// rebalanceLocked moves window overflow into main when admitted and evicts the
+// rest. protect is never evicted: its caller is about to read it.
+func (c *DataPackCache) rebalanceLocked(protect string) {
+	now := time.Now()
+	for c.windowOverLocked() {
+		candidate := c.window.Back().Value.(*cacheEntry)
+		// Pinned versions skip admission; main makes room for them below.
+		if candidate.pinned(now) || c.admitLocked(candidate, protect, now) {
+			c.window.Remove(candidate.elem)
+			c.windowSize -= candidate.sizeBytes
+			candidate.inWindow = false
+			candidate.elem = c.main.PushFront(candidate)
+			c.mainSize += candidate.sizeBytes
+			continue
+		}
+		if candidate.key == protect {
+			break
+		}
+		c.removeEntryLocked(candidate.key)
+	}
+	for c.mainOverLocked() {
+		victim := c.evictableLocked(protect, now)
+		if victim == nil {
 			break
 		}
+		c.removeEntryLocked(victim.key)
 	}
-	c.lruKeys = append(c.lruKeys, key)
 }
 
-func (c *DataPackCache) evictLocked() {
-	for {
-		if c.maxEntries > 0 && len(c.entries) > c.maxEntries {
-			c.removeOldestLocked()
-			continue
+// evictableLocked returns the least recent main entry that is neither pinned nor protected.
+func (c *DataPackCache) evictableLocked(protect string, now time.Time) *cacheEntry {
+	for elem := c.main.Back(); elem != nil; elem = elem.Prev() {
+		entry := elem.Value.(*cacheEntry)
+		if entry.key == protect {
+			return nil
+		}
+		if !entry.pinned(now) {
+			return entry
 		}
-		if c.maxBytes > 0 && c.totalSize > c.maxBytes {
-			c.removeOldestLocked()
+	}
+	return nil
+}
+
+// admitLocked decides whether candidate may enter main. It must be strictly
+// more frequent than every main entry evicted to make room, counting bytes as
+// well as entries, so one large cold version cannot push out several hot ones.
+func (c *DataPackCache) admitLocked(candidate *cacheEntry, protect string, now time.Time) bool {
+	maxEntries, maxBytes := c.mainLimits()
+	needEntries := c.main.Len() + 1 - maxEntries
+	needBytes := int64(0)
+	if c.maxBytes > 0 {
+		needBytes = c.mainSize + candidate.sizeBytes - maxBytes
+	}
+	if needEntries <= 0 && needBytes <= 0 {
+		return true
+	}
+	freq := c.sketch.estimate(candidate.key)
+	victims := make([]*cacheEntry, 0, 1)
+	for elem := c.main.Back(); elem != nil && (needEntries > 0 || needBytes > 0); elem = elem.Prev() {
+		victim := elem.Value.(*cacheEntry)
+		if victim.pinned(now) {
 			continue
 		}
-		break
+		if victim.key == protect || c.sketch.estimate(victim.key) >= freq {
+			return false
+		}
+		victims = append(victims, victim)
+		needEntries--
+		needBytes -= victim.sizeBytes
 	}
+	if needEntries > 0 || needBytes > 0 {
+		return false
+	}
+	for _, victim := range victims {
+		c.removeEntryLocked(victim.key)
+	}
+	return true
 }
 
-func (c *DataPackCache) removeOldestLocked() {
-	if len(c.lruKeys) == 0 {
-		return
+func (c *DataPackCache) unlinkLocked(entry *cacheEntry) {
+	if entry.inWindow {
+		c.window.Remove(entry.elem)
+		c.windowSize -= entry.sizeBytes
+	} else {
+		c.main.Remove(entry.elem)
+		c.mainSize -= entry.sizeBytes
 	}
-	key := c.lruKeys[0]
-	c.lruKeys = c.lruKeys[1:]
-	c.removeEntryLocked(key)
+	delete(c.entries, entry.key)
 }
 
 func (c *DataPackCache) removeEntryLocked(key string) {
@@ -390,9 +567,17 @@ func (c *DataPackCache) removeEntryLocked(key string) {
 	if !ok {
 		return
 	}
-	delete(c.entries, key)
-	c.totalSize -= entry.sizeBytes
-	_ = os.RemoveAll(entry.path)
+	c.unlinkLocked(entry)
+	c.forgetIndex(key)
+	if entry.refs > 0 {
+		// A judge is still reading or materializing into the directory.
+		c.retired[key] = entry
+	} else {
+		_ = os.RemoveAll(entry.path)
+	}
+	if entry.advertised != nil && c.peers != nil {
+		go c.peers.withdraw(*entry.advertised)
+	}
 }
 
 func (c *DataPackCache) storeLock(key string, lock *redis.RedisLock) {
@@ -0,0 +1,240 @@
+package cache
+
+import (
+	"context"
+	"errors"
+	"io"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+
+	appErr "fuzoj/pkg/errors"
+	"fuzoj/pkg/problem/seekpack"
+	"fuzoj/services/judge_service/internal/pmodel"
+
+	"github.com/zeromicro/go-zero/core/logx"
+	"github.com/zeromicro/go-zero/core/syncx"
+)
+
+// eagerFiles are materialized when a lazy version is opened; everything else waits for a run.
+var eagerFiles = []string{"manifest.json", "config.json"}
+
+var errSeekableUnavailable = errors.New("seekable data pack unavailable")
+
+// LazyPack materializes files of a lazily cached version on first use.
+type LazyPack struct {
+	cache *DataPackCache
+	key   string
+	root  string
+	meta  pmodel.ProblemMeta
+	index *seekpack.Index
+}
+
+// lazyState holds per-version indexes and deduplicates concurrent file fetches.
+type lazyState struct {
+	mu      sync.Mutex
+	indexes map[string]*seekpack.Index
+	flight  syncx.SingleFlight
+}
+
+func newLazyState() *lazyState {
+	return &lazyState{
+		indexes: make(map[string]*seekpack.Index),
+		flight:  syncx.NewSingleFlight(),
+	}
+}
+
+// openSeekable prepares path as a lazy version: it stores the index and the
+// eager files and leaves testcase data to Materialize. It returns the bytes written.
+func (c *DataPackCache) openSeekable(ctx context.Context, meta pmodel.ProblemMeta, path string) (int64, error) {
+	key := seekpack.ObjectKey(meta.DataPackKey)
+	stat, err := c.storage.StatObject(ctx, c.bucket, key)
+	if err != nil || stat.SizeBytes < seekpack.TrailerSize {
+		return 0, errSeekableUnavailable
+	}
+	trailer, err := c.readRange(ctx, key, stat.SizeBytes-seekpack.TrailerSize, seekpack.TrailerSize)
+	if err != nil {
+		return 0, appErr.Wrapf(err, appErr.CacheError, "read seekable trailer failed")
+	}
+	indexLen, err := seekpack.ParseTrailer(trailer)
+	if err != nil || indexLen > stat.SizeBytes-seekpack.TrailerSize {
+		return 0, errSeekableUnavailable
+	}
+	indexBytes, err := c.readRange(ctx, key, stat.SizeBytes-seekpack.TrailerSize-indexLen, indexLen)
+	if err != nil {
+		return 0, appErr.Wrapf(err, appErr.CacheError, "read seekable index failed")
+	}
+	index, err := seekpack.ParseIndex(indexBytes)
+	if err != nil {
+		return 0, errSeekableUnavailable
+	}
+	if meta.DataPackHash != "" && !strings.EqualFold(index.DataPackHash, meta.DataPackHash) {
+		logx.WithContext(ctx).Errorf(
+			"seekable data pack is stale key=%s expected=%s actual=%s",
+			key,
+			meta.DataPackHash,
+			index.DataPackHash,
+		)
+		return 0, errSeekableUnavailable
+	}
+
+	pack := &LazyPack{cache: c, key: cacheKey(meta.ProblemID, meta.Version), root: path, meta: meta, index: &index}
+	size := int64(len(indexBytes))
+	for _, name := range eagerFiles {
+		n, err := pack.materialize(ctx, name)
+		if err != nil {
+			return 0, err
+		}
+		size += n
+	}
+	if err := os.WriteFile(filepath.Join(path, seekpack.IndexFileName), indexBytes, 0644); err != nil {
+		return 0, appErr.Wrapf(err, appErr.CacheError, "write seekable index failed")
+	}
+	c.lazy.mu.Lock()
+	c.lazy.indexes[pack.key] = &index
+	c.lazy.mu.Unlock()
+	return size, nil
+}
+
+// Materializer returns the lazy handle for a cached version, or nil when the
+// version was fully extracted and every file is already on disk.
+func (c *DataPackCache) Materializer(meta pmodel.ProblemMeta, path string) *LazyPack {
+	key := cacheKey(meta.ProblemID, meta.Version)
+	c.lazy.mu.Lock()
+	index := c.lazy.indexes[key]
+	c.lazy.mu.Unlock()
+	if index == nil {
+		data, err := os.ReadFile(filepath.Join(path, seekpack.IndexFileName))
+		if err != nil {
+			return nil
+		}
+		parsed, err := seekpack.ParseIndex(data)
+		if err != nil {
+			return nil
+		}
+		index = &parsed
+		c.lazy.mu.Lock()
+		c.lazy.indexes[key] = index
+		c.lazy.mu.Unlock()
+	}
+	return &LazyPack{cache: c, key: key, root: path, meta: meta, index: index}
+}
+
+// Materialize makes sure the given host paths exist, fetching missing files by range.
+// Paths outside the version directory or absent from the index are left to the caller.
+func (p *LazyPack) Materialize(ctx context.Context, paths ...string) error {
+	for _, hostPath := range paths {
+		if hostPath == "" {
+			continue
+		}
+		rel, err := filepath.Rel(p.root, hostPath)
+		if err != nil || rel == "." || strings.HasPrefix(rel, "..") {
+			continue
+		}
+		if _, err := p.materialize(ctx, filepath.ToSlash(rel)); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// Size returns the uncompressed size recorded in the index for a host path.
+func (p *LazyPack) Size(hostPath string) (int64, bool) {
+	rel, err := filepath.Rel(p.root, hostPath)
+	if err != nil || rel == "." || strings.HasPrefix(rel, "..") {
+		return 0, false
+	}
+	entry, ok := p.index.Lookup(filepath.ToSlash(rel))
+	if !ok {
+		return 0, false
+	}
+	return entry.Size, true
+}
+
+// MaterializeAll fetches every file in the index, e.g. to warm a version ahead of a contest.
+func (p *LazyPack) MaterializeAll(ctx context.Context) error {
+	for _, entry := range p.index.Files {
+		if _, err := p.materialize(ctx, entry.Name); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+func (p *LazyPack) materialize(ctx context.Context, name string) (int64, error) {
+	target := filepath.Join(p.root, filepath.FromSlash(name))
+	if _, err := os.Stat(target); err == nil {
+		return 0, nil
+	}
+	entry, ok := p.index.Lookup(name)
+	if !ok {
+		return 0, nil
+	}
+	val, err := p.cache.lazy.flight.Do(p.key+"/"+entry.Name, func() (any, error) {
+		if _, err := os.Stat(target); err == nil {
+			return int64(0), nil
+		}
+		if err := p.fetchFile(ctx, entry, target); err != nil {
+			return int64(0), err
+		}
+		p.cache.growEntry(p.key, entry.Size)
+		return entry.Size, nil
+	})
+	if err != nil {
+		return 0, err
+	}
+	return val.(int64), nil
+}
+
+// fetchFile decodes one frame into a temp file and renames it into place, so
+// a visible file is always complete.
+func (p *LazyPack) fetchFile(ctx context.Context, entry seekpack.FileEntry, target string) error {
+	if err := os.MkdirAll(filepath.Dir(target), 0755); err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "create parent dir failed")
+	}
+	reader, err := p.cache.storage.GetObjectRange(ctx, p.cache.bucket, seekpack.ObjectKey(p.meta.DataPackKey), entry.Offset, entry.CompressedSize)
+	if err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "fetch data pack file failed")
+	}
+	defer reader.Close()
+
+	tmp, err := os.CreateTemp(filepath.Dir(target), ".lazy-*")
+	if err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "create file failed")
+	}
+	tmpPath := tmp.Name()
+	if err := seekpack.DecodeFile(io.LimitReader(reader, entry.CompressedSize), tmp, entry); err != nil {
+		_ = tmp.Close()
+		_ = os.Remove(tmpPath)
+		return appErr.Wrapf(err, appErr.CacheError, "decode data pack file failed")
+	}
+	if err := tmp.Chmod(fs.FileMode(entry.Mode) & fs.ModePerm); err != nil {
+		_ = tmp.Close()
+		_ = os.Remove(tmpPath)
+		return appErr.Wrapf(err, appErr.CacheError, "chmod file failed")
+	}
+	if err := tmp.Close(); err != nil {
+		_ = os.Remove(tmpPath)
+		return appErr.Wrapf(err, appErr.CacheError, "write file failed")
+	}
+	if err := os.Rename(tmpPath, target); err != nil {
+		_ = os.Remove(tmpPath)
+		return appErr.Wrapf(err, appErr.CacheError, "rename file failed")
+	}
+	return nil
+}
+
+func (c *DataPackCache) readRange(ctx context.Context, key string, offset, length int64) ([]byte, error) {
+	reader, err := c.storage.GetObjectRange(ctx, c.bucket, key, offset, length)
+	if err != nil {
+		return nil, err
+	}
+	defer reader.Close()
+	buf := make([]byte, length)
+	if _, err := io.ReadFull(reader, buf); err != nil {
+		return nil, err
+	}
+	return buf, nil
+}
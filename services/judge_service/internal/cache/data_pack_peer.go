@@ -0,0 +1,301 @@
+package cache
+
+import (
+	"context"
+	"crypto/subtle"
+	"encoding/json"
+	"fmt"
+	"io"
+	"math/rand"
+	"net/http"
+	"net/url"
+	"os"
+	"path/filepath"
+	"strings"
+	"time"
+
+	appErr "fuzoj/pkg/errors"
+	"fuzoj/pkg/problem/seekpack"
+	"fuzoj/services/judge_service/internal/pmodel"
+
+	"github.com/zeromicro/go-zero/core/logx"
+	"github.com/zeromicro/go-zero/core/stores/redis"
+)
+
+const (
+	peerKeyPrefix      = "judge:datapack:peers:"
+	peerMemberSep      = "|"
+	defaultPeerTimeout = 5 * time.Minute
+	minPeerAdvertTTL   = time.Hour
+	maxPeerAttempts    = 2
+	// peerPackFileName keeps the original tar.zst of an eager version for peers.
+	peerPackFileName = ".datapack.tar.zst"
+	// PeerRoutePath is the route judge nodes serve cached versions on.
+	PeerRoutePath = "/api/v1/judge/internal/datapacks"
+	// PeerTokenHeader carries the shared peer secret.
+	PeerTokenHeader = "X-Judge-Peer-Token"
+)
+
+// PeerOptions enables peer-to-peer data pack distribution.
+// Addr is the host:port peers use to reach this node's REST server; Zone
+// groups nodes that should prefer each other over remote peers. Secret is
+// shared by all judge nodes and required on every peer request, since the
+// route serves hidden test data on the judge's REST port.
+type PeerOptions struct {
+	Addr    string
+	Zone    string
+	Secret  string
+	Timeout time.Duration
+}
+
+// peerRegistry advertises versions this node holds and finds peers for others.
+// Each version has a Redis set of "zone|addr" members keyed by its pack hash.
+type peerRegistry struct {
+	redis  *redis.Redis
+	opts   PeerOptions
+	ttl    time.Duration
+	client *http.Client
+}
+
+// SetPeerOptions enables serving cached versions to peers and fetching from them.
+// An empty Addr or Secret keeps peer distribution disabled.
+func (c *DataPackCache) SetPeerOptions(opts PeerOptions) {
+	if opts.Addr == "" || c.lockClient == nil {
+		c.peers = nil
+		return
+	}
+	if opts.Secret == "" {
+		logx.Error("peer data pack distribution requires a peer secret, disabled")
+		c.peers = nil
+		return
+	}
+	if opts.Timeout <= 0 {
+		opts.Timeout = defaultPeerTimeout
+	}
+	ttl := 2 * c.ttl
+	if ttl < minPeerAdvertTTL {
+		ttl = minPeerAdvertTTL
+	}
+	c.peers = &peerRegistry{
+		redis:  c.lockClient,
+		opts:   opts,
+		ttl:    ttl,
+		client: &http.Client{Timeout: opts.Timeout},
+	}
+}
+
+// PeerEnabled reports whether this node serves and fetches versions from peers.
+func (c *DataPackCache) PeerEnabled() bool {
+	return c.peers != nil
+}
+
+// AuthorizePeer reports whether token matches the shared peer secret.
+func (c *DataPackCache) AuthorizePeer(token string) bool {
+	if c.peers == nil || token == "" {
+		return false
+	}
+	return subtle.ConstantTimeCompare([]byte(token), []byte(c.peers.opts.Secret)) == 1
+}
+
+// PeerTimeout bounds one peer transfer in either direction.
+func (c *DataPackCache) PeerTimeout() time.Duration {
+	if c.peers == nil {
+		return defaultPeerTimeout
+	}
+	return c.peers.opts.Timeout
+}
+
+func peerKey(meta pmodel.ProblemMeta) string {
+	return fmt.Sprintf("%s%d:%d:%s", peerKeyPrefix, meta.ProblemID, meta.Version, meta.DataPackHash)
+}
+
+func (r *peerRegistry) member() string {
+	return r.opts.Zone + peerMemberSep + r.opts.Addr
+}
+
+func (r *peerRegistry) advertise(ctx context.Context, meta pmodel.ProblemMeta) {
+	key := peerKey(meta)
+	if _, err := r.redis.SaddCtx(ctx, key, r.member()); err != nil {
+		logx.WithContext(ctx).Errorf("advertise data pack failed key=%s err=%v", key, err)
+		return
+	}
+	_ = r.redis.ExpireCtx(ctx, key, durationSeconds(r.ttl))
+}
+
+func (r *peerRegistry) withdraw(meta pmodel.ProblemMeta) {
+	ctx, cancel := context.WithTimeout(context.Background(), 3*time.Second)
+	defer cancel()
+	if _, err := r.redis.SremCtx(ctx, peerKey(meta), r.member()); err != nil {
+		logx.WithContext(ctx).Errorf("withdraw data pack failed key=%s err=%v", peerKey(meta), err)
+	}
+}
+
+// advertise announces a fully extracted version to peers, refreshing the
+// announcement at most once per half TTL. Lazy versions are never announced.
+func (c *DataPackCache) advertise(ctx context.Context, key string, meta pmodel.ProblemMeta) {
+	if c.peers == nil || meta.DataPackHash == "" {
+		return
+	}
+	c.mu.Lock()
+	entry, ok := c.entries[key]
+	due := ok && time.Since(entry.advertisedAt) >= c.peers.ttl/2
+	path := ""
+	if due {
+		entry.advertisedAt = time.Now()
+		path = entry.path
+	}
+	c.mu.Unlock()
+	if !due || !c.servable(path, meta.DataPackHash) {
+		return
+	}
+	c.peers.advertise(ctx, meta)
+	c.mu.Lock()
+	if entry, ok := c.entries[key]; ok {
+		advertised := meta
+		entry.advertised = &advertised
+	}
+	c.mu.Unlock()
+}
+
+// candidates returns peer addresses holding meta, same-zone peers first, each
+// group shuffled so load spreads across warm nodes.
+func (r *peerRegistry) candidates(ctx context.Context, meta pmodel.ProblemMeta) []string {
+	members, err := r.redis.SmembersCtx(ctx, peerKey(meta))
+	if err != nil || len(members) == 0 {
+		return nil
+	}
+	self := r.member()
+	var near, far []string
+	for _, m := range members {
+		if m == self {
+			continue
+		}
+		zone, addr, ok := strings.Cut(m, peerMemberSep)
+		if !ok || addr == "" {
+			continue
+		}
+		if zone == r.opts.Zone {
+			near = append(near, addr)
+		} else {
+			far = append(far, addr)
+		}
+	}
+	rand.Shuffle(len(near), func(i, j int) { near[i], near[j] = near[j], near[i] })
+	rand.Shuffle(len(far), func(i, j int) { far[i], far[j] = far[j], far[i] })
+	return append(near, far...)
+}
+
+// fetchFromPeers fills an empty version dir from a warm peer.
+// It returns false when no peer had the version or every attempt failed.
+func (c *DataPackCache) fetchFromPeers(ctx context.Context, meta pmodel.ProblemMeta, path string) (int64, bool) {
+	if c.peers == nil || meta.DataPackHash == "" {
+		return 0, false
+	}
+	peers := c.peers.candidates(ctx, meta)
+	if len(peers) == 0 {
+		return 0, false
+	}
+	if len(peers) > maxPeerAttempts {
+		peers = peers[:maxPeerAttempts]
+	}
+	for _, addr := range peers {
+		if err := resetDir(path); err != nil {
+			return 0, false
+		}
+		size, err := c.fetchFromPeer(ctx, addr, meta, path)
+		if err == nil {
+			logx.WithContext(ctx).Infof("fetched data pack from peer peer=%s problem_id=%d version=%d", addr, meta.ProblemID, meta.Version)
+			return size, true
+		}
+		logx.WithContext(ctx).Errorf("fetch data pack from peer failed peer=%s problem_id=%d version=%d err=%v", addr, meta.ProblemID, meta.Version, err)
+	}
+	_ = resetDir(path)
+	return 0, false
+}
+
+func (c *DataPackCache) fetchFromPeer(ctx context.Context, addr string, meta pmodel.ProblemMeta, path string) (int64, error) {
+	u := url.URL{
+		Scheme:   "http",
+		Host:     addr,
+		Path:     fmt.Sprintf("%s/%d/%d", PeerRoutePath, meta.ProblemID, meta.Version),
+		RawQuery: url.Values{"hash": []string{meta.DataPackHash}}.Encode(),
+	}
+	req, err := http.NewRequestWithContext(ctx, http.MethodGet, u.String(), nil)
+	if err != nil {
+		return 0, err
+	}
+	req.Header.Set(PeerTokenHeader, c.peers.opts.Secret)
+	resp, err := c.peers.client.Do(req)
+	if err != nil {
+		return 0, err
+	}
+	defer resp.Body.Close()
+	if resp.StatusCode != http.StatusOK {
+		return 0, fmt.Errorf("peer returned status %d", resp.StatusCode)
+	}
+	// Peers send the original pack, so it is held to the same hash as storage.
+	size, err := c.extractVerified(ctx, resp.Body, meta, path)
+	if err != nil {
+		return 0, err
+	}
+	if _, err := os.Stat(filepath.Join(path, "manifest.json")); err != nil {
+		return 0, fmt.Errorf("peer pack has no manifest")
+	}
+	return size, nil
+}
+
+// ServePeer streams the original tar.zst of a fully extracted cached version.
+// It returns NotFound when this node does not hold exactly that pack.
+func (c *DataPackCache) ServePeer(ctx context.Context, w io.Writer, problemID int64, version int32, dataPackHash string) error {
+	if problemID <= 0 || version <= 0 || dataPackHash == "" {
+		return appErr.ValidationError("problem_id", "required")
+	}
+	key := cacheKey(problemID, version)
+	c.mu.Lock()
+	entry, ok := c.entries[key]
+	path := ""
+	if ok {
+		path = entry.path
+	}
+	c.mu.Unlock()
+	if !ok || !c.servable(path, dataPackHash) {
+		return appErr.New(appErr.NotFound).WithMessage("data pack is not cached on this node")
+	}
+	file, err := os.Open(filepath.Join(path, peerPackFileName))
+	if err != nil {
+		return appErr.New(appErr.NotFound).WithMessage("data pack is not cached on this node")
+	}
+	defer file.Close()
+	if _, err := io.Copy(w, file); err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "stream data pack to peer failed")
+	}
+	return nil
+}
+
+// servable reports whether path is a complete extraction of the given pack that
+// kept its original bytes. Lazily materialized versions are never served because
+// they may be partial.
+func (c *DataPackCache) servable(path, dataPackHash string) bool {
+	if _, err := os.Stat(filepath.Join(path, seekpack.IndexFileName)); err == nil {
+		return false
+	}
+	if _, err := os.Stat(filepath.Join(path, peerPackFileName)); err != nil {
+		return false
+	}
+	var stored storedMeta
+	data, err := os.ReadFile(filepath.Join(path, metaFileName))
+	if err != nil || json.Unmarshal(data, &stored) != nil {
+		return false
+	}
+	return strings.EqualFold(stored.DataPackHash, dataPackHash)
+}
+
+func resetDir(path string) error {
+	if err := os.RemoveAll(path); err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "cleanup cache dir failed")
+	}
+	if err := os.MkdirAll(path, 0755); err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "create cache dir failed")
+	}
+	return nil
+}
@@ -0,0 +1,394 @@
+package cache
+
+import (
+	"archive/tar"
+	"bytes"
+	"context"
+	"crypto/sha256"
+	"encoding/hex"
+	"errors"
+	"io"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+
+	"fuzoj/internal/common/storage"
+	appErr "fuzoj/pkg/errors"
+	"fuzoj/services/judge_service/internal/pmodel"
+
+	"github.com/klauspost/compress/zstd"
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+const (
+	defaultDownloadParallelism = 4
+	defaultDownloadChunkBytes  = 8 << 20
+	defaultExtractWorkers      = 4
+	maxBufferedFileBytes       = 4 << 20
+)
+
+// DownloadOptions tunes the streaming download-and-extract pipeline.
+// Parallelism and ChunkBytes control ranged GETs; ExtractWorkers bounds concurrent file writes.
+// Lazy opens versions from their seekable pack and fetches testcase files on first use.
+type DownloadOptions struct {
+	Parallelism    int
+	ChunkBytes     int64
+	ExtractWorkers int
+	Lazy           bool
+}
+
+func (o DownloadOptions) withDefaults() DownloadOptions {
+	if o.Parallelism <= 0 {
+		o.Parallelism = defaultDownloadParallelism
+	}
+	if o.ChunkBytes <= 0 {
+		o.ChunkBytes = defaultDownloadChunkBytes
+	}
+	if o.ExtractWorkers <= 0 {
+		o.ExtractWorkers = defaultExtractWorkers
+	}
+	return o
+}
+
+// streamDataPack downloads, hashes, decompresses and extracts a data pack in one pass.
+// The object is never written to disk as a whole; the hash is verified after the last byte.
+// It returns the total size of the extracted files.
+func (c *DataPackCache) streamDataPack(ctx context.Context, meta pmodel.ProblemMeta, dstDir string) (int64, error) {
+	if meta.DataPackKey == "" {
+		return 0, appErr.ValidationError("data_pack_key", "required")
+	}
+	opts := c.downloadOpts
+	logx.WithContext(ctx).Infof(
+		"stream data pack start bucket=%s key=%s dst=%s parallelism=%d",
+		c.bucket,
+		meta.DataPackKey,
+		dstDir,
+		opts.Parallelism,
+	)
+
+	streamCtx, cancel := context.WithCancel(ctx)
+	defer cancel()
+	reader, err := c.openDataPack(streamCtx, meta.DataPackKey)
+	if err != nil {
+		logx.WithContext(ctx).Errorf(
+			"download data pack failed bucket=%s key=%s err=%v",
+			c.bucket,
+			meta.DataPackKey,
+			err,
+		)
+		return 0, appErr.Wrapf(err, appErr.CacheError, "download data pack failed")
+	}
+	defer reader.Close()
+
+	size, err := c.extractVerified(ctx, reader, meta, dstDir)
+	if err != nil {
+		return 0, err
+	}
+	logx.WithContext(ctx).Infof(
+		"stream data pack success bucket=%s key=%s dst=%s",
+		c.bucket,
+		meta.DataPackKey,
+		dstDir,
+	)
+	return size, nil
+}
+
+// extractVerified extracts a tar.zst stream into dstDir and checks its SHA-256
+// against meta.DataPackHash. With peer distribution enabled the compressed bytes
+// are also kept as peerPackFileName, so peers receive exactly what the hash covers.
+// It returns the bytes written, including the kept pack.
+func (c *DataPackCache) extractVerified(ctx context.Context, src io.Reader, meta pmodel.ProblemMeta, dstDir string) (int64, error) {
+	hasher := sha256.New()
+	var sink io.Writer = hasher
+	var packFile *os.File
+	if c.peers != nil {
+		file, err := os.Create(filepath.Join(dstDir, peerPackFileName))
+		if err != nil {
+			return 0, appErr.Wrapf(err, appErr.CacheError, "create peer pack failed")
+		}
+		defer file.Close()
+		packFile = file
+		sink = io.MultiWriter(hasher, file)
+	}
+	tee := io.TeeReader(src, sink)
+	size, err := extractDataPackStream(tee, dstDir, c.downloadOpts.ExtractWorkers)
+	if err != nil {
+		logx.WithContext(ctx).Errorf("extract data pack failed dst=%s err=%v", dstDir, err)
+		return 0, err
+	}
+	// Trailing tar padding and zstd frames past the tar EOF still count toward the hash.
+	if _, err := io.Copy(io.Discard, tee); err != nil {
+		return 0, appErr.Wrapf(err, appErr.CacheError, "download data pack failed")
+	}
+	if meta.DataPackHash != "" {
+		actual := hex.EncodeToString(hasher.Sum(nil))
+		if !strings.EqualFold(actual, meta.DataPackHash) {
+			logx.WithContext(ctx).Errorf(
+				"data pack hash mismatch dst=%s expected=%s actual=%s",
+				dstDir,
+				meta.DataPackHash,
+				actual,
+			)
+			return 0, appErr.New(appErr.CacheError).WithMessage("data pack hash mismatch")
+		}
+	}
+	if packFile != nil {
+		info, err := packFile.Stat()
+		if err != nil {
+			return 0, appErr.Wrapf(err, appErr.CacheError, "stat peer pack failed")
+		}
+		if err := packFile.Close(); err != nil {
+			return 0, appErr.Wrapf(err, appErr.CacheError, "write peer pack failed")
+		}
+		size += info.Size()
+	}
+	return size, nil
+}
+
+// openDataPack returns a sequential reader over the object.
+// Objects larger than one chunk are fetched with parallel ranged GETs and reassembled in order.
+func (c *DataPackCache) openDataPack(ctx context.Context, key string) (io.ReadCloser, error) {
+	opts := c.downloadOpts
+	if opts.Parallelism > 1 {
+		stat, err := c.storage.StatObject(ctx, c.bucket, key)
+		if err == nil && stat.SizeBytes > opts.ChunkBytes {
+			return newRangedReader(ctx, c.storage, c.bucket, key, stat.SizeBytes, opts.ChunkBytes, opts.Parallelism), nil
+		}
+	}
+	return c.storage.GetObject(ctx, c.bucket, key)
+}
+
+type chunkResult struct {
+	data []byte
+	err  error
+}
+
+// rangedReader reads an object as ordered chunks fetched concurrently.
+// At most parallelism chunks are in flight or buffered at any time.
+type rangedReader struct {
+	cancel  context.CancelFunc
+	pending chan chan chunkResult
+	cur     []byte
+	err     error
+	done    chan struct{}
+}
+
+func newRangedReader(ctx context.Context, client storage.ObjectStorage, bucket, key string, size, chunkBytes int64, parallelism int) *rangedReader {
+	ctx, cancel := context.WithCancel(ctx)
+	r := &rangedReader{
+		cancel:  cancel,
+		pending: make(chan chan chunkResult, parallelism),
+		done:    make(chan struct{}),
+	}
+	go func() {
+		defer close(r.pending)
+		for offset := int64(0); offset < size; offset += chunkBytes {
+			length := chunkBytes
+			if offset+length > size {
+				length = size - offset
+			}
+			slot := make(chan chunkResult, 1)
+			select {
+			case r.pending <- slot:
+			case <-ctx.Done():
+				return
+			case <-r.done:
+				return
+			}
+			go func(offset, length int64) {
+				slot <- fetchChunk(ctx, client, bucket, key, offset, length)
+			}(offset, length)
+		}
+	}()
+	return r
+}
+
+func fetchChunk(ctx context.Context, client storage.ObjectStorage, bucket, key string, offset, length int64) chunkResult {
+	reader, err := client.GetObjectRange(ctx, bucket, key, offset, length)
+	if err != nil {
+		return chunkResult{err: err}
+	}
+	defer reader.Close()
+	buf := make([]byte, length)
+	if _, err := io.ReadFull(reader, buf); err != nil {
+		return chunkResult{err: err}
+	}
+	return chunkResult{data: buf}
+}
+
+func (r *rangedReader) Read(p []byte) (int, error) {
+	for len(r.cur) == 0 {
+		if r.err != nil {
+			return 0, r.err
+		}
+		slot, ok := <-r.pending
+		if !ok {
+			r.err = io.EOF
+			return 0, io.EOF
+		}
+		res := <-slot
+		if res.err != nil {
+			r.err = res.err
+			return 0, res.err
+		}
+		r.cur = res.data
+	}
+	n := copy(p, r.cur)
+	r.cur = r.cur[n:]
+	return n, nil
+}
+
+func (r *rangedReader) Close() error {
+	select {
+	case <-r.done:
+	default:
+		close(r.done)
+	}
+	r.cancel()
+	return nil
+}
+
+// fileJob is one buffered tar entry waiting to be written by the extract pool.
+type fileJob struct {
+	target string
+	mode   fs.FileMode
+	data   []byte
+}
+
+// extractDataPackStream decodes a zstd-compressed tar from src into dstDir.
+// Small files are buffered and written by a bounded worker pool so disk writes
+// overlap with decompression; large files are streamed inline to cap memory.
+// It returns the total size of the regular files written.
+func extractDataPackStream(src io.Reader, dstDir string, workers int) (int64, error) {
+	zstdReader, err := zstd.NewReader(src)
+	if err != nil {
+		return 0, appErr.Wrapf(err, appErr.CacheError, "create zstd reader failed")
+	}
+	defer zstdReader.Close()
+
+	jobs := make(chan fileJob, workers)
+	var (
+		wg       sync.WaitGroup
+		errOnce  sync.Once
+		firstErr error
+		failed   = make(chan struct{})
+	)
+	setErr := func(err error) {
+		errOnce.Do(func() {
+			firstErr = err
+			close(failed)
+		})
+	}
+	for i := 0; i < workers; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for job := range jobs {
+				if err := os.WriteFile(job.target, job.data, job.mode); err != nil {
+					setErr(appErr.Wrapf(err, appErr.CacheError, "write file failed"))
+				}
+			}
+		}()
+	}
+	var written int64
+	finish := func(err error) (int64, error) {
+		close(jobs)
+		wg.Wait()
+		if err == nil {
+			err = firstErr
+		}
+		if err != nil {
+			return 0, err
+		}
+		return written, nil
+	}
+
+	cleanDst := filepath.Clean(dstDir)
+	tr := tar.NewReader(zstdReader)
+	for {
+		hdr, err := tr.Next()
+		if errors.Is(err, io.EOF) {
+			break
+		}
+		if err != nil {
+			return finish(appErr.Wrapf(err, appErr.CacheError, "read tar entry failed"))
+		}
+		target, ok, err := tarEntryTarget(cleanDst, hdr.Name)
+		if err != nil {
+			return finish(err)
+		}
+		if !ok {
+			continue
+		}
+		switch hdr.Typeflag {
+		case tar.TypeDir:
+			if err := os.MkdirAll(target, 0755); err != nil {
+				return finish(appErr.Wrapf(err, appErr.CacheError, "create dir failed"))
+			}
+		case tar.TypeReg:
+			if err := os.MkdirAll(filepath.Dir(target), 0755); err != nil {
+				return finish(appErr.Wrapf(err, appErr.CacheError, "create parent dir failed"))
+			}
+			mode := fs.FileMode(hdr.Mode)
+			written += hdr.Size
+			if hdr.Size > maxBufferedFileBytes {
+				if err := writeTarFile(target, mode, tr); err != nil {
+					return finish(err)
+				}
+				continue
+			}
+			var buf bytes.Buffer
+			buf.Grow(int(hdr.Size))
+			if _, err := io.Copy(&buf, tr); err != nil {
+				return finish(appErr.Wrapf(err, appErr.CacheError, "read tar entry failed"))
+			}
+			select {
+			case jobs <- fileJob{target: target, mode: mode, data: buf.Bytes()}:
+			case <-failed:
+				return finish(nil)
+			}
+		default:
+			// skip other types
+		}
+	}
+	// Drain the rest of the zstd stream so the caller's hash covers every byte.
+	if _, err := io.Copy(io.Discard, zstdReader); err != nil {
+		return finish(appErr.Wrapf(err, appErr.CacheError, "read data pack failed"))
+	}
+	return finish(nil)
+}
+
+func tarEntryTarget(cleanDst, name string) (string, bool, error) {
+	if name == "" {
+		return "", false, nil
+	}
+	cleanName := filepath.Clean(name)
+	if cleanName == "." {
+		return "", false, nil
+	}
+	if strings.HasPrefix(cleanName, "..") || filepath.IsAbs(cleanName) {
+		return "", false, appErr.New(appErr.CacheError).WithMessage("invalid tar entry path")
+	}
+	target := filepath.Join(cleanDst, cleanName)
+	if !strings.HasPrefix(target, cleanDst+string(filepath.Separator)) {
+		return "", false, appErr.New(appErr.CacheError).WithMessage("tar entry escape detected")
+	}
+	return target, true, nil
+}
+
+func writeTarFile(target string, mode fs.FileMode, src io.Reader) error {
+	file, err := os.OpenFile(target, os.O_CREATE|os.O_TRUNC|os.O_WRONLY, mode)
+	if err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "create file failed")
+	}
+	if _, err := io.Copy(file, src); err != nil {
+		_ = file.Close()
+		return appErr.Wrapf(err, appErr.CacheError, "write file failed")
+	}
+	if err := file.Close(); err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "write file failed")
+	}
+	return nil
+}
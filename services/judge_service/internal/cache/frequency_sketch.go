@@ -0,0 +1,76 @@
+package cache
+
+import "hash/fnv"
+
+const (
+	sketchDepth      = 4
+	sketchMaxCounter = 15
+)
+
+// frequencySketch is a count-min sketch with 4-bit saturating counters.
+// Counters are halved every sampleSize increments so old popularity decays.
+type frequencySketch struct {
+	rows       [sketchDepth][]uint8
+	mask       uint64
+	additions  int
+	sampleSize int
+}
+
+func newFrequencySketch(capacity int) *frequencySketch {
+	if capacity < 1 {
+		capacity = 1
+	}
+	width := 16
+	for width < capacity*16 {
+		width <<= 1
+	}
+	s := &frequencySketch{
+		mask:       uint64(width - 1),
+		sampleSize: capacity * 10,
+	}
+	for i := range s.rows {
+		s.rows[i] = make([]uint8, width)
+	}
+	return s
+}
+
+func (s *frequencySketch) increment(key string) {
+	h1, h2 := sketchHashes(key)
+	for i := range s.rows {
+		idx := (h1 + uint64(i)*h2) & s.mask
+		if s.rows[i][idx] < sketchMaxCounter {
+			s.rows[i][idx]++
+		}
+	}
+	s.additions++
+	if s.additions >= s.sampleSize {
+		s.reset()
+	}
+}
+
+func (s *frequencySketch) estimate(key string) uint8 {
+	h1, h2 := sketchHashes(key)
+	est := uint8(sketchMaxCounter)
+	for i := range s.rows {
+		if v := s.rows[i][(h1+uint64(i)*h2)&s.mask]; v < est {
+			est = v
+		}
+	}
+	return est
+}
+
+func (s *frequencySketch) reset() {
+	for i := range s.rows {
+		for j := range s.rows[i] {
+			s.rows[i][j] >>= 1
+		}
+	}
+	s.additions /= 2
+}
+
+func sketchHashes(key string) (uint64, uint64) {
+	h := fnv.New64a()
+	_, _ = h.Write([]byte(key))
+	sum := h.Sum64()
+	return sum, (sum >> 32) | 1
+}
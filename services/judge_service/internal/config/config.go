@@ -66,6 +66,9 @@ type KafkaConfig struct {
 	DeadLetter       string         `json:"deadLetter"`
 	MessageTTL       time.Duration  `json:"messageTTL"`
 	TopicWeights     map[string]int `json:"topicWeights"`
+	// WaitTargetsMs holds per-topic p99 dispatch wait targets in milliseconds;
+	// topics over target gain weight until they meet it.
+	WaitTargetsMs map[string]int `json:"waitTargetsMs,optional"`
 }
 
 // MinIOConfig holds object storage settings.
@@ -79,18 +82,45 @@ type MinIOConfig struct {
 }
 
 // CacheConfig holds local data pack cache settings.
+// CompileRootDir enables the compiled-binary cache; CompileMaxBytes bounds it.
+// DownloadParallelism and DownloadChunkBytes control ranged data pack GETs;
+// ExtractWorkers bounds concurrent file writes during extraction.
+// LazyDataPack fetches testcase files from the seekable pack only when a run reaches them.
+// PeerAddr is the host:port other judge nodes use to pull cached versions from this
+// node; empty disables peer distribution. PeerZone ranks same-zone peers first.
+// PeerSecret is shared by all judge nodes and required for peer distribution.
 type CacheConfig struct {
-	RootDir    string        `json:"rootDir"`
-	TTL        time.Duration `json:"ttl"`
-	LockWait   time.Duration `json:"lockWait"`
-	MaxEntries int           `json:"maxEntries"`
-	MaxBytes   int64         `json:"maxBytes"`
+	RootDir             string        `json:"rootDir"`
+	TTL                 time.Duration `json:"ttl"`
+	LockWait            time.Duration `json:"lockWait"`
+	MaxEntries          int           `json:"maxEntries"`
+	MaxBytes            int64         `json:"maxBytes"`
+	CompileRootDir      string        `json:"compileRootDir,optional"`
+	CompileMaxBytes     int64         `json:"compileMaxBytes,optional"`
+	DownloadParallelism int           `json:"downloadParallelism,optional"`
+	DownloadChunkBytes  int64         `json:"downloadChunkBytes,optional"`
+	ExtractWorkers      int           `json:"extractWorkers,optional"`
+	LazyDataPack        bool          `json:"lazyDataPack,optional"`
+	PeerAddr            string        `json:"peerAddr,optional"`
+	PeerZone            string        `json:"peerZone,optional"`
+	PeerSecret          string        `json:"peerSecret,optional"`
+	PeerTimeout         time.Duration `json:"peerTimeout,optional"`
 }
 
 // WorkerConfig holds worker pool settings.
+// TestParallelism bounds how many testcases of one submission run at once;
+// PinnedCPUs lists one cpuset per slot (e.g. "4" or "4-5") shared by all submissions.
+// MaxQueued bounds submissions waiting for a slot (default 4x PoolSize); AgingStep raises a
+// waiting submission one priority level per step; PreemptRejudge lets waiting contest
+// submissions kill running rejudges.
 type WorkerConfig struct {
-	PoolSize int           `json:"poolSize"`
-	Timeout  time.Duration `json:"timeout"`
+	PoolSize        int           `json:"poolSize"`
+	Timeout         time.Duration `json:"timeout"`
+	TestParallelism int           `json:"testParallelism,optional"`
+	PinnedCPUs      []string      `json:"pinnedCPUs,optional"`
+	MaxQueued       int           `json:"maxQueued,optional"`
+	AgingStep       time.Duration `json:"agingStep,optional"`
+	PreemptRejudge  bool          `json:"preemptRejudge,optional"`
 }
 
 // SourceConfig holds source download settings.
@@ -114,6 +144,8 @@ type StatusConfig struct {
 	FinalBatchSize     int           `json:"finalBatchSize"`
 	FinalBatchInterval time.Duration `json:"finalBatchInterval"`
 	FinalBatchTimeout  time.Duration `json:"finalBatchTimeout"`
+	// ProgressInterval is how often coalesced intermediate progress is flushed to Redis.
+	ProgressInterval time.Duration `json:"progressInterval,optional"`
 }
 
 // JudgeConfig holds judge runtime settings.
@@ -130,6 +162,8 @@ type SandboxConfig struct {
 	EnableSeccomp        bool   `json:"enableSeccomp"`
 	EnableCgroup         bool   `json:"enableCgroup"`
 	EnableNamespaces     bool   `json:"enableNamespaces"`
+	PCHDir               string `json:"pchDir,optional"`
+	CgroupPoolSize       int    `json:"cgroupPoolSize,optional"`
 }
 
 // LanguageConfig holds language definitions.
@@ -148,5 +182,6 @@ func (s SandboxConfig) ToEngineConfig() engine.Config {
 		EnableSeccomp:        s.EnableSeccomp,
 		EnableCgroup:         s.EnableCgroup,
 		EnableNamespaces:     s.EnableNamespaces,
+		CgroupPoolSize:       s.CgroupPoolSize,
 	}
 }
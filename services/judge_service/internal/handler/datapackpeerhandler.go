@@ -0,0 +1,68 @@
+package handler
+
+import (
+	"net/http"
+	"time"
+
+	appErr "fuzoj/pkg/errors"
+	"fuzoj/services/judge_service/internal/cache"
+	"fuzoj/services/judge_service/internal/svc"
+
+	"github.com/zeromicro/go-zero/rest"
+	"github.com/zeromicro/go-zero/rest/httpx"
+)
+
+type dataPackPeerRequest struct {
+	ProblemID int64  `path:"problemId"`
+	Version   int32  `path:"version"`
+	Hash      string `form:"hash"`
+}
+
+// RegisterPeerHandlers exposes cached data pack versions to other judge nodes.
+// timeout replaces the server default, which is too short for a whole pack.
+func RegisterPeerHandlers(server *rest.Server, serverCtx *svc.ServiceContext, timeout time.Duration) {
+	server.AddRoutes(
+		[]rest.Route{
+			{
+				Method:  http.MethodGet,
+				Path:    cache.PeerRoutePath + "/:problemId/:version",
+				Handler: DataPackPeerHandler(serverCtx),
+			},
+		},
+		rest.WithTimeout(timeout),
+	)
+}
+
+// DataPackPeerHandler streams the original tar.zst of a locally cached version.
+// Requests must carry the shared peer secret.
+func DataPackPeerHandler(svcCtx *svc.ServiceContext) http.HandlerFunc {
+	return func(w http.ResponseWriter, r *http.Request) {
+		if svcCtx.DataCache == nil {
+			http.Error(w, "data pack cache is not initialized", http.StatusServiceUnavailable)
+			return
+		}
+		if !svcCtx.DataCache.AuthorizePeer(r.Header.Get(cache.PeerTokenHeader)) {
+			http.Error(w, "peer token is invalid", http.StatusForbidden)
+			return
+		}
+		var req dataPackPeerRequest
+		if err := httpx.Parse(r, &req); err != nil {
+			httpx.ErrorCtx(r.Context(), w, err)
+			return
+		}
+		w.Header().Set("Content-Type", "application/zstd")
+		err := svcCtx.DataCache.ServePeer(r.Context(), w, req.ProblemID, req.Version, req.Hash)
+		if err == nil {
+			return
+		}
+		switch appErr.GetCode(err) {
+		case appErr.NotFound:
+			http.Error(w, err.Error(), http.StatusNotFound)
+		case appErr.ValidationFailed:
+			http.Error(w, err.Error(), http.StatusBadRequest)
+		default:
+			// Headers may already be sent; the peer sees a truncated stream and retries elsewhere.
+			http.Error(w, err.Error(), http.StatusInternalServerError)
+		}
+	}
+}
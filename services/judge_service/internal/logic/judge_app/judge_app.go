@@ -2,6 +2,7 @@ package judge_app
 
 import (
 	"context"
+	"errors"
 	"fmt"
 	"path/filepath"
 	"strconv"
@@ -16,6 +17,8 @@ import (
 	"fuzoj/services/judge_service/internal/repository"
 	"fuzoj/services/judge_service/internal/sandbox"
 	"fuzoj/services/judge_service/internal/sandbox/result"
+
+	"github.com/zeromicro/go-zero/core/logx"
 )
 
 // JudgeApp handles judge tasks.
@@ -39,11 +42,15 @@ type JudgeApp struct {
 	poolRetryBase  time.Duration
 	poolRetryMaxD  time.Duration
 	deadLetter     string
-	sem            chan struct{}
+	scheduler      *slotScheduler
+	progress       *repository.ProgressReporter
 
 	metaMu    sync.Mutex
 	metaCache map[int64]metaEntry
 	metaCalls map[int64]*metaCall
+
+	costMu     sync.Mutex
+	testCounts map[int64]int
 }
 
 type metaEntry struct {
@@ -61,6 +68,7 @@ type metaCall struct {
 type JudgeAppConfig struct {
 	Worker         *sandbox.Worker
 	StatusRepo     *repository.StatusRepository
+	Progress       *repository.ProgressReporter
 	ProblemClient  *problemclient.Client
 	DataCache      *cache.DataPackCache
 	Storage        storage.ObjectStorage
@@ -79,6 +87,8 @@ type JudgeAppConfig struct {
 	PoolRetryBase  time.Duration
 	PoolRetryMaxD  time.Duration
 	DeadLetter     string
+	Scheduler      SchedulerOptions
+	Killer         SubmissionKiller
 }
 
 // NewJudgeApp creates a new judge processor.
@@ -125,9 +135,11 @@ func NewJudgeApp(cfg JudgeAppConfig) (*JudgeApp, error) {
 		poolRetryBase:  cfg.PoolRetryBase,
 		poolRetryMaxD:  cfg.PoolRetryMaxD,
 		deadLetter:     cfg.DeadLetter,
-		sem:            make(chan struct{}, poolSize),
+		scheduler:      newSlotScheduler(poolSize, cfg.Scheduler, cfg.Killer),
+		progress:       cfg.Progress,
 		metaCache:      make(map[int64]metaEntry),
 		metaCalls:      make(map[int64]*metaCall),
+		testCounts:     make(map[int64]int),
 	}
 	if svc.worker != nil {
 		svc.worker.SetStatusReporter(svc)
@@ -154,7 +166,7 @@ func (s *JudgeApp) HandleMessage(ctx context.Context, payload pmodel.JudgeMessag
 	if s.statusRepo != nil {
 		existing, err := s.statusRepo.Get(ctx, payload.SubmissionID)
 		if err == nil {
-			if statusRank(existing.Status) > statusRank(result.StatusPending) {
+			if statusRank(existing.Status) > statusRank(result.StatusPending) && !isPoolRetryResumable(payload, existing.Status) {
 				return appErr.New(appErr.InvalidParams).WithMessage("submission status is ahead of incoming message")
 			}
 		} else if !appErr.Is(err, appErr.NotFound) {
@@ -162,6 +174,19 @@ func (s *JudgeApp) HandleMessage(ctx context.Context, payload pmodel.JudgeMessag
 		}
 	}
 
+	// Wait for a slot before reporting Compiling so queued submissions stay Pending
+	// and a bounce to the retry topic can be redelivered.
+	ticket, err := s.acquireSlot(ctx, payload)
+	if err != nil {
+		if appErr.Is(err, appErr.JudgeQueueFull) {
+			return s.requeueForPoolFull(ctx, payload)
+		}
+		return err
+	}
+	defer func() {
+		s.releaseSlot(ticket)
+	}()
+
 	now := time.Now().Unix()
 	compiling := pmodel.JudgeStatusResponse{
 		SubmissionID: payload.SubmissionID,
@@ -173,25 +198,17 @@ func (s *JudgeApp) HandleMessage(ctx context.Context, payload pmodel.JudgeMessag
 		return err
 	}
 
-	if err := s.acquireSlot(ctx, payload.SubmissionID); err != nil {
-		if appErr.Is(err, appErr.JudgeQueueFull) {
-			if requeueErr := s.requeueForPoolFull(ctx, payload); requeueErr != nil {
-				return requeueErr
-			}
-			return nil
-		}
-		return err
-	}
-	defer s.releaseSlot()
-
 	meta, err := s.getProblemMeta(ctx, payload.ProblemID)
 	if err != nil {
 		return s.handleFailure(ctx, payload.SubmissionID, err)
 	}
-	dataPath, err := s.dataCache.Get(ctx, meta)
+	// The lease keeps eviction from deleting the version while tests read it
+	// or lazily materialize into it.
+	dataPath, releaseData, err := s.dataCache.Acquire(ctx, meta)
 	if err != nil {
 		return s.handleFailure(ctx, payload.SubmissionID, err)
 	}
+	defer releaseData()
 
 	manifest, err := pmodel.LoadManifest(filepath.Join(dataPath, "manifest.json"))
 	if err != nil {
@@ -229,18 +246,20 @@ func (s *JudgeApp) HandleMessage(ctx context.Context, payload pmodel.JudgeMessag
 		Priority:          payload.Priority,
 		ReceivedAt:        compiling.Timestamps.ReceivedAt,
 	}
-
-	ctxWorker := ctx
-	if s.workerTimeout > 0 {
-		var cancel context.CancelFunc
-		ctxWorker, cancel = context.WithTimeout(ctx, s.workerTimeout)
-		defer cancel()
+	if pack := s.dataCache.Materializer(meta, dataPath); pack != nil {
+		judgeReq.Data = pack
 	}
 
-	res, err := s.worker.Execute(ctxWorker, judgeReq)
+	res, err := s.execute(ctx, &ticket, judgeReq)
+	if appErr.Is(err, appErr.JudgeQueueFull) {
+		return s.requeueForPoolFull(ctx, payload)
+	}
 	if err != nil {
 		return s.handleFailure(ctx, payload.SubmissionID, err)
 	}
+	// Charge by the manifest, not the tests that ran: a run stopped early
+	// would otherwise make the next message look cheap.
+	s.recordCost(payload.ProblemID, len(judgeReq.Tests))
 
 	finished := pmodel.JudgeStatusResponse{
 		SubmissionID: payload.SubmissionID,
@@ -267,6 +286,50 @@ func (s *JudgeApp) HandleMessage(ctx context.Context, payload pmodel.JudgeMessag
 	return nil
 }
 
+// execute runs the request on the granted slot. A preempted run gives the slot
+// back and waits in the queue again at its own priority, without a Kafka round trip.
+func (s *JudgeApp) execute(ctx context.Context, ticket **slotTicket, req sandbox.JudgeRequest) (result.JudgeResult, error) {
+	for attempt := 1; ; attempt++ {
+		runCtx, cancel := s.scheduler.bind(ctx, *ticket)
+		if s.workerTimeout > 0 {
+			runCtx, cancel = withCancelChain(runCtx, cancel, s.workerTimeout)
+		}
+		res, err := s.worker.Execute(runCtx, req)
+		cancel()
+		// Only a run that stopped on its context was cut short; one that finished
+		// before the preemption landed keeps its result.
+		if !isContextError(err) || ctx.Err() != nil || !s.scheduler.wasPreempted(*ticket) {
+			return res, err
+		}
+		logx.WithContext(ctx).Infof("judge run preempted, waiting for slot submission_id=%s attempt=%d", req.SubmissionID, attempt)
+		s.releaseSlot(*ticket)
+		*ticket = nil
+		next, err := s.scheduler.acquire(ctx, req.SubmissionID, req.Priority, attempt < maxPreemptions)
+		if err != nil {
+			return result.JudgeResult{}, err
+		}
+		*ticket = next
+	}
+}
+
+func isContextError(err error) bool {
+	return errors.Is(err, context.Canceled) || errors.Is(err, context.DeadlineExceeded)
+}
+
+func withCancelChain(ctx context.Context, parent context.CancelFunc, timeout time.Duration) (context.Context, context.CancelFunc) {
+	timeoutCtx, cancel := context.WithTimeout(ctx, timeout)
+	return timeoutCtx, func() {
+		cancel()
+		parent()
+	}
+}
+
+// isPoolRetryResumable lets a message bounced by the scheduler run again even if
+// an earlier attempt already reported progress.
+func isPoolRetryResumable(payload pmodel.JudgeMessage, status result.JudgeStatus) bool {
+	return payload.PoolRetry > 0 && statusRank(status) < statusRank(result.StatusFinished)
+}
+
 func statusRank(status result.JudgeStatus) int {
 	switch status {
 	case result.StatusPending:
@@ -0,0 +1,37 @@
+package judge_app
+
+import (
+	"encoding/json"
+)
+
+// testCountsMaxEntries bounds the per-problem test counts; the table is dropped
+// as a whole once full, which only sends unseen problems to the default cost
+// until it warms up again.
+const testCountsMaxEntries = 50000
+
+// recordCost remembers how many tests a problem has, the unit the dispatcher charges messages in.
+func (s *JudgeApp) recordCost(problemID int64, tests int) {
+	if problemID <= 0 || tests <= 0 {
+		return
+	}
+	s.costMu.Lock()
+	if _, ok := s.testCounts[problemID]; !ok && len(s.testCounts) >= testCountsMaxEntries {
+		s.testCounts = make(map[int64]int)
+	}
+	s.testCounts[problemID] = tests
+	s.costMu.Unlock()
+}
+
+// EstimateCost prices a judge message by the manifest test count last seen for its problem.
+// Unknown problems return 0 and are charged the dispatcher's default cost.
+func (s *JudgeApp) EstimateCost(topic, key, value string) int {
+	var msg struct {
+		ProblemID int64 `json:"problem_id"`
+	}
+	if err := json.Unmarshal([]byte(value), &msg); err != nil || msg.ProblemID <= 0 {
+		return 0
+	}
+	s.costMu.Lock()
+	defer s.costMu.Unlock()
+	return s.testCounts[msg.ProblemID]
+}
@@ -0,0 +1,33 @@
+package judge_app
+
+import (
+	"strconv"
+	"testing"
+)
+
+func TestRecordCostBoundsTestCounts(t *testing.T) {
+	s := &JudgeApp{testCounts: make(map[int64]int)}
+	for id := int64(1); id <= testCountsMaxEntries; id++ {
+		s.recordCost(id, 3)
+	}
+	// Updating a known problem keeps the table.
+	s.recordCost(1, 5)
+	if len(s.testCounts) != testCountsMaxEntries {
+		t.Fatalf("expected %d entries, got %d", testCountsMaxEntries, len(s.testCounts))
+	}
+	if got := s.EstimateCost("judge", "", `{"problem_id":1}`); got != 5 {
+		t.Fatalf("expected updated cost 5, got %d", got)
+	}
+
+	next := int64(testCountsMaxEntries + 1)
+	s.recordCost(next, 7)
+	if len(s.testCounts) != 1 {
+		t.Fatalf("expected the full table to be dropped, got %d entries", len(s.testCounts))
+	}
+	if got := s.EstimateCost("judge", "", `{"problem_id":`+strconv.FormatInt(next, 10)+`}`); got != 7 {
+		t.Fatalf("expected cost 7 for the new problem, got %d", got)
+	}
+	if got := s.EstimateCost("judge", "", `{"problem_id":1}`); got != 0 {
+		t.Fatalf("expected dropped problem to fall back to the default cost, got %d", got)
+	}
+}
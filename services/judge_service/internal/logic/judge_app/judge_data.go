@@ -98,10 +98,18 @@ func buildTestcases(manifest pmodel.Manifest, basePath string, defaults pmodel.R
 			}
 		}
 		limits := pmodel.MergeLimits(tc.Limits, defaults)
+		compareMode := tc.CompareMode
 		checker := tc.Checker
-		if checker == nil {
+		if checker == nil && compareMode == "" {
 			checker = manifest.Checker
 		}
+		if checker != nil && checker.BinaryPath == "" {
+			if checker.Mode == "" {
+				return nil, nil, appErr.ValidationError("checker", "binary_path_or_mode_required")
+			}
+			compareMode = checker.Mode
+			checker = nil
+		}
 		var checkerSpec *sandbox.CheckerSpec
 		if checker != nil {
 			checkerPath, err := safeJoin(basePath, checker.BinaryPath)
@@ -126,6 +134,7 @@ func buildTestcases(manifest pmodel.Manifest, basePath string, defaults pmodel.R
 			Limits:            pmodel.ToSandboxLimit(limits),
 			Checker:           checkerSpec,
 			CheckerLanguageID: tc.CheckerLanguageID,
+			CompareMode:       compareMode,
 		})
 	}
 
@@ -17,50 +17,22 @@ type MessagePusher interface {
 	PushWithKey(ctx context.Context, key, value string) error
 }
 
-func (s *JudgeApp) acquireSlot(ctx context.Context, submissionID string) error {
-	logger := logx.WithContext(ctx)
-	waitStart := time.Now()
-	waitTicker := time.NewTicker(2 * time.Second)
-	defer waitTicker.Stop()
-
-	select {
-	case s.sem <- struct{}{}:
-		return nil
-	case <-ctx.Done():
-		return ctx.Err()
-	default:
-	}
+func (s *JudgeApp) acquireSlot(ctx context.Context, payload pmodel.JudgeMessage) (*slotTicket, error) {
+	return s.scheduler.acquire(ctx, payload.SubmissionID, payload.Priority, true)
+}
 
-	for {
-		select {
-		case s.sem <- struct{}{}:
-			waitCost := time.Since(waitStart)
-			if waitCost >= 2*time.Second {
-				logger.Infof("worker slot acquired after waiting submission_id=%s wait_cost=%s", submissionID, waitCost)
-			}
-			return nil
-		case <-ctx.Done():
-			return ctx.Err()
-		case <-waitTicker.C:
-			logger.Infof("worker pool is full, waiting for slot submission_id=%s wait_cost=%s", submissionID, time.Since(waitStart))
-		}
-	}
+// FreeCredits reports how many more messages the consumer should hand over.
+func (s *JudgeApp) FreeCredits() int {
+	return s.scheduler.credits()
 }
 
-func (s *JudgeApp) releaseSlot() {
-	select {
-	case <-s.sem:
-	default:
-	}
+// SetCreditNotifier registers the callback fired when a worker slot frees up.
+func (s *JudgeApp) SetCreditNotifier(notify func()) {
+	s.scheduler.setNotifier(notify)
 }
 
-func (s *JudgeApp) tryAcquireSlot() bool {
-	select {
-	case s.sem <- struct{}{}:
-		return true
-	default:
-		return false
-	}
+func (s *JudgeApp) releaseSlot(ticket *slotTicket) {
+	s.scheduler.release(ticket)
 }
 
 func (s *JudgeApp) requeueForPoolFull(ctx context.Context, payload pmodel.JudgeMessage) error {
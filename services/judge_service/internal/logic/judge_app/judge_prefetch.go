@@ -0,0 +1,57 @@
+package judge_app
+
+import (
+	"context"
+	"time"
+
+	"fuzoj/pkg/contest/prefetchpubsub"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+// prefetchPinGrace keeps contest versions pinned a while after the end for late rejudges.
+const prefetchPinGrace = 30 * time.Minute
+
+// PrefetchContest pulls, verifies and pins the data packs of a contest's problems
+// so the first submission in the contest does not pay for download and extraction.
+// Versions are resolved the same way judging does, through the latest problem meta.
+func (s *JudgeApp) PrefetchContest(ctx context.Context, plan prefetchpubsub.Plan) {
+	logger := logx.WithContext(ctx)
+	until := time.UnixMilli(plan.EndAt).Add(prefetchPinGrace)
+	for _, problem := range plan.Problems {
+		meta, err := s.getProblemMeta(ctx, problem.ProblemID)
+		if err != nil {
+			logger.Errorf("prefetch problem meta failed contest=%s problem_id=%d err=%v", plan.ContestID, problem.ProblemID, err)
+			continue
+		}
+		if problem.Version > 0 && meta.Version != problem.Version {
+			logger.Infof(
+				"prefetch warms latest version contest=%s problem_id=%d contest_version=%d latest_version=%d",
+				plan.ContestID,
+				problem.ProblemID,
+				problem.Version,
+				meta.Version,
+			)
+		}
+		// Acquire verifies the pack hash before the version becomes visible.
+		path, release, err := s.dataCache.Acquire(ctx, meta)
+		if err != nil {
+			logger.Errorf("prefetch data pack failed contest=%s problem_id=%d version=%d err=%v", plan.ContestID, meta.ProblemID, meta.Version, err)
+			continue
+		}
+		if !s.dataCache.Pin(meta, until) {
+			release()
+			logger.Errorf("prefetch pin failed, version evicted contest=%s problem_id=%d version=%d", plan.ContestID, meta.ProblemID, meta.Version)
+			continue
+		}
+		if pack := s.dataCache.Materializer(meta, path); pack != nil {
+			if err := pack.MaterializeAll(ctx); err != nil {
+				release()
+				logger.Errorf("prefetch materialize failed contest=%s problem_id=%d version=%d err=%v", plan.ContestID, meta.ProblemID, meta.Version, err)
+				continue
+			}
+		}
+		release()
+		logger.Infof("prefetched data pack contest=%s problem_id=%d version=%d pinned_until=%s", plan.ContestID, meta.ProblemID, meta.Version, until.Format(time.RFC3339))
+	}
+}
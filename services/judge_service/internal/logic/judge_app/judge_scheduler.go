@@ -0,0 +1,346 @@
+package judge_app
+
+import (
+	"container/list"
+	"context"
+	"sync"
+	"time"
+
+	"fuzoj/internal/common/mq/weighted_kq"
+	appErr "fuzoj/pkg/errors"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+// Priority levels match JudgeMessage.Priority as set by submit_service.
+const (
+	priorityContest  = 0
+	priorityRejudge  = 3
+	priorityLevels   = 4
+	defaultAgingStep = 10 * time.Second
+	// maxPreemptions bounds how often one submission can be preempted before it runs to completion.
+	maxPreemptions = 3
+)
+
+// SubmissionKiller stops every sandbox process of a running submission.
+type SubmissionKiller interface {
+	KillSubmission(ctx context.Context, submissionID string) error
+}
+
+// SchedulerOptions tunes the worker slot scheduler.
+// MaxQueued bounds submissions waiting for a slot; beyond it the least urgent one
+// is bounced to the retry topic. AgingStep raises a waiting submission one
+// priority level per step. Preempt lets waiting contest submissions kill running rejudges.
+type SchedulerOptions struct {
+	MaxQueued int
+	AgingStep time.Duration
+	Preempt   bool
+}
+
+// slotScheduler hands out worker slots by priority instead of arrival order.
+// Each level is FIFO; across levels the waiter with the lowest aged priority wins.
+type slotScheduler struct {
+	mu       sync.Mutex
+	capacity int
+	inUse    int
+	queues   [priorityLevels]*list.List
+	queued   int
+	running  map[*slotTicket]struct{}
+	opts     SchedulerOptions
+	killer   SubmissionKiller
+	notify   func()
+}
+
+type slotWaiter struct {
+	submissionID string
+	priority     int
+	enqueuedAt   time.Time
+	elem         *list.Element
+	ticket       *slotTicket
+	ready        chan error
+}
+
+// slotTicket is a granted slot. Preemption cancels the context bound for the run
+// and closes killed once the run's sandboxes are gone.
+type slotTicket struct {
+	submissionID string
+	priority     int
+	preemptible  bool
+	preempted    bool
+	cancel       context.CancelFunc
+	killed       chan struct{}
+}
+
+func newSlotScheduler(capacity int, opts SchedulerOptions, killer SubmissionKiller) *slotScheduler {
+	if capacity <= 0 {
+		capacity = 1
+	}
+	if opts.MaxQueued <= 0 {
+		opts.MaxQueued = capacity * 4
+	}
+	if opts.AgingStep <= 0 {
+		opts.AgingStep = defaultAgingStep
+	}
+	s := &slotScheduler{
+		capacity: capacity,
+		running:  make(map[*slotTicket]struct{}),
+		opts:     opts,
+		killer:   killer,
+	}
+	for i := range s.queues {
+		s.queues[i] = list.New()
+	}
+	return s
+}
+
+func clampPriority(priority int) int {
+	if priority < priorityContest {
+		return priorityContest
+	}
+	if priority >= priorityLevels {
+		return priorityLevels - 1
+	}
+	return priority
+}
+
+// acquire blocks until a slot is granted. It returns JudgeQueueFull when the
+// queue is saturated with submissions at least as urgent as this one.
+func (s *slotScheduler) acquire(ctx context.Context, submissionID string, priority int, preemptible bool) (*slotTicket, error) {
+	priority = clampPriority(priority)
+	ticket := &slotTicket{
+		submissionID: submissionID,
+		priority:     priority,
+		preemptible:  preemptible && priority == priorityRejudge,
+	}
+
+	s.mu.Lock()
+	if s.inUse < s.capacity && s.queued == 0 {
+		s.grantLocked(ticket)
+		s.mu.Unlock()
+		weighted_kq.ClaimCredit(ctx)
+		return ticket, nil
+	}
+	now := time.Now()
+	if s.queued >= s.opts.MaxQueued {
+		victim := s.leastUrgentLocked(now)
+		if victim == nil || s.effectivePriority(victim, now) <= priority {
+			s.mu.Unlock()
+			return nil, appErr.New(appErr.JudgeQueueFull).WithMessage("worker pool is full")
+		}
+		s.removeWaiterLocked(victim)
+		victim.ready <- appErr.New(appErr.JudgeQueueFull).WithMessage("worker pool is full")
+	}
+	waiter := &slotWaiter{
+		submissionID: submissionID,
+		priority:     priority,
+		enqueuedAt:   now,
+		ticket:       ticket,
+		ready:        make(chan error, 1),
+	}
+	waiter.elem = s.queues[priority].PushBack(waiter)
+	s.queued++
+	if priority == priorityContest {
+		s.preemptLocked()
+	}
+	s.mu.Unlock()
+	// Queued submissions count against credits from here on.
+	weighted_kq.ClaimCredit(ctx)
+
+	logger := logx.WithContext(ctx)
+	waitTicker := time.NewTicker(2 * time.Second)
+	defer waitTicker.Stop()
+	for {
+		select {
+		case err := <-waiter.ready:
+			if err != nil {
+				return nil, err
+			}
+			if waitCost := time.Since(now); waitCost >= 2*time.Second {
+				logger.Infof("worker slot acquired after waiting submission_id=%s priority=%d wait_cost=%s", submissionID, priority, waitCost)
+			}
+			return ticket, nil
+		case <-ctx.Done():
+			s.mu.Lock()
+			if waiter.elem != nil {
+				s.removeWaiterLocked(waiter)
+				s.mu.Unlock()
+				return nil, ctx.Err()
+			}
+			s.mu.Unlock()
+			// Granted or rejected concurrently with cancellation.
+			if err := <-waiter.ready; err == nil {
+				s.release(ticket)
+			}
+			return nil, ctx.Err()
+		case <-waitTicker.C:
+			logger.Infof("worker pool is full, waiting for slot submission_id=%s priority=%d wait_cost=%s", submissionID, priority, time.Since(now))
+		}
+	}
+}
+
+// release returns a slot and hands it to the most urgent waiter. A preempted
+// ticket waits for its kill first: the kill targets the submission ID, so a late
+// one would hit the next attempt of the same submission.
+func (s *slotScheduler) release(ticket *slotTicket) {
+	if ticket == nil {
+		return
+	}
+	s.mu.Lock()
+	killed := ticket.killed
+	s.mu.Unlock()
+	if killed != nil {
+		<-killed
+	}
+	s.mu.Lock()
+	if _, ok := s.running[ticket]; ok {
+		delete(s.running, ticket)
+		s.inUse--
+	}
+	s.dispatchLocked()
+	notify := s.notify
+	s.mu.Unlock()
+	if notify != nil {
+		notify()
+	}
+}
+
+// credits is how many more submissions the scheduler takes without bouncing any.
+// It counts free slots plus a waiting room of one pool's worth (capped by
+// MaxQueued), enough for priority ordering and preemption to have candidates.
+func (s *slotScheduler) credits() int {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	room := s.capacity
+	if room > s.opts.MaxQueued {
+		room = s.opts.MaxQueued
+	}
+	free := s.capacity - s.inUse + room - s.queued
+	if free < 0 {
+		return 0
+	}
+	return free
+}
+
+func (s *slotScheduler) setNotifier(notify func()) {
+	s.mu.Lock()
+	s.notify = notify
+	s.mu.Unlock()
+}
+
+// bind derives the context a granted run executes under; preemption cancels it.
+func (s *slotScheduler) bind(ctx context.Context, ticket *slotTicket) (context.Context, context.CancelFunc) {
+	runCtx, cancel := context.WithCancel(ctx)
+	s.mu.Lock()
+	if ticket.preempted {
+		cancel()
+	}
+	ticket.cancel = cancel
+	s.mu.Unlock()
+	return runCtx, cancel
+}
+
+func (s *slotScheduler) wasPreempted(ticket *slotTicket) bool {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	return ticket.preempted
+}
+
+func (s *slotScheduler) grantLocked(ticket *slotTicket) {
+	s.inUse++
+	s.running[ticket] = struct{}{}
+}
+
+func (s *slotScheduler) dispatchLocked() {
+	now := time.Now()
+	for s.inUse < s.capacity && s.queued > 0 {
+		waiter := s.mostUrgentLocked(now)
+		s.removeWaiterLocked(waiter)
+		s.grantLocked(waiter.ticket)
+		waiter.ready <- nil
+	}
+}
+
+func (s *slotScheduler) removeWaiterLocked(waiter *slotWaiter) {
+	s.queues[waiter.priority].Remove(waiter.elem)
+	waiter.elem = nil
+	s.queued--
+}
+
+// effectivePriority lowers a waiter's level by one per AgingStep waited.
+func (s *slotScheduler) effectivePriority(waiter *slotWaiter, now time.Time) int {
+	return waiter.priority - int(now.Sub(waiter.enqueuedAt)/s.opts.AgingStep)
+}
+
+// mostUrgentLocked compares only queue heads: within a level the head has waited longest.
+func (s *slotScheduler) mostUrgentLocked(now time.Time) *slotWaiter {
+	var best *slotWaiter
+	bestPriority := 0
+	for _, queue := range s.queues {
+		if queue.Len() == 0 {
+			continue
+		}
+		waiter := queue.Front().Value.(*slotWaiter)
+		priority := s.effectivePriority(waiter, now)
+		if best == nil || priority < bestPriority || (priority == bestPriority && waiter.enqueuedAt.Before(best.enqueuedAt)) {
+			best = waiter
+			bestPriority = priority
+		}
+	}
+	return best
+}
+
+// leastUrgentLocked compares only queue tails: within a level the tail has waited least.
+func (s *slotScheduler) leastUrgentLocked(now time.Time) *slotWaiter {
+	var worst *slotWaiter
+	worstPriority := 0
+	for _, queue := range s.queues {
+		if queue.Len() == 0 {
+			continue
+		}
+		waiter := queue.Back().Value.(*slotWaiter)
+		priority := s.effectivePriority(waiter, now)
+		if worst == nil || priority > worstPriority || (priority == worstPriority && waiter.enqueuedAt.After(worst.enqueuedAt)) {
+			worst = waiter
+			worstPriority = priority
+		}
+	}
+	return worst
+}
+
+// preemptLocked kills running rejudges until every waiting contest submission
+// has a slot on the way. Killed runs re-enter the queue at their own priority.
+func (s *slotScheduler) preemptLocked() {
+	if !s.opts.Preempt || s.killer == nil || s.inUse < s.capacity {
+		return
+	}
+	needed := s.queues[priorityContest].Len()
+	for ticket := range s.running {
+		if ticket.preempted {
+			needed--
+		}
+	}
+	for ticket := range s.running {
+		if needed <= 0 {
+			return
+		}
+		if !ticket.preemptible || ticket.preempted {
+			continue
+		}
+		ticket.preempted = true
+		ticket.killed = make(chan struct{})
+		if ticket.cancel != nil {
+			ticket.cancel()
+		}
+		needed--
+		go func(submissionID string, killed chan struct{}) {
+			defer close(killed)
+			ctx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+			defer cancel()
+			if err := s.killer.KillSubmission(ctx, submissionID); err != nil {
+				logx.WithContext(ctx).Errorf("preempt rejudge failed submission_id=%s err=%v", submissionID, err)
+				return
+			}
+			logx.WithContext(ctx).Infof("rejudge preempted for contest submission submission_id=%s", submissionID)
+		}(ticket.submissionID, ticket.killed)
+	}
+}
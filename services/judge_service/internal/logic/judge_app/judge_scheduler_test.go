@@ -0,0 +1,246 @@
+package judge_app
+
+import (
+	"context"
+	"sync"
+	"testing"
+	"time"
+
+	appErr "fuzoj/pkg/errors"
+)
+
+type recordingKiller struct {
+	mu     sync.Mutex
+	killed []string
+}
+
+func (k *recordingKiller) KillSubmission(ctx context.Context, submissionID string) error {
+	k.mu.Lock()
+	k.killed = append(k.killed, submissionID)
+	k.mu.Unlock()
+	return nil
+}
+
+func (k *recordingKiller) count() int {
+	k.mu.Lock()
+	defer k.mu.Unlock()
+	return len(k.killed)
+}
+
+func waitQueued(t *testing.T, s *slotScheduler, n int) {
+	t.Helper()
+	deadline := time.Now().Add(time.Second)
+	for time.Now().Before(deadline) {
+		s.mu.Lock()
+		queued := s.queued
+		s.mu.Unlock()
+		if queued == n {
+			return
+		}
+		time.Sleep(time.Millisecond)
+	}
+	t.Fatalf("expected %d queued waiters", n)
+}
+
+func TestSlotSchedulerGrantsByPriority(t *testing.T) {
+	s := newSlotScheduler(1, SchedulerOptions{AgingStep: time.Hour}, nil)
+	ctx := context.Background()
+	holder, err := s.acquire(ctx, "holder", 1, false)
+	if err != nil {
+		t.Fatalf("acquire holder: %v", err)
+	}
+
+	order := make(chan string, 3)
+	var wg sync.WaitGroup
+	for i, w := range []struct {
+		id       string
+		priority int
+	}{{"rejudge", 3}, {"practice", 1}, {"contest", 0}} {
+		wg.Add(1)
+		go func(id string, priority int) {
+			defer wg.Done()
+			ticket, err := s.acquire(ctx, id, priority, false)
+			if err != nil {
+				t.Errorf("acquire %s: %v", id, err)
+				return
+			}
+			order <- id
+			s.release(ticket)
+		}(w.id, w.priority)
+		waitQueued(t, s, i+1)
+	}
+	s.release(holder)
+	wg.Wait()
+	close(order)
+
+	var got []string
+	for id := range order {
+		got = append(got, id)
+	}
+	want := []string{"contest", "practice", "rejudge"}
+	for i := range want {
+		if i >= len(got) || got[i] != want[i] {
+			t.Fatalf("expected grant order %v, got %v", want, got)
+		}
+	}
+}
+
+func TestSlotSchedulerAgesWaitingSubmissions(t *testing.T) {
+	s := newSlotScheduler(1, SchedulerOptions{AgingStep: 10 * time.Millisecond}, nil)
+	ctx := context.Background()
+	holder, _ := s.acquire(ctx, "holder", 1, false)
+
+	granted := make(chan string, 2)
+	go func() {
+		ticket, err := s.acquire(ctx, "old-rejudge", 3, false)
+		if err == nil {
+			granted <- "old-rejudge"
+			s.release(ticket)
+		}
+	}()
+	waitQueued(t, s, 1)
+	time.Sleep(50 * time.Millisecond)
+	go func() {
+		ticket, err := s.acquire(ctx, "new-practice", 1, false)
+		if err == nil {
+			granted <- "new-practice"
+			s.release(ticket)
+		}
+	}()
+	waitQueued(t, s, 2)
+	s.release(holder)
+
+	if first := <-granted; first != "old-rejudge" {
+		t.Fatalf("expected aged rejudge to run first, got %s", first)
+	}
+	<-granted
+}
+
+func TestSlotSchedulerAdmissionBouncesLeastUrgent(t *testing.T) {
+	s := newSlotScheduler(1, SchedulerOptions{MaxQueued: 1, AgingStep: time.Hour}, nil)
+	ctx := context.Background()
+	holder, _ := s.acquire(ctx, "holder", 1, false)
+
+	bounced := make(chan error, 1)
+	go func() {
+		_, err := s.acquire(ctx, "rejudge", 3, false)
+		bounced <- err
+	}()
+	waitQueued(t, s, 1)
+
+	contestDone := make(chan error, 1)
+	go func() {
+		ticket, err := s.acquire(ctx, "contest", 0, false)
+		if err == nil {
+			s.release(ticket)
+		}
+		contestDone <- err
+	}()
+	if err := <-bounced; !appErr.Is(err, appErr.JudgeQueueFull) {
+		t.Fatalf("expected rejudge to be bounced, got %v", err)
+	}
+	waitQueued(t, s, 1)
+
+	if _, err := s.acquire(ctx, "late-rejudge", 3, false); !appErr.Is(err, appErr.JudgeQueueFull) {
+		t.Fatalf("expected late rejudge to be rejected, got %v", err)
+	}
+	s.release(holder)
+	if err := <-contestDone; err != nil {
+		t.Fatalf("contest acquire: %v", err)
+	}
+}
+
+func TestSlotSchedulerPreemptsRejudgeForContest(t *testing.T) {
+	killer := &recordingKiller{}
+	s := newSlotScheduler(1, SchedulerOptions{AgingStep: time.Hour, Preempt: true}, killer)
+	ctx := context.Background()
+	rejudge, err := s.acquire(ctx, "rejudge", 3, true)
+	if err != nil {
+		t.Fatalf("acquire rejudge: %v", err)
+	}
+	runCtx, cancel := s.bind(ctx, rejudge)
+	defer cancel()
+
+	contestDone := make(chan error, 1)
+	go func() {
+		ticket, err := s.acquire(ctx, "contest", 0, false)
+		if err == nil {
+			s.release(ticket)
+		}
+		contestDone <- err
+	}()
+
+	select {
+	case <-runCtx.Done():
+	case <-time.After(time.Second):
+		t.Fatalf("expected rejudge run to be canceled")
+	}
+	if !s.wasPreempted(rejudge) {
+		t.Fatalf("expected rejudge to be marked preempted")
+	}
+	deadline := time.Now().Add(time.Second)
+	for killer.count() == 0 && time.Now().Before(deadline) {
+		time.Sleep(time.Millisecond)
+	}
+	if killer.count() != 1 {
+		t.Fatalf("expected one kill, got %d", killer.count())
+	}
+	s.release(rejudge)
+	if err := <-contestDone; err != nil {
+		t.Fatalf("contest acquire: %v", err)
+	}
+}
+
+type blockingKiller struct {
+	started chan string
+	unblock chan struct{}
+}
+
+func (k *blockingKiller) KillSubmission(ctx context.Context, submissionID string) error {
+	k.started <- submissionID
+	<-k.unblock
+	return nil
+}
+
+func TestSlotSchedulerReleaseWaitsForPreemptKill(t *testing.T) {
+	killer := &blockingKiller{started: make(chan string, 1), unblock: make(chan struct{})}
+	s := newSlotScheduler(1, SchedulerOptions{AgingStep: time.Hour, Preempt: true}, killer)
+	ctx := context.Background()
+	rejudge, err := s.acquire(ctx, "rejudge", 3, true)
+	if err != nil {
+		t.Fatalf("acquire rejudge: %v", err)
+	}
+	contestDone := make(chan error, 1)
+	go func() {
+		ticket, err := s.acquire(ctx, "contest", 0, false)
+		if err == nil {
+			s.release(ticket)
+		}
+		contestDone <- err
+	}()
+	select {
+	case <-killer.started:
+	case <-time.After(time.Second):
+		t.Fatalf("expected rejudge kill to start")
+	}
+
+	released := make(chan struct{})
+	go func() {
+		s.release(rejudge)
+		close(released)
+	}()
+	select {
+	case <-released:
+		t.Fatalf("expected release to wait for the kill")
+	case <-time.After(50 * time.Millisecond):
+	}
+	close(killer.unblock)
+	select {
+	case <-released:
+	case <-time.After(time.Second):
+		t.Fatalf("expected release after the kill finished")
+	}
+	if err := <-contestDone; err != nil {
+		t.Fatalf("contest acquire: %v", err)
+	}
+}
@@ -14,6 +14,9 @@ import (
 )
 
 func (s *JudgeApp) persistStatus(ctx context.Context, status pmodel.JudgeStatusResponse) error {
+	if s.progress != nil {
+		s.progress.Forget(status.SubmissionID)
+	}
 	ctxStatus := ctx
 	if s.statusTimeout > 0 {
 		var cancel context.CancelFunc
@@ -23,7 +26,8 @@ func (s *JudgeApp) persistStatus(ctx context.Context, status pmodel.JudgeStatusR
 	return s.statusRepo.Save(ctxStatus, status)
 }
 
-// ReportStatus updates intermediate judge status in cache.
+// ReportStatus updates intermediate judge status in cache. With a progress
+// reporter configured the write is coalesced and flushed asynchronously.
 func (s *JudgeApp) ReportStatus(ctx context.Context, update sandbox.StatusUpdate) error {
 	status := pmodel.JudgeStatusResponse{
 		SubmissionID: update.SubmissionID,
@@ -38,6 +42,10 @@ func (s *JudgeApp) ReportStatus(ctx context.Context, update sandbox.StatusUpdate
 			DoneTests:  update.DoneTests,
 		},
 	}
+	if s.progress != nil {
+		s.progress.Report(status)
+		return nil
+	}
 	if err := s.persistStatus(ctx, status); err != nil {
 		logx.WithContext(ctx).Errorf("update intermediate status failed: %v", err)
 		return err
@@ -103,6 +103,29 @@ func (l *JudgeConsumerLogic) Consume(ctx context.Context, key, value string) err
 	return nil
 }
 
+// FreeCredits lets the weighted dispatcher fetch only what the worker pool can hold.
+func (l *JudgeConsumerLogic) FreeCredits() int {
+	if l.processor == nil {
+		return 1
+	}
+	return l.processor.FreeCredits()
+}
+
+func (l *JudgeConsumerLogic) SetCreditNotifier(notify func()) {
+	if l.processor == nil {
+		return
+	}
+	l.processor.SetCreditNotifier(notify)
+}
+
+// EstimateCost prices a message for the weighted dispatcher's deficit round robin.
+func (l *JudgeConsumerLogic) EstimateCost(topic, key, value string) int {
+	if l.processor == nil {
+		return 0
+	}
+	return l.processor.EstimateCost(topic, key, value)
+}
+
 func NewJudgeAppFromServiceContext(svcCtx *svc.ServiceContext) *judge_app.JudgeApp {
 	if svcCtx == nil {
 		return nil
@@ -113,6 +136,7 @@ func NewJudgeAppFromServiceContext(svcCtx *svc.ServiceContext) *judge_app.JudgeA
 	cfg := judge_app.JudgeAppConfig{
 		Worker:         svcCtx.Worker,
 		StatusRepo:     svcCtx.StatusRepo,
+		Progress:       svcCtx.ProgressReporter,
 		ProblemClient:  svcCtx.ProblemClient,
 		DataCache:      svcCtx.DataCache,
 		Storage:        svcCtx.Storage,
@@ -131,6 +155,12 @@ func NewJudgeAppFromServiceContext(svcCtx *svc.ServiceContext) *judge_app.JudgeA
 		PoolRetryBase:  svcCtx.Config.Kafka.PoolRetryBase,
 		PoolRetryMaxD:  svcCtx.Config.Kafka.PoolRetryMaxD,
 		DeadLetter:     svcCtx.Config.Kafka.DeadLetter,
+		Scheduler: judge_app.SchedulerOptions{
+			MaxQueued: svcCtx.Config.Worker.MaxQueued,
+			AgingStep: svcCtx.Config.Worker.AgingStep,
+			Preempt:   svcCtx.Config.Worker.PreemptRejudge,
+		},
+		Killer: svcCtx.Killer,
 	}
 	processor, err := judge_app.NewJudgeApp(cfg)
 	if err != nil {
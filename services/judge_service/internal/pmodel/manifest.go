@@ -25,14 +25,17 @@ type ManifestIOConfig struct {
 }
 
 // CheckerSpec describes checker binary and limits.
+// A checker without binaryPath selects the built-in comparator given by mode.
 type CheckerSpec struct {
 	BinaryPath string         `json:"binaryPath"`
+	Mode       string         `json:"mode"`
 	Args       []string       `json:"args"`
 	Env        []string       `json:"env"`
 	Limits     *ResourceLimit `json:"limits"`
 }
 
 // ManifestTest describes one testcase.
+// CompareMode selects the built-in comparator (token, line, exact) when no checker applies.
 type ManifestTest struct {
 	TestID            string         `json:"testId"`
 	InputPath         string         `json:"inputPath"`
@@ -42,6 +45,7 @@ type ManifestTest struct {
 	Limits            *ResourceLimit `json:"limits"`
 	Checker           *CheckerSpec   `json:"checker"`
 	CheckerLanguageID string         `json:"checkerLanguageId"`
+	CompareMode       string         `json:"compareMode"`
 }
 
 // ManifestSubtask defines scoring group.
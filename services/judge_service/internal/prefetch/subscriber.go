@@ -0,0 +1,136 @@
+package prefetch
+
+import (
+	"context"
+	"encoding/json"
+	"errors"
+	"sync"
+	"time"
+
+	"fuzoj/pkg/contest/prefetchpubsub"
+
+	red "github.com/redis/go-redis/v9"
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+type contestPrefetcher interface {
+	PrefetchContest(ctx context.Context, plan prefetchpubsub.Plan)
+}
+
+// Subscriber warms contest data packs from stored plans at startup and from
+// broadcast plans afterwards. Plans for one contest run one at a time.
+type Subscriber struct {
+	client     *red.Client
+	prefetcher contestPrefetcher
+	cancel     context.CancelFunc
+	done       chan struct{}
+	wg         sync.WaitGroup
+	mu         sync.Mutex
+	running    map[string]*prefetchpubsub.Plan
+}
+
+func NewSubscriber(client *red.Client, prefetcher contestPrefetcher) *Subscriber {
+	return &Subscriber{
+		client:     client,
+		prefetcher: prefetcher,
+		done:       make(chan struct{}),
+		running:    make(map[string]*prefetchpubsub.Plan),
+	}
+}
+
+func (s *Subscriber) Start(ctx context.Context) {
+	if s == nil || s.client == nil || s.prefetcher == nil {
+		return
+	}
+	if ctx == nil {
+		ctx = context.Background()
+	}
+	runCtx, cancel := context.WithCancel(ctx)
+	s.cancel = cancel
+	go s.run(runCtx)
+}
+
+func (s *Subscriber) Stop() {
+	if s == nil {
+		return
+	}
+	if s.cancel == nil {
+		return
+	}
+	s.cancel()
+	<-s.done
+	s.wg.Wait()
+}
+
+func (s *Subscriber) run(ctx context.Context) {
+	defer close(s.done)
+	logger := logx.WithContext(ctx)
+	pubsub := s.client.Subscribe(ctx, prefetchpubsub.Channel())
+	defer func() { _ = pubsub.Close() }()
+
+	// Subscribe first so plans published while loading are not missed.
+	plans, err := prefetchpubsub.LoadActive(ctx, s.client, time.Now())
+	if err != nil {
+		logger.Errorf("load contest prefetch plans failed: %v", err)
+	}
+	for _, plan := range plans {
+		s.dispatch(ctx, plan)
+	}
+
+	for {
+		msg, err := pubsub.ReceiveMessage(ctx)
+		if err != nil {
+			if errors.Is(err, context.Canceled) || errors.Is(err, red.ErrClosed) {
+				return
+			}
+			logger.Errorf("receive contest prefetch plan failed: %v", err)
+			select {
+			case <-ctx.Done():
+				return
+			case <-time.After(time.Second):
+			}
+			continue
+		}
+
+		var plan prefetchpubsub.Plan
+		if err := json.Unmarshal([]byte(msg.Payload), &plan); err != nil {
+			logger.Errorf("decode contest prefetch plan failed: %v", err)
+			continue
+		}
+		if plan.ContestID == "" || !plan.Active(time.Now()) {
+			continue
+		}
+		s.dispatch(ctx, plan)
+	}
+}
+
+// dispatch runs a plan in the background. A plan arriving while the same
+// contest is being warmed replaces any queued one and runs afterwards.
+func (s *Subscriber) dispatch(ctx context.Context, plan prefetchpubsub.Plan) {
+	s.mu.Lock()
+	if _, ok := s.running[plan.ContestID]; ok {
+		queued := plan
+		s.running[plan.ContestID] = &queued
+		s.mu.Unlock()
+		return
+	}
+	s.running[plan.ContestID] = nil
+	s.mu.Unlock()
+
+	s.wg.Add(1)
+	go func() {
+		defer s.wg.Done()
+		next := &plan
+		for next != nil {
+			s.prefetcher.PrefetchContest(ctx, *next)
+			s.mu.Lock()
+			next = s.running[plan.ContestID]
+			if next == nil {
+				delete(s.running, plan.ContestID)
+			} else {
+				s.running[plan.ContestID] = nil
+			}
+			s.mu.Unlock()
+		}
+	}()
+}
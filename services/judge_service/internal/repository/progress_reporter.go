@@ -0,0 +1,181 @@
+package repository
+
+import (
+	"context"
+	"sync"
+	"time"
+
+	"fuzoj/pkg/submit/statusmonotonic"
+	"fuzoj/pkg/submit/statuswriter"
+	"fuzoj/services/judge_service/internal/pmodel"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+const (
+	defaultProgressFlushInterval = 200 * time.Millisecond
+	defaultProgressFlushTimeout  = 2 * time.Second
+)
+
+// ProgressUpdater applies status summaries in batches; statusflow.Updater implements it.
+type ProgressUpdater interface {
+	ApplySummaries(ctx context.Context, nexts []statuswriter.StatusPayload) ([]string, error)
+}
+
+// ProgressReporter coalesces intermediate judge status off the judging goroutine.
+// Only the latest progress per submission is kept. Each tick hands the batch to
+// the updater, which applies the monotonic check and publishes with pipelines.
+type ProgressReporter struct {
+	updater  ProgressUpdater
+	interval time.Duration
+	timeout  time.Duration
+
+	mu      sync.Mutex
+	pending map[string]pmodel.JudgeStatusResponse
+	// gen counts Forget calls per submission while its progress is in flight;
+	// inflight is closed once the batch holding that progress is written.
+	gen      map[string]uint64
+	inflight map[string]chan struct{}
+
+	stopCh chan struct{}
+	doneCh chan struct{}
+}
+
+func NewProgressReporter(updater ProgressUpdater, interval, timeout time.Duration) *ProgressReporter {
+	if interval <= 0 {
+		interval = defaultProgressFlushInterval
+	}
+	if timeout <= 0 {
+		timeout = defaultProgressFlushTimeout
+	}
+	return &ProgressReporter{
+		updater:  updater,
+		interval: interval,
+		timeout:  timeout,
+		pending:  make(map[string]pmodel.JudgeStatusResponse),
+		gen:      make(map[string]uint64),
+		inflight: make(map[string]chan struct{}),
+		stopCh:   make(chan struct{}),
+		doneCh:   make(chan struct{}),
+	}
+}
+
+func (r *ProgressReporter) Start() {
+	go r.run()
+}
+
+func (r *ProgressReporter) Stop() {
+	close(r.stopCh)
+	<-r.doneCh
+}
+
+// Report records progress for the next flush. It never blocks on Redis.
+func (r *ProgressReporter) Report(status pmodel.JudgeStatusResponse) {
+	if status.SubmissionID == "" {
+		return
+	}
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	if current, ok := r.pending[status.SubmissionID]; ok && !acceptProgress(current, status) {
+		return
+	}
+	r.pending[status.SubmissionID] = status
+}
+
+// Forget drops unflushed progress. If progress of this submission is being
+// written it waits for that write only, so a synchronous status write that
+// follows cannot be overwritten by older progress; other submissions never block.
+func (r *ProgressReporter) Forget(submissionID string) {
+	r.mu.Lock()
+	delete(r.pending, submissionID)
+	done, ok := r.inflight[submissionID]
+	if ok {
+		r.gen[submissionID]++
+	}
+	r.mu.Unlock()
+	if ok {
+		<-done
+	}
+}
+
+func (r *ProgressReporter) run() {
+	ticker := time.NewTicker(r.interval)
+	defer func() {
+		ticker.Stop()
+		r.flush(context.Background())
+		close(r.doneCh)
+	}()
+	for {
+		select {
+		case <-r.stopCh:
+			return
+		case <-ticker.C:
+			r.flush(context.Background())
+		}
+	}
+}
+
+func (r *ProgressReporter) flush(ctx context.Context) {
+	r.mu.Lock()
+	if len(r.pending) == 0 {
+		r.mu.Unlock()
+		return
+	}
+	items := r.pending
+	r.pending = make(map[string]pmodel.JudgeStatusResponse, len(items))
+	done := make(chan struct{})
+	for id := range items {
+		r.inflight[id] = done
+	}
+	r.mu.Unlock()
+	defer func() {
+		r.mu.Lock()
+		for id := range items {
+			delete(r.inflight, id)
+			delete(r.gen, id)
+		}
+		r.mu.Unlock()
+		close(done)
+	}()
+	if r.updater == nil {
+		return
+	}
+
+	flushCtx, cancel := context.WithTimeout(ctx, r.timeout)
+	defer cancel()
+	logger := logx.WithContext(flushCtx)
+	start := time.Now()
+
+	// Progress forgotten between taking the batch and writing it is dropped.
+	nexts := make([]statuswriter.StatusPayload, 0, len(items))
+	r.mu.Lock()
+	for id, status := range items {
+		if r.gen[id] == 0 {
+			nexts = append(nexts, toStatusWriterPayload(status))
+		}
+	}
+	r.mu.Unlock()
+	if len(nexts) == 0 {
+		return
+	}
+	written, err := r.updater.ApplySummaries(flushCtx, nexts)
+	if err != nil {
+		logger.Errorf("flush progress status failed: %v count=%d", err, len(nexts))
+		return
+	}
+	if cost := time.Since(start); cost > finalStatusFlushWarnThreshold {
+		logger.Infof("progress status flush slow count=%d written=%d cost=%s", len(nexts), len(written), cost)
+	}
+}
+
+func acceptProgress(current, next pmodel.JudgeStatusResponse) bool {
+	accept, _ := statusmonotonic.ShouldAccept(
+		string(current.Status),
+		current.Progress.DoneTests,
+		current.Progress.TotalTests,
+		string(next.Status),
+		next.Progress.DoneTests,
+		next.Progress.TotalTests,
+	)
+	return accept
+}
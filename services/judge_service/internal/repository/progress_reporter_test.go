@@ -0,0 +1,178 @@
+package repository
+
+import (
+	"context"
+	"encoding/json"
+	"testing"
+	"time"
+
+	"fuzoj/pkg/submit/statuscache"
+	"fuzoj/pkg/submit/statusflow"
+	"fuzoj/pkg/submit/statuspubsub"
+	"fuzoj/pkg/submit/statuswriter"
+	"fuzoj/services/judge_service/internal/pmodel"
+	"fuzoj/services/judge_service/internal/sandbox/result"
+
+	"github.com/alicebob/miniredis/v2"
+	red "github.com/redis/go-redis/v9"
+	"github.com/zeromicro/go-zero/core/stores/redis"
+)
+
+func newProgressReporterForTest(t *testing.T) (*ProgressReporter, *redis.Redis) {
+	t.Helper()
+	mini := miniredis.RunT(t)
+	cache, err := redis.NewRedis(redis.RedisConf{Host: mini.Addr(), Type: "node"})
+	if err != nil {
+		t.Fatalf("new redis failed: %v", err)
+	}
+	return NewProgressReporter(statusflow.NewUpdater(cache, nil, time.Minute), time.Hour, time.Second), cache
+}
+
+func progressStatus(submissionID string, status result.JudgeStatus, done, total int) pmodel.JudgeStatusResponse {
+	return pmodel.JudgeStatusResponse{
+		SubmissionID: submissionID,
+		Status:       status,
+		Progress:     pmodel.Progress{DoneTests: done, TotalTests: total},
+	}
+}
+
+func loadCachedProgress(t *testing.T, cache *redis.Redis, submissionID string) statuswriter.StatusPayload {
+	t.Helper()
+	raw, hit, err := statuscache.Get(context.Background(), cache, submissionID)
+	if err != nil || !hit {
+		t.Fatalf("expected cached status, hit=%v err=%v", hit, err)
+	}
+	var payload statuswriter.StatusPayload
+	if err := json.Unmarshal([]byte(raw), &payload); err != nil {
+		t.Fatalf("decode cached status failed: %v", err)
+	}
+	return payload
+}
+
+func TestProgressReporterKeepsLatestProgress(t *testing.T) {
+	reporter, cache := newProgressReporterForTest(t)
+	for done := 1; done <= 50; done++ {
+		reporter.Report(progressStatus("sub-1", result.StatusRunning, done, 100))
+	}
+	reporter.Report(progressStatus("sub-1", result.StatusRunning, 10, 100))
+	reporter.Report(progressStatus("sub-2", result.StatusRunning, 1, 5))
+	reporter.flush(context.Background())
+
+	if got := loadCachedProgress(t, cache, "sub-1"); got.Progress.DoneTests != 50 {
+		t.Fatalf("expected latest progress 50, got %d", got.Progress.DoneTests)
+	}
+	if got := loadCachedProgress(t, cache, "sub-2"); got.Progress.DoneTests != 1 {
+		t.Fatalf("expected progress 1 for sub-2, got %d", got.Progress.DoneTests)
+	}
+}
+
+func TestProgressReporterSkipsRegressiveProgress(t *testing.T) {
+	reporter, cache := newProgressReporterForTest(t)
+	final, _ := json.Marshal(statuswriter.BuildSummary(statuswriter.StatusPayload{
+		SubmissionID: "sub-1",
+		Status:       string(result.StatusFinished),
+	}))
+	if err := statuscache.Set(context.Background(), cache, "sub-1", string(final), 60); err != nil {
+		t.Fatalf("seed final status failed: %v", err)
+	}
+
+	reporter.Report(progressStatus("sub-1", result.StatusRunning, 3, 10))
+	reporter.flush(context.Background())
+	if got := loadCachedProgress(t, cache, "sub-1"); got.Status != string(result.StatusFinished) {
+		t.Fatalf("expected final status to be kept, got %s", got.Status)
+	}
+}
+
+func TestProgressReporterForgetDropsPending(t *testing.T) {
+	reporter, cache := newProgressReporterForTest(t)
+	reporter.Report(progressStatus("sub-1", result.StatusRunning, 3, 10))
+	reporter.Forget("sub-1")
+	reporter.flush(context.Background())
+	if _, hit, _ := statuscache.Get(context.Background(), cache, "sub-1"); hit {
+		t.Fatalf("expected forgotten progress not to be written")
+	}
+}
+
+func TestProgressReporterPublishesThroughPubSubClient(t *testing.T) {
+	mini := miniredis.RunT(t)
+	cache, err := redis.NewRedis(redis.RedisConf{Host: mini.Addr(), Type: "node"})
+	if err != nil {
+		t.Fatalf("new redis failed: %v", err)
+	}
+	pubsub := red.NewClient(&red.Options{Addr: mini.Addr()})
+	defer pubsub.Close()
+	sub := pubsub.Subscribe(context.Background(), statuspubsub.Channel("sub-1"))
+	defer sub.Close()
+	if _, err := sub.Receive(context.Background()); err != nil {
+		t.Fatalf("subscribe failed: %v", err)
+	}
+
+	reporter := NewProgressReporter(statusflow.NewUpdater(cache, pubsub, time.Minute), time.Hour, time.Second)
+	reporter.Report(progressStatus("sub-1", result.StatusRunning, 2, 10))
+	reporter.flush(context.Background())
+
+	select {
+	case msg := <-sub.Channel():
+		var event statuspubsub.Event
+		if err := json.Unmarshal([]byte(msg.Payload), &event); err != nil || event.SubmissionID != "sub-1" {
+			t.Fatalf("unexpected pubsub event %q err=%v", msg.Payload, err)
+		}
+	case <-time.After(time.Second):
+		t.Fatalf("expected a status pubsub event")
+	}
+	if got := loadCachedProgress(t, cache, "sub-1"); got.Progress.DoneTests != 2 {
+		t.Fatalf("expected progress 2, got %d", got.Progress.DoneTests)
+	}
+}
+
+type blockingUpdater struct {
+	started chan struct{}
+	unblock chan struct{}
+}
+
+func (u *blockingUpdater) ApplySummaries(ctx context.Context, nexts []statuswriter.StatusPayload) ([]string, error) {
+	close(u.started)
+	<-u.unblock
+	return nil, nil
+}
+
+func TestProgressReporterForgetWaitsOnlyForOwnWrite(t *testing.T) {
+	updater := &blockingUpdater{started: make(chan struct{}), unblock: make(chan struct{})}
+	reporter := NewProgressReporter(updater, time.Hour, time.Second)
+	reporter.Report(progressStatus("sub-1", result.StatusRunning, 1, 10))
+	flushed := make(chan struct{})
+	go func() {
+		reporter.flush(context.Background())
+		close(flushed)
+	}()
+	<-updater.started
+
+	otherDone := make(chan struct{})
+	go func() {
+		reporter.Forget("sub-2")
+		close(otherDone)
+	}()
+	select {
+	case <-otherDone:
+	case <-time.After(time.Second):
+		t.Fatalf("expected Forget of an idle submission not to wait for the flush")
+	}
+
+	ownDone := make(chan struct{})
+	go func() {
+		reporter.Forget("sub-1")
+		close(ownDone)
+	}()
+	select {
+	case <-ownDone:
+		t.Fatalf("expected Forget to wait for the in-flight write of its submission")
+	case <-time.After(50 * time.Millisecond):
+	}
+	close(updater.unblock)
+	<-flushed
+	select {
+	case <-ownDone:
+	case <-time.After(time.Second):
+		t.Fatalf("expected Forget to return after the write")
+	}
+}
@@ -47,6 +47,18 @@ type JudgeRequest struct {
 
 	// ReceivedAt is the unix timestamp when the judge task was accepted.
 	ReceivedAt int64
+
+	// Data fetches testcase files on demand when the data pack is cached lazily.
+	// Nil means every path already exists locally.
+	Data DataMaterializer
+}
+
+// DataMaterializer makes testcase files available before a run reads them.
+// Size reports the size of a file it can fetch, so scheduling does not need
+// the file on disk.
+type DataMaterializer interface {
+	Materialize(ctx context.Context, paths ...string) error
+	Size(path string) (int64, bool)
 }
 
 // TestcaseSpec describes one test case input and expected answer.
@@ -61,6 +73,8 @@ type TestcaseSpec struct {
 	Checker    *CheckerSpec
 	// CheckerLanguageID defaults to LanguageID if empty.
 	CheckerLanguageID string
+	// CompareMode selects the built-in output comparator when Checker is nil.
+	CompareMode string
 }
 
 // SubtaskSpec defines scoring strategy for a group of testcases.
@@ -0,0 +1,375 @@
+//go:build cgo && linux
+
+// Native output comparator used by the run path when a testcase selects a
+// built-in compare mode instead of a checker binary. Both files are mapped
+// read-only and scanned with AVX2 or SSE4.2 when the CPU supports them.
+
+#include "compare.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FUZOJ_COMPARE_X86 1
+#endif
+
+namespace {
+
+constexpr size_t kSnippetMax = 32;
+
+inline bool is_space(uint8_t c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool is_blank(uint8_t c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+size_t mismatch_scalar(const uint8_t *a, const uint8_t *b, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		if (a[i] != b[i]) {
+			return i;
+		}
+	}
+	return n;
+}
+
+size_t find_space_scalar(const uint8_t *p, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		if (is_space(p[i])) {
+			return i;
+		}
+	}
+	return n;
+}
+
+size_t find_nonspace_scalar(const uint8_t *p, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		if (!is_space(p[i])) {
+			return i;
+		}
+	}
+	return n;
+}
+
+#ifdef FUZOJ_COMPARE_X86
+
+__attribute__((target("avx2"))) inline uint32_t space_mask_avx2(__m256i v) {
+	const __m256i sp = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+	const __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+	const __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t);
+	return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(sp, ctl)));
+}
+
+__attribute__((target("avx2"))) size_t mismatch_avx2(const uint8_t *a, const uint8_t *b, size_t n) {
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+		const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+		const uint32_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+		if (eq != 0xFFFFFFFFu) {
+			return i + static_cast<size_t>(__builtin_ctz(~eq));
+		}
+	}
+	return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) size_t find_space_avx2(const uint8_t *p, size_t n) {
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		const uint32_t mask = space_mask_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)));
+		if (mask != 0) {
+			return i + static_cast<size_t>(__builtin_ctz(mask));
+		}
+	}
+	return i + find_space_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2"))) size_t find_nonspace_avx2(const uint8_t *p, size_t n) {
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		const uint32_t mask = space_mask_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)));
+		if (mask != 0xFFFFFFFFu) {
+			return i + static_cast<size_t>(__builtin_ctz(~mask));
+		}
+	}
+	return i + find_nonspace_scalar(p + i, n - i);
+}
+
+// Ranges for PCMPESTRI: [\t, \r] and [' ', ' '].
+__attribute__((target("sse4.2"))) inline __m128i space_ranges_sse42() {
+	return _mm_setr_epi8('\t', '\r', ' ', ' ', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+}
+
+__attribute__((target("sse4.2"))) size_t mismatch_sse42(const uint8_t *a, const uint8_t *b, size_t n) {
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+		const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+		const uint32_t eq = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+		if (eq != 0xFFFFu) {
+			return i + static_cast<size_t>(__builtin_ctz(~eq));
+		}
+	}
+	return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse4.2"))) size_t find_space_sse42(const uint8_t *p, size_t n) {
+	const __m128i ranges = space_ranges_sse42();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+		const int idx = _mm_cmpestri(ranges, 4, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+		if (idx < 16) {
+			return i + static_cast<size_t>(idx);
+		}
+	}
+	return i + find_space_scalar(p + i, n - i);
+}
+
+__attribute__((target("sse4.2"))) size_t find_nonspace_sse42(const uint8_t *p, size_t n) {
+	const __m128i ranges = space_ranges_sse42();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+		const int idx = _mm_cmpestri(ranges, 4, v, 16,
+			_SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+		if (idx < 16) {
+			return i + static_cast<size_t>(idx);
+		}
+	}
+	return i + find_nonspace_scalar(p + i, n - i);
+}
+
+#endif
+
+struct scan_ops {
+	size_t (*mismatch)(const uint8_t *, const uint8_t *, size_t);
+	size_t (*find_space)(const uint8_t *, size_t);
+	size_t (*find_nonspace)(const uint8_t *, size_t);
+};
+
+scan_ops select_ops() {
+#ifdef FUZOJ_COMPARE_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return scan_ops{mismatch_avx2, find_space_avx2, find_nonspace_avx2};
+	}
+	if (__builtin_cpu_supports("sse4.2")) {
+		return scan_ops{mismatch_sse42, find_space_sse42, find_nonspace_sse42};
+	}
+#endif
+	return scan_ops{mismatch_scalar, find_space_scalar, find_nonspace_scalar};
+}
+
+const scan_ops ops = select_ops();
+
+class mapped_file {
+public:
+	mapped_file() = default;
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+
+	~mapped_file() {
+		if (data_ != nullptr && size_ > 0) {
+			munmap(const_cast<uint8_t *>(data_), size_);
+		}
+		if (fd_ >= 0) {
+			close(fd_);
+		}
+	}
+
+	// open returns 0 on success or the errno of the failing step.
+	int open(const char *path) {
+		fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+		if (fd_ < 0) {
+			return errno;
+		}
+		struct stat st;
+		if (fstat(fd_, &st) != 0) {
+			return errno;
+		}
+		size_ = static_cast<size_t>(st.st_size);
+		if (size_ == 0) {
+			return 0;
+		}
+		void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+		if (addr == MAP_FAILED) {
+			size_ = 0;
+			return errno;
+		}
+		madvise(addr, size_, MADV_SEQUENTIAL);
+		data_ = static_cast<const uint8_t *>(addr);
+		return 0;
+	}
+
+	const uint8_t *data() const { return data_; }
+	size_t size() const { return size_; }
+
+private:
+	int fd_ = -1;
+	const uint8_t *data_ = nullptr;
+	size_t size_ = 0;
+};
+
+struct cursor {
+	const uint8_t *p;
+	size_t n;
+	size_t pos;
+};
+
+int differ(char *msg, size_t msg_len, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+int differ(char *msg, size_t msg_len, const char *fmt, ...) {
+	if (msg != nullptr && msg_len > 0) {
+		va_list args;
+		va_start(args, fmt);
+		vsnprintf(msg, msg_len, fmt, args);
+		va_end(args);
+	}
+	return FUZOJ_COMPARE_DIFFER;
+}
+
+int snippet_len(size_t n) {
+	return static_cast<int>(n < kSnippetMax ? n : kSnippetMax);
+}
+
+int compare_token(cursor out, cursor ans, char *msg, size_t msg_len) {
+	size_t index = 0;
+	for (;;) {
+		out.pos += ops.find_nonspace(out.p + out.pos, out.n - out.pos);
+		ans.pos += ops.find_nonspace(ans.p + ans.pos, ans.n - ans.pos);
+		const bool out_done = out.pos == out.n;
+		const bool ans_done = ans.pos == ans.n;
+		if (out_done && ans_done) {
+			return FUZOJ_COMPARE_EQUAL;
+		}
+		index++;
+		if (out_done) {
+			return differ(msg, msg_len, "output ended early at token #%zu", index);
+		}
+		if (ans_done) {
+			return differ(msg, msg_len, "extra output at token #%zu", index);
+		}
+		const size_t out_len = ops.find_space(out.p + out.pos, out.n - out.pos);
+		const size_t ans_len = ops.find_space(ans.p + ans.pos, ans.n - ans.pos);
+		if (out_len != ans_len || ops.mismatch(out.p + out.pos, ans.p + ans.pos, out_len) != out_len) {
+			return differ(msg, msg_len, "token #%zu differs: expected \"%.*s\" got \"%.*s\"", index,
+				snippet_len(ans_len), reinterpret_cast<const char *>(ans.p + ans.pos),
+				snippet_len(out_len), reinterpret_cast<const char *>(out.p + out.pos));
+		}
+		out.pos += out_len;
+		ans.pos += ans_len;
+	}
+}
+
+size_t trim_trailing_space(const uint8_t *p, size_t n) {
+	while (n > 0 && is_space(p[n - 1])) {
+		n--;
+	}
+	return n;
+}
+
+size_t line_length(const cursor &c, size_t *next) {
+	const void *nl = memchr(c.p + c.pos, '\n', c.n - c.pos);
+	size_t end = nl == nullptr ? c.n : static_cast<size_t>(static_cast<const uint8_t *>(nl) - c.p);
+	*next = nl == nullptr ? c.n : end + 1;
+	while (end > c.pos && is_blank(c.p[end - 1])) {
+		end--;
+	}
+	return end - c.pos;
+}
+
+int compare_line(cursor out, cursor ans, char *msg, size_t msg_len) {
+	// Trailing blank lines and spaces at the end of the file never count.
+	out.n = trim_trailing_space(out.p, out.n);
+	ans.n = trim_trailing_space(ans.p, ans.n);
+	size_t line = 0;
+	for (;;) {
+		const bool out_done = out.pos >= out.n;
+		const bool ans_done = ans.pos >= ans.n;
+		if (out_done && ans_done) {
+			return FUZOJ_COMPARE_EQUAL;
+		}
+		line++;
+		if (out_done) {
+			return differ(msg, msg_len, "output ended early at line %zu", line);
+		}
+		if (ans_done) {
+			return differ(msg, msg_len, "extra output at line %zu", line);
+		}
+		size_t out_next = 0;
+		size_t ans_next = 0;
+		const size_t out_len = line_length(out, &out_next);
+		const size_t ans_len = line_length(ans, &ans_next);
+		if (out_len != ans_len || ops.mismatch(out.p + out.pos, ans.p + ans.pos, out_len) != out_len) {
+			return differ(msg, msg_len, "line %zu differs: expected \"%.*s\" got \"%.*s\"", line,
+				snippet_len(ans_len), reinterpret_cast<const char *>(ans.p + ans.pos),
+				snippet_len(out_len), reinterpret_cast<const char *>(out.p + out.pos));
+		}
+		out.pos = out_next;
+		ans.pos = ans_next;
+	}
+}
+
+int compare_exact(cursor out, cursor ans, char *msg, size_t msg_len) {
+	const size_t common = out.n < ans.n ? out.n : ans.n;
+	const size_t at = ops.mismatch(out.p, ans.p, common);
+	if (at < common) {
+		return differ(msg, msg_len, "byte %zu differs", at);
+	}
+	if (out.n < ans.n) {
+		return differ(msg, msg_len, "output ended early at byte %zu", out.n);
+	}
+	if (out.n > ans.n) {
+		return differ(msg, msg_len, "extra output at byte %zu", ans.n);
+	}
+	return FUZOJ_COMPARE_EQUAL;
+}
+
+int fail(char *msg, size_t msg_len, int *err_no, int err, const char *what) {
+	if (err_no != nullptr) {
+		*err_no = err;
+	}
+	if (msg != nullptr && msg_len > 0) {
+		snprintf(msg, msg_len, "%s", what);
+	}
+	return FUZOJ_COMPARE_ERROR;
+}
+
+}  // namespace
+
+extern "C" int fuzoj_compare_files(const char *output_path, const char *answer_path, int mode,
+				   char *msg, size_t msg_len, int *err_no) {
+	if (msg != nullptr && msg_len > 0) {
+		msg[0] = '\0';
+	}
+	mapped_file out;
+	if (int err = out.open(output_path); err != 0) {
+		return fail(msg, msg_len, err_no, err, "open output");
+	}
+	mapped_file ans;
+	if (int err = ans.open(answer_path); err != 0) {
+		return fail(msg, msg_len, err_no, err, "open answer");
+	}
+	const cursor out_cur{out.data(), out.size(), 0};
+	const cursor ans_cur{ans.data(), ans.size(), 0};
+	switch (mode) {
+	case FUZOJ_COMPARE_TOKEN:
+		return compare_token(out_cur, ans_cur, msg, msg_len);
+	case FUZOJ_COMPARE_LINE:
+		return compare_line(out_cur, ans_cur, msg, msg_len);
+	case FUZOJ_COMPARE_EXACT:
+		return compare_exact(out_cur, ans_cur, msg, msg_len);
+	default:
+		return fail(msg, msg_len, err_no, EINVAL, "unknown compare mode");
+	}
+}
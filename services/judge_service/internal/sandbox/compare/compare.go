@@ -0,0 +1,55 @@
+// Package compare implements built-in output comparison for testcases that
+// do not ship a checker binary.
+package compare
+
+import (
+	"errors"
+	"fmt"
+	"strings"
+)
+
+// Mode selects how program output is matched against the answer file.
+type Mode string
+
+const (
+	// ModeToken compares whitespace-separated tokens.
+	ModeToken Mode = "token"
+	// ModeLine compares lines, ignoring trailing blanks and trailing empty lines.
+	ModeLine Mode = "line"
+	// ModeExact compares raw bytes.
+	ModeExact Mode = "exact"
+)
+
+// Result is the outcome of one comparison.
+type Result struct {
+	Equal bool
+	// Message describes the first difference when Equal is false.
+	Message string
+}
+
+// ErrOutputNotFound reports that the program did not produce the output file;
+// callers judge it as a wrong answer rather than a system error.
+var ErrOutputNotFound = errors.New("output file not found")
+
+// ParseMode validates a compare mode from manifest or request data.
+func ParseMode(value string) (Mode, error) {
+	switch Mode(strings.ToLower(strings.TrimSpace(value))) {
+	case ModeToken:
+		return ModeToken, nil
+	case ModeLine:
+		return ModeLine, nil
+	case ModeExact:
+		return ModeExact, nil
+	default:
+		return "", fmt.Errorf("unsupported compare mode: %s", value)
+	}
+}
+
+// Files compares the output file against the answer file.
+func Files(outputPath, answerPath string, mode Mode) (Result, error) {
+	parsed, err := ParseMode(string(mode))
+	if err != nil {
+		return Result{}, err
+	}
+	return compareFiles(outputPath, answerPath, parsed)
+}
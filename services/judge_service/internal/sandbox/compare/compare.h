@@ -0,0 +1,32 @@
+#ifndef FUZOJ_SANDBOX_COMPARE_H
+#define FUZOJ_SANDBOX_COMPARE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum fuzoj_compare_mode {
+	FUZOJ_COMPARE_TOKEN = 0,
+	FUZOJ_COMPARE_LINE = 1,
+	FUZOJ_COMPARE_EXACT = 2,
+};
+
+enum fuzoj_compare_status {
+	FUZOJ_COMPARE_EQUAL = 0,
+	FUZOJ_COMPARE_DIFFER = 1,
+	FUZOJ_COMPARE_ERROR = -1,
+};
+
+// fuzoj_compare_files maps both files read-only and compares them with the
+// given mode. On FUZOJ_COMPARE_DIFFER msg holds a short human readable reason;
+// on FUZOJ_COMPARE_ERROR *err_no holds the failing errno and msg names the step.
+int fuzoj_compare_files(const char *output_path, const char *answer_path, int mode,
+			char *msg, size_t msg_len, int *err_no);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
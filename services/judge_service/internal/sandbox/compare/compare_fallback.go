@@ -0,0 +1,161 @@
+//go:build !cgo || !linux
+
+package compare
+
+import (
+	"bytes"
+	"errors"
+	"fmt"
+	"os"
+)
+
+const snippetMax = 32
+
+// compareFiles is the portable implementation used when the native
+// comparator cannot be built. It mirrors the semantics and messages of compare.cpp.
+func compareFiles(outputPath, answerPath string, mode Mode) (Result, error) {
+	out, err := os.ReadFile(outputPath)
+	if errors.Is(err, os.ErrNotExist) {
+		return Result{}, fmt.Errorf("compare open output: %w", ErrOutputNotFound)
+	}
+	if err != nil {
+		return Result{}, fmt.Errorf("compare open output: %w", err)
+	}
+	ans, err := os.ReadFile(answerPath)
+	if err != nil {
+		return Result{}, fmt.Errorf("compare open answer: %w", err)
+	}
+	switch mode {
+	case ModeLine:
+		return compareLine(out, ans), nil
+	case ModeExact:
+		return compareExact(out, ans), nil
+	default:
+		return compareToken(out, ans), nil
+	}
+}
+
+func isSpace(c byte) bool {
+	return c == ' ' || (c >= '\t' && c <= '\r')
+}
+
+func isBlank(c byte) bool {
+	return c == ' ' || c == '\t' || c == '\r'
+}
+
+func differ(format string, args ...interface{}) Result {
+	return Result{Message: fmt.Sprintf(format, args...)}
+}
+
+func snippet(b []byte) []byte {
+	if len(b) > snippetMax {
+		return b[:snippetMax]
+	}
+	return b
+}
+
+func skipSpace(b []byte, pos int) int {
+	for pos < len(b) && isSpace(b[pos]) {
+		pos++
+	}
+	return pos
+}
+
+func tokenEnd(b []byte, pos int) int {
+	for pos < len(b) && !isSpace(b[pos]) {
+		pos++
+	}
+	return pos
+}
+
+func compareToken(out, ans []byte) Result {
+	outPos, ansPos := 0, 0
+	for index := 1; ; index++ {
+		outPos = skipSpace(out, outPos)
+		ansPos = skipSpace(ans, ansPos)
+		outDone := outPos == len(out)
+		ansDone := ansPos == len(ans)
+		if outDone && ansDone {
+			return Result{Equal: true}
+		}
+		if outDone {
+			return differ("output ended early at token #%d", index)
+		}
+		if ansDone {
+			return differ("extra output at token #%d", index)
+		}
+		outEnd := tokenEnd(out, outPos)
+		ansEnd := tokenEnd(ans, ansPos)
+		if !bytes.Equal(out[outPos:outEnd], ans[ansPos:ansEnd]) {
+			return differ("token #%d differs: expected \"%s\" got \"%s\"", index,
+				snippet(ans[ansPos:ansEnd]), snippet(out[outPos:outEnd]))
+		}
+		outPos, ansPos = outEnd, ansEnd
+	}
+}
+
+func trimTrailingSpace(b []byte) []byte {
+	n := len(b)
+	for n > 0 && isSpace(b[n-1]) {
+		n--
+	}
+	return b[:n]
+}
+
+// nextLine returns the line at pos without trailing blanks and the offset of the next line.
+func nextLine(b []byte, pos int) ([]byte, int) {
+	end := len(b)
+	next := len(b)
+	if idx := bytes.IndexByte(b[pos:], '\n'); idx >= 0 {
+		end = pos + idx
+		next = end + 1
+	}
+	for end > pos && isBlank(b[end-1]) {
+		end--
+	}
+	return b[pos:end], next
+}
+
+func compareLine(out, ans []byte) Result {
+	out = trimTrailingSpace(out)
+	ans = trimTrailingSpace(ans)
+	outPos, ansPos := 0, 0
+	for line := 1; ; line++ {
+		outDone := outPos >= len(out)
+		ansDone := ansPos >= len(ans)
+		if outDone && ansDone {
+			return Result{Equal: true}
+		}
+		if outDone {
+			return differ("output ended early at line %d", line)
+		}
+		if ansDone {
+			return differ("extra output at line %d", line)
+		}
+		outLine, outNext := nextLine(out, outPos)
+		ansLine, ansNext := nextLine(ans, ansPos)
+		if !bytes.Equal(outLine, ansLine) {
+			return differ("line %d differs: expected \"%s\" got \"%s\"", line, snippet(ansLine), snippet(outLine))
+		}
+		outPos, ansPos = outNext, ansNext
+	}
+}
+
+func compareExact(out, ans []byte) Result {
+	common := len(out)
+	if len(ans) < common {
+		common = len(ans)
+	}
+	for i := 0; i < common; i++ {
+		if out[i] != ans[i] {
+			return differ("byte %d differs", i)
+		}
+	}
+	if len(out) < len(ans) {
+		return differ("output ended early at byte %d", len(out))
+	}
+	if len(out) > len(ans) {
+		return differ("extra output at byte %d", len(ans))
+	}
+	return Result{Equal: true}
+}
@@ -0,0 +1,52 @@
+//go:build cgo && linux
+
+package compare
+
+/*
+#cgo CXXFLAGS: -std=c++17 -O2
+#include <stdlib.h>
+#include "compare.h"
+*/
+import "C"
+
+import (
+	"fmt"
+	"syscall"
+	"unsafe"
+)
+
+const messageBufSize = 256
+
+func compareFiles(outputPath, answerPath string, mode Mode) (Result, error) {
+	cOutput := C.CString(outputPath)
+	defer C.free(unsafe.Pointer(cOutput))
+	cAnswer := C.CString(answerPath)
+	defer C.free(unsafe.Pointer(cAnswer))
+
+	var msg [messageBufSize]C.char
+	var errNo C.int
+	status := C.fuzoj_compare_files(cOutput, cAnswer, nativeMode(mode), &msg[0], C.size_t(len(msg)), &errNo)
+	switch status {
+	case C.FUZOJ_COMPARE_EQUAL:
+		return Result{Equal: true}, nil
+	case C.FUZOJ_COMPARE_DIFFER:
+		return Result{Message: C.GoString(&msg[0])}, nil
+	default:
+		step := C.GoString(&msg[0])
+		if step == "open output" && syscall.Errno(errNo) == syscall.ENOENT {
+			return Result{}, fmt.Errorf("compare open output: %w", ErrOutputNotFound)
+		}
+		return Result{}, fmt.Errorf("compare %s: %w", step, syscall.Errno(errNo))
+	}
+}
+
+func nativeMode(mode Mode) C.int {
+	switch mode {
+	case ModeLine:
+		return C.FUZOJ_COMPARE_LINE
+	case ModeExact:
+		return C.FUZOJ_COMPARE_EXACT
+	default:
+		return C.FUZOJ_COMPARE_TOKEN
+	}
+}
@@ -0,0 +1,114 @@
+package sandbox
+
+import (
+	"context"
+	"crypto/sha256"
+	"encoding/hex"
+	"io"
+	"os"
+	"strconv"
+
+	appErr "fuzoj/pkg/errors"
+	"fuzoj/services/judge_service/internal/sandbox/profile"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+const compileCacheKeyVersion = "v1"
+
+// CompileCache stores successfully compiled binaries by content key.
+type CompileCache interface {
+	// Lookup materializes the binary for key at dst and reports whether it existed.
+	Lookup(ctx context.Context, key, dst string) (bool, error)
+	// Store records the binary at src under key.
+	Store(ctx context.Context, key, src string) error
+}
+
+// SetCompileCache enables reuse of compiled binaries across submissions.
+func (w *Worker) SetCompileCache(cache CompileCache) {
+	w.compileCache = cache
+}
+
+// compileCacheKey hashes everything that can change the produced binary: the
+// source bytes, the language spec, the extra flags and the compile rootfs.
+// It returns "" when caching is disabled or the key cannot be computed.
+func (w *Worker) compileCacheKey(ctx context.Context, req JudgeRequest, lang profile.LanguageSpec, compileProfile profile.TaskProfile) string {
+	if w.compileCache == nil || lang.BinaryFile == "" {
+		return ""
+	}
+	sourceHash, err := hashFile(req.SourcePath)
+	if err != nil {
+		logx.WithContext(ctx).Errorf("hash source for compile cache failed submission_id=%s err=%v", req.SubmissionID, err)
+		return ""
+	}
+	h := sha256.New()
+	write := func(value string) {
+		_, _ = io.WriteString(h, value)
+		_, _ = h.Write([]byte{0})
+	}
+	write(compileCacheKeyVersion)
+	write(sourceHash)
+	write(lang.ID)
+	write(lang.Version)
+	write(lang.SourceFile)
+	write(lang.BinaryFile)
+	write(lang.CompileCmdTpl)
+	write(strconv.Itoa(len(lang.Env)))
+	for _, env := range lang.Env {
+		write(env)
+	}
+	write(strconv.Itoa(len(req.ExtraCompileFlags)))
+	for _, flag := range req.ExtraCompileFlags {
+		write(flag)
+	}
+	write(rootfsDigest(compileProfile.RootFS))
+	return hex.EncodeToString(h.Sum(nil))
+}
+
+func (w *Worker) lookupCompiled(ctx context.Context, key, dst string) bool {
+	if key == "" {
+		return false
+	}
+	hit, err := w.compileCache.Lookup(ctx, key, dst)
+	if err != nil {
+		logx.WithContext(ctx).Errorf("compile cache lookup failed key=%s err=%v", key, err)
+		_ = os.Remove(dst)
+		return false
+	}
+	return hit
+}
+
+func (w *Worker) storeCompiled(ctx context.Context, key, src string) {
+	if key == "" {
+		return
+	}
+	if err := w.compileCache.Store(ctx, key, src); err != nil {
+		logx.WithContext(ctx).Errorf("compile cache store failed key=%s err=%v", key, err)
+	}
+}
+
+// rootfsDigest identifies the compile toolchain image. Rootfs images are
+// replaced by swapping directories, which changes the root's mtime.
+func rootfsDigest(root string) string {
+	if root == "" {
+		return "host"
+	}
+	info, err := os.Stat(root)
+	if err != nil {
+		return root
+	}
+	return root + "@" + strconv.FormatInt(info.ModTime().UnixNano(), 10)
+}
+
+func hashFile(path string) (string, error) {
+	file, err := os.Open(path)
+	if err != nil {
+		return "", appErr.Wrapf(err, appErr.JudgeSystemError, "open source file failed")
+	}
+	defer file.Close()
+	h := sha256.New()
+	if _, err := io.Copy(h, file); err != nil {
+		return "", appErr.Wrapf(err, appErr.JudgeSystemError, "read source file failed")
+	}
+	return hex.EncodeToString(h.Sum(nil)), nil
+}
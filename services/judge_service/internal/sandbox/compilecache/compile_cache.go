@@ -0,0 +1,225 @@
+// Package compilecache provides a content-addressed local cache of compiled binaries.
+package compilecache
+
+import (
+	"container/list"
+	"context"
+	"errors"
+	"fmt"
+	"io"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+
+	appErr "fuzoj/pkg/errors"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+const tempFilePrefix = ".tmp-"
+
+type entry struct {
+	key       string
+	sizeBytes int64
+}
+
+// Cache keeps compiled artifacts under rootDir, one file per key, and evicts
+// the least recently used ones once the total size exceeds maxBytes.
+// Artifacts are handed out as hard links when possible, so a hit costs one
+// link(2) and eviction never disturbs a submission already using the file.
+type Cache struct {
+	rootDir  string
+	maxBytes int64
+
+	mu        sync.Mutex
+	entries   map[string]*list.Element
+	lru       *list.List
+	totalSize int64
+}
+
+// New creates a cache rooted at rootDir and indexes artifacts left by a
+// previous process, oldest first.
+func New(rootDir string, maxBytes int64) (*Cache, error) {
+	if rootDir == "" {
+		return nil, appErr.ValidationError("compile_cache_root", "required")
+	}
+	if err := os.MkdirAll(rootDir, 0755); err != nil {
+		return nil, appErr.Wrapf(err, appErr.CacheError, "create compile cache dir failed")
+	}
+	c := &Cache{
+		rootDir:  rootDir,
+		maxBytes: maxBytes,
+		entries:  make(map[string]*list.Element),
+		lru:      list.New(),
+	}
+	if err := c.loadExisting(); err != nil {
+		return nil, err
+	}
+	return c, nil
+}
+
+// Lookup materializes the artifact for key at dst. It returns false on a miss.
+func (c *Cache) Lookup(ctx context.Context, key, dst string) (bool, error) {
+	if key == "" {
+		return false, nil
+	}
+	c.mu.Lock()
+	elem, ok := c.entries[key]
+	if ok {
+		c.lru.MoveToFront(elem)
+	}
+	c.mu.Unlock()
+	if !ok {
+		return false, nil
+	}
+
+	src := c.path(key)
+	if err := linkOrCopy(src, dst); err != nil {
+		if errors.Is(err, fs.ErrNotExist) {
+			// Removed behind our back; forget it and treat as a miss.
+			c.mu.Lock()
+			c.removeLocked(key)
+			c.mu.Unlock()
+			return false, nil
+		}
+		return false, appErr.Wrapf(err, appErr.CacheError, "materialize cached binary failed")
+	}
+	logx.WithContext(ctx).Infof("compile cache hit key=%s dst=%s", key, dst)
+	return true, nil
+}
+
+// Store adds the artifact at src under key. Storing an existing key is a no-op.
+func (c *Cache) Store(ctx context.Context, key, src string) error {
+	if key == "" {
+		return nil
+	}
+	c.mu.Lock()
+	_, exists := c.entries[key]
+	c.mu.Unlock()
+	if exists {
+		return nil
+	}
+
+	tmp, err := os.CreateTemp(c.rootDir, tempFilePrefix)
+	if err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "create compile cache temp file failed")
+	}
+	tmpPath := tmp.Name()
+	_ = tmp.Close()
+	_ = os.Remove(tmpPath)
+	if err := linkOrCopy(src, tmpPath); err != nil {
+		_ = os.Remove(tmpPath)
+		return appErr.Wrapf(err, appErr.CacheError, "write compile cache entry failed")
+	}
+	info, err := os.Stat(tmpPath)
+	if err != nil {
+		_ = os.Remove(tmpPath)
+		return appErr.Wrapf(err, appErr.CacheError, "stat compile cache entry failed")
+	}
+	if err := os.Rename(tmpPath, c.path(key)); err != nil {
+		_ = os.Remove(tmpPath)
+		return appErr.Wrapf(err, appErr.CacheError, "commit compile cache entry failed")
+	}
+
+	c.mu.Lock()
+	c.addLocked(key, info.Size())
+	c.evictLocked()
+	c.mu.Unlock()
+	logx.WithContext(ctx).Infof("compile cache store key=%s size=%d", key, info.Size())
+	return nil
+}
+
+func (c *Cache) path(key string) string {
+	return filepath.Join(c.rootDir, key)
+}
+
+func (c *Cache) loadExisting() error {
+	dirEntries, err := os.ReadDir(c.rootDir)
+	if err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "read compile cache dir failed")
+	}
+	type diskEntry struct {
+		key     string
+		size    int64
+		modTime int64
+	}
+	found := make([]diskEntry, 0, len(dirEntries))
+	for _, d := range dirEntries {
+		if d.IsDir() {
+			continue
+		}
+		if strings.HasPrefix(d.Name(), tempFilePrefix) {
+			_ = os.Remove(c.path(d.Name()))
+			continue
+		}
+		info, err := d.Info()
+		if err != nil {
+			continue
+		}
+		found = append(found, diskEntry{key: d.Name(), size: info.Size(), modTime: info.ModTime().UnixNano()})
+	}
+	sort.Slice(found, func(i, j int) bool { return found[i].modTime < found[j].modTime })
+	c.mu.Lock()
+	for _, e := range found {
+		c.addLocked(e.key, e.size)
+	}
+	c.evictLocked()
+	c.mu.Unlock()
+	return nil
+}
+
+func (c *Cache) addLocked(key string, size int64) {
+	if elem, ok := c.entries[key]; ok {
+		c.totalSize -= elem.Value.(*entry).sizeBytes
+		elem.Value.(*entry).sizeBytes = size
+		c.totalSize += size
+		c.lru.MoveToFront(elem)
+		return
+	}
+	c.entries[key] = c.lru.PushFront(&entry{key: key, sizeBytes: size})
+	c.totalSize += size
+}
+
+func (c *Cache) evictLocked() {
+	for c.maxBytes > 0 && c.totalSize > c.maxBytes && c.lru.Len() > 0 {
+		oldest := c.lru.Back()
+		c.removeLocked(oldest.Value.(*entry).key)
+	}
+}
+
+func (c *Cache) removeLocked(key string) {
+	elem, ok := c.entries[key]
+	if !ok {
+		return
+	}
+	c.lru.Remove(elem)
+	delete(c.entries, key)
+	c.totalSize -= elem.Value.(*entry).sizeBytes
+	_ = os.Remove(c.path(key))
+}
+
+// linkOrCopy hard-links src to dst and falls back to a copy across filesystems.
+func linkOrCopy(src, dst string) error {
+	if err := os.Link(src, dst); err == nil {
+		return nil
+	} else if errors.Is(err, fs.ErrNotExist) {
+		return err
+	}
+	in, err := os.Open(src)
+	if err != nil {
+		return err
+	}
+	defer in.Close()
+	out, err := os.OpenFile(dst, os.O_CREATE|os.O_TRUNC|os.O_WRONLY, 0755)
+	if err != nil {
+		return err
+	}
+	if _, err := io.Copy(out, in); err != nil {
+		_ = out.Close()
+		return fmt.Errorf("copy %s: %w", src, err)
+	}
+	return out.Close()
+}
@@ -8,7 +8,6 @@ import (
 	"path/filepath"
 	"strconv"
 	"strings"
-	"syscall"
 	"time"
 
 	appErr "fuzoj/pkg/errors"
@@ -17,18 +16,22 @@ import (
 	"github.com/zeromicro/go-zero/core/logx"
 )
 
-func createRunCgroup(root, submissionID, testID string) (string, func(), error) {
+func createRunCgroup(root, submissionID, testID string, withCPUSet bool) (string, func(), error) {
 	if root == "" {
 		return "", func() {}, appErr.ValidationError("cgroup_root", "required")
 	}
-	if err := enableSubtreeControllers(root, []string{"cpu", "memory", "pids"}); err != nil {
+	controllers := []string{"cpu", "memory", "pids"}
+	if withCPUSet {
+		controllers = append(controllers, "cpuset")
+	}
+	if err := enableSubtreeControllers(root, controllers); err != nil {
 		return "", func() {}, appErr.Wrapf(err, appErr.JudgeSystemError, "enable root cgroup controllers failed")
 	}
 	submissionPath := filepath.Join(root, submissionID)
 	if err := os.MkdirAll(submissionPath, 0750); err != nil {
 		return "", func() {}, appErr.Wrapf(err, appErr.JudgeSystemError, "create submission cgroup path failed")
 	}
-	if err := enableSubtreeControllers(submissionPath, []string{"cpu", "memory", "pids"}); err != nil {
+	if err := enableSubtreeControllers(submissionPath, controllers); err != nil {
 		return "", func() {}, appErr.Wrapf(err, appErr.JudgeSystemError, "enable submission cgroup controllers failed")
 	}
 	runDir := fmt.Sprintf("%s-%d", testID, time.Now().UnixNano())
@@ -42,6 +45,10 @@ func createRunCgroup(root, submissionID, testID string) (string, func(), error)
 	return cgroupPath, cleanup, nil
 }
 
+// cgroupCPUMax is the cpu.max written for every run: CPU time is bounded by
+// the deadline timer, not by throttling.
+const cgroupCPUMax = "max 100000"
+
 func applyCgroupLimits(cgroupPath string, limits spec.ResourceLimit) error {
 	pidsValue := "max"
 	if limits.PIDs > 0 {
@@ -51,19 +58,33 @@ func applyCgroupLimits(cgroupPath string, limits spec.ResourceLimit) error {
 		logx.Errorf("write pids.max failed: cgroupPath=%s value=%s err=%v", cgroupPath, pidsValue, err)
 		return appErr.Wrapf(err, appErr.JudgeSystemError, "write pids.max failed")
 	}
+	// "max" is written explicitly so a reused pool leaf drops the previous run's limit.
+	memoryValue := "max"
 	if limits.MemoryMB > 0 {
-		if err := writeCgroupValue(cgroupPath, "memory.max", strconv.FormatInt(limits.MemoryMB*1024*1024, 10)); err != nil {
-			logx.Errorf("write memory.max failed: cgroupPath=%s valueMB=%d err=%v", cgroupPath, limits.MemoryMB, err)
-			return appErr.Wrapf(err, appErr.JudgeSystemError, "write memory.max failed")
-		}
+		memoryValue = strconv.FormatInt(limits.MemoryMB*1024*1024, 10)
+	}
+	if err := writeCgroupValue(cgroupPath, "memory.max", memoryValue); err != nil {
+		logx.Errorf("write memory.max failed: cgroupPath=%s value=%s err=%v", cgroupPath, memoryValue, err)
+		return appErr.Wrapf(err, appErr.JudgeSystemError, "write memory.max failed")
 	}
-	if err := writeCgroupValue(cgroupPath, "cpu.max", "max 100000"); err != nil {
+	if err := writeCgroupValue(cgroupPath, "cpu.max", cgroupCPUMax); err != nil {
 		logx.Errorf("write cpu.max failed: cgroupPath=%s err=%v", cgroupPath, err)
 		return appErr.Wrapf(err, appErr.JudgeSystemError, "write cpu.max failed")
 	}
 	return nil
 }
 
+func applyCgroupCPUSet(cgroupPath, cpus string) error {
+	if cpus == "" {
+		return nil
+	}
+	if err := writeCgroupValue(cgroupPath, "cpuset.cpus", cpus); err != nil {
+		logx.Errorf("write cpuset.cpus failed: cgroupPath=%s value=%s err=%v", cgroupPath, cpus, err)
+		return appErr.Wrapf(err, appErr.JudgeSystemError, "write cpuset.cpus failed")
+	}
+	return nil
+}
+
 func addProcessToCgroup(cgroupPath string, pid int) error {
 	if pid <= 0 {
 		return appErr.ValidationError("pid", "invalid")
@@ -83,12 +104,16 @@ func killCgroup(cgroupPath string) error {
 }
 
 func wasOomKilled(cgroupPath string) bool {
+	return cgroupOomKillCount(cgroupPath) > 0
+}
+
+func cgroupOomKillCount(cgroupPath string) int64 {
 	if cgroupPath == "" {
-		return false
+		return 0
 	}
 	data, err := os.ReadFile(filepath.Join(cgroupPath, "memory.events"))
 	if err != nil {
-		return false
+		return 0
 	}
 	lines := strings.Split(string(data), "\n")
 	for _, line := range lines {
@@ -98,10 +123,10 @@ func wasOomKilled(cgroupPath string) bool {
 		}
 		if fields[0] == "oom_kill" {
 			val, _ := strconv.ParseInt(fields[1], 10, 64)
-			return val > 0
+			return val
 		}
 	}
-	return false
+	return 0
 }
 
 func cgroupCPUTimeMs(cgroupPath string) (int64, error) {
@@ -129,7 +154,7 @@ func cgroupCPUTimeMs(cgroupPath string) (int64, error) {
 	return 0, appErr.New(appErr.JudgeSystemError).WithMessage("usage_usec not found in cpu.stat")
 }
 
-func memoryPeakKB(cgroupPath string, state *os.ProcessState, sampledPeakBytes int64) int64 {
+func memoryPeakKB(cgroupPath string, maxRSSKB int64, sampledPeakBytes int64) int64 {
 	sampledPeakKB := int64(0)
 	if sampledPeakBytes > 0 {
 		sampledPeakKB = sampledPeakBytes / 1024
@@ -142,13 +167,7 @@ func memoryPeakKB(cgroupPath string, state *os.ProcessState, sampledPeakBytes in
 			return maxInt64(current/1024, sampledPeakKB)
 		}
 	}
-	if state == nil {
-		return sampledPeakKB
-	}
-	if usage, ok := state.SysUsage().(*syscall.Rusage); ok {
-		return maxInt64(usage.Maxrss, sampledPeakKB)
-	}
-	return sampledPeakKB
+	return maxInt64(maxRSSKB, sampledPeakKB)
 }
 
 func cgroupMemoryCurrentBytes(cgroupPath string) (int64, error) {
@@ -0,0 +1,250 @@
+//go:build linux
+
+package engine
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"strconv"
+	"strings"
+	"sync"
+
+	appErr "fuzoj/pkg/errors"
+	"fuzoj/services/judge_service/internal/sandbox/spec"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+const cgroupPoolDirName = "pool"
+
+// leafDrainSlackBytes is how much memory a reused leaf may still have charged
+// when a run starts; more would raise the run's memory.peak baseline.
+const leafDrainSlackBytes = 1 << 20
+
+// runCgroup is the cgroup one run executes in. A reused pool leaf carries the
+// counter values at acquire time so readers report this run's deltas, and an
+// fd on memory.peak whose peak was reset for this run.
+type runCgroup struct {
+	path       string
+	cpuBaseMs  int64
+	oomBase    int64
+	peakFile   *os.File
+	cpuSetUsed bool
+}
+
+func (c *runCgroup) cpuTimeMs() (int64, error) {
+	usageMs, err := cgroupCPUTimeMs(c.path)
+	if err != nil {
+		return 0, err
+	}
+	return usageMs - c.cpuBaseMs, nil
+}
+
+func (c *runCgroup) oomKills() int64 {
+	return cgroupOomKillCount(c.path) - c.oomBase
+}
+
+func (c *runCgroup) memoryPeakKB(maxRSSKB, sampledPeakBytes int64) int64 {
+	if c.peakFile != nil {
+		if val, err := readCgroupFileInt(c.peakFile); err == nil && val > 0 {
+			return maxInt64(val/1024, sampledPeakBytes/1024)
+		}
+	}
+	return memoryPeakKB(c.path, maxRSSKB, sampledPeakBytes)
+}
+
+// cgroupPool keeps leaf cgroups under <CgroupRoot>/pool for reuse. Controllers
+// are enabled once when the pool is created; a run then costs a few limit
+// writes and counter reads instead of mkdir, subtree_control writes and rmdir.
+type cgroupPool struct {
+	root    string
+	maxIdle int
+
+	mu   sync.Mutex
+	idle []*runCgroup
+	next int
+}
+
+// newCgroupPool prepares the pool directory and checks that memory.peak can be
+// reset per run (Linux 6.12+), without which a reused leaf would report the
+// highest peak of any earlier run.
+func newCgroupPool(cgroupRoot string, maxIdle int) (*cgroupPool, error) {
+	if cgroupRoot == "" {
+		return nil, appErr.ValidationError("cgroup_root", "required")
+	}
+	controllers := []string{"cpu", "memory", "pids", "cpuset"}
+	if err := enableSubtreeControllers(cgroupRoot, controllers); err != nil {
+		return nil, err
+	}
+	root := filepath.Join(cgroupRoot, cgroupPoolDirName)
+	if err := os.MkdirAll(root, 0750); err != nil {
+		return nil, appErr.Wrapf(err, appErr.JudgeSystemError, "create cgroup pool dir failed")
+	}
+	if err := enableSubtreeControllers(root, controllers); err != nil {
+		return nil, err
+	}
+	p := &cgroupPool{root: root, maxIdle: maxIdle}
+
+	probe, err := p.newLeaf()
+	if err != nil {
+		return nil, err
+	}
+	if err := probe.resetPeak(); err != nil {
+		_ = os.RemoveAll(probe.path)
+		return nil, appErr.Wrapf(err, appErr.JudgeSystemError, "memory.peak reset unsupported")
+	}
+	probe.closePeak()
+	p.idle = append(p.idle, probe)
+	return p, nil
+}
+
+// acquire returns a leaf with limits and cpuset applied and counters baselined.
+// An idle leaf that still holds memory after reclaim is replaced by a new one.
+func (p *cgroupPool) acquire(limits spec.ResourceLimit, cpuSet string) (*runCgroup, error) {
+	p.mu.Lock()
+	var leaf *runCgroup
+	if n := len(p.idle); n > 0 {
+		leaf = p.idle[n-1]
+		p.idle = p.idle[:n-1]
+	}
+	p.mu.Unlock()
+	if leaf != nil && !leaf.drain() {
+		p.discard(leaf)
+		leaf = nil
+	}
+	if leaf == nil {
+		var err error
+		if leaf, err = p.newLeaf(); err != nil {
+			return nil, err
+		}
+	}
+
+	if err := applyCgroupLimits(leaf.path, limits); err != nil {
+		p.discard(leaf)
+		return nil, err
+	}
+	if cpuSet != "" || leaf.cpuSetUsed {
+		// An empty cpuset.cpus makes the leaf inherit its parent's CPUs again.
+		if err := writeCgroupValue(leaf.path, "cpuset.cpus", cpuSet); err != nil {
+			p.discard(leaf)
+			return nil, err
+		}
+		leaf.cpuSetUsed = cpuSet != ""
+	}
+	leaf.cpuBaseMs, _ = cgroupCPUTimeMs(leaf.path)
+	leaf.oomBase = cgroupOomKillCount(leaf.path)
+	if err := leaf.resetPeak(); err != nil {
+		p.discard(leaf)
+		return nil, appErr.Wrapf(err, appErr.JudgeSystemError, "reset memory.peak failed")
+	}
+	return leaf, nil
+}
+
+// release returns the leaf to the pool, or removes it when processes are still
+// inside (e.g. a kill that has not finished) or the pool is full.
+func (p *cgroupPool) release(leaf *runCgroup) {
+	leaf.closePeak()
+	if cgroupPopulated(leaf.path) {
+		_ = killCgroup(leaf.path)
+		p.discard(leaf)
+		return
+	}
+	p.mu.Lock()
+	if len(p.idle) < p.maxIdle {
+		p.idle = append(p.idle, leaf)
+		leaf = nil
+	}
+	p.mu.Unlock()
+	if leaf != nil {
+		p.discard(leaf)
+	}
+}
+
+func (p *cgroupPool) discard(leaf *runCgroup) {
+	leaf.closePeak()
+	if err := os.RemoveAll(leaf.path); err != nil {
+		logx.Errorf("remove pooled cgroup failed: cgroupPath=%s err=%v", leaf.path, err)
+	}
+}
+
+func (p *cgroupPool) newLeaf() (*runCgroup, error) {
+	p.mu.Lock()
+	p.next++
+	name := fmt.Sprintf("slot-%d", p.next)
+	p.mu.Unlock()
+	path := filepath.Join(p.root, name)
+	if err := os.MkdirAll(path, 0750); err != nil {
+		return nil, appErr.Wrapf(err, appErr.JudgeSystemError, "create pooled cgroup failed")
+	}
+	return &runCgroup{path: path}, nil
+}
+
+// drain reclaims what earlier runs left charged to the leaf, mostly page cache
+// of files they wrote, and reports whether it is now close to empty. A leaf
+// without memory.current counts as drained.
+func (c *runCgroup) drain() bool {
+	current, err := cgroupMemoryCurrentBytes(c.path)
+	if err != nil || current <= leafDrainSlackBytes {
+		return true
+	}
+	// memory.reclaim fails with EAGAIN when it falls short; memory.current
+	// decides either way.
+	if f, err := os.OpenFile(filepath.Join(c.path, "memory.reclaim"), os.O_WRONLY, 0); err == nil {
+		_, _ = f.Write([]byte(strconv.FormatInt(current, 10)))
+		_ = f.Close()
+	}
+	current, err = cgroupMemoryCurrentBytes(c.path)
+	return err == nil && current <= leafDrainSlackBytes
+}
+
+// resetPeak opens memory.peak and resets it; later reads on the same fd report
+// the peak since the reset. A missing memory.peak is not an error.
+func (c *runCgroup) resetPeak() error {
+	c.closePeak()
+	f, err := os.OpenFile(filepath.Join(c.path, "memory.peak"), os.O_RDWR, 0)
+	if err != nil {
+		if os.IsNotExist(err) {
+			return nil
+		}
+		return err
+	}
+	if _, err := f.Write([]byte("reset")); err != nil {
+		_ = f.Close()
+		return err
+	}
+	c.peakFile = f
+	return nil
+}
+
+func (c *runCgroup) closePeak() {
+	if c.peakFile != nil {
+		_ = c.peakFile.Close()
+		c.peakFile = nil
+	}
+}
+
+func readCgroupFileInt(f *os.File) (int64, error) {
+	buf := make([]byte, 32)
+	n, err := f.ReadAt(buf, 0)
+	if n == 0 && err != nil {
+		return 0, err
+	}
+	return strconv.ParseInt(strings.TrimSpace(string(buf[:n])), 10, 64)
+}
+
+// cgroupPopulated reports whether cgroup.events says processes remain. A
+// missing file counts as empty.
+func cgroupPopulated(cgroupPath string) bool {
+	data, err := os.ReadFile(filepath.Join(cgroupPath, "cgroup.events"))
+	if err != nil {
+		return false
+	}
+	for _, line := range strings.Split(string(data), "\n") {
+		fields := strings.Fields(line)
+		if len(fields) == 2 && fields[0] == "populated" {
+			return fields[1] != "0"
+		}
+	}
+	return false
+}
@@ -0,0 +1,102 @@
+//go:build linux
+
+package engine
+
+import (
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	"fuzoj/services/judge_service/internal/sandbox/spec"
+)
+
+func readCgroupTestFile(t *testing.T, dir, name string) string {
+	t.Helper()
+	data, err := os.ReadFile(filepath.Join(dir, name))
+	if err != nil {
+		t.Fatalf("read %s: %v", name, err)
+	}
+	return strings.TrimSpace(string(data))
+}
+
+func writeCgroupTestFile(t *testing.T, dir, name, value string) {
+	t.Helper()
+	if err := os.WriteFile(filepath.Join(dir, name), []byte(value), 0644); err != nil {
+		t.Fatalf("write %s: %v", name, err)
+	}
+}
+
+// TestCgroupPoolReusedLeafDropsMemoryLimit runs on a plain directory standing
+// in for the cgroup tree: a run without a memory limit must not inherit the
+// previous run's memory.max.
+func TestCgroupPoolReusedLeafDropsMemoryLimit(t *testing.T) {
+	pool, err := newCgroupPool(t.TempDir(), 4)
+	if err != nil {
+		t.Fatalf("create pool: %v", err)
+	}
+	first, err := pool.acquire(spec.ResourceLimit{MemoryMB: 64}, "")
+	if err != nil {
+		t.Fatalf("acquire: %v", err)
+	}
+	if got := readCgroupTestFile(t, first.path, "memory.max"); got != "67108864" {
+		t.Fatalf("expected 64MiB memory.max, got %q", got)
+	}
+	pool.release(first)
+
+	second, err := pool.acquire(spec.ResourceLimit{}, "")
+	if err != nil {
+		t.Fatalf("acquire: %v", err)
+	}
+	defer pool.release(second)
+	if second.path != first.path {
+		t.Fatalf("expected the idle leaf to be reused, got %s after %s", second.path, first.path)
+	}
+	if got := readCgroupTestFile(t, second.path, "memory.max"); got != "max" {
+		t.Fatalf("expected memory.max reset to max, got %q", got)
+	}
+}
+
+// TestCgroupPoolDrainsLeafBeforeReuse checks that memory left charged to an
+// idle leaf is reclaimed, and that a leaf reclaim cannot empty is replaced.
+func TestCgroupPoolDrainsLeafBeforeReuse(t *testing.T) {
+	pool, err := newCgroupPool(t.TempDir(), 4)
+	if err != nil {
+		t.Fatalf("create pool: %v", err)
+	}
+
+	// A little residue stays within the slack and the leaf is reused untouched.
+	leaf, err := pool.acquire(spec.ResourceLimit{MemoryMB: 64}, "")
+	if err != nil {
+		t.Fatalf("acquire: %v", err)
+	}
+	writeCgroupTestFile(t, leaf.path, "memory.current", "4096")
+	writeCgroupTestFile(t, leaf.path, "memory.reclaim", "")
+	pool.release(leaf)
+	reused, err := pool.acquire(spec.ResourceLimit{MemoryMB: 64}, "")
+	if err != nil {
+		t.Fatalf("acquire: %v", err)
+	}
+	if reused.path != leaf.path {
+		t.Fatalf("expected a drained leaf to be reused")
+	}
+	if got := readCgroupTestFile(t, reused.path, "memory.reclaim"); got != "" {
+		t.Fatalf("expected no reclaim below the slack, got %q", got)
+	}
+
+	// 64MiB of page cache that a plain file never gives back: the pool asks
+	// for all of it and then swaps in a fresh leaf.
+	writeCgroupTestFile(t, reused.path, "memory.current", "67108864")
+	pool.release(reused)
+	fresh, err := pool.acquire(spec.ResourceLimit{MemoryMB: 64}, "")
+	if err != nil {
+		t.Fatalf("acquire: %v", err)
+	}
+	defer pool.release(fresh)
+	if fresh.path == reused.path {
+		t.Fatalf("expected a leaf still holding memory to be replaced")
+	}
+	if _, err := os.Stat(reused.path); !os.IsNotExist(err) {
+		t.Fatalf("expected the charged leaf to be removed, got err=%v", err)
+	}
+}
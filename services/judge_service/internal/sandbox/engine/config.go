@@ -8,6 +8,9 @@ type ProfileResolver interface {
 }
 
 // Config controls sandbox engine behavior.
+// CgroupPoolSize > 0 reuses up to that many idle leaf cgroups under
+// <CgroupRoot>/pool instead of creating and removing one per run; it needs
+// memory.peak reset support (Linux 6.12+) and is skipped otherwise.
 type Config struct {
 	CgroupRoot           string
 	SeccompDir           string
@@ -16,4 +19,5 @@ type Config struct {
 	EnableSeccomp        bool
 	EnableCgroup         bool
 	EnableNamespaces     bool
+	CgroupPoolSize       int
 }
@@ -12,7 +12,6 @@ import (
 	"os/exec"
 	"path/filepath"
 	"sync"
-	"sync/atomic"
 	"syscall"
 	"time"
 
@@ -32,6 +31,9 @@ const (
 type linuxEngine struct {
 	cfg       Config
 	resolver  ProfileResolver
+	seccomp   *seccompCache
+	watcher   *cgroupWatcher
+	cgroups   *cgroupPool
 	registry  map[string][]string
 	registryM sync.Mutex
 }
@@ -47,11 +49,33 @@ func NewEngine(cfg Config, resolver ProfileResolver) (Engine, error) {
 	if cfg.HelperPath == "" {
 		cfg.HelperPath = "sandbox-init"
 	}
-	return &linuxEngine{
+	eng := &linuxEngine{
 		cfg:      cfg,
 		resolver: resolver,
 		registry: make(map[string][]string),
-	}, nil
+	}
+	if cfg.EnableSeccomp {
+		eng.seccomp = newSeccompCache(cfg.HelperPath)
+		eng.seccomp.warm(cfg.SeccompDir)
+	}
+	if cfg.EnableCgroup && cfg.CgroupPoolSize > 0 {
+		pool, err := newCgroupPool(cfg.CgroupRoot, cfg.CgroupPoolSize)
+		if err != nil {
+			logx.Errorf("init cgroup pool failed, falling back to per-run cgroups: %v", err)
+		} else {
+			eng.cgroups = pool
+		}
+	}
+	if cfg.EnableCgroup {
+		watcher, err := newCgroupWatcher()
+		if err != nil {
+			// Without it OOM kills are still reported, just not acted on early.
+			logx.Errorf("init cgroup watcher failed: %v", err)
+		} else {
+			eng.watcher = watcher
+		}
+	}
+	return eng, nil
 }
 
 func (e *linuxEngine) Run(ctx context.Context, runSpec spec.RunSpec) (result.RunResult, error) {
@@ -74,25 +98,21 @@ func (e *linuxEngine) Run(ctx context.Context, runSpec spec.RunSpec) (result.Run
 		isoProfile.SeccompProfile = filepath.Join(e.cfg.SeccompDir, isoProfile.SeccompProfile)
 	}
 
+	var cg *runCgroup
 	cgroupPath := ""
-	cgroupCleanup := func() {}
 	if e.cfg.EnableCgroup {
-		cgroupPath, cgroupCleanup, err = createRunCgroup(e.cfg.CgroupRoot, runSpec.SubmissionID, runSpec.TestID)
+		var release func()
+		cg, release, err = e.acquireCgroup(runSpec)
 		if err != nil {
 			return result.RunResult{}, err
 		}
-		if err := applyCgroupLimits(cgroupPath, runSpec.Limits); err != nil {
-			cgroupCleanup()
-			return result.RunResult{}, err
-		}
+		cgroupPath = cg.path
 		e.registerCgroup(runSpec.SubmissionID, cgroupPath)
-	}
-	defer func() {
-		if e.cfg.EnableCgroup {
+		defer func() {
 			e.unregisterCgroup(runSpec.SubmissionID, cgroupPath)
-			cgroupCleanup()
-		}
-	}()
+			release()
+		}()
+	}
 
 	initReq := initRequest{
 		RunSpec:       runSpec,
@@ -101,141 +121,109 @@ func (e *linuxEngine) Run(ctx context.Context, runSpec spec.RunSpec) (result.Run
 		EnableNs:      e.cfg.EnableNamespaces,
 	}
 
-	stdinPipe, err := jsonToPipe(initReq)
-	if err != nil {
-		return result.RunResult{}, appErr.Wrapf(err, appErr.JudgeSystemError, "encode init request failed")
+	var extraFiles []*os.File
+	var stdoutFile *os.File
+	var capture *stdoutCapture
+	if runSpec.StdoutMemfd {
+		capture, err = newStdoutCapture(runSpec.TestID, runSpec.Limits.OutputMB*1024*1024)
+		if err != nil {
+			return result.RunResult{}, appErr.Wrapf(err, appErr.JudgeSystemError, "create stdout memfd failed")
+		}
+		stdoutFile = capture.file
+		// Closed here unless handed to the caller in the result.
+		defer func() {
+			if stdoutFile != nil {
+				_ = stdoutFile.Close()
+			}
+		}()
+		initReq.StdoutFD = helperFirstExtraFD + len(extraFiles)
+		extraFiles = append(extraFiles, capture.writer)
 	}
-	defer stdinPipe.Close()
-
-	cmd := exec.CommandContext(ctx, e.cfg.HelperPath)
-	cmd.SysProcAttr = buildSysProcAttr(isoProfile, e.cfg.EnableNamespaces)
-	cmd.Stdin = stdinPipe
-
-	var helperStdout bytes.Buffer
-	var helperStderr bytes.Buffer
-	cmd.Stdout = &helperStdout
-	cmd.Stderr = &helperStderr
-
-	start := time.Now()
-	if err := cmd.Start(); err != nil {
-		return result.RunResult{}, appErr.Wrapf(err, appErr.JudgeSystemError, "start helper failed")
+	if e.seccomp != nil && isoProfile.SeccompProfile != "" {
+		program, release, err := e.seccomp.acquire(ctx, isoProfile.SeccompProfile)
+		if err != nil {
+			// The helper still compiles the profile itself when no program is passed.
+			logger.Errorf("load precompiled seccomp program failed: %v", err)
+		} else {
+			defer release()
+			initReq.SeccompFD = helperFirstExtraFD + len(extraFiles)
+			extraFiles = append(extraFiles, program)
+		}
 	}
 
-	if e.cfg.EnableCgroup {
-		if err := addProcessToCgroup(cgroupPath, cmd.Process.Pid); err != nil {
-			logger.Info("add process to cgroup failed", zap.String("cgroup", cgroupPath), zap.Error(err))
+	start := time.Now()
+	proc, err := e.startHelper(ctx, initReq, cgroupPath, extraFiles)
+	if err != nil {
+		if capture != nil {
+			capture.abort()
 		}
+		return result.RunResult{}, err
+	}
+	if capture != nil {
+		capture.start(proc)
 	}
 
-	var timedOut atomic.Bool
-	var cpuTimedOut atomic.Bool
-	var memoryPeakBytes atomic.Int64
-	killCtx, cancelKill := context.WithCancel(ctx)
-	defer cancelKill()
-
+	watch := &runWatch{}
+	limits := runLimits{
+		wallTimeMs: runSpec.Limits.WallTimeMs,
+		cpuTimeMs:  runSpec.Limits.CPUTimeMs,
+		cpuSlots:   cpuSlotsFor(runSpec.CPUSet, cgroupCPUMax),
+	}
 	done := make(chan struct{})
+	watchDone := make(chan struct{})
 	go func() {
-		wallLimit := durationFromMs(runSpec.Limits.WallTimeMs)
-		cpuLimitMs := runSpec.Limits.CPUTimeMs
-		var wallTimer <-chan time.Time
-		if wallLimit > 0 {
-			wallTimer = time.After(wallLimit)
-		}
-		var cpuTicker *time.Ticker
-		if cpuLimitMs > 0 && e.cfg.EnableCgroup && cgroupPath != "" {
-			// Poll cgroup cpu.stat to enforce CPU time limit.
-			cpuTicker = time.NewTicker(100 * time.Millisecond)
-			defer cpuTicker.Stop()
-		}
-		var memoryTicker *time.Ticker
-		if e.cfg.EnableCgroup && cgroupPath != "" {
-			// Sample memory.current for environments where memory.peak is unavailable.
-			memoryTicker = time.NewTicker(100 * time.Millisecond)
-			defer memoryTicker.Stop()
-		}
-		var cpuTick <-chan time.Time
-		if cpuTicker != nil {
-			cpuTick = cpuTicker.C
-		}
-		var memoryTick <-chan time.Time
-		if memoryTicker != nil {
-			memoryTick = memoryTicker.C
-		}
-		for {
-			select {
-			case <-killCtx.Done():
-				// Context canceled: terminate the whole process group.
-				e.killProcessGroup(cmd.Process.Pid)
-				return
-			case <-wallTimer:
-				// Wall-time exceeded.
-				timedOut.Store(true)
-				e.killProcessGroup(cmd.Process.Pid)
-				return
-			case <-done:
-				// Process finished normally.
-				return
-			case <-cpuTick:
-				usageMs, err := cgroupCPUTimeMs(cgroupPath)
-				if err == nil && usageMs >= cpuLimitMs {
-					// CPU time exceeded based on the same source used for stats.
-					cpuTimedOut.Store(true)
-					e.killProcessGroup(cmd.Process.Pid)
-					return
-				}
-			case <-memoryTick:
-				currentBytes, err := cgroupMemoryCurrentBytes(cgroupPath)
-				if err != nil || currentBytes <= 0 {
-					continue
-				}
-				for {
-					prev := memoryPeakBytes.Load()
-					if currentBytes <= prev {
-						break
-					}
-					if memoryPeakBytes.CompareAndSwap(prev, currentBytes) {
-						break
-					}
-				}
-			}
-		}
+		defer close(watchDone)
+		e.watchRun(ctx, proc, cg, limits, done, watch)
 	}()
 
-	waitErr := cmd.Wait()
+	exit, waitErr := proc.wait()
 	close(done)
+	<-watchDone
+	if capture != nil {
+		capture.wait()
+	}
 
 	if waitErr != nil {
-		if helperStderr.Len() > 0 {
-			logger.Info(ctx, "helper stderr", zap.String("stderr", helperStderr.String()))
+		if exit.Stderr != "" {
+			logger.Info(ctx, "helper stderr", zap.String("stderr", exit.Stderr))
 		}
 	}
 
 	wallTimeMs := time.Since(start).Milliseconds()
 	stdoutPath := resolveHostPath(runSpec.StdoutPath, runSpec)
 	stderrPath := resolveHostPath(runSpec.StderrPath, runSpec)
-	timeMs := cpuTimeMs(cmd.ProcessState)
+	timeMs := exit.CPUTimeMs
 	// Prefer cgroup CPU usage so stats and CPU limit use the same source.
-	if e.cfg.EnableCgroup && cgroupPath != "" {
-		if usageMs, err := cgroupCPUTimeMs(cgroupPath); err == nil && usageMs > 0 {
+	if cg != nil {
+		if usageMs, err := cg.cpuTimeMs(); err == nil && usageMs > 0 {
 			timeMs = usageMs
 		}
 	}
 
 	runResult := result.RunResult{
-		ExitCode:   exitCodeFromErr(waitErr, cmd.ProcessState),
+		ExitCode:   exit.ExitCode,
 		TimeMs:     timeMs,
 		WallTimeMs: wallTimeMs,
-		MemoryKB:   memoryPeakKB(cgroupPath, cmd.ProcessState, memoryPeakBytes.Load()),
+		MemoryKB:   memoryPeakKB("", exit.MaxRSSKB, watch.memoryPeakBytes.Load()),
 		OutputKB:   stdoutSizeKB(stdoutPath),
 		Stdout:     readLimitedFile(stdoutPath, e.cfg.StdoutStderrMaxBytes),
 		Stderr:     readLimitedFile(stderrPath, e.cfg.StdoutStderrMaxBytes),
-		OomKilled:  wasOomKilled(cgroupPath),
+		OomKilled:  watch.oomKilled.Load(),
 	}
-	if waitErr != nil && runResult.Stderr == "" && helperStderr.Len() > 0 {
-		runResult.Stderr = helperStderr.String()
+	if cg != nil {
+		runResult.MemoryKB = cg.memoryPeakKB(exit.MaxRSSKB, watch.memoryPeakBytes.Load())
+		runResult.OomKilled = runResult.OomKilled || cg.oomKills() > 0
+	}
+	if stdoutFile != nil {
+		runResult.OutputKB = fileSizeKB(stdoutFile)
+		runResult.Stdout = readLimitedFileAt(stdoutFile, e.cfg.StdoutStderrMaxBytes)
+		runResult.StdoutFile, stdoutFile = stdoutFile, nil
+	}
+	if waitErr != nil && runResult.Stderr == "" && exit.Stderr != "" {
+		runResult.Stderr = exit.Stderr
 	}
 
-	if (timedOut.Load() || cpuTimedOut.Load()) && runResult.ExitCode == 0 {
+	if (watch.timedOut.Load() || watch.cpuTimedOut.Load()) && runResult.ExitCode == 0 {
 		runResult.ExitCode = -1
 	}
 
@@ -243,13 +231,107 @@ func (e *linuxEngine) Run(ctx context.Context, runSpec spec.RunSpec) (result.Run
 		runResult.ExitCode = -1
 	}
 
-	if waitErr != nil && helperStderr.Len() > 0 {
-		logger.Info(ctx, "sandbox helper failed", zap.String("stderr", helperStderr.String()))
+	if waitErr != nil && exit.Stderr != "" {
+		logger.Info(ctx, "sandbox helper failed", zap.String("stderr", exit.Stderr))
 	}
 
 	return runResult, nil
 }
 
+// acquireCgroup returns the cgroup for one run with its limits applied and a
+// function that releases it: back to the pool when pooling is enabled,
+// otherwise by removing the per-run directory.
+func (e *linuxEngine) acquireCgroup(runSpec spec.RunSpec) (*runCgroup, func(), error) {
+	limits := runSpec.Limits
+	if e.cgroups != nil {
+		cg, err := e.cgroups.acquire(limits, runSpec.CPUSet)
+		if err != nil {
+			return nil, nil, err
+		}
+		return cg, func() { e.cgroups.release(cg) }, nil
+	}
+	cgroupPath, cleanup, err := createRunCgroup(e.cfg.CgroupRoot, runSpec.SubmissionID, runSpec.TestID, runSpec.CPUSet != "")
+	if err != nil {
+		return nil, nil, err
+	}
+	if err := applyCgroupLimits(cgroupPath, limits); err != nil {
+		cleanup()
+		return nil, nil, err
+	}
+	if err := applyCgroupCPUSet(cgroupPath, runSpec.CPUSet); err != nil {
+		cleanup()
+		return nil, nil, err
+	}
+	return &runCgroup{path: cgroupPath}, cleanup, nil
+}
+
+// helperExit is the outcome of one sandbox-init run, however it was launched.
+type helperExit struct {
+	ExitCode  int
+	CPUTimeMs int64
+	MaxRSSKB  int64
+	Stderr    string
+}
+
+// helperProcess is a running sandbox-init child.
+type helperProcess interface {
+	kill()
+	wait() (helperExit, error)
+}
+
+// startHelper launches sandbox-init for initReq. extraFiles are inherited by the
+// helper in order from helperFirstExtraFD.
+func (e *linuxEngine) startHelper(ctx context.Context, initReq initRequest, cgroupPath string, extraFiles []*os.File) (helperProcess, error) {
+	stdinPipe, err := jsonToPipe(initReq)
+	if err != nil {
+		return nil, appErr.Wrapf(err, appErr.JudgeSystemError, "encode init request failed")
+	}
+
+	cmd := exec.CommandContext(ctx, e.cfg.HelperPath)
+	cmd.SysProcAttr = buildSysProcAttr(initReq.Isolation, e.cfg.EnableNamespaces)
+	cmd.Stdin = stdinPipe
+	cmd.ExtraFiles = extraFiles
+
+	proc := &execHelper{cmd: cmd, stdin: stdinPipe}
+	cmd.Stdout = &proc.stdout
+	cmd.Stderr = &proc.stderr
+	if err := cmd.Start(); err != nil {
+		_ = stdinPipe.Close()
+		return nil, appErr.Wrapf(err, appErr.JudgeSystemError, "start helper failed")
+	}
+
+	if cgroupPath != "" {
+		if err := addProcessToCgroup(cgroupPath, cmd.Process.Pid); err != nil {
+			logx.WithContext(ctx).Info("add process to cgroup failed", zap.String("cgroup", cgroupPath), zap.Error(err))
+		}
+	}
+	return proc, nil
+}
+
+// execHelper is a sandbox-init started with a fresh set of namespaces.
+type execHelper struct {
+	cmd    *exec.Cmd
+	stdin  io.ReadCloser
+	stdout bytes.Buffer
+	stderr bytes.Buffer
+}
+
+func (h *execHelper) kill() {
+	killProcessGroup(h.cmd.Process.Pid)
+}
+
+func (h *execHelper) wait() (helperExit, error) {
+	err := h.cmd.Wait()
+	_ = h.stdin.Close()
+	state := h.cmd.ProcessState
+	return helperExit{
+		ExitCode:  exitCodeFromErr(err, state),
+		CPUTimeMs: cpuTimeMs(state),
+		MaxRSSKB:  maxRSSKB(state),
+		Stderr:    h.stderr.String(),
+	}, err
+}
+
 func exitCodeFromErr(err error, state *os.ProcessState) int {
 	if state != nil {
 		return state.ExitCode()
@@ -269,8 +351,11 @@ func (e *linuxEngine) KillSubmission(ctx context.Context, submissionID string) e
 	if submissionID == "" {
 		return appErr.ValidationError("submission_id", "required")
 	}
-	paths := e.snapshotCgroups(submissionID)
-	for _, cgroupPath := range paths {
+	// Kill under the registry lock: once a run unregisters, its (possibly
+	// pooled and reused) cgroup can no longer be killed on its behalf.
+	e.registryM.Lock()
+	defer e.registryM.Unlock()
+	for _, cgroupPath := range e.registry[submissionID] {
 		if err := killCgroup(cgroupPath); err != nil {
 			logger.Info(ctx, "kill cgroup failed", zap.String("cgroup", cgroupPath), zap.Error(err))
 		}
@@ -304,16 +389,7 @@ func (e *linuxEngine) unregisterCgroup(submissionID, cgroupPath string) {
 	e.registry[submissionID] = updated
 }
 
-func (e *linuxEngine) snapshotCgroups(submissionID string) []string {
-	e.registryM.Lock()
-	defer e.registryM.Unlock()
-	paths := e.registry[submissionID]
-	out := make([]string, len(paths))
-	copy(out, paths)
-	return out
-}
-
-func (e *linuxEngine) killProcessGroup(pid int) {
+func killProcessGroup(pid int) {
 	if pid <= 0 {
 		return
 	}
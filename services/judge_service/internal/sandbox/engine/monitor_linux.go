@@ -0,0 +1,292 @@
+//go:build linux
+
+package engine
+
+import (
+	"context"
+	"encoding/binary"
+	"os"
+	"path/filepath"
+	"strconv"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"syscall"
+	"time"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+const (
+	// cpuDeadlineMinStep bounds how often the CPU deadline timer re-reads
+	// cpu.stat near the limit; overshoot is at most cpuSlots * this step.
+	cpuDeadlineMinStep = 10 * time.Millisecond
+	// cpuDeadlineRetryStep is used when cpu.stat cannot be read.
+	cpuDeadlineRetryStep = 100 * time.Millisecond
+	// memorySampleInterval is only used on kernels without memory.peak.
+	memorySampleInterval = 100 * time.Millisecond
+)
+
+// runWatch holds what the watchdog observed for one run.
+type runWatch struct {
+	timedOut        atomic.Bool
+	cpuTimedOut     atomic.Bool
+	oomKilled       atomic.Bool
+	memoryPeakBytes atomic.Int64
+	cpuPolls        atomic.Int64
+}
+
+// watchRun enforces wall and CPU limits for one run and returns when the run
+// is done or has been killed. Nothing is polled on a fixed tick: the wall
+// limit is one timer; the CPU limit is a deadline timer set to the earliest
+// time the remaining budget can be spent by the CPUs the cgroup grants, so a
+// single-threaded TLE run re-reads cpu.stat a few times; OOM kills arrive as
+// inotify events on memory.events. memory.current is sampled only when the
+// kernel has no memory.peak.
+func (e *linuxEngine) watchRun(ctx context.Context, proc helperProcess, cg *runCgroup, limits runLimits, done <-chan struct{}, w *runWatch) {
+	cgroupPath := ""
+	if cg != nil {
+		cgroupPath = cg.path
+	}
+	var wallTimer <-chan time.Time
+	if wall := durationFromMs(limits.wallTimeMs); wall > 0 {
+		t := time.NewTimer(wall)
+		defer t.Stop()
+		wallTimer = t.C
+	}
+
+	var cpuTimer *time.Timer
+	var cpuDeadline <-chan time.Time
+	if limits.cpuTimeMs > 0 && cgroupPath != "" {
+		cpuTimer = time.NewTimer(cpuDeadlineStep(limits.cpuTimeMs, limits.cpuSlots))
+		defer cpuTimer.Stop()
+		cpuDeadline = cpuTimer.C
+	}
+
+	var memoryEvents <-chan struct{}
+	if cgroupPath != "" && e.watcher != nil {
+		events, unwatch, err := e.watcher.watch(filepath.Join(cgroupPath, "memory.events"))
+		if err != nil {
+			logx.WithContext(ctx).Errorf("watch memory.events failed: cgroupPath=%s err=%v", cgroupPath, err)
+		} else {
+			defer unwatch()
+			memoryEvents = events
+		}
+	}
+
+	var memoryTick <-chan time.Time
+	if cgroupPath != "" && !cgroupFileExists(cgroupPath, "memory.peak") {
+		ticker := time.NewTicker(memorySampleInterval)
+		defer ticker.Stop()
+		memoryTick = ticker.C
+	}
+
+	for {
+		select {
+		case <-ctx.Done():
+			// Context canceled: terminate the whole process group.
+			proc.kill()
+			return
+		case <-done:
+			return
+		case <-wallTimer:
+			w.timedOut.Store(true)
+			proc.kill()
+			return
+		case <-cpuDeadline:
+			w.cpuPolls.Add(1)
+			usageMs, err := cg.cpuTimeMs()
+			if err != nil {
+				cpuTimer.Reset(cpuDeadlineRetryStep)
+				continue
+			}
+			if usageMs >= limits.cpuTimeMs {
+				// CPU time exceeded based on the same source used for stats.
+				w.cpuTimedOut.Store(true)
+				proc.kill()
+				return
+			}
+			cpuTimer.Reset(cpuDeadlineStep(limits.cpuTimeMs-usageMs, limits.cpuSlots))
+		case <-memoryEvents:
+			if cg.oomKills() > 0 {
+				// Kill the rest of the group now instead of waiting for it to
+				// notice its sibling died.
+				w.oomKilled.Store(true)
+				proc.kill()
+				return
+			}
+		case <-memoryTick:
+			currentBytes, err := cgroupMemoryCurrentBytes(cgroupPath)
+			if err != nil || currentBytes <= 0 {
+				continue
+			}
+			for {
+				prev := w.memoryPeakBytes.Load()
+				if currentBytes <= prev || w.memoryPeakBytes.CompareAndSwap(prev, currentBytes) {
+					break
+				}
+			}
+		}
+	}
+}
+
+// runLimits is the part of spec.ResourceLimit the watchdog enforces.
+type runLimits struct {
+	wallTimeMs int64
+	cpuTimeMs  int64
+	// cpuSlots is how many CPUs the cgroup lets the run burn at once.
+	cpuSlots int64
+}
+
+// cpuDeadlineStep is the earliest time the run can exhaust remainingMs of CPU.
+func cpuDeadlineStep(remainingMs, cpuSlots int64) time.Duration {
+	if cpuSlots < 1 {
+		cpuSlots = 1
+	}
+	step := time.Duration(remainingMs) * time.Millisecond / time.Duration(cpuSlots)
+	if step < cpuDeadlineMinStep {
+		return cpuDeadlineMinStep
+	}
+	return step
+}
+
+// cpuSlotsFor returns how many CPUs the run's cgroup grants at once: the size of
+// the applied cpuset, capped by the cpu.max quota. With neither the deadline
+// uses the single-thread bound; a multi-threaded unpinned run can then
+// overshoot the CPU limit before the kill, which the wall limit still bounds.
+func cpuSlotsFor(cpuSet, cpuMax string) int64 {
+	slots := cpuSetSize(cpuSet)
+	if quota := cpuMaxSlots(cpuMax); quota > 0 && (slots == 0 || quota < slots) {
+		slots = quota
+	}
+	if slots < 1 {
+		return 1
+	}
+	return slots
+}
+
+// cpuMaxSlots rounds a cpu.max value such as "200000 100000" up to whole CPUs.
+// It returns 0 for "max" or a malformed value.
+func cpuMaxSlots(cpuMax string) int64 {
+	fields := strings.Fields(cpuMax)
+	if len(fields) != 2 || fields[0] == "max" {
+		return 0
+	}
+	quota, err := strconv.ParseInt(fields[0], 10, 64)
+	if err != nil || quota <= 0 {
+		return 0
+	}
+	period, err := strconv.ParseInt(fields[1], 10, 64)
+	if err != nil || period <= 0 {
+		return 0
+	}
+	return (quota + period - 1) / period
+}
+
+// cpuSetSize counts CPUs in a cpuset list such as "0-3,8". It returns 0 for an
+// empty or malformed list.
+func cpuSetSize(cpuSet string) int64 {
+	if cpuSet == "" {
+		return 0
+	}
+	var total int64
+	for _, part := range strings.Split(cpuSet, ",") {
+		part = strings.TrimSpace(part)
+		lo, hi, isRange := strings.Cut(part, "-")
+		first, err := strconv.ParseInt(lo, 10, 64)
+		if err != nil {
+			return 0
+		}
+		last := first
+		if isRange {
+			if last, err = strconv.ParseInt(hi, 10, 64); err != nil || last < first {
+				return 0
+			}
+		}
+		total += last - first + 1
+	}
+	return total
+}
+
+func cgroupFileExists(cgroupPath, name string) bool {
+	_, err := os.Stat(filepath.Join(cgroupPath, name))
+	return err == nil
+}
+
+// cgroupWatcher multiplexes inotify watches for every running cgroup on one
+// non-blocking descriptor served by a single goroutine, so the cost does not
+// grow with the number of runs in flight.
+type cgroupWatcher struct {
+	fd   int
+	file *os.File
+
+	mu      sync.Mutex
+	watches map[int32]chan struct{}
+}
+
+func newCgroupWatcher() (*cgroupWatcher, error) {
+	fd, err := syscall.InotifyInit1(syscall.IN_NONBLOCK | syscall.IN_CLOEXEC)
+	if err != nil {
+		return nil, err
+	}
+	w := &cgroupWatcher{
+		fd:      fd,
+		file:    os.NewFile(uintptr(fd), "inotify"),
+		watches: make(map[int32]chan struct{}),
+	}
+	go w.loop()
+	return w, nil
+}
+
+// watch delivers a coalesced signal on the returned channel whenever path is
+// modified. The caller must call the returned function when done.
+func (w *cgroupWatcher) watch(path string) (<-chan struct{}, func(), error) {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+	wd, err := syscall.InotifyAddWatch(w.fd, path, syscall.IN_MODIFY)
+	if err != nil {
+		return nil, func() {}, err
+	}
+	ch := make(chan struct{}, 1)
+	w.watches[int32(wd)] = ch
+	unwatch := func() {
+		w.mu.Lock()
+		defer w.mu.Unlock()
+		if w.watches[int32(wd)] == ch {
+			delete(w.watches, int32(wd))
+			_, _ = syscall.InotifyRmWatch(w.fd, uint32(wd))
+		}
+	}
+	return ch, unwatch, nil
+}
+
+func (w *cgroupWatcher) loop() {
+	buf := make([]byte, 64*(syscall.SizeofInotifyEvent+syscall.NAME_MAX+1))
+	for {
+		n, err := w.file.Read(buf)
+		if err != nil {
+			logx.Errorf("cgroup watcher stopped: %v", err)
+			return
+		}
+		w.mu.Lock()
+		for offset := 0; offset+syscall.SizeofInotifyEvent <= n; {
+			wd := int32(binary.NativeEndian.Uint32(buf[offset:]))
+			mask := binary.NativeEndian.Uint32(buf[offset+4:])
+			nameLen := binary.NativeEndian.Uint32(buf[offset+12:])
+			offset += syscall.SizeofInotifyEvent + int(nameLen)
+			ch, ok := w.watches[wd]
+			if !ok {
+				continue
+			}
+			if mask&syscall.IN_IGNORED != 0 {
+				// Cgroup removed; the kernel already dropped the watch.
+				delete(w.watches, wd)
+			}
+			select {
+			case ch <- struct{}{}:
+			default:
+			}
+		}
+		w.mu.Unlock()
+	}
+}
@@ -0,0 +1,88 @@
+//go:build linux
+
+package engine
+
+import (
+	"context"
+	"fmt"
+	"os"
+	"path/filepath"
+	"runtime"
+	"testing"
+	"time"
+)
+
+type fakeHelperProcess struct {
+	killed chan struct{}
+}
+
+func (p *fakeHelperProcess) kill() {
+	select {
+	case <-p.killed:
+	default:
+		close(p.killed)
+	}
+}
+
+func (p *fakeHelperProcess) wait() (helperExit, error) {
+	<-p.killed
+	return helperExit{ExitCode: -1}, nil
+}
+
+// TestWatchRunPollsCPUStatFewTimesOnTLE drives the watchdog against a fake
+// cgroup whose cpu.stat grows like one busy thread. The run is unpinned, so
+// the host CPU count must not shrink the deadline step.
+func TestWatchRunPollsCPUStatFewTimesOnTLE(t *testing.T) {
+	if got := cpuSlotsFor("", cgroupCPUMax); got != 1 {
+		t.Fatalf("expected one slot for an unpinned run on %d CPUs, got %d", runtime.NumCPU(), got)
+	}
+	if got := cpuSlotsFor("0-7", "200000 100000"); got != 2 {
+		t.Fatalf("expected cpu.max quota to cap the cpuset, got %d", got)
+	}
+
+	dir := t.TempDir()
+	statPath := filepath.Join(dir, "cpu.stat")
+	writeUsage := func(usec int64) {
+		if err := os.WriteFile(statPath, []byte(fmt.Sprintf("usage_usec %d\n", usec)), 0644); err != nil {
+			t.Errorf("write cpu.stat: %v", err)
+		}
+	}
+	writeUsage(0)
+
+	proc := &fakeHelperProcess{killed: make(chan struct{})}
+	start := time.Now()
+	go func() {
+		ticker := time.NewTicker(time.Millisecond)
+		defer ticker.Stop()
+		for {
+			select {
+			case <-proc.killed:
+				return
+			case <-ticker.C:
+				writeUsage(time.Since(start).Microseconds())
+			}
+		}
+	}()
+
+	const cpuLimitMs = 300
+	limits := runLimits{
+		wallTimeMs: 5000,
+		cpuTimeMs:  cpuLimitMs,
+		cpuSlots:   cpuSlotsFor("", cgroupCPUMax),
+	}
+	watch := &runWatch{}
+	e := &linuxEngine{}
+	e.watchRun(context.Background(), proc, &runCgroup{path: dir}, limits, make(chan struct{}), watch)
+
+	if !watch.cpuTimedOut.Load() {
+		t.Fatalf("expected CPU time limit to fire")
+	}
+	if elapsed := time.Since(start); elapsed > cpuLimitMs*time.Millisecond+200*time.Millisecond {
+		t.Fatalf("expected kill shortly after the limit, took %s", elapsed)
+	}
+	// remaining, then the floor: a fixed 100ms ticker needed 3 reads, the
+	// NumCPU-divided step about 11.
+	if polls := watch.cpuPolls.Load(); polls > 4 {
+		t.Fatalf("expected at most 4 cpu.stat reads, got %d", polls)
+	}
+}
@@ -10,4 +10,9 @@ type initRequest struct {
 	Isolation     security.IsolationProfile
 	EnableSeccomp bool
 	EnableNs      bool
+	// StdoutFD is the inherited descriptor the helper makes stdout (0: use StdoutPath).
+	StdoutFD int
+	// SeccompFD is an inherited, sealed memfd with the precompiled BPF program
+	// (0: the helper compiles Isolation.SeccompProfile itself).
+	SeccompFD int
 }
@@ -0,0 +1,188 @@
+//go:build linux
+
+package engine
+
+import (
+	"bytes"
+	"context"
+	"fmt"
+	"os"
+	"os/exec"
+	"path/filepath"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/zeromicro/go-zero/core/logx"
+	"github.com/zeromicro/go-zero/core/syncx"
+	"golang.org/x/sys/unix"
+)
+
+const (
+	compileSeccompFlag    = "--compile-seccomp"
+	seccompCompileTimeout = 10 * time.Second
+	seccompMemfdSeals     = unix.F_SEAL_SEAL | unix.F_SEAL_SHRINK | unix.F_SEAL_GROW | unix.F_SEAL_WRITE
+)
+
+// seccompCache holds one precompiled BPF program per seccomp profile, so runs
+// only install a filter instead of compiling the JSON profile each time. A
+// program is recompiled when its profile's size or mtime changes; superseded
+// programs are closed once the last run holding them has started. Compiles run
+// outside mu and are shared per profile version, so a cold profile only blocks
+// the runs that need it.
+type seccompCache struct {
+	helperPath string
+	flight     syncx.SingleFlight
+
+	mu       sync.Mutex
+	programs map[string]*seccompProgram
+}
+
+type seccompProgram struct {
+	file    *os.File
+	size    int64
+	modTime time.Time
+	refs    int
+	stale   bool
+}
+
+func (p *seccompProgram) matches(info os.FileInfo) bool {
+	return p.size == info.Size() && p.modTime.Equal(info.ModTime())
+}
+
+func newSeccompCache(helperPath string) *seccompCache {
+	return &seccompCache{
+		helperPath: helperPath,
+		flight:     syncx.NewSingleFlight(),
+		programs:   make(map[string]*seccompProgram),
+	}
+}
+
+// warm compiles every profile in dir so the first runs do not pay for it.
+func (c *seccompCache) warm(dir string) {
+	if dir == "" {
+		return
+	}
+	paths, err := filepath.Glob(filepath.Join(dir, "*.json"))
+	if err != nil {
+		return
+	}
+	for _, path := range paths {
+		_, release, err := c.acquire(context.Background(), path)
+		if err != nil {
+			logx.Errorf("precompile seccomp profile failed: path=%s err=%v", path, err)
+			continue
+		}
+		release()
+	}
+}
+
+// acquire returns a sealed memfd holding the compiled program of profilePath.
+// The file stays open until release is called.
+func (c *seccompCache) acquire(ctx context.Context, profilePath string) (*os.File, func(), error) {
+	info, err := os.Stat(profilePath)
+	if err != nil {
+		return nil, nil, fmt.Errorf("stat seccomp profile: %w", err)
+	}
+
+	c.mu.Lock()
+	prog, ok := c.programs[profilePath]
+	if ok && prog.matches(info) {
+		prog.refs++
+		c.mu.Unlock()
+		return prog.file, c.releaser(prog), nil
+	}
+	c.mu.Unlock()
+
+	key := fmt.Sprintf("%s\x00%d\x00%d", profilePath, info.Size(), info.ModTime().UnixNano())
+	if _, err := c.flight.Do(key, func() (any, error) {
+		return nil, c.install(ctx, profilePath, info)
+	}); err != nil {
+		return nil, nil, err
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	prog, ok = c.programs[profilePath]
+	if !ok {
+		return nil, nil, fmt.Errorf("seccomp program missing: %s", profilePath)
+	}
+	prog.refs++
+	return prog.file, c.releaser(prog), nil
+}
+
+// install compiles the profile version described by info and makes it current,
+// retiring the program it supersedes.
+func (c *seccompCache) install(ctx context.Context, profilePath string, info os.FileInfo) error {
+	// The compile is shared by every run waiting on this version; one caller's
+	// cancellation must not fail the others.
+	file, err := c.compile(context.WithoutCancel(ctx), profilePath)
+	if err != nil {
+		return err
+	}
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	prog, ok := c.programs[profilePath]
+	if ok && (prog.matches(info) || prog.modTime.After(info.ModTime())) {
+		// Another caller already installed this or a newer version.
+		_ = file.Close()
+		return nil
+	}
+	if ok {
+		c.retire(prog)
+		logx.Infof("seccomp profile recompiled: path=%s", profilePath)
+	}
+	c.programs[profilePath] = &seccompProgram{file: file, size: info.Size(), modTime: info.ModTime()}
+	return nil
+}
+
+func (c *seccompCache) releaser(prog *seccompProgram) func() {
+	var once sync.Once
+	return func() {
+		once.Do(func() {
+			c.mu.Lock()
+			defer c.mu.Unlock()
+			prog.refs--
+			if prog.stale && prog.refs == 0 {
+				_ = prog.file.Close()
+			}
+		})
+	}
+}
+
+func (c *seccompCache) retire(prog *seccompProgram) {
+	prog.stale = true
+	if prog.refs == 0 {
+		_ = prog.file.Close()
+	}
+}
+
+// compile runs the helper in compile mode with a memfd as stdout and seals the
+// result, so runs can share the descriptor without being able to alter it.
+func (c *seccompCache) compile(ctx context.Context, profilePath string) (*os.File, error) {
+	name := "seccomp-" + filepath.Base(profilePath)
+	fd, err := unix.MemfdCreate(name, unix.MFD_CLOEXEC|unix.MFD_ALLOW_SEALING)
+	if err != nil {
+		return nil, fmt.Errorf("create seccomp memfd: %w", err)
+	}
+	file := os.NewFile(uintptr(fd), name)
+
+	ctx, cancel := context.WithTimeout(ctx, seccompCompileTimeout)
+	defer cancel()
+	cmd := exec.CommandContext(ctx, c.helperPath, compileSeccompFlag, profilePath)
+	var stderr bytes.Buffer
+	cmd.Stdout = file
+	cmd.Stderr = &stderr
+	if err := cmd.Run(); err != nil {
+		_ = file.Close()
+		if stderr.Len() > 0 {
+			return nil, fmt.Errorf("compile seccomp profile: %w: %s", err, strings.TrimSpace(stderr.String()))
+		}
+		return nil, fmt.Errorf("compile seccomp profile: %w", err)
+	}
+	if _, err := unix.FcntlInt(file.Fd(), unix.F_ADD_SEALS, seccompMemfdSeals); err != nil {
+		_ = file.Close()
+		return nil, fmt.Errorf("seal seccomp memfd: %w", err)
+	}
+	return file, nil
+}
@@ -11,6 +11,8 @@ import (
 	"time"
 
 	"fuzoj/services/judge_service/internal/sandbox/spec"
+
+	"golang.org/x/sys/unix"
 )
 
 func durationFromMs(ms int64) time.Duration {
@@ -33,6 +35,107 @@ func cpuTimeMs(state *os.ProcessState) int64 {
 	return int64((utime + stime).Milliseconds())
 }
 
+func maxRSSKB(state *os.ProcessState) int64 {
+	if state == nil {
+		return 0
+	}
+	usage, ok := state.SysUsage().(*syscall.Rusage)
+	if !ok {
+		return 0
+	}
+	return usage.Maxrss
+}
+
+// helperFirstExtraFD is where the helper finds the first inherited descriptor
+// (stdout capture, then seccomp program): the first one after
+// stdin/stdout/stderr, as exec.Cmd.ExtraFiles places them.
+const helperFirstExtraFD = 3
+
+// outputDrainTimeout bounds how long Run waits for the stdout pipe to reach EOF
+// after the helper exited, in case a leftover process still holds it open.
+const outputDrainTimeout = time.Second
+
+// stdoutCapture collects one run's stdout in memory. The helper writes to a
+// pipe and the engine copies it into a memfd, so the captured pages are charged
+// to the engine instead of the run's cgroup: memory.max stays the real limit
+// and the reported peak is the program's own.
+type stdoutCapture struct {
+	file   *os.File
+	reader *os.File
+	writer *os.File
+	limit  int64
+	done   chan struct{}
+}
+
+func newStdoutCapture(name string, limitBytes int64) (*stdoutCapture, error) {
+	fd, err := unix.MemfdCreate("stdout-"+name, unix.MFD_CLOEXEC)
+	if err != nil {
+		return nil, err
+	}
+	file := os.NewFile(uintptr(fd), "stdout-"+name)
+	reader, writer, err := os.Pipe()
+	if err != nil {
+		_ = file.Close()
+		return nil, err
+	}
+	return &stdoutCapture{file: file, reader: reader, writer: writer, limit: limitBytes, done: make(chan struct{})}, nil
+}
+
+// start drops the engine's write end and copies until EOF. Output past the
+// limit kills the run, leaving the capture exactly at the limit.
+func (c *stdoutCapture) start(proc helperProcess) {
+	_ = c.writer.Close()
+	go func() {
+		defer close(c.done)
+		if c.limit <= 0 {
+			_, _ = io.Copy(c.file, c.reader)
+			return
+		}
+		if n, _ := io.Copy(c.file, io.LimitReader(c.reader, c.limit)); n < c.limit {
+			return
+		}
+		var probe [1]byte
+		if n, _ := c.reader.Read(probe[:]); n > 0 {
+			proc.kill()
+		}
+	}()
+}
+
+// wait lets the copy finish once the helper exited, then releases the pipe.
+func (c *stdoutCapture) wait() {
+	select {
+	case <-c.done:
+	case <-time.After(outputDrainTimeout):
+	}
+	_ = c.reader.Close()
+	<-c.done
+}
+
+// abort releases the pipe when the helper never started; the memfd stays with the caller.
+func (c *stdoutCapture) abort() {
+	_ = c.writer.Close()
+	_ = c.reader.Close()
+}
+
+func fileSizeKB(file *os.File) int64 {
+	info, err := file.Stat()
+	if err != nil {
+		return 0
+	}
+	return info.Size() / 1024
+}
+
+func readLimitedFileAt(file *os.File, maxBytes int64) string {
+	if maxBytes <= 0 {
+		return ""
+	}
+	data, err := io.ReadAll(io.NewSectionReader(file, 0, maxBytes))
+	if err != nil {
+		return ""
+	}
+	return string(data)
+}
+
 func stdoutSizeKB(path string) int64 {
 	if path == "" {
 		return 0
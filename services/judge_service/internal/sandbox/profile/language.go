@@ -2,6 +2,8 @@
 package profile
 
 // LanguageSpec defines how to compile and run a language.
+// PCHHeader optionally names a header (e.g. "bits/stdc++.h") to precompile
+// per flag set; CompileCmdTpl must contain {extraFlags} for it to take effect.
 type LanguageSpec struct {
 	ID               string
 	Name             string
@@ -14,4 +16,5 @@ type LanguageSpec struct {
 	Env              []string
 	TimeMultiplier   float64
 	MemoryMultiplier float64
+	PCHHeader        string `json:",optional"`
 }
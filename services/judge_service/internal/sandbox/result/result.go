@@ -1,6 +1,8 @@
 // Package result defines sandbox execution results and verdict mapping.
 package result
 
+import "os"
+
 // JudgeStatus represents the lifecycle state of a submission.
 type JudgeStatus string
 
@@ -28,6 +30,8 @@ const (
 )
 
 // RunResult captures raw sandbox execution data.
+// StdoutFile is the captured stdout when RunSpec.StdoutMemfd was honored; the
+// caller owns it and must close it.
 type RunResult struct {
 	ExitCode   int
 	TimeMs     int64
@@ -37,6 +41,7 @@ type RunResult struct {
 	Stdout     string
 	Stderr     string
 	OomKilled  bool
+	StdoutFile *os.File `json:"-"`
 }
 
 // CompileResult contains compilation outcomes.
@@ -2,6 +2,7 @@ package runner
 
 import (
 	"context"
+	"errors"
 	"fmt"
 	"io"
 	"math"
@@ -13,6 +14,7 @@ import (
 	"github.com/zeromicro/go-zero/core/logx"
 
 	appErr "fuzoj/pkg/errors"
+	"fuzoj/services/judge_service/internal/sandbox/compare"
 	"fuzoj/services/judge_service/internal/sandbox/engine"
 	"fuzoj/services/judge_service/internal/sandbox/observer"
 	"fuzoj/services/judge_service/internal/sandbox/profile"
@@ -36,6 +38,7 @@ const (
 type runnerSupport struct {
 	eng     engine.Engine
 	metrics observer.MetricsRecorder
+	pch     *PCHCache
 }
 
 type checkerRunResult struct {
@@ -75,6 +78,9 @@ func (s runnerSupport) executeRun(ctx context.Context, req RunRequest, limits sp
 	}
 
 	runRes, runErr := s.eng.Run(ctx, runSpec)
+	if runRes.StdoutFile != nil {
+		defer runRes.StdoutFile.Close()
+	}
 	runtimeLog, runtimeErr := readLogFile(runtimeLogPath, runtimeLogMaxSize)
 	if runtimeErr != nil {
 		logx.WithContext(ctx).Errorf("read runtime log failed submission_id=%s test_id=%s err=%v", req.SubmissionID, req.TestID, runtimeErr)
@@ -90,7 +96,21 @@ func (s runnerSupport) executeRun(ctx context.Context, req RunRequest, limits sp
 
 	verdict := mapRunVerdict(runRes, limits)
 	checkerLog := ""
+	outputPath := filepath.Join(req.WorkDir, outputName)
+	if runRes.StdoutFile != nil {
+		outputPath = capturedOutputPath(runRes.StdoutFile)
+	}
 	if verdict == result.VerdictAC && req.Checker != nil && req.CheckerProfile != nil {
+		if runRes.StdoutFile != nil {
+			// The checker runs in its own sandbox and reads the output from /work.
+			if err := materializeOutput(runRes.StdoutFile, filepath.Join(req.WorkDir, outputName)); err != nil {
+				return result.TestcaseResult{
+					TestID:     req.TestID,
+					Verdict:    result.VerdictSE,
+					RuntimeLog: runtimeLog,
+				}, err
+			}
+		}
 		checkerRes, checkerErr := s.runChecker(ctx, req, outputName)
 		checkerLog, runtimeErr = readLogFile(checkerRes.LogPath, checkerLogMaxSize)
 		if runtimeErr != nil {
@@ -107,6 +127,23 @@ func (s runnerSupport) executeRun(ctx context.Context, req RunRequest, limits sp
 		if checkerRes.ExitCode != 0 {
 			verdict = result.VerdictWA
 		}
+	} else if verdict == result.VerdictAC && req.CompareMode != "" {
+		cmpRes, cmpErr := compare.Files(outputPath, req.AnswerPath, compare.Mode(req.CompareMode))
+		if errors.Is(cmpErr, compare.ErrOutputNotFound) {
+			// A program that never wrote its output file answered wrongly.
+			cmpRes, cmpErr = compare.Result{Message: compare.ErrOutputNotFound.Error()}, nil
+		}
+		if cmpErr != nil {
+			return result.TestcaseResult{
+				TestID:     req.TestID,
+				Verdict:    result.VerdictSE,
+				RuntimeLog: runtimeLog,
+			}, appErr.Wrapf(cmpErr, appErr.JudgeSystemError, "compare output failed")
+		}
+		if !cmpRes.Equal {
+			verdict = result.VerdictWA
+			checkerLog = cmpRes.Message
+		}
 	}
 
 	res := result.TestcaseResult{
@@ -156,6 +193,7 @@ func (s runnerSupport) runChecker(ctx context.Context, req RunRequest, outputNam
 		StderrPath:   filepath.Join(containerWorkDir, checkerLogName),
 		Profile:      profileName(checkerLanguageID(req), req.CheckerProfile.TaskType),
 		Limits:       checkerLimits,
+		CPUSet:       req.CPUSet,
 		BindMounts: buildBindMounts(req.WorkDir, []spec.MountSpec{
 			{Source: req.InputPath, Target: filepath.Join(containerWorkDir, inputName(req.IOConfig)), ReadOnly: true},
 			{Source: req.AnswerPath, Target: filepath.Join(containerWorkDir, defaultAnswerName), ReadOnly: true},
@@ -237,6 +275,17 @@ func validateRunRequest(req RunRequest) error {
 	if req.InputPath == "" {
 		return appErr.ValidationError("input_path", "required")
 	}
+	if req.BinaryPath != "" && req.Language.BinaryFile == "" {
+		return appErr.ValidationError("binary_file", "required")
+	}
+	if req.Checker == nil && req.CompareMode != "" {
+		if req.AnswerPath == "" {
+			return appErr.ValidationError("answer_path", "required")
+		}
+		if _, err := compare.ParseMode(req.CompareMode); err != nil {
+			return appErr.Wrapf(err, appErr.InvalidParams, "invalid compare mode")
+		}
+	}
 	if req.IOConfig.Mode == "fileio" {
 		if req.IOConfig.InputFileName == "" {
 			return appErr.ValidationError("input_file_name", "required")
@@ -266,9 +315,11 @@ func buildRunSpec(req RunRequest, limits spec.ResourceLimit) (spec.RunSpec, stri
 	stderrPath := filepath.Join(containerWorkDir, runtimeLogName)
 	stdinPath := ""
 	stdoutPath := ""
+	stdoutMemfd := false
 	if req.IOConfig.Mode == "" || req.IOConfig.Mode == "stdio" {
 		stdinPath = filepath.Join(containerWorkDir, input)
 		stdoutPath = filepath.Join(containerWorkDir, output)
+		stdoutMemfd = true
 	}
 
 	runSpec := spec.RunSpec{
@@ -282,16 +333,52 @@ func buildRunSpec(req RunRequest, limits spec.ResourceLimit) (spec.RunSpec, stri
 		StderrPath:   stderrPath,
 		Profile:      profileName(req.Language.ID, req.Profile.TaskType),
 		Limits:       limits,
+		CPUSet:       req.CPUSet,
+		StdoutMemfd:  stdoutMemfd,
 		BindMounts: buildBindMounts(req.WorkDir, []spec.MountSpec{
 			{Source: req.InputPath, Target: filepath.Join(containerWorkDir, input), ReadOnly: true},
 			{Source: req.AnswerPath, Target: filepath.Join(containerWorkDir, defaultAnswerName), ReadOnly: true},
 		}),
 	}
+	if req.BinaryPath != "" {
+		runSpec.BindMounts = append(runSpec.BindMounts, spec.MountSpec{
+			Source:   req.BinaryPath,
+			Target:   filepath.Join(containerWorkDir, req.Language.BinaryFile),
+			ReadOnly: true,
+		})
+	}
 
 	runtimeLogPath := filepath.Join(req.WorkDir, runtimeLogName)
 	return runSpec, runtimeLogPath, output, nil
 }
 
+// capturedOutputPath names an engine stdout capture by path so the comparator
+// can map it directly, without writing it to the work dir first.
+func capturedOutputPath(file *os.File) string {
+	return fmt.Sprintf("/proc/self/fd/%d", file.Fd())
+}
+
+func materializeOutput(file *os.File, dst string) error {
+	out, err := os.OpenFile(dst, os.O_CREATE|os.O_TRUNC|os.O_WRONLY, 0644)
+	if err != nil {
+		return appErr.Wrapf(err, appErr.JudgeSystemError, "create output file failed")
+	}
+	// The capture shares its offset with the finished run; rewind, then copy
+	// file to file so the kernel can move the data.
+	if _, err := file.Seek(0, io.SeekStart); err != nil {
+		_ = out.Close()
+		return appErr.Wrapf(err, appErr.JudgeSystemError, "rewind captured output failed")
+	}
+	if _, err := io.Copy(out, file); err != nil {
+		_ = out.Close()
+		return appErr.Wrapf(err, appErr.JudgeSystemError, "write output file failed")
+	}
+	if err := out.Close(); err != nil {
+		return appErr.Wrapf(err, appErr.JudgeSystemError, "write output file failed")
+	}
+	return nil
+}
+
 func buildBindMounts(workDir string, extra []spec.MountSpec) []spec.MountSpec {
 	mounts := []spec.MountSpec{{
 		Source:   workDir,
@@ -386,6 +473,11 @@ func scaleLimit(value int64, multiplier float64) int64 {
 }
 
 func mapRunVerdict(res result.RunResult, limits spec.ResourceLimit) result.Verdict {
+	// RLIMIT_FSIZE (or the engine, for a memfd capture) kills the run with the
+	// output exactly at the cap.
+	if limits.OutputMB > 0 && res.ExitCode != 0 && res.OutputKB >= limits.OutputMB*1024 {
+		return result.VerdictOLE
+	}
 	if res.ExitCode == -1 {
 		return result.VerdictTLE
 	}
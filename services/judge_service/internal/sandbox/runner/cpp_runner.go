@@ -37,7 +37,17 @@ func (r *CppRunner) Compile(ctx context.Context, req CompileRequest) (result.Com
 	}
 
 	limits := applyLimits(req.Limits, req.Profile.DefaultLimits, req.Language)
-	cmd, err := buildCommand(req.Language.CompileCmdTpl, req.Language, req.ExtraCompileFlags)
+	extraFlags := req.ExtraCompileFlags
+	mounts := []spec.MountSpec{{
+		Source:   req.WorkDir,
+		Target:   containerWorkDir,
+		ReadOnly: false,
+	}}
+	if pchDir := r.support.pch.lookup(req.Language, req.Profile, req.ExtraCompileFlags); pchDir != "" {
+		extraFlags = append([]string{"-I" + pchMountDir}, extraFlags...)
+		mounts = append(mounts, spec.MountSpec{Source: pchDir, Target: pchMountDir, ReadOnly: true})
+	}
+	cmd, err := buildCommand(req.Language.CompileCmdTpl, req.Language, extraFlags)
 	if err != nil {
 		return result.CompileResult{}, err
 	}
@@ -52,11 +62,7 @@ func (r *CppRunner) Compile(ctx context.Context, req CompileRequest) (result.Com
 		StderrPath:   filepath.Join(containerWorkDir, compileLogName),
 		Profile:      profileName(req.Language.ID, req.Profile.TaskType),
 		Limits:       limits,
-		BindMounts: []spec.MountSpec{{
-			Source:   req.WorkDir,
-			Target:   containerWorkDir,
-			ReadOnly: false,
-		}},
+		BindMounts:   mounts,
 	}
 
 	runRes, runErr := r.support.eng.Run(ctx, runSpec)
@@ -29,6 +29,17 @@ func NewRunnerWithObserver(eng engine.Engine, metrics observer.MetricsRecorder)
 	}
 }
 
+// NewRunnerWithPCH creates a dispatch runner whose C++ compiles use headers
+// precompiled by pch when one matches the language and flags.
+func NewRunnerWithPCH(eng engine.Engine, pch *PCHCache) Runner {
+	support := newRunnerSupport(eng, observer.NoopMetricsRecorder{})
+	support.pch = pch
+	return &LanguageDispatchRunner{
+		cpp: newCppRunner(support),
+		py:  newPythonRunner(support),
+	}
+}
+
 func (r *LanguageDispatchRunner) Compile(ctx context.Context, req CompileRequest) (result.CompileResult, error) {
 	selected, err := r.pick(req.Language.ID)
 	if err != nil {
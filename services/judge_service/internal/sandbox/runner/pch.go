@@ -0,0 +1,264 @@
+package runner
+
+import (
+	"context"
+	"crypto/sha256"
+	"encoding/hex"
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/zeromicro/go-zero/core/logx"
+
+	appErr "fuzoj/pkg/errors"
+	"fuzoj/services/judge_service/internal/sandbox/engine"
+	"fuzoj/services/judge_service/internal/sandbox/profile"
+	"fuzoj/services/judge_service/internal/sandbox/spec"
+)
+
+const (
+	pchKeyVersion      = "v1"
+	pchMountDir        = "/pch"
+	pchDirName         = "pch"
+	pchWrapperName     = "pch_wrapper.h"
+	pchBuildLogName    = "pch.log"
+	pchBuildTimeout    = 2 * time.Minute
+	pchMaxFlagSets     = 16
+	pchBuildDirPrefix  = ".build-"
+	pchBuildLogMaxSize = 4 * 1024
+)
+
+// pchBuildLimits override the compile profile defaults: a bits/stdc++.h PCH
+// takes a few seconds and is ~100 MB, well above a normal compile's output cap.
+var pchBuildLimits = spec.ResourceLimit{
+	CPUTimeMs:  60000,
+	WallTimeMs: 120000,
+	MemoryMB:   2048,
+	OutputMB:   512,
+}
+
+// ProfileSource resolves task profiles for PCH warm-up.
+type ProfileSource interface {
+	GetTaskProfile(ctx context.Context, taskType profile.TaskType, languageID string) (profile.TaskProfile, error)
+}
+
+// PCHCache builds precompiled headers for LanguageSpec.PCHHeader inside the
+// compile sandbox, one per language spec, compile rootfs and flag set, and
+// keeps them under rootDir across restarts. GCC only accepts a .gch built with
+// matching options and silently falls back to the real header otherwise, so a
+// stale or missing PCH never changes the result, only the compile time.
+type PCHCache struct {
+	rootDir string
+	eng     engine.Engine
+
+	mu      sync.Mutex
+	entries map[string]*pchEntry
+}
+
+type pchEntry struct {
+	done chan struct{}
+	// dir is the host directory to mount at /pch; empty if the build failed.
+	dir string
+}
+
+// NewPCHCache creates a PCH cache rooted at rootDir.
+func NewPCHCache(rootDir string, eng engine.Engine) (*PCHCache, error) {
+	if rootDir == "" {
+		return nil, appErr.ValidationError("pch_dir", "required")
+	}
+	if err := os.MkdirAll(rootDir, 0755); err != nil {
+		return nil, appErr.Wrapf(err, appErr.CacheError, "create pch dir failed")
+	}
+	dirEntries, err := os.ReadDir(rootDir)
+	if err != nil {
+		return nil, appErr.Wrapf(err, appErr.CacheError, "read pch dir failed")
+	}
+	for _, d := range dirEntries {
+		if strings.HasPrefix(d.Name(), pchBuildDirPrefix) {
+			_ = os.RemoveAll(filepath.Join(rootDir, d.Name()))
+		}
+	}
+	return &PCHCache{
+		rootDir: rootDir,
+		eng:     eng,
+		entries: make(map[string]*pchEntry),
+	}, nil
+}
+
+// Warm builds the PCH for the default flag set (no extra flags) of every
+// compiled language that declares a PCHHeader, and waits for the builds.
+// Failures are logged; those languages simply compile without a PCH.
+func (c *PCHCache) Warm(ctx context.Context, languages []profile.LanguageSpec, profiles ProfileSource) {
+	for _, lang := range languages {
+		if !pchSupported(lang) {
+			continue
+		}
+		prof, err := profiles.GetTaskProfile(ctx, profile.TaskTypeCompile, lang.ID)
+		if err != nil {
+			logx.WithContext(ctx).Errorf("pch warm skipped language_id=%s err=%v", lang.ID, err)
+			continue
+		}
+		entry, created := c.entry(pchKey(lang, prof, nil))
+		if entry == nil {
+			continue
+		}
+		if created {
+			c.build(ctx, entry, lang, prof, nil)
+			continue
+		}
+		select {
+		case <-entry.done:
+		case <-ctx.Done():
+			return
+		}
+	}
+}
+
+// lookup returns the host PCH directory for a compile, or "" when none is
+// ready yet. A miss starts a background build so later compiles with the same
+// flags benefit; the current compile proceeds without a PCH.
+func (c *PCHCache) lookup(lang profile.LanguageSpec, prof profile.TaskProfile, extraFlags []string) string {
+	if c == nil || !pchSupported(lang) {
+		return ""
+	}
+	entry, created := c.entry(pchKey(lang, prof, extraFlags))
+	if entry == nil {
+		return ""
+	}
+	if created {
+		flags := append([]string(nil), extraFlags...)
+		go func() {
+			ctx, cancel := context.WithTimeout(context.Background(), pchBuildTimeout)
+			defer cancel()
+			c.build(ctx, entry, lang, prof, flags)
+		}()
+		return ""
+	}
+	select {
+	case <-entry.done:
+		return entry.dir
+	default:
+		return ""
+	}
+}
+
+// entry returns the entry for key, creating it when absent. created tells the
+// caller it owns the build. It returns nil once pchMaxFlagSets is reached.
+func (c *PCHCache) entry(key string) (*pchEntry, bool) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if e, ok := c.entries[key]; ok {
+		return e, false
+	}
+	if len(c.entries) >= pchMaxFlagSets {
+		return nil, false
+	}
+	e := &pchEntry{done: make(chan struct{})}
+	c.entries[key] = e
+	return e, true
+}
+
+func (c *PCHCache) build(ctx context.Context, entry *pchEntry, lang profile.LanguageSpec, prof profile.TaskProfile, extraFlags []string) {
+	defer close(entry.done)
+	key := pchKey(lang, prof, extraFlags)
+	finalDir := filepath.Join(c.rootDir, key)
+	if _, err := os.Stat(filepath.Join(finalDir, pchDirName, lang.PCHHeader+".gch")); err == nil {
+		entry.dir = filepath.Join(finalDir, pchDirName)
+		return
+	}
+
+	logger := logx.WithContext(ctx)
+	start := time.Now()
+	buildDir, err := os.MkdirTemp(c.rootDir, pchBuildDirPrefix+key+"-")
+	if err != nil {
+		logger.Errorf("pch build failed language_id=%s key=%s err=%v", lang.ID, key, err)
+		return
+	}
+	defer os.RemoveAll(buildDir)
+	if err := c.compile(ctx, buildDir, key, lang, prof, extraFlags); err != nil {
+		logger.Errorf("pch build failed language_id=%s key=%s err=%v", lang.ID, key, err)
+		return
+	}
+	_ = os.Remove(filepath.Join(buildDir, pchWrapperName))
+	_ = os.Remove(filepath.Join(buildDir, pchBuildLogName))
+	if err := os.Rename(buildDir, finalDir); err != nil && !os.IsExist(err) {
+		logger.Errorf("pch commit failed language_id=%s key=%s err=%v", lang.ID, key, err)
+		return
+	}
+	entry.dir = filepath.Join(finalDir, pchDirName)
+	logger.Infof("pch ready language_id=%s key=%s header=%s cost=%s", lang.ID, key, lang.PCHHeader, time.Since(start))
+}
+
+// compile runs the language's own compile template with {src} replaced by a
+// wrapper header compiled as -x c++-header and {bin} by <dir>/pch/<header>.gch,
+// so the PCH sees exactly the options a submission compile uses.
+func (c *PCHCache) compile(ctx context.Context, buildDir, key string, lang profile.LanguageSpec, prof profile.TaskProfile, extraFlags []string) error {
+	gchPath := filepath.Join(pchDirName, lang.PCHHeader+".gch")
+	if err := os.MkdirAll(filepath.Dir(filepath.Join(buildDir, gchPath)), 0755); err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "create pch output dir failed")
+	}
+	wrapper := "#include <" + lang.PCHHeader + ">\n"
+	if err := os.WriteFile(filepath.Join(buildDir, pchWrapperName), []byte(wrapper), 0644); err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "write pch wrapper failed")
+	}
+
+	tpl := strings.ReplaceAll(lang.CompileCmdTpl, "{src}", "-x c++-header "+filepath.Join(containerWorkDir, pchWrapperName))
+	tpl = strings.ReplaceAll(tpl, "{bin}", filepath.Join(containerWorkDir, gchPath))
+	cmd, err := buildCommand(tpl, lang, extraFlags)
+	if err != nil {
+		return err
+	}
+	runSpec := spec.RunSpec{
+		SubmissionID: "pch-" + key,
+		TestID:       "pch",
+		WorkDir:      containerWorkDir,
+		Cmd:          cmd,
+		Env:          lang.Env,
+		StderrPath:   filepath.Join(containerWorkDir, pchBuildLogName),
+		Profile:      profileName(lang.ID, profile.TaskTypeCompile),
+		Limits:       mergeLimits(prof.DefaultLimits, pchBuildLimits),
+		BindMounts: []spec.MountSpec{{
+			Source:   buildDir,
+			Target:   containerWorkDir,
+			ReadOnly: false,
+		}},
+	}
+	runRes, runErr := c.eng.Run(ctx, runSpec)
+	if runErr != nil {
+		return runErr
+	}
+	if runRes.ExitCode != 0 {
+		log, _ := readCompileLog(filepath.Join(buildDir, pchBuildLogName), pchBuildLogMaxSize)
+		return appErr.New(appErr.CacheError).WithMessage(fmt.Sprintf("pch compile exited with code %d: %s", runRes.ExitCode, log))
+	}
+	if _, err := os.Stat(filepath.Join(buildDir, gchPath)); err != nil {
+		return appErr.Wrapf(err, appErr.CacheError, "pch output missing")
+	}
+	return nil
+}
+
+// pchSupported reports whether lang can take a PCH: the header must be set and
+// the template must expose {extraFlags} so -I/pch can be injected.
+func pchSupported(lang profile.LanguageSpec) bool {
+	return lang.CompileEnabled && lang.PCHHeader != "" && strings.Contains(lang.CompileCmdTpl, "{extraFlags}")
+}
+
+func pchKey(lang profile.LanguageSpec, prof profile.TaskProfile, extraFlags []string) string {
+	h := sha256.New()
+	write := func(s string) {
+		h.Write([]byte(s))
+		h.Write([]byte{0})
+	}
+	write(pchKeyVersion)
+	write(lang.ID)
+	write(lang.Version)
+	write(lang.CompileCmdTpl)
+	write(lang.PCHHeader)
+	write(strings.Join(lang.Env, "\x01"))
+	write(prof.RootFS)
+	write(strings.Join(extraFlags, "\x01"))
+	return hex.EncodeToString(h.Sum(nil))[:32]
+}
@@ -21,6 +21,9 @@ type CompileRequest struct {
 }
 
 // RunRequest describes one execution task.
+// BinaryPath is the host path of the compiled artifact; when set it is
+// bind-mounted read-only at /work/<BinaryFile> instead of being copied.
+// CPUSet pins the run (and its checker) to the given cpuset list.
 type RunRequest struct {
 	SubmissionID      string
 	TestID            string
@@ -28,6 +31,7 @@ type RunRequest struct {
 	Profile           profile.TaskProfile
 	WorkDir           string
 	SourcePath        string
+	BinaryPath        string
 	IOConfig          IOConfig
 	InputPath         string
 	AnswerPath        string
@@ -35,8 +39,10 @@ type RunRequest struct {
 	Checker           *CheckerSpec
 	CheckerLanguageID string
 	CheckerProfile    *profile.TaskProfile
+	CompareMode       string
 	Score             int
 	SubtaskID         string
+	CPUSet            string
 }
 
 // Runner orchestrates compile and run workflows.
@@ -0,0 +1,189 @@
+package sandbox
+
+import (
+	"os"
+	"sort"
+	"sync"
+
+	"fuzoj/services/judge_service/internal/sandbox/result"
+)
+
+const (
+	// testHistoryMaxEntries bounds the failure history; it is dropped as a whole
+	// once full, which only costs ordering quality until it warms up again.
+	testHistoryMaxEntries = 100000
+)
+
+// stopRule decides which later testcases a failure makes pointless.
+// Without subtasks the first non-AC stops the submission (ACM style). With
+// subtasks a failure only skips the rest of its own min subtask, unless that
+// subtask is StopOnFail; tests outside any subtask never skip others.
+type stopRule struct {
+	perSubtask bool
+	subtaskOf  []string
+	stopOnFail map[string]bool
+}
+
+func newStopRule(testcases []TestcaseSpec, subtaskIndex map[string]*subtaskState) stopRule {
+	rule := stopRule{perSubtask: len(subtaskIndex) > 0}
+	if !rule.perSubtask {
+		return rule
+	}
+	rule.subtaskOf = make([]string, len(testcases))
+	for i, tc := range testcases {
+		rule.subtaskOf[i] = tc.SubtaskID
+	}
+	rule.stopOnFail = make(map[string]bool, len(subtaskIndex))
+	for id, state := range subtaskIndex {
+		rule.stopOnFail[id] = state.spec.StopOnFail
+	}
+	return rule
+}
+
+// skips reports whether a failure at index failed means index k must not run.
+func (r stopRule) skips(failed, k int) bool {
+	if k <= failed {
+		return false
+	}
+	if !r.perSubtask {
+		return true
+	}
+	subtaskID := r.subtaskOf[failed]
+	if subtaskID == "" {
+		return false
+	}
+	if r.stopOnFail[subtaskID] {
+		return true
+	}
+	return r.subtaskOf[k] == subtaskID
+}
+
+func (r stopRule) skipped(failures []int, k int) bool {
+	for _, failed := range failures {
+		if r.skips(failed, k) {
+			return true
+		}
+	}
+	return false
+}
+
+// testHistory counts past non-AC results per problem testcase so tests that
+// usually fail are tried first within their subtask.
+type testHistory struct {
+	mu       sync.Mutex
+	failures map[string]int
+}
+
+func newTestHistory() *testHistory {
+	return &testHistory{failures: make(map[string]int)}
+}
+
+func (h *testHistory) failureCount(problemID, testID string) int {
+	if h == nil || problemID == "" {
+		return 0
+	}
+	h.mu.Lock()
+	defer h.mu.Unlock()
+	return h.failures[problemID+"/"+testID]
+}
+
+func (h *testHistory) record(problemID string, tests []result.TestcaseResult) {
+	if h == nil || problemID == "" {
+		return
+	}
+	h.mu.Lock()
+	defer h.mu.Unlock()
+	for _, tc := range tests {
+		if tc.Verdict == result.VerdictAC {
+			continue
+		}
+		if len(h.failures) >= testHistoryMaxEntries {
+			h.failures = make(map[string]int)
+		}
+		h.failures[problemID+"/"+tc.TestID]++
+	}
+}
+
+// orderTestcases keeps subtasks in manifest order (by first appearance) and,
+// inside each subtask, runs historically failing tests first and then smaller
+// inputs, so a doomed subtask is detected with the least sandbox time. Without
+// subtasks the manifest order is kept because it defines the reported verdict.
+func orderTestcases(req JudgeRequest, history *testHistory) []TestcaseSpec {
+	if len(req.Subtasks) == 0 || len(req.Tests) <= 1 {
+		return req.Tests
+	}
+	type rankedTest struct {
+		tc        TestcaseSpec
+		group     int
+		failures  int
+		inputSize int64
+		index     int
+	}
+	groups := make(map[string]int)
+	ranked := make([]rankedTest, 0, len(req.Tests))
+	for i, tc := range req.Tests {
+		group := len(groups)
+		if tc.SubtaskID != "" {
+			if g, ok := groups[tc.SubtaskID]; ok {
+				group = g
+			} else {
+				groups[tc.SubtaskID] = group
+			}
+		} else {
+			groups["\x00"+tc.TestID] = group
+		}
+		ranked = append(ranked, rankedTest{
+			tc:        tc,
+			group:     group,
+			failures:  history.failureCount(req.ProblemID, tc.TestID),
+			inputSize: testInputSize(req.Data, tc.InputPath),
+			index:     i,
+		})
+	}
+	sort.SliceStable(ranked, func(i, j int) bool {
+		a, b := ranked[i], ranked[j]
+		if a.group != b.group {
+			return a.group < b.group
+		}
+		if a.failures != b.failures {
+			return a.failures > b.failures
+		}
+		if a.inputSize != b.inputSize {
+			return a.inputSize < b.inputSize
+		}
+		return a.index < b.index
+	})
+	ordered := make([]TestcaseSpec, 0, len(ranked))
+	for _, r := range ranked {
+		ordered = append(ordered, r.tc)
+	}
+	return ordered
+}
+
+// testInputSize prefers the size recorded by a lazy data pack, since ordering runs
+// before any testcase file is materialized.
+func testInputSize(data DataMaterializer, path string) int64 {
+	if data != nil {
+		if size, ok := data.Size(path); ok {
+			return size
+		}
+	}
+	if info, err := os.Stat(path); err == nil {
+		return info.Size()
+	}
+	return 0
+}
+
+// restoreManifestOrder sorts executed results back into req.Tests order.
+func restoreManifestOrder(req JudgeRequest, tests []result.TestcaseResult) {
+	if len(req.Subtasks) == 0 {
+		return
+	}
+	position := make(map[string]int, len(req.Tests))
+	for i, tc := range req.Tests {
+		position[tc.TestID] = i
+	}
+	sort.SliceStable(tests, func(i, j int) bool {
+		return position[tests[i].TestID] < position[tests[j].TestID]
+	})
+}
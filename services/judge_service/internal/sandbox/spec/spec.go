@@ -19,6 +19,11 @@ type MountSpec struct {
 }
 
 // RunSpec is the unified execution specification for one task.
+// CPUSet optionally pins the run to a cgroup cpuset list (e.g. "3" or "4-5").
+// StdoutMemfd captures stdout in an in-memory file owned by the engine instead
+// of StdoutPath (which stays the fallback for engines without support); the
+// engine enforces the output limit as it collects the output, and
+// RunResult.StdoutFile holds the capture.
 type RunSpec struct {
 	SubmissionID string
 	TestID       string
@@ -31,4 +36,6 @@ type RunSpec struct {
 	BindMounts   []MountSpec
 	Profile      string
 	Limits       ResourceLimit
+	CPUSet       string
+	StdoutMemfd  bool
 }
@@ -3,12 +3,13 @@ package sandbox
 
 import (
 	"context"
-	"io"
+	"errors"
 	"os"
 	"path/filepath"
 	"time"
 
 	appErr "fuzoj/pkg/errors"
+	"fuzoj/services/judge_service/internal/sandbox/compare"
 	"fuzoj/services/judge_service/internal/sandbox/config"
 	"fuzoj/services/judge_service/internal/sandbox/profile"
 	"fuzoj/services/judge_service/internal/sandbox/result"
@@ -27,6 +28,10 @@ type Worker struct {
 	langRepo       config.LanguageSpecRepository
 	profileRepo    config.TaskProfileRepository
 	statusReporter StatusReporter
+	parallelism    int
+	cpuSlots       chan string
+	history        *testHistory
+	compileCache   CompileCache
 }
 
 // NewWorker creates a new worker with required dependencies.
@@ -39,6 +44,7 @@ func NewWorker(
 		runner:      runner,
 		langRepo:    langRepo,
 		profileRepo: profileRepo,
+		history:     newTestHistory(),
 	}
 }
 
@@ -97,60 +103,81 @@ func (w *Worker) Execute(ctx context.Context, req JudgeRequest) (result.JudgeRes
 		if err := os.MkdirAll(compileDir, 0755); err != nil {
 			return resultBase, appErr.Wrapf(err, appErr.JudgeSystemError, "create compile workdir failed")
 		}
-		compileReq := runner.CompileRequest{
-			SubmissionID:      req.SubmissionID,
-			Language:          lang,
-			Profile:           compileProfile,
-			WorkDir:           compileDir,
-			SourcePath:        req.SourcePath,
-			ExtraCompileFlags: req.ExtraCompileFlags,
-			Limits:            spec.ResourceLimit{},
-		}
-		compileRes, compileErr := w.runner.Compile(ctx, compileReq)
-		resultBase.Compile = &compileRes
-		if compileErr != nil {
-			resultBase.Status = result.StatusFailed
-			resultBase.Verdict = result.VerdictSE
-			return resultBase, compileErr
+		binaryDst := filepath.Join(compileDir, lang.BinaryFile)
+		cacheKey := w.compileCacheKey(ctx, req, lang, compileProfile)
+		if w.lookupCompiled(ctx, cacheKey, binaryDst) {
+			resultBase.Compile = &result.CompileResult{OK: true}
+		} else {
+			compileReq := runner.CompileRequest{
+				SubmissionID:      req.SubmissionID,
+				Language:          lang,
+				Profile:           compileProfile,
+				WorkDir:           compileDir,
+				SourcePath:        req.SourcePath,
+				ExtraCompileFlags: req.ExtraCompileFlags,
+				Limits:            spec.ResourceLimit{},
+			}
+			compileRes, compileErr := w.runner.Compile(ctx, compileReq)
+			if err := canceledErr(ctx); err != nil {
+				return resultBase, err
+			}
+			resultBase.Compile = &compileRes
+			if compileErr != nil {
+				resultBase.Status = result.StatusFailed
+				resultBase.Verdict = result.VerdictSE
+				return resultBase, compileErr
+			}
+			if !compileRes.OK {
+				resultBase.Status = result.StatusFinished
+				resultBase.Verdict = result.VerdictCE
+				return resultBase, nil
+			}
+			w.storeCompiled(ctx, cacheKey, binaryDst)
 		}
-		if !compileRes.OK {
-			resultBase.Status = result.StatusFinished
-			resultBase.Verdict = result.VerdictCE
-			return resultBase, nil
+	}
+
+	// The compiled artifact is bind-mounted read-only into every test, so
+	// per-test workdirs only ever hold outputs and logs.
+	binaryPath := ""
+	if lang.CompileEnabled {
+		binaryPath, err = compiledBinaryPath(submissionRoot, lang.BinaryFile)
+		if err != nil {
+			return resultBase, err
 		}
 	}
 
 	w.reportStatus(ctx, req, result.StatusRunning, totalTests, doneTests)
 
-	testcases, subtaskIndex, err := prepareSubtasks(req)
+	testcases, subtaskIndex, err := prepareSubtasks(req, w.history)
 	if err != nil {
 		return resultBase, err
 	}
 
-	summary := result.SummaryStat{}
-	tests := make([]result.TestcaseResult, 0, len(testcases))
-	firstFailedTestID := ""
-	globalFailed := false
-
-	for _, tc := range testcases {
-		if globalFailed {
-			break
-		}
+	slots, releaseSlots, err := w.acquireSlots(ctx)
+	if err != nil {
+		return resultBase, err
+	}
+	defer releaseSlots()
 
+	runTestcase := func(ctx context.Context, tc TestcaseSpec, cpuSet string) (result.TestcaseResult, error) {
 		testWorkDir := filepath.Join(submissionRoot, tc.TestID)
 		if err := os.MkdirAll(testWorkDir, 0755); err != nil {
-			return resultBase, appErr.Wrapf(err, appErr.JudgeSystemError, "create test workdir failed")
+			return result.TestcaseResult{}, appErr.Wrapf(err, appErr.JudgeSystemError, "create test workdir failed")
 		}
 
-		if lang.CompileEnabled {
-			if err := copyBinary(submissionRoot, tc.TestID, lang.BinaryFile); err != nil {
-				return resultBase, err
+		if req.Data != nil {
+			paths := []string{tc.InputPath, tc.AnswerPath}
+			if tc.Checker != nil {
+				paths = append(paths, tc.Checker.BinaryPath)
+			}
+			if err := req.Data.Materialize(ctx, paths...); err != nil {
+				return result.TestcaseResult{}, appErr.Wrapf(err, appErr.JudgeSystemError, "materialize testcase data failed")
 			}
 		}
 
 		checkerSpec, checkerProfile, err := w.buildCheckerProfile(ctx, tc, req.LanguageID)
 		if err != nil {
-			return resultBase, err
+			return result.TestcaseResult{}, err
 		}
 
 		runReq := runner.RunRequest{
@@ -160,6 +187,7 @@ func (w *Worker) Execute(ctx context.Context, req JudgeRequest) (result.JudgeRes
 			Profile:           runProfile,
 			WorkDir:           testWorkDir,
 			SourcePath:        req.SourcePath,
+			BinaryPath:        binaryPath,
 			IOConfig:          runner.IOConfig(tc.IOConfig),
 			InputPath:         tc.InputPath,
 			AnswerPath:        tc.AnswerPath,
@@ -167,20 +195,32 @@ func (w *Worker) Execute(ctx context.Context, req JudgeRequest) (result.JudgeRes
 			Checker:           checkerSpec,
 			CheckerLanguageID: tc.CheckerLanguageID,
 			CheckerProfile:    checkerProfile,
+			CompareMode:       tc.CompareMode,
 			Score:             tc.Score,
 			SubtaskID:         tc.SubtaskID,
+			CPUSet:            cpuSet,
 		}
+		return w.runner.Run(ctx, runReq)
+	}
 
-		runRes, runErr := w.runner.Run(ctx, runReq)
-		if runErr != nil {
-			resultBase.Status = result.StatusFailed
-			resultBase.Verdict = result.VerdictSE
-			return resultBase, runErr
-		}
-
-		tests = append(tests, runRes)
+	tests, runErr := runTests(ctx, testcases, newStopRule(testcases, subtaskIndex), slots, runTestcase, func() {
 		doneTests++
 		w.reportStatus(ctx, req, result.StatusRunning, totalTests, doneTests)
+	})
+	if runErr != nil {
+		resultBase.Status = result.StatusFailed
+		resultBase.Verdict = result.VerdictSE
+		return resultBase, runErr
+	}
+	if err := canceledErr(ctx); err != nil {
+		return resultBase, err
+	}
+	w.history.record(req.ProblemID, tests)
+	restoreManifestOrder(req, tests)
+
+	summary := result.SummaryStat{}
+	firstFailedTestID := ""
+	for _, runRes := range tests {
 		summary.TotalTimeMs += runRes.TimeMs
 		if runRes.MemoryKB > summary.MaxMemoryKB {
 			summary.MaxMemoryKB = runRes.MemoryKB
@@ -190,7 +230,6 @@ func (w *Worker) Execute(ctx context.Context, req JudgeRequest) (result.JudgeRes
 
 		if runRes.Verdict != result.VerdictAC && firstFailedTestID == "" {
 			firstFailedTestID = runRes.TestID
-			globalFailed = true
 		}
 	}
 
@@ -211,6 +250,15 @@ func (w *Worker) Execute(ctx context.Context, req JudgeRequest) (result.JudgeRes
 	return resultBase, nil
 }
 
+// canceledErr reports a run whose context was canceled mid-way, e.g. by
+// preemption: its sandboxes were killed, so the verdicts it produced are void.
+func canceledErr(ctx context.Context) error {
+	if err := ctx.Err(); errors.Is(err, context.Canceled) {
+		return appErr.Wrapf(err, appErr.JudgeSystemError, "judge run canceled")
+	}
+	return nil
+}
+
 func (w *Worker) reportStatus(ctx context.Context, req JudgeRequest, status result.JudgeStatus, totalTests, doneTests int) {
 	if w.statusReporter == nil {
 		return
@@ -262,9 +310,14 @@ func validateJudgeRequest(req JudgeRequest) error {
 		if err := validateIOConfig(tc.IOConfig); err != nil {
 			return err
 		}
-		if tc.Checker != nil && tc.AnswerPath == "" {
+		if (tc.Checker != nil || tc.CompareMode != "") && tc.AnswerPath == "" {
 			return appErr.ValidationError("answer_path", "required")
 		}
+		if tc.Checker == nil && tc.CompareMode != "" {
+			if _, err := compare.ParseMode(tc.CompareMode); err != nil {
+				return appErr.Wrapf(err, appErr.InvalidParams, "invalid compare mode")
+			}
+		}
 	}
 	return nil
 }
@@ -285,7 +338,7 @@ func validateIOConfig(cfg IOConfig) error {
 	return nil
 }
 
-func prepareSubtasks(req JudgeRequest) ([]TestcaseSpec, map[string]*subtaskState, error) {
+func prepareSubtasks(req JudgeRequest, history *testHistory) ([]TestcaseSpec, map[string]*subtaskState, error) {
 	subtaskIndex := make(map[string]*subtaskState)
 	for _, st := range req.Subtasks {
 		strategy := st.Strategy
@@ -309,7 +362,7 @@ func prepareSubtasks(req JudgeRequest) ([]TestcaseSpec, map[string]*subtaskState
 		}
 		state.expected++
 	}
-	return req.Tests, subtaskIndex, nil
+	return orderTestcases(req, history), subtaskIndex, nil
 }
 
 func updateSubtaskState(subtaskIndex map[string]*subtaskState, res result.TestcaseResult) {
@@ -400,35 +453,17 @@ func (w *Worker) buildCheckerProfile(ctx context.Context, tc TestcaseSpec, defau
 	}, &checkerProfile, nil
 }
 
-func copyBinary(submissionRoot, testID, binaryName string) error {
+func compiledBinaryPath(submissionRoot, binaryName string) (string, error) {
 	if binaryName == "" {
-		return appErr.New(appErr.InvalidParams).WithMessage("binary file name is required")
-	}
-	src := filepath.Join(submissionRoot, "compile", binaryName)
-	dstDir := filepath.Join(submissionRoot, testID)
-	dst := filepath.Join(dstDir, binaryName)
-
-	if err := os.MkdirAll(dstDir, 0755); err != nil {
-		return appErr.Wrapf(err, appErr.JudgeSystemError, "create test workdir failed")
-	}
-
-	srcFile, err := os.Open(src)
-	if err != nil {
-		return appErr.Wrapf(err, appErr.JudgeSystemError, "open compiled binary failed")
+		return "", appErr.New(appErr.InvalidParams).WithMessage("binary file name is required")
 	}
-	defer srcFile.Close()
-
-	dstFile, err := os.Create(dst)
+	path := filepath.Join(submissionRoot, "compile", binaryName)
+	info, err := os.Stat(path)
 	if err != nil {
-		return appErr.Wrapf(err, appErr.JudgeSystemError, "create test binary failed")
+		return "", appErr.Wrapf(err, appErr.JudgeSystemError, "open compiled binary failed")
 	}
-	defer dstFile.Close()
-
-	if _, err := io.Copy(dstFile, srcFile); err != nil {
-		return appErr.Wrapf(err, appErr.JudgeSystemError, "copy compiled binary failed")
-	}
-	if err := dstFile.Chmod(0755); err != nil {
-		return appErr.Wrapf(err, appErr.JudgeSystemError, "chmod test binary failed")
+	if info.IsDir() {
+		return "", appErr.New(appErr.JudgeSystemError).WithMessage("compiled binary is a directory")
 	}
-	return nil
+	return path, nil
 }
@@ -0,0 +1,199 @@
+package sandbox
+
+import (
+	"context"
+
+	appErr "fuzoj/pkg/errors"
+	"fuzoj/services/judge_service/internal/sandbox/result"
+)
+
+// testRunFunc executes one testcase pinned to cpuSet ("" means unpinned).
+type testRunFunc func(ctx context.Context, tc TestcaseSpec, cpuSet string) (result.TestcaseResult, error)
+
+type testOutcome struct {
+	index int
+	res   result.TestcaseResult
+	err   error
+}
+
+// SetParallelism lets one submission run up to parallelism testcases at once.
+// When cpus is non-empty each concurrent run holds one entry (a cpuset list
+// such as "4" or "4-5") from a pool shared by every submission on this worker,
+// so a slot always owns its cores and timings stay comparable.
+func (w *Worker) SetParallelism(parallelism int, cpus []string) {
+	if parallelism < 1 {
+		parallelism = 1
+	}
+	w.parallelism = parallelism
+	w.cpuSlots = nil
+	if len(cpus) == 0 {
+		return
+	}
+	w.cpuSlots = make(chan string, len(cpus))
+	for _, cpu := range cpus {
+		w.cpuSlots <- cpu
+	}
+}
+
+// acquireSlots blocks for at least one slot and then takes as many more as are
+// free, up to the configured parallelism.
+func (w *Worker) acquireSlots(ctx context.Context) ([]string, func(), error) {
+	parallelism := w.parallelism
+	if parallelism < 1 {
+		parallelism = 1
+	}
+	if w.cpuSlots == nil {
+		return make([]string, parallelism), func() {}, nil
+	}
+	slots := make([]string, 0, parallelism)
+	select {
+	case slot := <-w.cpuSlots:
+		slots = append(slots, slot)
+	case <-ctx.Done():
+		return nil, func() {}, appErr.Wrapf(ctx.Err(), appErr.JudgeSystemError, "wait for cpu slot failed")
+	}
+fill:
+	for len(slots) < parallelism {
+		select {
+		case slot := <-w.cpuSlots:
+			slots = append(slots, slot)
+		default:
+			break fill
+		}
+	}
+	release := func() {
+		for _, slot := range slots {
+			w.cpuSlots <- slot
+		}
+	}
+	return slots, release, nil
+}
+
+// runTests executes testcases over the given slots and returns the results a
+// serial run in testcase order would produce under rule. onDone is called from
+// the calling goroutine after each completed test.
+func runTests(ctx context.Context, testcases []TestcaseSpec, rule stopRule, slots []string, run testRunFunc, onDone func()) ([]result.TestcaseResult, error) {
+	if len(slots) <= 1 || len(testcases) <= 1 {
+		cpuSet := ""
+		if len(slots) > 0 {
+			cpuSet = slots[0]
+		}
+		return runTestsSerial(ctx, testcases, rule, cpuSet, run, onDone)
+	}
+	return runTestsParallel(ctx, testcases, rule, slots, run, onDone)
+}
+
+func runTestsSerial(ctx context.Context, testcases []TestcaseSpec, rule stopRule, cpuSet string, run testRunFunc, onDone func()) ([]result.TestcaseResult, error) {
+	tests := make([]result.TestcaseResult, 0, len(testcases))
+	var failures []int
+	for i, tc := range testcases {
+		if rule.skipped(failures, i) {
+			continue
+		}
+		res, err := run(ctx, tc, cpuSet)
+		if err != nil {
+			return tests, err
+		}
+		tests = append(tests, res)
+		onDone()
+		if res.Verdict != result.VerdictAC {
+			failures = append(failures, i)
+		}
+	}
+	return tests, nil
+}
+
+// runTestsParallel dispatches testcases in order. A failure at i stops
+// dispatching and cancels in-flight runs that rule skips after i. Since skipping
+// only ever moves forward, the runs that complete are a superset of what a
+// serial run executes, and replaying the outcomes in order yields exactly the
+// serial result. An error cancels everything and is returned once all in-flight
+// runs have drained.
+func runTestsParallel(ctx context.Context, testcases []TestcaseSpec, rule stopRule, slots []string, run testRunFunc, onDone func()) ([]result.TestcaseResult, error) {
+	outcomes := make([]*testOutcome, len(testcases))
+	outCh := make(chan testOutcome, len(slots))
+	freeSlots := append([]string(nil), slots...)
+
+	cancels := make(map[int]context.CancelFunc, len(slots))
+	slotOf := make(map[int]string, len(slots))
+
+	var failures []int
+	var runErr error
+	dropped := func(k int) bool {
+		return runErr != nil || rule.skipped(failures, k)
+	}
+	next := 0
+	running := 0
+	for {
+		for running < len(slots) {
+			for next < len(testcases) && dropped(next) {
+				next++
+			}
+			if next >= len(testcases) {
+				break
+			}
+			slot := freeSlots[len(freeSlots)-1]
+			freeSlots = freeSlots[:len(freeSlots)-1]
+			runCtx, cancel := context.WithCancel(ctx)
+			cancels[next] = cancel
+			slotOf[next] = slot
+			go func(index int, tc TestcaseSpec, slot string) {
+				res, err := run(runCtx, tc, slot)
+				outCh <- testOutcome{index: index, res: res, err: err}
+			}(next, testcases[next], slot)
+			next++
+			running++
+		}
+		if running == 0 {
+			break
+		}
+
+		out := <-outCh
+		running--
+		freeSlots = append(freeSlots, slotOf[out.index])
+		delete(slotOf, out.index)
+		if cancel, ok := cancels[out.index]; ok {
+			cancel()
+			delete(cancels, out.index)
+		}
+		if dropped(out.index) {
+			continue
+		}
+		outcomes[out.index] = &out
+		if out.err != nil {
+			runErr = out.err
+		} else {
+			onDone()
+			if out.res.Verdict != result.VerdictAC {
+				failures = append(failures, out.index)
+			}
+		}
+		if out.err != nil || out.res.Verdict != result.VerdictAC {
+			for index, cancel := range cancels {
+				if dropped(index) {
+					cancel()
+				}
+			}
+		}
+	}
+
+	if runErr != nil {
+		return nil, runErr
+	}
+	tests := make([]result.TestcaseResult, 0, len(testcases))
+	var serialFailures []int
+	for i := range testcases {
+		if rule.skipped(serialFailures, i) {
+			continue
+		}
+		out := outcomes[i]
+		if out == nil {
+			return tests, appErr.New(appErr.JudgeSystemError).WithMessage("testcase result missing")
+		}
+		tests = append(tests, out.res)
+		if out.res.Verdict != result.VerdictAC {
+			serialFailures = append(serialFailures, i)
+		}
+	}
+	return tests, nil
+}
@@ -27,7 +27,9 @@ type ServiceContext struct {
 	StatusPublisher    repository.StatusEventPublisher
 	FinalStatusBatcher *repository.FinalStatusBatcher
 	StatusRepo         *repository.StatusRepository
+	ProgressReporter   *repository.ProgressReporter
 	Worker             *sandbox.Worker
+	Killer             judge_app.SubmissionKiller
 	ProblemClient      *problemclient.Client
 	JudgeApp           *judge_app.JudgeApp
 	DataCache          *cache.DataPackCache
@@ -12,16 +12,20 @@ import (
 	"fuzoj/internal/common/mq/weighted_kq"
 	"fuzoj/internal/common/storage"
 	"fuzoj/pkg/bootstrap"
+	"fuzoj/pkg/contest/prefetchpubsub"
 	"fuzoj/pkg/problem/metapubsub"
+	"fuzoj/pkg/submit/statusflow"
 	"fuzoj/pkg/submit/statuspubsub"
 	"fuzoj/services/judge_service/internal/cache"
 	"fuzoj/services/judge_service/internal/config"
 	"fuzoj/services/judge_service/internal/handler"
 	"fuzoj/services/judge_service/internal/logic"
 	"fuzoj/services/judge_service/internal/metainvalidation"
+	"fuzoj/services/judge_service/internal/prefetch"
 	"fuzoj/services/judge_service/internal/problemclient"
 	"fuzoj/services/judge_service/internal/repository"
 	"fuzoj/services/judge_service/internal/sandbox"
+	"fuzoj/services/judge_service/internal/sandbox/compilecache"
 	sbconfig "fuzoj/services/judge_service/internal/sandbox/config"
 	"fuzoj/services/judge_service/internal/sandbox/engine"
 	"fuzoj/services/judge_service/internal/sandbox/runner"
@@ -129,8 +133,27 @@ func main() {
 		return
 	}
 	jobRunner := runner.NewRunner(eng)
+	if c.Sandbox.PCHDir != "" {
+		pch, err := runner.NewPCHCache(c.Sandbox.PCHDir, eng)
+		if err != nil {
+			logx.Errorf("init pch cache failed: %v", err)
+			return
+		}
+		pch.Warm(context.Background(), c.Language.Languages, localRepo)
+		jobRunner = runner.NewRunnerWithPCH(eng, pch)
+	}
 	worker := sandbox.NewWorker(jobRunner, localRepo, localRepo)
+	worker.SetParallelism(c.Worker.TestParallelism, c.Worker.PinnedCPUs)
+	if c.CacheConfig.CompileRootDir != "" {
+		compileCache, err := compilecache.New(c.CacheConfig.CompileRootDir, c.CacheConfig.CompileMaxBytes)
+		if err != nil {
+			logx.Errorf("init compile cache failed: %v", err)
+			return
+		}
+		worker.SetCompileCache(compileCache)
+	}
 	ctx.Worker = worker
+	ctx.Killer = eng
 
 	if len(c.Kafka.Brokers) == 0 {
 		logx.Error("kafka brokers are required")
@@ -182,7 +205,16 @@ func main() {
 		c.StatusCacheEmptyTTL,
 		finalBatcher,
 	)
-	ctx.StatusRepo.SetStatusPubSub(statuspubsub.NewClient(c.Redis))
+	statusPubSub := statuspubsub.NewClient(c.Redis)
+	ctx.StatusRepo.SetStatusPubSub(statusPubSub)
+	progressReporter := repository.NewProgressReporter(
+		statusflow.NewUpdater(ctx.StatusCache, statusPubSub, c.StatusCacheTTL),
+		c.Status.ProgressInterval,
+		c.Status.Timeout,
+	)
+	progressReporter.Start()
+	defer progressReporter.Stop()
+	ctx.ProgressReporter = progressReporter
 
 	dataCache := cache.NewDataPackCache(
 		c.CacheConfig.RootDir,
@@ -194,6 +226,18 @@ func main() {
 		objStorage,
 		ctx.StatusCache,
 	)
+	dataCache.SetDownloadOptions(cache.DownloadOptions{
+		Parallelism:    c.CacheConfig.DownloadParallelism,
+		ChunkBytes:     c.CacheConfig.DownloadChunkBytes,
+		ExtractWorkers: c.CacheConfig.ExtractWorkers,
+		Lazy:           c.CacheConfig.LazyDataPack,
+	})
+	dataCache.SetPeerOptions(cache.PeerOptions{
+		Addr:    c.CacheConfig.PeerAddr,
+		Zone:    c.CacheConfig.PeerZone,
+		Secret:  c.CacheConfig.PeerSecret,
+		Timeout: c.CacheConfig.PeerTimeout,
+	})
 	ctx.DataCache = dataCache
 	ctx.Storage = objStorage
 
@@ -216,8 +260,15 @@ func main() {
 	metaSub.Start(context.Background())
 	defer metaSub.Stop()
 
+	prefetchSub := prefetch.NewSubscriber(prefetchpubsub.NewClient(c.Redis), ctx.JudgeApp)
+	prefetchSub.Start(context.Background())
+	defer prefetchSub.Stop()
+
 	go startConsumerLoop(ctx, &c)
 	handler.RegisterHandlers(server, ctx)
+	if ctx.DataCache.PeerEnabled() {
+		handler.RegisterPeerHandlers(server, ctx, ctx.DataCache.PeerTimeout())
+	}
 
 	logx.Infof("starting server at %s:%d...", c.Host, c.Port)
 	server.Start()
@@ -246,10 +297,18 @@ func startConsumerLoop(ctx *svc.ServiceContext, c *config.Config) {
 			continue
 		}
 		logx.Infof("judge consumer config topics=%v group=%s brokers=%v", c.Kafka.Topics, c.Kafka.ConsumerGroup, c.Kafka.Brokers)
+		waitTargets := make(map[string]time.Duration, len(c.Kafka.WaitTargetsMs))
+		for topic, ms := range c.Kafka.WaitTargetsMs {
+			if ms > 0 {
+				waitTargets[topic] = time.Duration(ms) * time.Millisecond
+			}
+		}
 		queueGroup, err := weighted_kq.NewWeightedKqQueuesWithPolicy(confs, consumer, weighted_kq.WeightedQueuePolicy{
 			TopicWeights:     c.Kafka.TopicWeights,
 			RetryTopic:       c.Kafka.RetryTopic,
 			RetryMaxInFlight: c.Kafka.RetryMaxInFlight,
+			Cost:             consumer.EstimateCost,
+			WaitTargets:      waitTargets,
 		})
 		if err != nil {
 			logx.Errorf("init kq consumers failed: %v", err)
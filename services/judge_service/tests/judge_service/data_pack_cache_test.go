@@ -0,0 +1,565 @@
+package judge_service
+
+import (
+	"archive/tar"
+	"bytes"
+	"context"
+	"crypto/sha256"
+	"encoding/hex"
+	"errors"
+	"fmt"
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"os"
+	"path/filepath"
+	"strconv"
+	"strings"
+	"sync/atomic"
+	"testing"
+	"time"
+
+	"fuzoj/internal/common/storage"
+	"fuzoj/pkg/problem/seekpack"
+	"fuzoj/services/judge_service/internal/cache"
+	"fuzoj/services/judge_service/internal/pmodel"
+
+	"github.com/klauspost/compress/zstd"
+)
+
+type packStorage struct {
+	data        []byte
+	seekable    []byte
+	rangeCalls  atomic.Int32
+	objectCalls atomic.Int32
+}
+
+func (s *packStorage) object(objectKey string) ([]byte, error) {
+	if strings.HasSuffix(objectKey, seekpack.ObjectSuffix) {
+		if s.seekable == nil {
+			return nil, errors.New("object not found")
+		}
+		return s.seekable, nil
+	}
+	return s.data, nil
+}
+
+func (s *packStorage) GetObject(ctx context.Context, bucket, objectKey string) (storage.ObjectReader, error) {
+	s.objectCalls.Add(1)
+	data, err := s.object(objectKey)
+	if err != nil {
+		return nil, err
+	}
+	return io.NopCloser(bytes.NewReader(data)), nil
+}
+
+func (s *packStorage) GetObjectRange(ctx context.Context, bucket, objectKey string, offset, length int64) (storage.ObjectReader, error) {
+	s.rangeCalls.Add(1)
+	data, err := s.object(objectKey)
+	if err != nil {
+		return nil, err
+	}
+	end := int64(len(data))
+	if length > 0 && offset+length < end {
+		end = offset + length
+	}
+	return io.NopCloser(bytes.NewReader(data[offset:end])), nil
+}
+
+func (s *packStorage) PutObject(ctx context.Context, bucket, objectKey string, reader storage.ObjectReader, sizeBytes int64, contentType string) error {
+	return errors.New("not implemented")
+}
+
+func (s *packStorage) CreateMultipartUpload(ctx context.Context, bucket, objectKey, contentType string) (string, error) {
+	return "", errors.New("not implemented")
+}
+
+func (s *packStorage) PresignUploadPart(ctx context.Context, bucket, objectKey, uploadID string, partNumber int, ttl time.Duration, contentType string) (string, error) {
+	return "", errors.New("not implemented")
+}
+
+func (s *packStorage) CompleteMultipartUpload(ctx context.Context, bucket, objectKey, uploadID string, parts []storage.CompletedPart) (string, error) {
+	return "", errors.New("not implemented")
+}
+
+func (s *packStorage) AbortMultipartUpload(ctx context.Context, bucket, objectKey, uploadID string) error {
+	return errors.New("not implemented")
+}
+
+func (s *packStorage) StatObject(ctx context.Context, bucket, objectKey string) (storage.ObjectStat, error) {
+	data, err := s.object(objectKey)
+	if err != nil {
+		return storage.ObjectStat{}, err
+	}
+	return storage.ObjectStat{SizeBytes: int64(len(data))}, nil
+}
+
+func (s *packStorage) ListObjects(ctx context.Context, bucket, prefix string) <-chan storage.ObjectInfo {
+	ch := make(chan storage.ObjectInfo)
+	close(ch)
+	return ch
+}
+
+func (s *packStorage) RemoveObjects(ctx context.Context, bucket string, keys []string) error {
+	return errors.New("not implemented")
+}
+
+func (s *packStorage) ListMultipartUploads(ctx context.Context, bucket, prefix, keyMarker, uploadIDMarker string, maxUploads int) (storage.ListMultipartUploadsResult, error) {
+	return storage.ListMultipartUploadsResult{}, errors.New("not implemented")
+}
+
+func buildDataPack(t *testing.T, files map[string][]byte) ([]byte, string) {
+	t.Helper()
+	var buf bytes.Buffer
+	zw, err := zstd.NewWriter(&buf)
+	if err != nil {
+		t.Fatalf("create zstd writer: %v", err)
+	}
+	tw := tar.NewWriter(zw)
+	for name, content := range files {
+		if err := tw.WriteHeader(&tar.Header{Name: name, Mode: 0644, Size: int64(len(content)), Typeflag: tar.TypeReg}); err != nil {
+			t.Fatalf("write tar header: %v", err)
+		}
+		if _, err := tw.Write(content); err != nil {
+			t.Fatalf("write tar body: %v", err)
+		}
+	}
+	if err := tw.Close(); err != nil {
+		t.Fatalf("close tar: %v", err)
+	}
+	if err := zw.Close(); err != nil {
+		t.Fatalf("close zstd: %v", err)
+	}
+	sum := sha256.Sum256(buf.Bytes())
+	return buf.Bytes(), hex.EncodeToString(sum[:])
+}
+
+func TestDataPackCacheStreamsRangedDownload(t *testing.T) {
+	big := bytes.Repeat([]byte("0123456789abcdef"), 8<<16)
+	files := map[string][]byte{
+		"manifest.json":     []byte(`{"tests":[]}`),
+		"config.json":       []byte(`{}`),
+		"tests/1/input.txt": []byte("1 2\n"),
+		"tests/1/big.txt":   big,
+	}
+	pack, hash := buildDataPack(t, files)
+	store := &packStorage{data: pack}
+	root := t.TempDir()
+	dataCache := cache.NewDataPackCache(root, time.Minute, time.Second, 8, 0, "bucket", store, newFakeCache(t))
+	dataCache.SetDownloadOptions(cache.DownloadOptions{Parallelism: 3, ChunkBytes: 4096, ExtractWorkers: 2})
+
+	meta := pmodel.ProblemMeta{ProblemID: 7, Version: 1, DataPackKey: "pack", DataPackHash: hash}
+	path, err := dataCache.Get(context.Background(), meta)
+	if err != nil {
+		t.Fatalf("get data pack: %v", err)
+	}
+	for name, want := range files {
+		got, err := os.ReadFile(filepath.Join(path, name))
+		if err != nil {
+			t.Fatalf("read %s: %v", name, err)
+		}
+		if !bytes.Equal(got, want) {
+			t.Fatalf("content mismatch for %s", name)
+		}
+	}
+	if store.rangeCalls.Load() < 2 || store.objectCalls.Load() != 0 {
+		t.Fatalf("expected ranged download, got range=%d object=%d", store.rangeCalls.Load(), store.objectCalls.Load())
+	}
+	if _, err := os.Stat(filepath.Join(path, "data-pack.tmp")); !os.IsNotExist(err) {
+		t.Fatalf("expected no temp pack file, got err=%v", err)
+	}
+}
+
+func TestDataPackCacheHashMismatchRemovesDir(t *testing.T) {
+	pack, _ := buildDataPack(t, map[string][]byte{"manifest.json": []byte(`{}`)})
+	store := &packStorage{data: pack}
+	root := t.TempDir()
+	dataCache := cache.NewDataPackCache(root, time.Minute, time.Second, 8, 0, "bucket", store, newFakeCache(t))
+
+	meta := pmodel.ProblemMeta{ProblemID: 7, Version: 2, DataPackKey: "pack", DataPackHash: "deadbeef"}
+	if _, err := dataCache.Get(context.Background(), meta); err == nil {
+		t.Fatalf("expected hash mismatch error")
+	}
+	if _, err := os.Stat(filepath.Join(root, "7", "2")); !os.IsNotExist(err) {
+		t.Fatalf("expected version dir removed, got err=%v", err)
+	}
+}
+
+func TestDataPackCacheLazyMaterializesOnDemand(t *testing.T) {
+	files := map[string][]byte{
+		"manifest.json":      []byte(`{"tests":[]}`),
+		"config.json":        []byte(`{}`),
+		"tests/1/input.txt":  []byte("1 2\n"),
+		"tests/2/input.txt":  []byte("3 4\n"),
+		"tests/2/answer.txt": []byte("7\n"),
+	}
+	pack, hash := buildDataPack(t, files)
+	var seekable bytes.Buffer
+	if _, _, err := seekpack.Build(bytes.NewReader(pack), &seekable); err != nil {
+		t.Fatalf("build seekable pack: %v", err)
+	}
+	store := &packStorage{data: pack, seekable: seekable.Bytes()}
+	root := t.TempDir()
+	dataCache := cache.NewDataPackCache(root, time.Minute, time.Second, 8, 0, "bucket", store, newFakeCache(t))
+	dataCache.SetDownloadOptions(cache.DownloadOptions{Lazy: true})
+
+	meta := pmodel.ProblemMeta{ProblemID: 9, Version: 1, DataPackKey: "pack", DataPackHash: hash}
+	path, err := dataCache.Get(context.Background(), meta)
+	if err != nil {
+		t.Fatalf("get data pack: %v", err)
+	}
+	if store.objectCalls.Load() != 0 {
+		t.Fatalf("expected no full download, got %d", store.objectCalls.Load())
+	}
+	for _, name := range []string{"manifest.json", "config.json"} {
+		if _, err := os.Stat(filepath.Join(path, name)); err != nil {
+			t.Fatalf("expected %s materialized: %v", name, err)
+		}
+	}
+	if _, err := os.Stat(filepath.Join(path, "tests/2/input.txt")); !os.IsNotExist(err) {
+		t.Fatalf("expected tests/2 not fetched yet, got err=%v", err)
+	}
+
+	lazy := dataCache.Materializer(meta, path)
+	if lazy == nil {
+		t.Fatalf("expected lazy materializer")
+	}
+	input := filepath.Join(path, "tests/2/input.txt")
+	answer := filepath.Join(path, "tests/2/answer.txt")
+	if size, ok := lazy.Size(input); !ok || size != int64(len(files["tests/2/input.txt"])) {
+		t.Fatalf("expected indexed size of unfetched input, got %d ok=%v", size, ok)
+	}
+	if _, ok := lazy.Size(filepath.Join(root, "elsewhere.txt")); ok {
+		t.Fatalf("expected no size outside the version dir")
+	}
+	if err := lazy.Materialize(context.Background(), input, answer); err != nil {
+		t.Fatalf("materialize: %v", err)
+	}
+	for name, target := range map[string]string{"tests/2/input.txt": input, "tests/2/answer.txt": answer} {
+		got, err := os.ReadFile(target)
+		if err != nil || !bytes.Equal(got, files[name]) {
+			t.Fatalf("content mismatch for %s err=%v", name, err)
+		}
+	}
+	if _, err := os.Stat(filepath.Join(path, "tests/1/input.txt")); !os.IsNotExist(err) {
+		t.Fatalf("expected tests/1 never fetched, got err=%v", err)
+	}
+}
+
+func TestDataPackCacheLazyFallsBackWithoutSeekable(t *testing.T) {
+	pack, hash := buildDataPack(t, map[string][]byte{"manifest.json": []byte(`{}`), "tests/1/input.txt": []byte("1\n")})
+	store := &packStorage{data: pack}
+	root := t.TempDir()
+	dataCache := cache.NewDataPackCache(root, time.Minute, time.Second, 8, 0, "bucket", store, newFakeCache(t))
+	dataCache.SetDownloadOptions(cache.DownloadOptions{Lazy: true})
+
+	meta := pmodel.ProblemMeta{ProblemID: 9, Version: 2, DataPackKey: "pack", DataPackHash: hash}
+	path, err := dataCache.Get(context.Background(), meta)
+	if err != nil {
+		t.Fatalf("get data pack: %v", err)
+	}
+	if _, err := os.Stat(filepath.Join(path, "tests/1/input.txt")); err != nil {
+		t.Fatalf("expected full extraction: %v", err)
+	}
+	if dataCache.Materializer(meta, path) != nil {
+		t.Fatalf("expected no materializer for fully extracted version")
+	}
+}
+
+func TestDataPackCacheOneOffMissesKeepHotVersions(t *testing.T) {
+	pack, hash := buildDataPack(t, map[string][]byte{"manifest.json": []byte(`{}`)})
+	store := &packStorage{data: pack}
+	root := t.TempDir()
+	// 16 entries: a window of 1 and a main segment of 15.
+	dataCache := cache.NewDataPackCache(root, time.Minute, time.Second, 16, 0, "bucket", store, newFakeCache(t))
+	ctx := context.Background()
+	get := func(problemID int64) {
+		t.Helper()
+		meta := pmodel.ProblemMeta{ProblemID: problemID, Version: 1, DataPackKey: "pack", DataPackHash: hash}
+		if _, err := dataCache.Get(ctx, meta); err != nil {
+			t.Fatalf("get %d: %v", problemID, err)
+		}
+	}
+	for id := int64(1); id <= 14; id++ {
+		for i := 0; i < 3; i++ {
+			get(id)
+		}
+	}
+	for id := int64(100); id < 130; id++ {
+		get(id)
+	}
+	for id := int64(1); id <= 14; id++ {
+		if _, err := os.Stat(filepath.Join(root, fmt.Sprintf("%d", id), "1")); err != nil {
+			t.Fatalf("hot version %d was evicted: %v", id, err)
+		}
+	}
+	// 100 still fits in main; every later one-off loses admission to the hot set.
+	evicted := 0
+	for id := int64(101); id < 129; id++ {
+		if _, err := os.Stat(filepath.Join(root, fmt.Sprintf("%d", id), "1")); os.IsNotExist(err) {
+			evicted++
+		}
+	}
+	if evicted != 28 {
+		t.Fatalf("expected one-off versions to be evicted, got %d", evicted)
+	}
+}
+
+func TestDataPackCachePinnedVersionSurvivesEvictionAndTTL(t *testing.T) {
+	pack, hash := buildDataPack(t, map[string][]byte{"manifest.json": []byte(`{}`)})
+	store := &packStorage{data: pack}
+	root := t.TempDir()
+	dataCache := cache.NewDataPackCache(root, 50*time.Millisecond, time.Second, 4, 0, "bucket", store, newFakeCache(t))
+	ctx := context.Background()
+	metaOf := func(problemID int64) pmodel.ProblemMeta {
+		return pmodel.ProblemMeta{ProblemID: problemID, Version: 1, DataPackKey: "pack", DataPackHash: hash}
+	}
+
+	pinned := metaOf(1)
+	if _, err := dataCache.Get(ctx, pinned); err != nil {
+		t.Fatalf("get pinned: %v", err)
+	}
+	if !dataCache.Pin(pinned, time.Now().Add(time.Hour)) {
+		t.Fatalf("expected pin to succeed")
+	}
+	for id := int64(2); id <= 9; id++ {
+		for i := 0; i < 3; i++ {
+			if _, err := dataCache.Get(ctx, metaOf(id)); err != nil {
+				t.Fatalf("get %d: %v", id, err)
+			}
+		}
+	}
+	if _, err := os.Stat(filepath.Join(root, "1", "1")); err != nil {
+		t.Fatalf("pinned version was evicted: %v", err)
+	}
+
+	time.Sleep(100 * time.Millisecond)
+	reads := store.objectCalls.Load() + store.rangeCalls.Load()
+	if _, err := dataCache.Get(ctx, pinned); err != nil {
+		t.Fatalf("get pinned after ttl: %v", err)
+	}
+	if after := store.objectCalls.Load() + store.rangeCalls.Load(); after != reads {
+		t.Fatalf("expected pinned version to outlive ttl without refetch")
+	}
+	if dataCache.Pin(metaOf(42), time.Now().Add(time.Hour)) {
+		t.Fatalf("expected pin of uncached version to fail")
+	}
+}
+
+func TestDataPackCacheKeepsLeasedVersionUntilRelease(t *testing.T) {
+	pack, hash := buildDataPack(t, map[string][]byte{"manifest.json": []byte(`{}`)})
+	store := &packStorage{data: pack}
+	root := t.TempDir()
+	dataCache := cache.NewDataPackCache(root, time.Minute, time.Second, 4, 0, "bucket", store, newFakeCache(t))
+	ctx := context.Background()
+	metaOf := func(problemID int64) pmodel.ProblemMeta {
+		return pmodel.ProblemMeta{ProblemID: problemID, Version: 1, DataPackKey: "pack", DataPackHash: hash}
+	}
+
+	held, release, err := dataCache.Acquire(ctx, metaOf(1))
+	if err != nil {
+		t.Fatalf("acquire: %v", err)
+	}
+	for id := int64(2); id <= 9; id++ {
+		for i := 0; i < 3; i++ {
+			if _, err := dataCache.Get(ctx, metaOf(id)); err != nil {
+				t.Fatalf("get %d: %v", id, err)
+			}
+		}
+	}
+	if dataCache.Pin(metaOf(1), time.Now().Add(time.Hour)) {
+		t.Fatalf("expected leased version to be evicted from the cache budget")
+	}
+	if _, err := os.Stat(filepath.Join(held, "manifest.json")); err != nil {
+		t.Fatalf("leased version was deleted while held: %v", err)
+	}
+
+	release()
+	release()
+	if _, err := os.Stat(held); !os.IsNotExist(err) {
+		t.Fatalf("expected evicted version to be deleted on release, got err=%v", err)
+	}
+}
+
+func TestDataPackCacheFetchesFromPeer(t *testing.T) {
+	files := map[string][]byte{
+		"manifest.json":      []byte(`{"tests":[]}`),
+		"config.json":        []byte(`{}`),
+		"tests/1/input.txt":  []byte("1 2\n"),
+		"tests/1/answer.txt": []byte("3\n"),
+	}
+	pack, hash := buildDataPack(t, files)
+	store := &packStorage{data: pack}
+	redisClient := newFakeCache(t)
+
+	var seeder *cache.DataPackCache
+	var served atomic.Int32
+	srv := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		parts := strings.Split(strings.TrimPrefix(r.URL.Path, cache.PeerRoutePath+"/"), "/")
+		if len(parts) != 2 {
+			http.NotFound(w, r)
+			return
+		}
+		if !seeder.AuthorizePeer(r.Header.Get(cache.PeerTokenHeader)) {
+			http.Error(w, "forbidden", http.StatusForbidden)
+			return
+		}
+		problemID, _ := strconv.ParseInt(parts[0], 10, 64)
+		version, _ := strconv.ParseInt(parts[1], 10, 32)
+		served.Add(1)
+		if err := seeder.ServePeer(r.Context(), w, problemID, int32(version), r.URL.Query().Get("hash")); err != nil {
+			http.Error(w, err.Error(), http.StatusNotFound)
+		}
+	}))
+	defer srv.Close()
+
+	seeder = cache.NewDataPackCache(t.TempDir(), time.Minute, time.Second, 8, 0, "bucket", store, redisClient)
+	seeder.SetPeerOptions(cache.PeerOptions{Addr: srv.Listener.Addr().String(), Zone: "a", Secret: "s3cret"})
+	fetcher := cache.NewDataPackCache(t.TempDir(), time.Minute, time.Second, 8, 0, "bucket", store, redisClient)
+	fetcher.SetPeerOptions(cache.PeerOptions{Addr: "127.0.0.1:1", Zone: "a", Secret: "s3cret"})
+	if seeder.AuthorizePeer("wrong") || seeder.AuthorizePeer("") {
+		t.Fatalf("expected peer token mismatch to be rejected")
+	}
+
+	meta := pmodel.ProblemMeta{ProblemID: 9, Version: 2, DataPackKey: "pack", DataPackHash: hash}
+	if _, err := seeder.Get(context.Background(), meta); err != nil {
+		t.Fatalf("seed data pack: %v", err)
+	}
+	pulls := store.objectCalls.Load() + store.rangeCalls.Load()
+
+	path, err := fetcher.Get(context.Background(), meta)
+	if err != nil {
+		t.Fatalf("get data pack from peer: %v", err)
+	}
+	for name, want := range files {
+		got, err := os.ReadFile(filepath.Join(path, name))
+		if err != nil {
+			t.Fatalf("read %s: %v", name, err)
+		}
+		if !bytes.Equal(got, want) {
+			t.Fatalf("content mismatch for %s", name)
+		}
+	}
+	if served.Load() != 1 {
+		t.Fatalf("expected one peer transfer, got %d", served.Load())
+	}
+	if after := store.objectCalls.Load() + store.rangeCalls.Load(); after != pulls {
+		t.Fatalf("expected no storage reads after seeding, got %d extra", after-pulls)
+	}
+
+	stale := meta
+	stale.DataPackHash = strings.Repeat("0", len(hash))
+	var buf bytes.Buffer
+	if err := seeder.ServePeer(context.Background(), &buf, stale.ProblemID, stale.Version, stale.DataPackHash); err == nil {
+		t.Fatalf("expected stale hash to be rejected")
+	}
+}
+
+func TestDataPackCacheRejectsTamperedPeerPack(t *testing.T) {
+	files := map[string][]byte{
+		"manifest.json":      []byte(`{"tests":[]}`),
+		"tests/1/answer.txt": []byte("3\n"),
+	}
+	pack, hash := buildDataPack(t, files)
+	forged, _ := buildDataPack(t, map[string][]byte{
+		"manifest.json":      []byte(`{"tests":[]}`),
+		"tests/1/answer.txt": []byte("4\n"),
+	})
+	store := &packStorage{data: pack}
+	redisClient := newFakeCache(t)
+
+	var served atomic.Int32
+	srv := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		served.Add(1)
+		_, _ = w.Write(forged)
+	}))
+	defer srv.Close()
+
+	meta := pmodel.ProblemMeta{ProblemID: 11, Version: 1, DataPackKey: "pack", DataPackHash: hash}
+	key := fmt.Sprintf("judge:datapack:peers:%d:%d:%s", meta.ProblemID, meta.Version, meta.DataPackHash)
+	if _, err := redisClient.Sadd(key, "a|"+srv.Listener.Addr().String()); err != nil {
+		t.Fatalf("advertise fake peer: %v", err)
+	}
+	fetcher := cache.NewDataPackCache(t.TempDir(), time.Minute, time.Second, 8, 0, "bucket", store, redisClient)
+	fetcher.SetPeerOptions(cache.PeerOptions{Addr: "127.0.0.1:1", Zone: "a", Secret: "s3cret"})
+
+	path, err := fetcher.Get(context.Background(), meta)
+	if err != nil {
+		t.Fatalf("get data pack: %v", err)
+	}
+	if served.Load() == 0 {
+		t.Fatalf("expected fake peer to be tried")
+	}
+	if store.objectCalls.Load()+store.rangeCalls.Load() == 0 {
+		t.Fatalf("expected fallback to storage after peer hash mismatch")
+	}
+	got, err := os.ReadFile(filepath.Join(path, "tests/1/answer.txt"))
+	if err != nil {
+		t.Fatalf("read answer: %v", err)
+	}
+	if string(got) != "3\n" {
+		t.Fatalf("expected storage content, got %q", got)
+	}
+}
+
+func TestDataPackCacheWaitsForSlowLockHolder(t *testing.T) {
+	files := map[string][]byte{
+		"manifest.json":      []byte(`{"tests":[]}`),
+		"tests/1/answer.txt": []byte("3\n"),
+	}
+	pack, hash := buildDataPack(t, files)
+	store := &packStorage{data: pack}
+	redisClient := newFakeCache(t)
+
+	meta := pmodel.ProblemMeta{ProblemID: 12, Version: 1, DataPackKey: "pack", DataPackHash: hash}
+	lockKey := fmt.Sprintf("judge:datapack:lock:%d:%d", meta.ProblemID, meta.Version)
+	if err := redisClient.Setex(lockKey, "other-node", 300); err != nil {
+		t.Fatalf("hold lock: %v", err)
+	}
+	fetcher := cache.NewDataPackCache(t.TempDir(), time.Minute, 50*time.Millisecond, 8, 0, "bucket", store, redisClient)
+	fetcher.SetPeerOptions(cache.PeerOptions{Addr: "127.0.0.1:1", Zone: "a", Secret: "s3cret"})
+
+	type result struct {
+		path string
+		err  error
+	}
+	done := make(chan result, 1)
+	go func() {
+		path, err := fetcher.Get(context.Background(), meta)
+		done <- result{path: path, err: err}
+	}()
+
+	// Several lockWait rounds pass while the holder is still alive.
+	select {
+	case res := <-done:
+		t.Fatalf("expected Get to wait for the lock holder, got path=%q err=%v", res.path, res.err)
+	case <-time.After(700 * time.Millisecond):
+	}
+	if calls := store.objectCalls.Load() + store.rangeCalls.Load(); calls != 0 {
+		t.Fatalf("expected no storage reads while the lock is held, got %d", calls)
+	}
+
+	// The holder is gone: the waiter takes the lock and fills from storage.
+	if _, err := redisClient.Del(lockKey); err != nil {
+		t.Fatalf("drop lock: %v", err)
+	}
+	var res result
+	select {
+	case res = <-done:
+	case <-time.After(5 * time.Second):
+		t.Fatalf("expected Get to finish after the holder released the lock")
+	}
+	if res.err != nil {
+		t.Fatalf("get data pack: %v", res.err)
+	}
+	if store.objectCalls.Load()+store.rangeCalls.Load() == 0 {
+		t.Fatalf("expected storage fill once the lock was free")
+	}
+	got, err := os.ReadFile(filepath.Join(res.path, "tests/1/answer.txt"))
+	if err != nil {
+		t.Fatalf("read answer: %v", err)
+	}
+	if string(got) != "3\n" {
+		t.Fatalf("expected storage content, got %q", got)
+	}
+}
@@ -0,0 +1,79 @@
+package sandbox_test
+
+import (
+	"errors"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	"fuzoj/services/judge_service/internal/sandbox/compare"
+)
+
+func TestCompareFilesModes(t *testing.T) {
+	long := strings.Repeat("1234567 ", 64)
+	cases := []struct {
+		name      string
+		mode      compare.Mode
+		output    string
+		answer    string
+		wantEqual bool
+		wantMsg   string
+	}{
+		{name: "token equal", mode: compare.ModeToken, output: "1  2\n3\n\n", answer: "1 2 3", wantEqual: true},
+		{name: "token long equal", mode: compare.ModeToken, output: long + "\n", answer: strings.ReplaceAll(long, " ", "\n"), wantEqual: true},
+		{name: "token differs", mode: compare.ModeToken, output: "1 2 4", answer: "1 2 3", wantMsg: `token #3 differs: expected "3" got "4"`},
+		{name: "token prefix", mode: compare.ModeToken, output: "1 2 3", answer: "1 2 34", wantMsg: "token #3 differs"},
+		{name: "token short", mode: compare.ModeToken, output: "1 2", answer: "1 2 3", wantMsg: "output ended early at token #3"},
+		{name: "token extra", mode: compare.ModeToken, output: long + "9", answer: long, wantMsg: "extra output at token #65"},
+		{name: "token empty", mode: compare.ModeToken, output: "", answer: " \n", wantEqual: true},
+		{name: "line equal", mode: compare.ModeLine, output: "a b \r\nc\n\n\n", answer: "a b\nc", wantEqual: true},
+		{name: "line spacing", mode: compare.ModeLine, output: "a  b\n", answer: "a b\n", wantMsg: "line 1 differs"},
+		{name: "line blank inside", mode: compare.ModeLine, output: "a\n\nb\n", answer: "a\nb\n", wantMsg: "line 2 differs"},
+		{name: "line short", mode: compare.ModeLine, output: "a\n", answer: "a\nb\n", wantMsg: "output ended early at line 2"},
+		{name: "exact equal", mode: compare.ModeExact, output: long, answer: long, wantEqual: true},
+		{name: "exact differs", mode: compare.ModeExact, output: long + "x", answer: long + "y", wantMsg: "byte 512 differs"},
+		{name: "exact newline", mode: compare.ModeExact, output: "3\n", answer: "3", wantMsg: "extra output at byte 1"},
+	}
+
+	for _, tc := range cases {
+		t.Run(tc.name, func(t *testing.T) {
+			dir := t.TempDir()
+			outputPath := filepath.Join(dir, "output.txt")
+			answerPath := filepath.Join(dir, "answer.txt")
+			if err := os.WriteFile(outputPath, []byte(tc.output), 0644); err != nil {
+				t.Fatalf("write output: %v", err)
+			}
+			if err := os.WriteFile(answerPath, []byte(tc.answer), 0644); err != nil {
+				t.Fatalf("write answer: %v", err)
+			}
+			res, err := compare.Files(outputPath, answerPath, tc.mode)
+			if err != nil {
+				t.Fatalf("compare failed: %v", err)
+			}
+			if res.Equal != tc.wantEqual {
+				t.Fatalf("expected equal=%v, got %v (%s)", tc.wantEqual, res.Equal, res.Message)
+			}
+			if !strings.HasPrefix(res.Message, tc.wantMsg) {
+				t.Fatalf("unexpected message: %q", res.Message)
+			}
+		})
+	}
+}
+
+func TestCompareFilesMissingOutput(t *testing.T) {
+	dir := t.TempDir()
+	answerPath := filepath.Join(dir, "answer.txt")
+	if err := os.WriteFile(answerPath, []byte("1"), 0644); err != nil {
+		t.Fatalf("write answer: %v", err)
+	}
+	if _, err := compare.Files(filepath.Join(dir, "missing.txt"), answerPath, compare.ModeToken); !errors.Is(err, compare.ErrOutputNotFound) {
+		t.Fatalf("expected ErrOutputNotFound for missing output, got %v", err)
+	}
+	if _, err := compare.Files(answerPath, filepath.Join(dir, "missing-answer.txt"), compare.ModeToken); err == nil || errors.Is(err, compare.ErrOutputNotFound) {
+		t.Fatalf("expected a system error for missing answer, got %v", err)
+	}
+	if _, err := compare.ParseMode("fuzzy"); err == nil {
+		t.Fatalf("expected error for unknown mode")
+	}
+}
@@ -0,0 +1,137 @@
+package sandbox_test
+
+import (
+	"context"
+	"os"
+	"path/filepath"
+	"sync/atomic"
+	"testing"
+
+	"fuzoj/services/judge_service/internal/sandbox"
+	"fuzoj/services/judge_service/internal/sandbox/compilecache"
+	"fuzoj/services/judge_service/internal/sandbox/profile"
+	"fuzoj/services/judge_service/internal/sandbox/result"
+	"fuzoj/services/judge_service/internal/sandbox/runner"
+)
+
+// countingCompileRunner writes a fixed binary on compile and checks it on run.
+type countingCompileRunner struct {
+	compiles atomic.Int32
+}
+
+func (r *countingCompileRunner) Compile(ctx context.Context, req runner.CompileRequest) (result.CompileResult, error) {
+	r.compiles.Add(1)
+	if err := os.WriteFile(filepath.Join(req.WorkDir, req.Language.BinaryFile), []byte("binary"), 0755); err != nil {
+		return result.CompileResult{}, err
+	}
+	return result.CompileResult{OK: true}, nil
+}
+
+func (r *countingCompileRunner) Run(ctx context.Context, req runner.RunRequest) (result.TestcaseResult, error) {
+	data, err := os.ReadFile(req.BinaryPath)
+	if err != nil || string(data) != "binary" {
+		return result.TestcaseResult{TestID: req.TestID, Verdict: result.VerdictRE}, nil
+	}
+	return result.TestcaseResult{TestID: req.TestID, Verdict: result.VerdictAC}, nil
+}
+
+func TestCompileCacheLookupAndEvict(t *testing.T) {
+	root := t.TempDir()
+	srcDir := t.TempDir()
+	cache, err := compilecache.New(root, 10)
+	if err != nil {
+		t.Fatalf("create cache: %v", err)
+	}
+	ctx := context.Background()
+	for _, key := range []string{"a", "b"} {
+		src := filepath.Join(srcDir, key)
+		if err := os.WriteFile(src, []byte("12345"), 0755); err != nil {
+			t.Fatalf("write artifact: %v", err)
+		}
+		if err := cache.Store(ctx, key, src); err != nil {
+			t.Fatalf("store %s: %v", key, err)
+		}
+	}
+	// Touch a so that b is the least recently used entry.
+	if hit, err := cache.Lookup(ctx, "a", filepath.Join(srcDir, "a-out")); err != nil || !hit {
+		t.Fatalf("expected hit for a, got hit=%v err=%v", hit, err)
+	}
+	src := filepath.Join(srcDir, "c")
+	if err := os.WriteFile(src, []byte("12345"), 0755); err != nil {
+		t.Fatalf("write artifact: %v", err)
+	}
+	if err := cache.Store(ctx, "c", src); err != nil {
+		t.Fatalf("store c: %v", err)
+	}
+	if hit, _ := cache.Lookup(ctx, "b", filepath.Join(srcDir, "b-out")); hit {
+		t.Fatalf("expected b to be evicted")
+	}
+
+	reopened, err := compilecache.New(root, 10)
+	if err != nil {
+		t.Fatalf("reopen cache: %v", err)
+	}
+	dst := filepath.Join(srcDir, "c-out")
+	if hit, err := reopened.Lookup(ctx, "c", dst); err != nil || !hit {
+		t.Fatalf("expected persisted hit for c, got hit=%v err=%v", hit, err)
+	}
+	if data, err := os.ReadFile(dst); err != nil || string(data) != "12345" {
+		t.Fatalf("unexpected cached content %q err=%v", data, err)
+	}
+}
+
+func TestWorkerCompileCacheSkipsRecompile(t *testing.T) {
+	workRoot := t.TempDir()
+	sourcePath := filepath.Join(workRoot, "main.cpp")
+	if err := os.WriteFile(sourcePath, []byte("int main(){return 0;}"), 0644); err != nil {
+		t.Fatalf("write source: %v", err)
+	}
+	inputPath := filepath.Join(workRoot, "input.txt")
+	if err := os.WriteFile(inputPath, []byte("1\n"), 0644); err != nil {
+		t.Fatalf("write input: %v", err)
+	}
+	cache, err := compilecache.New(filepath.Join(t.TempDir(), "compile-cache"), 0)
+	if err != nil {
+		t.Fatalf("create cache: %v", err)
+	}
+
+	lang := profile.LanguageSpec{ID: "cpp", Version: "gnu++17", SourceFile: "main.cpp", BinaryFile: "main", CompileEnabled: true}
+	r := &countingCompileRunner{}
+	worker := sandbox.NewWorker(r, fakeLangRepo{spec: lang}, fakeProfileRepo{
+		profiles: map[profile.TaskType]profile.TaskProfile{
+			profile.TaskTypeCompile: {TaskType: profile.TaskTypeCompile},
+			profile.TaskTypeRun:     {TaskType: profile.TaskTypeRun},
+		},
+	})
+	worker.SetCompileCache(cache)
+
+	req := sandbox.JudgeRequest{
+		SubmissionID: "sub-cache-1",
+		LanguageID:   "cpp",
+		WorkRoot:     workRoot,
+		SourcePath:   sourcePath,
+		Tests:        []sandbox.TestcaseSpec{{TestID: "t1", InputPath: inputPath}},
+	}
+	for _, id := range []string{"sub-cache-1", "sub-cache-2"} {
+		req.SubmissionID = id
+		res, err := worker.Execute(context.Background(), req)
+		if err != nil {
+			t.Fatalf("execute %s: %v", id, err)
+		}
+		if res.Verdict != result.VerdictAC {
+			t.Fatalf("expected AC for %s, got %s", id, res.Verdict)
+		}
+	}
+	if got := r.compiles.Load(); got != 1 {
+		t.Fatalf("expected 1 compile for identical source, got %d", got)
+	}
+
+	req.SubmissionID = "sub-cache-3"
+	req.ExtraCompileFlags = []string{"-DLOCAL"}
+	if _, err := worker.Execute(context.Background(), req); err != nil {
+		t.Fatalf("execute with flags: %v", err)
+	}
+	if got := r.compiles.Load(); got != 2 {
+		t.Fatalf("expected different flags to recompile, got %d compiles", got)
+	}
+}
@@ -205,6 +205,88 @@ func TestCppCompileLogTruncated(t *testing.T) {
 	}
 }
 
+type staticProfiles map[string]profile.TaskProfile
+
+func (p staticProfiles) GetTaskProfile(ctx context.Context, taskType profile.TaskType, languageID string) (profile.TaskProfile, error) {
+	prof, ok := p[languageID+"-"+string(taskType)]
+	if !ok {
+		return profile.TaskProfile{}, errors.New("profile not found")
+	}
+	return prof, nil
+}
+
+func TestCppCompileUsesWarmPCH(t *testing.T) {
+	lang := profile.LanguageSpec{
+		ID:             "cpp",
+		SourceFile:     "main.cpp",
+		BinaryFile:     "main",
+		CompileEnabled: true,
+		CompileCmdTpl:  "g++ -O2 {extraFlags} -o {bin} {src}",
+		RunCmdTpl:      "{bin}",
+		PCHHeader:      "bits/stdc++.h",
+	}
+	noPlaceholder := lang
+	noPlaceholder.ID = "cpp-legacy"
+	noPlaceholder.CompileCmdTpl = "g++ -O2 -o {bin} {src}"
+	prof := profile.TaskProfile{LanguageID: "cpp", TaskType: profile.TaskTypeCompile, RootFS: "/rootfs/cpp-compile"}
+	profiles := staticProfiles{"cpp-compile": prof, "cpp-legacy-compile": prof}
+
+	pchEngine := &fakeEngine{runFn: func(runSpec spec.RunSpec) {
+		// Emulate g++ writing the -o target inside the mounted work dir.
+		for i, arg := range runSpec.Cmd {
+			if arg == "-o" && i+1 < len(runSpec.Cmd) {
+				hostPath := filepath.Join(runSpec.BindMounts[0].Source, strings.TrimPrefix(runSpec.Cmd[i+1], "/work/"))
+				_ = os.MkdirAll(filepath.Dir(hostPath), 0755)
+				_ = os.WriteFile(hostPath, []byte("gch"), 0644)
+			}
+		}
+	}}
+	pch, err := runner.NewPCHCache(t.TempDir(), pchEngine)
+	if err != nil {
+		t.Fatalf("new pch cache: %v", err)
+	}
+	pch.Warm(context.Background(), []profile.LanguageSpec{lang, noPlaceholder}, profiles)
+
+	if len(pchEngine.runSpecs) != 1 {
+		t.Fatalf("expected 1 pch build, got %d", len(pchEngine.runSpecs))
+	}
+	buildCmd := strings.Join(pchEngine.runSpecs[0].Cmd, " ")
+	if !strings.Contains(buildCmd, "-x c++-header") || !strings.Contains(buildCmd, "/work/pch/bits/stdc++.h.gch") {
+		t.Fatalf("unexpected pch build cmd: %s", buildCmd)
+	}
+
+	workDir := t.TempDir()
+	sourcePath := filepath.Join(workDir, "src.cpp")
+	if err := os.WriteFile(sourcePath, []byte("#include <bits/stdc++.h>\nint main() {return 0;}"), 0644); err != nil {
+		t.Fatalf("write source: %v", err)
+	}
+	eng := &fakeEngine{runResults: []result.RunResult{{ExitCode: 0}}}
+	r := runner.NewRunnerWithPCH(eng, pch)
+	if _, err := r.Compile(context.Background(), runner.CompileRequest{
+		SubmissionID: "sub-1",
+		Language:     lang,
+		Profile:      prof,
+		WorkDir:      workDir,
+		SourcePath:   sourcePath,
+	}); err != nil {
+		t.Fatalf("compile failed: %v", err)
+	}
+	runSpec := eng.runSpecs[0]
+	if len(runSpec.Cmd) < 3 || runSpec.Cmd[2] != "-I/pch" {
+		t.Fatalf("expected -I/pch in compile cmd, got %v", runSpec.Cmd)
+	}
+	if len(runSpec.BindMounts) != 2 {
+		t.Fatalf("expected workdir and pch mounts, got %+v", runSpec.BindMounts)
+	}
+	mount := runSpec.BindMounts[1]
+	if mount.Target != "/pch" || !mount.ReadOnly {
+		t.Fatalf("unexpected pch mount: %+v", mount)
+	}
+	if _, err := os.Stat(filepath.Join(mount.Source, "bits", "stdc++.h.gch")); err != nil {
+		t.Fatalf("expected gch under mounted dir: %v", err)
+	}
+}
+
 func TestCppRunStdioRunSpec(t *testing.T) {
 	workDir := t.TempDir()
 	inputPath := filepath.Join(workDir, "input.src")
@@ -256,6 +338,61 @@ func TestCppRunStdioRunSpec(t *testing.T) {
 	}
 }
 
+func TestCppRunMountsCompiledBinary(t *testing.T) {
+	workDir := t.TempDir()
+	binaryPath := filepath.Join(t.TempDir(), "main")
+	inputPath := filepath.Join(workDir, "input.src")
+	if err := os.WriteFile(binaryPath, []byte("bin"), 0755); err != nil {
+		t.Fatalf("write binary: %v", err)
+	}
+	if err := os.WriteFile(inputPath, []byte("1 2"), 0644); err != nil {
+		t.Fatalf("write input: %v", err)
+	}
+
+	lang := profile.LanguageSpec{
+		ID:         "cpp",
+		SourceFile: "main.cpp",
+		BinaryFile: "main",
+		RunCmdTpl:  "{bin}",
+	}
+	engine := &fakeEngine{runResults: []result.RunResult{{ExitCode: 0}}}
+	r := runner.NewRunner(engine)
+
+	req := runner.RunRequest{
+		SubmissionID: "sub-1",
+		TestID:       "t1",
+		Language:     lang,
+		Profile:      profile.TaskProfile{TaskType: profile.TaskTypeRun},
+		WorkDir:      workDir,
+		BinaryPath:   binaryPath,
+		IOConfig:     runner.IOConfig{Mode: "stdio"},
+		InputPath:    inputPath,
+		Limits:       spec.ResourceLimit{WallTimeMs: 1000},
+	}
+
+	if _, err := r.Run(context.Background(), req); err != nil {
+		t.Fatalf("run failed: %v", err)
+	}
+	if len(engine.runSpecs) != 1 {
+		t.Fatalf("expected 1 run spec, got %d", len(engine.runSpecs))
+	}
+	var found bool
+	for _, m := range engine.runSpecs[0].BindMounts {
+		if m.Target == "/work/main" {
+			found = true
+			if m.Source != binaryPath || !m.ReadOnly {
+				t.Fatalf("unexpected binary mount: %+v", m)
+			}
+		}
+	}
+	if !found {
+		t.Fatalf("expected compiled binary mount, got %+v", engine.runSpecs[0].BindMounts)
+	}
+	if _, err := os.Stat(filepath.Join(workDir, "main")); !os.IsNotExist(err) {
+		t.Fatalf("expected no binary copy in test workdir, got err=%v", err)
+	}
+}
+
 func TestCppRunVerdictMapping(t *testing.T) {
 	workDir := t.TempDir()
 	inputPath := filepath.Join(workDir, "input.src")
@@ -370,6 +507,74 @@ func TestCppRunWithChecker(t *testing.T) {
 	}
 }
 
+func TestCppRunWithCompareMode(t *testing.T) {
+	workDir := t.TempDir()
+	inputPath := filepath.Join(workDir, "input.src")
+	answerPath := filepath.Join(workDir, "answer.src")
+	if err := os.WriteFile(inputPath, []byte("1 2"), 0644); err != nil {
+		t.Fatalf("write input: %v", err)
+	}
+	if err := os.WriteFile(answerPath, []byte("3\n"), 0644); err != nil {
+		t.Fatalf("write answer: %v", err)
+	}
+
+	lang := profile.LanguageSpec{
+		ID:         "cpp",
+		BinaryFile: "main",
+		RunCmdTpl:  "{bin}",
+	}
+	prof := profile.TaskProfile{TaskType: profile.TaskTypeRun}
+
+	cases := []struct {
+		name     string
+		output   string
+		wantVerd result.Verdict
+	}{
+		{name: "ac", output: "3", wantVerd: result.VerdictAC},
+		{name: "wa", output: "4\n", wantVerd: result.VerdictWA},
+		{name: "missing output", wantVerd: result.VerdictWA},
+	}
+	for _, tc := range cases {
+		t.Run(tc.name, func(t *testing.T) {
+			engine := &fakeEngine{
+				runResults: []result.RunResult{{ExitCode: 0}},
+				runFn: func(_ spec.RunSpec) {
+					outputPath := filepath.Join(workDir, "output.txt")
+					if tc.output == "" {
+						_ = os.Remove(outputPath)
+						return
+					}
+					_ = os.WriteFile(outputPath, []byte(tc.output), 0644)
+				},
+			}
+			r := runner.NewRunner(engine)
+			res, err := r.Run(context.Background(), runner.RunRequest{
+				SubmissionID: "sub-1",
+				TestID:       "t1",
+				Language:     lang,
+				Profile:      prof,
+				WorkDir:      workDir,
+				IOConfig:     runner.IOConfig{Mode: "stdio"},
+				InputPath:    inputPath,
+				AnswerPath:   answerPath,
+				CompareMode:  "token",
+			})
+			if err != nil {
+				t.Fatalf("run failed: %v", err)
+			}
+			if res.Verdict != tc.wantVerd {
+				t.Fatalf("expected verdict %s, got %s", tc.wantVerd, res.Verdict)
+			}
+			if len(engine.runSpecs) != 1 {
+				t.Fatalf("compare mode should not spawn a checker, got %d run specs", len(engine.runSpecs))
+			}
+			if tc.wantVerd == result.VerdictWA && res.CheckerLog == "" {
+				t.Fatalf("expected compare message in checker log")
+			}
+		})
+	}
+}
+
 func TestCppRunnerCallsEngineWithComplexProgram(t *testing.T) {
 	if runtime.GOOS != "linux" {
 		t.Skip("linux only")
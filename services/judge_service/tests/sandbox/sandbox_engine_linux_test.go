@@ -6,9 +6,11 @@ import (
 	"context"
 	"errors"
 	"fmt"
+	"io"
 	"os"
 	"os/exec"
 	"path/filepath"
+	"strconv"
 	"strings"
 	"testing"
 	"time"
@@ -401,6 +403,164 @@ func TestLinuxEngineRun(t *testing.T) {
 				}
 			},
 		},
+		{
+			name: "cgroup_pool_reuses_leaf",
+			run: func(t *testing.T) (result.RunResult, error) {
+				workDir := t.TempDir()
+				cgroupRoot := filepath.Join(workDir, "cgroup")
+
+				cfg := engine.Config{
+					CgroupRoot:       cgroupRoot,
+					HelperPath:       helperPath,
+					EnableCgroup:     true,
+					EnableNamespaces: false,
+					CgroupPoolSize:   4,
+				}
+				eng, err := engine.NewEngine(cfg, resolver)
+				if err != nil {
+					t.Fatalf("create engine: %v", err)
+				}
+
+				ctx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+				defer cancel()
+
+				var res result.RunResult
+				for i, pids := range []int64{5, 7} {
+					runSpec := spec.RunSpec{
+						SubmissionID: fmt.Sprintf("sub-pool-%d", i),
+						TestID:       "t1",
+						WorkDir:      workDir,
+						Cmd:          []string{"/bin/sh", "-c", "echo ok"},
+						StdoutPath:   filepath.Join(workDir, "stdout.txt"),
+						Profile:      "default",
+						Limits:       spec.ResourceLimit{MemoryMB: 16, PIDs: pids},
+					}
+					if res, err = eng.Run(ctx, runSpec); err != nil {
+						return res, err
+					}
+					if _, err := os.Stat(filepath.Join(cgroupRoot, runSpec.SubmissionID)); !errors.Is(err, os.ErrNotExist) {
+						t.Fatalf("expected no per-submission cgroup dir, stat err=%v", err)
+					}
+				}
+
+				entries, err := os.ReadDir(filepath.Join(cgroupRoot, "pool"))
+				if err != nil {
+					t.Fatalf("read pool dir: %v", err)
+				}
+				if len(entries) != 1 {
+					t.Fatalf("expected one reused leaf, got %d", len(entries))
+				}
+				leaf := filepath.Join(cgroupRoot, "pool", entries[0].Name())
+				if data, err := os.ReadFile(filepath.Join(leaf, "pids.max")); err != nil {
+					t.Fatalf("read pids.max: %v", err)
+				} else if strings.TrimSpace(string(data)) != "7" {
+					t.Fatalf("expected limits rewritten in place, pids.max=%q", strings.TrimSpace(string(data)))
+				}
+				return res, nil
+			},
+			verify: func(t *testing.T, res result.RunResult, err error) {
+				if err != nil {
+					t.Fatalf("run failed: %v", err)
+				}
+				if res.ExitCode != 0 || !strings.Contains(res.Stdout, "ok") {
+					t.Fatalf("unexpected result: %+v", res)
+				}
+			},
+		},
+		{
+			name: "stdout_captured_in_memfd",
+			run: func(t *testing.T) (result.RunResult, error) {
+				workDir := t.TempDir()
+				stdoutPath := filepath.Join(workDir, "stdout.txt")
+
+				cfg := engine.Config{
+					HelperPath:       helperPath,
+					EnableCgroup:     false,
+					EnableNamespaces: false,
+				}
+				eng, err := engine.NewEngine(cfg, resolver)
+				if err != nil {
+					t.Fatalf("create engine: %v", err)
+				}
+
+				runSpec := spec.RunSpec{
+					SubmissionID: "sub-memfd",
+					TestID:       "t-memfd",
+					WorkDir:      workDir,
+					Cmd:          []string{"/bin/sh", "-c", "echo captured"},
+					StdoutPath:   stdoutPath,
+					StdoutMemfd:  true,
+					Profile:      "default",
+				}
+
+				ctx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+				defer cancel()
+
+				res, err := eng.Run(ctx, runSpec)
+				if _, statErr := os.Stat(stdoutPath); !errors.Is(statErr, os.ErrNotExist) {
+					t.Fatalf("expected stdout not to touch disk, stat err=%v", statErr)
+				}
+				return res, err
+			},
+			verify: func(t *testing.T, res result.RunResult, err error) {
+				if err != nil {
+					t.Fatalf("run failed: %v", err)
+				}
+				if res.StdoutFile == nil {
+					t.Fatalf("expected stdout capture file")
+				}
+				defer res.StdoutFile.Close()
+				data, err := io.ReadAll(io.NewSectionReader(res.StdoutFile, 0, 1<<20))
+				if err != nil {
+					t.Fatalf("read capture: %v", err)
+				}
+				if string(data) != "captured\n" || res.Stdout != "captured\n" {
+					t.Fatalf("unexpected capture %q / %q", data, res.Stdout)
+				}
+			},
+		},
+		{
+			name: "stdout_memfd_flood_stops_at_limit",
+			run: func(t *testing.T) (result.RunResult, error) {
+				workDir := t.TempDir()
+				cfg := engine.Config{
+					HelperPath:       helperPath,
+					EnableCgroup:     false,
+					EnableNamespaces: false,
+				}
+				eng, err := engine.NewEngine(cfg, resolver)
+				if err != nil {
+					t.Fatalf("create engine: %v", err)
+				}
+
+				runSpec := spec.RunSpec{
+					SubmissionID: "sub-memfd-flood",
+					TestID:       "t-memfd-flood",
+					WorkDir:      workDir,
+					Cmd:          []string{"/bin/sh", "-c", "head -c 8388608 /dev/zero"},
+					StdoutPath:   filepath.Join(workDir, "stdout.txt"),
+					StdoutMemfd:  true,
+					Profile:      "default",
+					Limits:       spec.ResourceLimit{OutputMB: 1},
+				}
+
+				ctx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+				defer cancel()
+				return eng.Run(ctx, runSpec)
+			},
+			verify: func(t *testing.T, res result.RunResult, err error) {
+				if err != nil {
+					t.Fatalf("run failed: %v", err)
+				}
+				if res.StdoutFile == nil {
+					t.Fatalf("expected stdout capture file")
+				}
+				defer res.StdoutFile.Close()
+				if res.OutputKB != 1024 || res.ExitCode == 0 {
+					t.Fatalf("expected run killed with output at the 1MiB cap, got output=%dKB exit=%d", res.OutputKB, res.ExitCode)
+				}
+			},
+		},
 		{
 			name: "timeout_kills_process",
 			run: func(t *testing.T) (result.RunResult, error) {
@@ -459,6 +619,137 @@ func TestLinuxEngineRun(t *testing.T) {
 	}
 }
 
+// TestLinuxEngineMemfdUnchargedAfterRelease needs a writable cgroup v2
+// hierarchy: the captured output must not stay charged to the pooled leaf.
+func TestLinuxEngineMemfdUnchargedAfterRelease(t *testing.T) {
+	if os.Geteuid() != 0 {
+		t.Skip("requires root for cgroup v2")
+	}
+	if _, err := os.Stat("/sys/fs/cgroup/cgroup.controllers"); err != nil {
+		t.Skip("cgroup v2 is not mounted")
+	}
+	cgroupRoot := filepath.Join("/sys/fs/cgroup", fmt.Sprintf("fuzoj-memfd-test-%d", os.Getpid()))
+	if err := os.Mkdir(cgroupRoot, 0750); err != nil {
+		t.Skipf("create test cgroup: %v", err)
+	}
+	t.Cleanup(func() { removeCgroupTree(cgroupRoot) })
+
+	helperPath := buildSandboxHelper(t)
+	eng, err := engine.NewEngine(engine.Config{
+		CgroupRoot:     cgroupRoot,
+		HelperPath:     helperPath,
+		EnableCgroup:   true,
+		CgroupPoolSize: 1,
+	}, staticResolver{profile: security.IsolationProfile{}})
+	if err != nil {
+		t.Skipf("create engine: %v", err)
+	}
+
+	workDir := t.TempDir()
+	ctx, cancel := context.WithTimeout(context.Background(), 10*time.Second)
+	defer cancel()
+	res, err := eng.Run(ctx, spec.RunSpec{
+		SubmissionID: "sub-memfd-charge",
+		TestID:       "t1",
+		WorkDir:      workDir,
+		Cmd:          []string{"/bin/sh", "-c", "head -c 33554432 /dev/zero"},
+		StdoutPath:   filepath.Join(workDir, "stdout.txt"),
+		StdoutMemfd:  true,
+		Profile:      "default",
+		Limits:       spec.ResourceLimit{MemoryMB: 64, OutputMB: 64},
+	})
+	if err != nil {
+		t.Fatalf("run failed: %v", err)
+	}
+	if res.StdoutFile == nil {
+		t.Fatalf("expected stdout capture file")
+	}
+	defer res.StdoutFile.Close()
+	if info, err := res.StdoutFile.Stat(); err != nil || info.Size() != 32<<20 {
+		t.Fatalf("expected 32MiB capture, got %v err=%v", info, err)
+	}
+	if res.MemoryKB >= 32<<10 {
+		t.Fatalf("expected captured output excluded from memory, got %dKB", res.MemoryKB)
+	}
+
+	entries, err := os.ReadDir(filepath.Join(cgroupRoot, "pool"))
+	if err != nil || len(entries) != 1 {
+		t.Fatalf("expected one pooled leaf, got %d err=%v", len(entries), err)
+	}
+	data, err := os.ReadFile(filepath.Join(cgroupRoot, "pool", entries[0].Name(), "memory.current"))
+	if err != nil {
+		t.Fatalf("read memory.current: %v", err)
+	}
+	current, err := strconv.ParseInt(strings.TrimSpace(string(data)), 10, 64)
+	if err != nil {
+		t.Fatalf("parse memory.current %q: %v", data, err)
+	}
+	if current >= 8<<20 {
+		t.Fatalf("expected output uncharged from released leaf, memory.current=%d", current)
+	}
+}
+
+// TestLinuxEngineMemfdPeakBeforeOutputIsMLE covers a program that peaks above
+// the memory limit before printing: the captured output must not give it room.
+func TestLinuxEngineMemfdPeakBeforeOutputIsMLE(t *testing.T) {
+	if os.Geteuid() != 0 {
+		t.Skip("requires root for cgroup v2")
+	}
+	if _, err := os.Stat("/sys/fs/cgroup/cgroup.controllers"); err != nil {
+		t.Skip("cgroup v2 is not mounted")
+	}
+	cgroupRoot := filepath.Join("/sys/fs/cgroup", fmt.Sprintf("fuzoj-memfd-mle-test-%d", os.Getpid()))
+	if err := os.Mkdir(cgroupRoot, 0750); err != nil {
+		t.Skipf("create test cgroup: %v", err)
+	}
+	t.Cleanup(func() { removeCgroupTree(cgroupRoot) })
+
+	helperPath := buildSandboxHelper(t)
+	eng, err := engine.NewEngine(engine.Config{
+		CgroupRoot:   cgroupRoot,
+		HelperPath:   helperPath,
+		EnableCgroup: true,
+	}, staticResolver{profile: security.IsolationProfile{}})
+	if err != nil {
+		t.Skipf("create engine: %v", err)
+	}
+
+	// Hold 300MiB in a shell variable, drop it, then print 60MiB.
+	script := `x=$(head -c 314572800 /dev/zero | tr '\0' a); x=; head -c 62914560 /dev/zero`
+	workDir := t.TempDir()
+	ctx, cancel := context.WithTimeout(context.Background(), 30*time.Second)
+	defer cancel()
+	res, err := eng.Run(ctx, spec.RunSpec{
+		SubmissionID: "sub-memfd-mle",
+		TestID:       "t1",
+		WorkDir:      workDir,
+		Cmd:          []string{"/bin/sh", "-c", script},
+		StdoutPath:   filepath.Join(workDir, "stdout.txt"),
+		StdoutMemfd:  true,
+		Profile:      "default",
+		Limits:       spec.ResourceLimit{MemoryMB: 256, OutputMB: 64},
+	})
+	if err != nil {
+		t.Fatalf("run failed: %v", err)
+	}
+	if res.StdoutFile != nil {
+		defer res.StdoutFile.Close()
+	}
+	if !res.OomKilled && res.MemoryKB <= 256<<10 {
+		t.Fatalf("expected MLE for a 300MiB peak under a 256MiB limit, got memory=%dKB output=%dKB oom=%v", res.MemoryKB, res.OutputKB, res.OomKilled)
+	}
+}
+
+func removeCgroupTree(path string) {
+	entries, _ := os.ReadDir(path)
+	for _, entry := range entries {
+		if entry.IsDir() {
+			removeCgroupTree(filepath.Join(path, entry.Name()))
+		}
+	}
+	_ = os.Remove(path)
+}
+
 func waitForRunDir(root, submissionID string, timeout time.Duration) (string, error) {
 	deadline := time.Now().Add(timeout)
 	submissionDir := filepath.Join(root, submissionID)
@@ -513,7 +804,8 @@ import (
 )
 
 type initRequest struct {
-	RunSpec runSpec ` + "`json:\"RunSpec\"`" + `
+	RunSpec  runSpec ` + "`json:\"RunSpec\"`" + `
+	StdoutFD int     ` + "`json:\"StdoutFD\"`" + `
 }
 
 type runSpec struct {
@@ -568,8 +860,10 @@ func run() error {
 	if err != nil {
 		return fmt.Errorf("open stdin: %w", err)
 	}
-	stdoutFile, err := os.OpenFile(stdoutPath, os.O_CREATE|os.O_WRONLY|os.O_TRUNC, 0644)
-	if err != nil {
+	var stdoutFile *os.File
+	if req.StdoutFD > 0 {
+		stdoutFile = os.NewFile(uintptr(req.StdoutFD), "stdout")
+	} else if stdoutFile, err = os.OpenFile(stdoutPath, os.O_CREATE|os.O_WRONLY|os.O_TRUNC, 0644); err != nil {
 		return fmt.Errorf("open stdout: %w", err)
 	}
 	stderrFile, err := os.OpenFile(stderrPath, os.O_CREATE|os.O_WRONLY|os.O_TRUNC, 0644)
@@ -0,0 +1,133 @@
+package sandbox_test
+
+import (
+	"context"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"testing"
+
+	"fuzoj/services/judge_service/internal/sandbox"
+	"fuzoj/services/judge_service/internal/sandbox/profile"
+	"fuzoj/services/judge_service/internal/sandbox/result"
+	"fuzoj/services/judge_service/internal/sandbox/runner"
+)
+
+const (
+	benchBinarySize = 2 << 20
+	benchTestCount  = 100
+)
+
+// artifactRunner writes a binary of the given size on compile and accepts every run.
+type artifactRunner struct {
+	binary []byte
+}
+
+func (r *artifactRunner) Compile(ctx context.Context, req runner.CompileRequest) (result.CompileResult, error) {
+	path := filepath.Join(req.WorkDir, req.Language.BinaryFile)
+	if err := os.WriteFile(path, r.binary, 0755); err != nil {
+		return result.CompileResult{}, err
+	}
+	return result.CompileResult{OK: true}, nil
+}
+
+func (r *artifactRunner) Run(ctx context.Context, req runner.RunRequest) (result.TestcaseResult, error) {
+	return result.TestcaseResult{TestID: req.TestID, Verdict: result.VerdictAC}, nil
+}
+
+// BenchmarkPerTestSetup compares the old per-test binary copy against
+// Worker.Execute, which hands each run the compiled binary by path instead.
+// Both report ns/test for a 2 MB binary. The runner here is a stub, so the
+// by_path case covers the worker's own per-test work only; the read-only bind
+// mount that sandbox-init makes of that path is not measured.
+func BenchmarkPerTestSetup(b *testing.B) {
+	binary := make([]byte, benchBinarySize)
+	for i := range binary {
+		binary[i] = byte(i)
+	}
+	workRoot := b.TempDir()
+	inputPath := filepath.Join(workRoot, "input.txt")
+	if err := os.WriteFile(inputPath, []byte("1\n"), 0644); err != nil {
+		b.Fatalf("write input: %v", err)
+	}
+	sourcePath := filepath.Join(workRoot, "main.cpp")
+	if err := os.WriteFile(sourcePath, []byte("int main(){}"), 0644); err != nil {
+		b.Fatalf("write source: %v", err)
+	}
+
+	b.Run("copy", func(b *testing.B) {
+		submissionRoot := filepath.Join(workRoot, "copy")
+		compileDir := filepath.Join(submissionRoot, "compile")
+		if err := os.MkdirAll(compileDir, 0755); err != nil {
+			b.Fatalf("create compile dir: %v", err)
+		}
+		if err := os.WriteFile(filepath.Join(compileDir, "main"), binary, 0755); err != nil {
+			b.Fatalf("write binary: %v", err)
+		}
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			for j := 0; j < benchTestCount; j++ {
+				testDir := filepath.Join(submissionRoot, fmt.Sprintf("t%d", j))
+				if err := copyFileForBench(filepath.Join(compileDir, "main"), testDir); err != nil {
+					b.Fatalf("copy binary: %v", err)
+				}
+			}
+			b.StopTimer()
+			for j := 0; j < benchTestCount; j++ {
+				_ = os.RemoveAll(filepath.Join(submissionRoot, fmt.Sprintf("t%d", j)))
+			}
+			b.StartTimer()
+		}
+		b.ReportMetric(float64(b.Elapsed().Nanoseconds())/float64(b.N*benchTestCount), "ns/test")
+	})
+
+	b.Run("by_path", func(b *testing.B) {
+		tests := make([]sandbox.TestcaseSpec, 0, benchTestCount)
+		for j := 0; j < benchTestCount; j++ {
+			tests = append(tests, sandbox.TestcaseSpec{TestID: fmt.Sprintf("t%d", j), InputPath: inputPath})
+		}
+		lang := profile.LanguageSpec{ID: "cpp", SourceFile: "main.cpp", BinaryFile: "main", CompileEnabled: true}
+		worker := sandbox.NewWorker(&artifactRunner{binary: binary}, fakeLangRepo{spec: lang}, fakeProfileRepo{
+			profiles: map[profile.TaskType]profile.TaskProfile{
+				profile.TaskTypeCompile: {TaskType: profile.TaskTypeCompile},
+				profile.TaskTypeRun:     {TaskType: profile.TaskTypeRun},
+			},
+		})
+		req := sandbox.JudgeRequest{
+			SubmissionID: "by-path",
+			LanguageID:   "cpp",
+			WorkRoot:     workRoot,
+			SourcePath:   sourcePath,
+			Tests:        tests,
+		}
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			res, err := worker.Execute(context.Background(), req)
+			if err != nil || res.Verdict != result.VerdictAC {
+				b.Fatalf("execute failed: verdict=%s err=%v", res.Verdict, err)
+			}
+		}
+		b.ReportMetric(float64(b.Elapsed().Nanoseconds())/float64(b.N*benchTestCount), "ns/test")
+	})
+}
+
+func copyFileForBench(src, dstDir string) error {
+	if err := os.MkdirAll(dstDir, 0755); err != nil {
+		return err
+	}
+	in, err := os.Open(src)
+	if err != nil {
+		return err
+	}
+	defer in.Close()
+	out, err := os.Create(filepath.Join(dstDir, filepath.Base(src)))
+	if err != nil {
+		return err
+	}
+	defer out.Close()
+	if _, err := io.Copy(out, in); err != nil {
+		return err
+	}
+	return out.Chmod(0755)
+}
@@ -2,12 +2,15 @@ package sandbox_test
 
 import (
 	"context"
+	"fmt"
 	"os"
 	"os/exec"
 	"path/filepath"
 	"runtime"
 	"strings"
+	"sync"
 	"testing"
+	"time"
 
 	pkgerrors "fuzoj/pkg/errors"
 	"fuzoj/services/judge_service/internal/sandbox"
@@ -230,6 +233,321 @@ func TestWorkerSubtaskMinScore(t *testing.T) {
 	}
 }
 
+// pinnedRunner is safe for concurrent use and records the cpuset of every run.
+type pinnedRunner struct {
+	mu       sync.Mutex
+	verdicts map[string]result.Verdict
+	delays   map[string]time.Duration
+	cpuSets  map[string]string
+	active   map[string]bool
+	order    []string
+	overlap  bool
+}
+
+func (f *pinnedRunner) Compile(ctx context.Context, req runner.CompileRequest) (result.CompileResult, error) {
+	return result.CompileResult{OK: true}, nil
+}
+
+func (f *pinnedRunner) Run(ctx context.Context, req runner.RunRequest) (result.TestcaseResult, error) {
+	f.mu.Lock()
+	f.cpuSets[req.TestID] = req.CPUSet
+	f.order = append(f.order, req.TestID)
+	if f.active[req.CPUSet] {
+		f.overlap = true
+	}
+	f.active[req.CPUSet] = true
+	f.mu.Unlock()
+	defer func() {
+		f.mu.Lock()
+		f.active[req.CPUSet] = false
+		f.mu.Unlock()
+	}()
+
+	select {
+	case <-time.After(f.delays[req.TestID]):
+	case <-ctx.Done():
+		return result.TestcaseResult{}, ctx.Err()
+	}
+	verdict, ok := f.verdicts[req.TestID]
+	if !ok {
+		verdict = result.VerdictAC
+	}
+	return result.TestcaseResult{TestID: req.TestID, Verdict: verdict, Score: req.Score, SubtaskID: req.SubtaskID}, nil
+}
+
+func TestWorkerParallelKeepsSerialSemantics(t *testing.T) {
+	workRoot := t.TempDir()
+	sourcePath := filepath.Join(workRoot, "main.py")
+	if err := os.WriteFile(sourcePath, []byte("print(1)"), 0644); err != nil {
+		t.Fatalf("write source: %v", err)
+	}
+	inputPath := filepath.Join(workRoot, "input.txt")
+	if err := os.WriteFile(inputPath, []byte("1\n"), 0644); err != nil {
+		t.Fatalf("write input: %v", err)
+	}
+
+	lang := profile.LanguageSpec{ID: "py", SourceFile: "main.py"}
+	r := &pinnedRunner{
+		// t1 is slow, so t3 fails first in wall time; t1 and t2 must still be reported.
+		verdicts: map[string]result.Verdict{"t3": result.VerdictWA, "t4": result.VerdictTLE},
+		delays:   map[string]time.Duration{"t1": 50 * time.Millisecond, "t5": time.Second, "t6": time.Second},
+		cpuSets:  make(map[string]string),
+		active:   make(map[string]bool),
+	}
+	worker := sandbox.NewWorker(r, fakeLangRepo{spec: lang}, fakeProfileRepo{
+		profiles: map[profile.TaskType]profile.TaskProfile{
+			profile.TaskTypeRun: {TaskType: profile.TaskTypeRun},
+		},
+	})
+	worker.SetParallelism(3, []string{"0", "1", "2"})
+
+	tests := make([]sandbox.TestcaseSpec, 0, 6)
+	for i := 1; i <= 6; i++ {
+		tests = append(tests, sandbox.TestcaseSpec{TestID: fmt.Sprintf("t%d", i), InputPath: inputPath, Score: 10})
+	}
+	req := sandbox.JudgeRequest{
+		SubmissionID: "sub-parallel",
+		LanguageID:   "py",
+		WorkRoot:     workRoot,
+		SourcePath:   sourcePath,
+		Tests:        tests,
+	}
+
+	start := time.Now()
+	res, err := worker.Execute(context.Background(), req)
+	if err != nil {
+		t.Fatalf("run failed: %v", err)
+	}
+	if elapsed := time.Since(start); elapsed > 500*time.Millisecond {
+		t.Fatalf("expected in-flight tests after the failure to be cancelled, took %s", elapsed)
+	}
+	if len(res.Tests) != 3 {
+		t.Fatalf("expected results for t1..t3, got %+v", res.Tests)
+	}
+	for i, tc := range res.Tests {
+		if want := fmt.Sprintf("t%d", i+1); tc.TestID != want {
+			t.Fatalf("expected %s at index %d, got %s", want, i, tc.TestID)
+		}
+	}
+	if res.Verdict != result.VerdictWA || res.Summary.FailedTestID != "t3" {
+		t.Fatalf("expected WA on t3, got %s on %s", res.Verdict, res.Summary.FailedTestID)
+	}
+	if res.Summary.TotalScore != 20 {
+		t.Fatalf("expected total score 20, got %d", res.Summary.TotalScore)
+	}
+
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	if r.overlap {
+		t.Fatalf("expected each cpu slot to run one test at a time")
+	}
+	for testID, cpuSet := range r.cpuSets {
+		if cpuSet != "0" && cpuSet != "1" && cpuSet != "2" {
+			t.Fatalf("unexpected cpuset %q for %s", cpuSet, testID)
+		}
+	}
+}
+
+func newPinnedRunner(verdicts map[string]result.Verdict) *pinnedRunner {
+	return &pinnedRunner{
+		verdicts: verdicts,
+		delays:   make(map[string]time.Duration),
+		cpuSets:  make(map[string]string),
+		active:   make(map[string]bool),
+	}
+}
+
+func TestWorkerSubtaskEarlyStop(t *testing.T) {
+	workRoot := t.TempDir()
+	sourcePath := filepath.Join(workRoot, "main.py")
+	if err := os.WriteFile(sourcePath, []byte("print(1)"), 0644); err != nil {
+		t.Fatalf("write source: %v", err)
+	}
+	inputPath := filepath.Join(workRoot, "input.txt")
+	if err := os.WriteFile(inputPath, []byte("1\n"), 0644); err != nil {
+		t.Fatalf("write input: %v", err)
+	}
+	lang := profile.LanguageSpec{ID: "py", SourceFile: "main.py"}
+	tests := []sandbox.TestcaseSpec{
+		{TestID: "t1", InputPath: inputPath, SubtaskID: "s1"},
+		{TestID: "t2", InputPath: inputPath, SubtaskID: "s1"},
+		{TestID: "t3", InputPath: inputPath, SubtaskID: "s1"},
+		{TestID: "t4", InputPath: inputPath, SubtaskID: "s2"},
+		{TestID: "t5", InputPath: inputPath, SubtaskID: "s2"},
+	}
+
+	cases := []struct {
+		name        string
+		stopOnFail  bool
+		parallelism int
+		wantRan     []string
+		wantScore   int
+	}{
+		{name: "skip failed subtask", parallelism: 1, wantRan: []string{"t1", "t2", "t4", "t5"}, wantScore: 60},
+		{name: "skip failed subtask parallel", parallelism: 3, wantRan: []string{"t1", "t2", "t4", "t5"}, wantScore: 60},
+		{name: "stop on fail", stopOnFail: true, parallelism: 1, wantRan: []string{"t1", "t2"}, wantScore: 0},
+		{name: "stop on fail parallel", stopOnFail: true, parallelism: 3, wantRan: []string{"t1", "t2"}, wantScore: 0},
+	}
+	for _, tc := range cases {
+		t.Run(tc.name, func(t *testing.T) {
+			r := newPinnedRunner(map[string]result.Verdict{"t2": result.VerdictWA})
+			worker := sandbox.NewWorker(r, fakeLangRepo{spec: lang}, fakeProfileRepo{
+				profiles: map[profile.TaskType]profile.TaskProfile{
+					profile.TaskTypeRun: {TaskType: profile.TaskTypeRun},
+				},
+			})
+			worker.SetParallelism(tc.parallelism, nil)
+			req := sandbox.JudgeRequest{
+				SubmissionID: "sub-subtask",
+				LanguageID:   "py",
+				WorkRoot:     workRoot,
+				SourcePath:   sourcePath,
+				Tests:        tests,
+				Subtasks: []sandbox.SubtaskSpec{
+					{ID: "s1", Score: 40, Strategy: "min", StopOnFail: tc.stopOnFail},
+					{ID: "s2", Score: 60, Strategy: "min"},
+				},
+			}
+
+			res, err := worker.Execute(context.Background(), req)
+			if err != nil {
+				t.Fatalf("run failed: %v", err)
+			}
+			got := make([]string, 0, len(res.Tests))
+			for _, tr := range res.Tests {
+				got = append(got, tr.TestID)
+			}
+			if strings.Join(got, ",") != strings.Join(tc.wantRan, ",") {
+				t.Fatalf("expected results for %v, got %v", tc.wantRan, got)
+			}
+			if res.Summary.TotalScore != tc.wantScore {
+				t.Fatalf("expected total score %d, got %d", tc.wantScore, res.Summary.TotalScore)
+			}
+			if res.Verdict != result.VerdictWA || res.Summary.FailedTestID != "t2" {
+				t.Fatalf("expected WA on t2, got %s on %s", res.Verdict, res.Summary.FailedTestID)
+			}
+		})
+	}
+}
+
+func TestWorkerRunsHistoricallyFailingTestsFirst(t *testing.T) {
+	workRoot := t.TempDir()
+	sourcePath := filepath.Join(workRoot, "main.py")
+	if err := os.WriteFile(sourcePath, []byte("print(1)"), 0644); err != nil {
+		t.Fatalf("write source: %v", err)
+	}
+	smallInput := filepath.Join(workRoot, "small.txt")
+	largeInput := filepath.Join(workRoot, "large.txt")
+	if err := os.WriteFile(smallInput, []byte("1\n"), 0644); err != nil {
+		t.Fatalf("write input: %v", err)
+	}
+	if err := os.WriteFile(largeInput, []byte(strings.Repeat("1 ", 1024)), 0644); err != nil {
+		t.Fatalf("write input: %v", err)
+	}
+	lang := profile.LanguageSpec{ID: "py", SourceFile: "main.py"}
+	r := newPinnedRunner(map[string]result.Verdict{"t3": result.VerdictTLE})
+	worker := sandbox.NewWorker(r, fakeLangRepo{spec: lang}, fakeProfileRepo{
+		profiles: map[profile.TaskType]profile.TaskProfile{
+			profile.TaskTypeRun: {TaskType: profile.TaskTypeRun},
+		},
+	})
+	req := sandbox.JudgeRequest{
+		SubmissionID: "sub-order",
+		LanguageID:   "py",
+		WorkRoot:     workRoot,
+		SourcePath:   sourcePath,
+		ProblemID:    "1001",
+		Tests: []sandbox.TestcaseSpec{
+			{TestID: "t1", InputPath: largeInput, SubtaskID: "s1"},
+			{TestID: "t2", InputPath: smallInput, SubtaskID: "s1"},
+			{TestID: "t3", InputPath: largeInput, SubtaskID: "s1"},
+		},
+		Subtasks: []sandbox.SubtaskSpec{{ID: "s1", Score: 100, Strategy: "min"}},
+	}
+
+	if _, err := worker.Execute(context.Background(), req); err != nil {
+		t.Fatalf("first run failed: %v", err)
+	}
+	if got := strings.Join(r.order, ","); got != "t2,t1,t3" {
+		t.Fatalf("expected smaller input first, got %s", got)
+	}
+
+	r.order = nil
+	res, err := worker.Execute(context.Background(), req)
+	if err != nil {
+		t.Fatalf("second run failed: %v", err)
+	}
+	if got := strings.Join(r.order, ","); got != "t3" {
+		t.Fatalf("expected only the previously failing test to run, got %s", got)
+	}
+	if res.Verdict != result.VerdictTLE || res.Summary.TotalScore != 0 {
+		t.Fatalf("expected TLE with score 0, got %s/%d", res.Verdict, res.Summary.TotalScore)
+	}
+}
+
+// sizedData reports sizes of inputs that are only written on Materialize, like a lazy pack.
+type sizedData struct {
+	sizes map[string]int64
+}
+
+func (d sizedData) Materialize(ctx context.Context, paths ...string) error {
+	for _, path := range paths {
+		size, ok := d.sizes[path]
+		if !ok {
+			continue
+		}
+		if _, err := os.Stat(path); err == nil {
+			continue
+		}
+		if err := os.WriteFile(path, []byte(strings.Repeat("1", int(size))), 0644); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+func (d sizedData) Size(path string) (int64, bool) {
+	size, ok := d.sizes[path]
+	return size, ok
+}
+
+func TestWorkerOrdersLazyInputsBySize(t *testing.T) {
+	workRoot := t.TempDir()
+	sourcePath := filepath.Join(workRoot, "main.py")
+	if err := os.WriteFile(sourcePath, []byte("print(1)"), 0644); err != nil {
+		t.Fatalf("write source: %v", err)
+	}
+	largeInput := filepath.Join(workRoot, "large.txt")
+	smallInput := filepath.Join(workRoot, "small.txt")
+	lang := profile.LanguageSpec{ID: "py", SourceFile: "main.py"}
+	r := newPinnedRunner(nil)
+	worker := sandbox.NewWorker(r, fakeLangRepo{spec: lang}, fakeProfileRepo{
+		profiles: map[profile.TaskType]profile.TaskProfile{
+			profile.TaskTypeRun: {TaskType: profile.TaskTypeRun},
+		},
+	})
+	req := sandbox.JudgeRequest{
+		SubmissionID: "sub-lazy-order",
+		LanguageID:   "py",
+		WorkRoot:     workRoot,
+		SourcePath:   sourcePath,
+		ProblemID:    "1002",
+		Tests: []sandbox.TestcaseSpec{
+			{TestID: "t1", InputPath: largeInput, SubtaskID: "s1"},
+			{TestID: "t2", InputPath: smallInput, SubtaskID: "s1"},
+		},
+		Subtasks: []sandbox.SubtaskSpec{{ID: "s1", Score: 100, Strategy: "min"}},
+		Data:     sizedData{sizes: map[string]int64{largeInput: 2048, smallInput: 2}},
+	}
+
+	if _, err := worker.Execute(context.Background(), req); err != nil {
+		t.Fatalf("run failed: %v", err)
+	}
+	if got := strings.Join(r.order, ","); got != "t2,t1" {
+		t.Fatalf("expected smaller lazy input first, got %s", got)
+	}
+}
+
 func TestWorkerInvalidRequest(t *testing.T) {
 	worker := sandbox.NewWorker(&fakeRunner{}, fakeLangRepo{}, fakeProfileRepo{})
 	_, err := worker.Execute(context.Background(), sandbox.JudgeRequest{})
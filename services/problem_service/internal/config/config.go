@@ -49,11 +49,17 @@ type MinIOConfig struct {
 }
 
 // UploadConfig holds upload session settings.
+// SeekableDataPack writes a per-file seekable copy of each data pack after completion,
+// built in the background by SeekableWorkers workers.
 type UploadConfig struct {
-	KeyPrefix     string        `json:"keyPrefix"`
-	PartSizeBytes int64         `json:"partSizeBytes"`
-	SessionTTL    time.Duration `json:"sessionTTL"`
-	PresignTTL    time.Duration `json:"presignTTL"`
+	KeyPrefix        string        `json:"keyPrefix"`
+	PartSizeBytes    int64         `json:"partSizeBytes"`
+	SessionTTL       time.Duration `json:"sessionTTL"`
+	PresignTTL       time.Duration `json:"presignTTL"`
+	SeekableDataPack bool          `json:"seekableDataPack,optional"`
+	SeekableWorkers  int           `json:"seekableWorkers,optional"`
+	SeekableQueue    int           `json:"seekableQueue,optional"`
+	SeekableTimeout  time.Duration `json:"seekableTimeout,optional"`
 }
 
 // CleanupConfig holds cleanup consumer settings.
@@ -17,7 +17,7 @@ func NewProblemAppFromContext(svcCtx *svc.ServiceContext) *problemApp {
 	if svcCtx == nil {
 		return newProblemApp(nil, nil, nil, nil, nil, nil, nil, "", "", 0, 0, 0, 0)
 	}
-	return newProblemApp(
+	app := newProblemApp(
 		svcCtx.ProblemRepo,
 		svcCtx.StatementRepo,
 		svcCtx.UploadRepo,
@@ -32,6 +32,10 @@ func NewProblemAppFromContext(svcCtx *svc.ServiceContext) *problemApp {
 		svcCtx.Config.Upload.PresignTTL,
 		svcCtx.Config.Statement.MaxBytes,
 	)
+	if svcCtx.SeekableBuilder != nil {
+		app.seekableBuilder = svcCtx.SeekableBuilder
+	}
+	return app
 }
 
 // NewProblemApp exposes the core manager as an interface for other internal packages.
@@ -13,6 +13,7 @@ import (
 	"fuzoj/internal/common/storage"
 	pkgerrors "fuzoj/pkg/errors"
 	"fuzoj/services/problem_service/internal/repository"
+	"fuzoj/services/problem_service/internal/seekablepack"
 
 	"github.com/zeromicro/go-zero/core/logx"
 	"github.com/zeromicro/go-zero/core/stores/sqlx"
@@ -39,12 +40,17 @@ type problemApp struct {
 	sessionTTL        time.Duration
 	presignTTL        time.Duration
 	statementMaxBytes int
+	seekableBuilder   seekableBuilder
 }
 
 type cleanupPublisher interface {
 	PublishProblemDeleted(ctx context.Context, problemID int64) error
 }
 
+type seekableBuilder interface {
+	Enqueue(job seekablepack.Job) bool
+}
+
 type metaInvalidationPublisher interface {
 	PublishProblemMetaInvalidated(ctx context.Context, problemID int64, version int32) error
 }
@@ -474,6 +480,13 @@ func (m *problemApp) CompleteDataPackUpload(ctx context.Context, input CompleteU
 		logx.WithContext(ctx).Errorf("complete upload persist failed upload_id=%d err=%v", session.ID, err)
 		return CompleteUploadOutput{}, pkgerrors.Wrap(fmt.Errorf("complete upload persist failed: %w", err), pkgerrors.DatabaseError)
 	}
+	if m.seekableBuilder != nil {
+		// The seekable pack only speeds up judges; they fall back to the tar.zst without it.
+		job := seekablepack.Job{Bucket: session.Bucket, ObjectKey: session.ObjectKey, DataPackHash: input.DataPackHash}
+		if !m.seekableBuilder.Enqueue(job) {
+			logx.WithContext(ctx).Errorf("seekable data pack queue full object_key=%s", session.ObjectKey)
+		}
+	}
 
 	return CompleteUploadOutput{
 		ProblemID:    session.ProblemID,
@@ -0,0 +1,160 @@
+// Package seekablepack builds seekable copies of uploaded data packs in the
+// background, so completing an upload does not stream the whole pack through
+// the RPC. Judges fall back to the tar.zst until the copy exists.
+package seekablepack
+
+import (
+	"context"
+	"fmt"
+	"io"
+	"os"
+	"strings"
+	"sync"
+	"time"
+
+	"fuzoj/internal/common/storage"
+	"fuzoj/pkg/problem/seekpack"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+const (
+	contentType      = "application/octet-stream"
+	defaultWorkers   = 2
+	defaultQueueSize = 64
+	defaultTimeout   = 10 * time.Minute
+)
+
+// Job names one completed data pack.
+type Job struct {
+	Bucket       string
+	ObjectKey    string
+	DataPackHash string
+}
+
+// Options tunes the builder; zero values use the defaults.
+type Options struct {
+	Workers   int
+	QueueSize int
+	Timeout   time.Duration
+}
+
+// Builder runs seekable pack builds on a fixed set of workers.
+type Builder struct {
+	storage storage.ObjectStorage
+	timeout time.Duration
+	jobs    chan Job
+	wg      sync.WaitGroup
+
+	mu     sync.RWMutex
+	closed bool
+}
+
+func NewBuilder(storageClient storage.ObjectStorage, opts Options) *Builder {
+	if opts.Workers <= 0 {
+		opts.Workers = defaultWorkers
+	}
+	if opts.QueueSize <= 0 {
+		opts.QueueSize = defaultQueueSize
+	}
+	if opts.Timeout <= 0 {
+		opts.Timeout = defaultTimeout
+	}
+	b := &Builder{
+		storage: storageClient,
+		timeout: opts.Timeout,
+		jobs:    make(chan Job, opts.QueueSize),
+	}
+	for i := 0; i < opts.Workers; i++ {
+		b.wg.Add(1)
+		go b.work()
+	}
+	return b
+}
+
+// Enqueue schedules a build without blocking. It returns false when the queue
+// is full or the builder is closed; the pack then stays without a seekable copy.
+func (b *Builder) Enqueue(job Job) bool {
+	if b == nil {
+		return false
+	}
+	b.mu.RLock()
+	defer b.mu.RUnlock()
+	if b.closed {
+		return false
+	}
+	select {
+	case b.jobs <- job:
+		return true
+	default:
+		return false
+	}
+}
+
+// Close stops accepting jobs and waits for queued builds to finish.
+func (b *Builder) Close() {
+	if b == nil {
+		return
+	}
+	b.mu.Lock()
+	if b.closed {
+		b.mu.Unlock()
+		return
+	}
+	b.closed = true
+	close(b.jobs)
+	b.mu.Unlock()
+	b.wg.Wait()
+}
+
+func (b *Builder) work() {
+	defer b.wg.Done()
+	for job := range b.jobs {
+		ctx, cancel := context.WithTimeout(context.Background(), b.timeout)
+		start := time.Now()
+		if err := Build(ctx, b.storage, job.Bucket, job.ObjectKey, job.DataPackHash); err != nil {
+			logx.WithContext(ctx).Errorf("build seekable data pack failed object_key=%s err=%v", job.ObjectKey, err)
+		} else {
+			logx.WithContext(ctx).Infof("seekable data pack built object_key=%s cost=%s", job.ObjectKey, time.Since(start))
+		}
+		cancel()
+	}
+}
+
+// Build re-encodes the uploaded tar.zst so judges can fetch single files by range.
+// The copy is staged in a temp file because PutObject needs the final size.
+func Build(ctx context.Context, storageClient storage.ObjectStorage, bucket, objectKey, dataPackHash string) error {
+	reader, err := storageClient.GetObject(ctx, bucket, objectKey)
+	if err != nil {
+		return fmt.Errorf("open data pack failed: %w", err)
+	}
+	defer reader.Close()
+
+	tmp, err := os.CreateTemp("", "seekable-pack-*")
+	if err != nil {
+		return fmt.Errorf("create temp file failed: %w", err)
+	}
+	defer func() {
+		_ = tmp.Close()
+		_ = os.Remove(tmp.Name())
+	}()
+
+	_, packHash, err := seekpack.Build(reader, tmp)
+	if err != nil {
+		return err
+	}
+	if !strings.EqualFold(packHash, dataPackHash) {
+		return fmt.Errorf("data pack hash mismatch expected=%s actual=%s", dataPackHash, packHash)
+	}
+	size, err := tmp.Seek(0, io.SeekCurrent)
+	if err != nil {
+		return fmt.Errorf("stat temp file failed: %w", err)
+	}
+	if _, err := tmp.Seek(0, io.SeekStart); err != nil {
+		return fmt.Errorf("rewind temp file failed: %w", err)
+	}
+	if err := storageClient.PutObject(ctx, bucket, seekpack.ObjectKey(objectKey), tmp, size, contentType); err != nil {
+		return fmt.Errorf("upload seekable pack failed: %w", err)
+	}
+	return nil
+}
@@ -13,6 +13,7 @@ import (
 	"fuzoj/services/problem_service/internal/logic/cleanup"
 	"fuzoj/services/problem_service/internal/metainvalidation"
 	"fuzoj/services/problem_service/internal/repository"
+	"fuzoj/services/problem_service/internal/seekablepack"
 
 	red "github.com/redis/go-redis/v9"
 	"github.com/zeromicro/go-queue/kq"
@@ -36,6 +37,7 @@ type ServiceContext struct {
 	CleanupPublisher *cleanup.ProblemCleanupPublisher
 	MetaPublisher    MetaPublisher
 	DeadLetterPusher *kq.Pusher
+	SeekableBuilder  *seekablepack.Builder
 }
 
 type MetaPublisher interface {
@@ -107,6 +109,15 @@ func NewServiceContext(c config.Config) *ServiceContext {
 		}
 	}
 
+	var seekableBuilder *seekablepack.Builder
+	if c.Upload.SeekableDataPack && storageClient != nil {
+		seekableBuilder = seekablepack.NewBuilder(storageClient, seekablepack.Options{
+			Workers:   c.Upload.SeekableWorkers,
+			QueueSize: c.Upload.SeekableQueue,
+			Timeout:   c.Upload.SeekableTimeout,
+		})
+	}
+
 	return &ServiceContext{
 		Config:           c,
 		Conn:             conn,
@@ -120,6 +131,7 @@ func NewServiceContext(c config.Config) *ServiceContext {
 		CleanupPublisher: cleanupPublisher,
 		MetaPublisher:    metaPublisher,
 		DeadLetterPusher: deadLetterPusher,
+		SeekableBuilder:  seekableBuilder,
 	}
 }
 
@@ -137,6 +137,9 @@ func main() {
 	if ctx.MetaPublisher != nil {
 		defer ctx.MetaPublisher.Close()
 	}
+	if ctx.SeekableBuilder != nil {
+		defer ctx.SeekableBuilder.Close()
+	}
 	if ctx.DeadLetterPusher != nil {
 		defer ctx.DeadLetterPusher.Close()
 	}
@@ -11,6 +11,7 @@ import (
 	pkgerrors "fuzoj/pkg/errors"
 	"fuzoj/services/problem_service/internal/handler"
 	"fuzoj/services/problem_service/internal/repository"
+	"fuzoj/services/problem_service/internal/seekablepack"
 	"fuzoj/services/problem_service/internal/types"
 
 	"github.com/zeromicro/go-zero/core/stores/sqlx"
@@ -74,6 +75,79 @@ func TestCompleteUploadHandler(t *testing.T) {
 		}
 	})
 
+	t.Run("seekable pack built in background", func(t *testing.T) {
+		uploadRepo := &fakeUploadRepo{
+			getSessionByIDFn: func(ctx context.Context, session sqlx.Session, uploadSessionID int64) (repository.UploadSession, error) {
+				return repository.UploadSession{
+					ID:        uploadSessionID,
+					ProblemID: 1,
+					Version:   2,
+					Bucket:    "problem-bucket",
+					ObjectKey: "problems/1/versions/2/data-pack.tar.zst",
+					UploadID:  "upload-1",
+					State:     repository.UploadStateUploading,
+					ExpiresAt: time.Now().Add(10 * time.Minute),
+				}, nil
+			},
+			getProblemVersionIDFn: func(ctx context.Context, session sqlx.Session, problemID int64, version int32) (int64, error) {
+				return 99, nil
+			},
+			updateProblemDraftMetaFn: func(ctx context.Context, session sqlx.Session, problemID int64, version int32, configJSON []byte, manifestHash, dataPackKey, dataPackHash string) error {
+				return nil
+			},
+			upsertManifestFn: func(ctx context.Context, session sqlx.Session, problemVersionID int64, manifestJSON []byte) error {
+				return nil
+			},
+			upsertDataPackFn: func(ctx context.Context, session sqlx.Session, problemVersionID int64, objectKey string, sizeBytes int64, md5, sha256 string) error {
+				return nil
+			},
+			markCompletedFn: func(ctx context.Context, session sqlx.Session, uploadSessionID int64) error {
+				return nil
+			},
+		}
+		release := make(chan struct{})
+		fetched := make(chan string, 1)
+		st := &fakeStorage{
+			completeMultipartFn: func(ctx context.Context, bucket, objectKey, uploadID string, parts []storage.CompletedPart) (string, error) {
+				return "etag", nil
+			},
+			statObjectFn: func(ctx context.Context, bucket, objectKey string) (storage.ObjectStat, error) {
+				return storage.ObjectStat{SizeBytes: 10}, nil
+			},
+			getObjectFn: func(ctx context.Context, bucket, objectKey string) (storage.ObjectReader, error) {
+				<-release
+				fetched <- objectKey
+				return nil, errors.New("stop after fetch")
+			},
+		}
+		cfg := defaultTestConfig()
+		cfg.Upload.SeekableDataPack = true
+		ctx := newTestServiceContext(&fakeProblemRepo{}, nil, uploadRepo, st, cfg)
+		ctx.SeekableBuilder = seekablepack.NewBuilder(st, seekablepack.Options{Workers: 1})
+		body := map[string]any{
+			"parts":          []types.CompletedPartInput{{PartNumber: 1, ETag: "etag"}},
+			"manifest_json":  `{"name":"x"}`,
+			"config_json":    `{"version":1}`,
+			"manifest_hash":  "mh",
+			"data_pack_hash": "dh",
+		}
+		// The build blocks until release, so the request must not wait for it.
+		rr := doRequest(t, handler.CompleteUploadHandler(ctx), http.MethodPost, "/api/v1/problems/1/data-pack/uploads/1/complete", body, nil, map[string]string{"id": "1", "upload_id": "1"})
+		if rr.Code != http.StatusOK {
+			t.Fatalf("unexpected status: %d", rr.Code)
+		}
+		close(release)
+		ctx.SeekableBuilder.Close()
+		select {
+		case key := <-fetched:
+			if key != "problems/1/versions/2/data-pack.tar.zst" {
+				t.Fatalf("unexpected data pack key %s", key)
+			}
+		default:
+			t.Fatalf("expected seekable build to read the data pack")
+		}
+	})
+
 	t.Run("invalid params", func(t *testing.T) {
 		ctx := newTestServiceContext(&fakeProblemRepo{}, nil, &fakeUploadRepo{}, &fakeStorage{}, defaultTestConfig())
 		body := map[string]any{
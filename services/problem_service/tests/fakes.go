@@ -237,10 +237,18 @@ type fakeStorage struct {
 	listObjectsFn           func(ctx context.Context, bucket, prefix string) <-chan storage.ObjectInfo
 	removeObjectsFn         func(ctx context.Context, bucket string, keys []string) error
 	listMultipartUploadsFn  func(ctx context.Context, bucket, prefix, keyMarker, uploadIDMarker string, maxUploads int) (storage.ListMultipartUploadsResult, error)
+	getObjectFn             func(ctx context.Context, bucket, objectKey string) (storage.ObjectReader, error)
 }
 
 func (f *fakeStorage) GetObject(ctx context.Context, bucket, objectKey string) (storage.ObjectReader, error) {
-	return nil, errors.New("get object not implemented")
+	if f.getObjectFn == nil {
+		return nil, errors.New("get object not implemented")
+	}
+	return f.getObjectFn(ctx, bucket, objectKey)
+}
+
+func (f *fakeStorage) GetObjectRange(ctx context.Context, bucket, objectKey string, offset, length int64) (storage.ObjectReader, error) {
+	return nil, errors.New("get object range not implemented")
 }
 
 func (f *fakeStorage) PutObject(ctx context.Context, bucket, objectKey string, reader storage.ObjectReader, sizeBytes int64, contentType string) error {
@@ -8,6 +8,7 @@ import (
 	"time"
 
 	rankpb "fuzoj/api/proto/rank"
+	"fuzoj/pkg/contest/rankdetail"
 	appErr "fuzoj/pkg/errors"
 
 	red "github.com/redis/go-redis/v9"
@@ -173,17 +174,19 @@ func (r *LeaderboardRepository) GetMember(ctx context.Context, contestID, member
 	}, nil
 }
 
+// loadSummary reads the member hash; DetailJSON is assembled from its problem cells.
 func (r *LeaderboardRepository) loadSummary(ctx context.Context, contestID, memberID string) (*leaderboardSummary, error) {
 	if r.redis == nil {
 		return nil, appErr.New(appErr.ServiceUnavailable).WithMessage("redis is not configured")
 	}
-	val, err := r.redis.HgetCtx(ctx, detailKey(contestID, memberID), "summary")
+	fields, err := r.redis.HgetallCtx(ctx, detailKey(contestID, memberID))
 	if err != nil {
 		if errors.Is(err, red.Nil) {
 			return nil, nil
 		}
 		return nil, appErr.Wrapf(err, appErr.CacheError, "load summary failed")
 	}
+	val := fields["summary"]
 	if val == "" {
 		return nil, nil
 	}
@@ -191,6 +194,7 @@ func (r *LeaderboardRepository) loadSummary(ctx context.Context, contestID, memb
 	if err := json.Unmarshal([]byte(val), &summary); err != nil {
 		return nil, fmt.Errorf("decode summary failed: %w", err)
 	}
+	summary.DetailJSON = rankdetail.Detail(rankdetail.CellsFromHash(fields), summary.DetailJSON, summary.UpdatedAt)
 	return &summary, nil
 }
 
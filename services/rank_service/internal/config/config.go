@@ -55,6 +55,11 @@ type RankConfig struct {
 		MainTableFallbackEnabled bool          `json:"mainTableFallbackEnabled"`
 		RebuildBatchSize         int           `json:"rebuildBatchSize"`
 	} `json:"recover"`
+	// MemoryRanking serves live pages from an in-process ranking engine; Redis is still written.
+	// Only contests whose rank updates this instance consumes are served from memory.
+	MemoryRanking bool `json:"memoryRanking,optional"`
+	// MemoryIdleTTL evicts in-memory boards of contests without updates for this long.
+	MemoryIdleTTL time.Duration `json:"memoryIdleTTL,optional"`
 }
 
 type TimeoutConfig struct {
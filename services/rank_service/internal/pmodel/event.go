@@ -1,5 +1,7 @@
 package pmodel
 
+import "fuzoj/pkg/contest/rankdetail"
+
 // RankUpdateEvent represents a pre-computed leaderboard update payload.
 type RankUpdateEvent struct {
 	ContestID  string `json:"contest_id"`
@@ -9,20 +11,38 @@ type RankUpdateEvent struct {
 	ScoreTotal int64  `json:"score_total"`
 	Penalty    int64  `json:"penalty_total"`
 	ACCount    int64  `json:"ac_count"`
+	// ProblemDetail is the detail cell of ProblemID.
+	ProblemDetail string `json:"problem_detail"`
+	// DetailJSON is the whole member detail, sent by producers that predate problem cells.
 	DetailJSON string `json:"detail_json"`
 	Version    string `json:"version"`
 	ResultID   int64  `json:"result_id"`
 	UpdatedAt  int64  `json:"updated_at"`
+	// Cells carries every problem cell of the member when rebuilding from MySQL.
+	Cells map[string]string `json:"-"`
+}
+
+// DetailCells returns the problem cells written by the event, keyed by problem id.
+func (e RankUpdateEvent) DetailCells() map[string]string {
+	if len(e.Cells) > 0 {
+		return e.Cells
+	}
+	if e.ProblemID != "" && e.ProblemDetail != "" {
+		return map[string]string{e.ProblemID: e.ProblemDetail}
+	}
+	return rankdetail.Split(e.DetailJSON)
 }
 
-// LeaderboardSummary holds stored summary fields.
+// LeaderboardSummary holds stored summary fields. Problem detail lives in the
+// "p:<problem>" cells of the member hash; DetailJSON is only set on summaries
+// written before cells existed.
 type LeaderboardSummary struct {
 	MemberID   string `json:"member_id"`
 	SortScore  int64  `json:"sort_score"`
 	ScoreTotal int64  `json:"score_total"`
 	Penalty    int64  `json:"penalty_total"`
 	ACCount    int64  `json:"ac_count"`
-	DetailJSON string `json:"detail_json"`
+	DetailJSON string `json:"detail_json,omitempty"`
 	UpdatedAt  int64  `json:"updated_at"`
 	Version    string `json:"version"`
 }
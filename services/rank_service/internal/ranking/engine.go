@@ -0,0 +1,386 @@
+package ranking
+
+import (
+	"strconv"
+	"sync"
+	"time"
+
+	"fuzoj/pkg/contest/rankdetail"
+	"fuzoj/services/rank_service/internal/pmodel"
+	"fuzoj/services/rank_service/internal/types"
+)
+
+// Entry is the in-memory state of one member, mirroring the Redis summary
+// plus the ordering gates of the apply script.
+type Entry struct {
+	MemberID   string
+	SortScore  int64
+	ScoreTotal int64
+	Penalty    int64
+	ACCount    int64
+	// Cells holds the per-problem detail cells; it is replaced, never mutated,
+	// so copies handed out by Entries stay stable.
+	Cells map[string]string
+	// DetailJSON is the whole member detail of summaries written before cells existed.
+	DetailJSON string
+	UpdatedAt  int64
+	Version    string
+	ResultID   int64
+	VersionNum int64
+}
+
+// Engine keeps live leaderboards in process. A contest is only served once it
+// has been loaded from Redis; updates for contests that are not loaded are
+// dropped since Redis stays the source they are loaded from.
+//
+// A board only stays current while this process consumes every update of its
+// contest, i.e. owns the contest's Kafka partition. Owned reports whether
+// updates were applied here recently, and Evict forgets contests that went
+// quiet, which covers ended contests and partitions moved to another replica.
+type Engine struct {
+	mu      sync.RWMutex
+	boards  map[string]*board
+	idleTTL time.Duration
+	// applied records when updates of a contest were last applied here.
+	applied map[string]time.Time
+}
+
+type board struct {
+	mu      sync.RWMutex
+	ready   bool
+	list    *skiplist
+	members map[string]*Entry
+	version int64
+	// resultID is the highest result id applied, mirroring the meta seen_result_id.
+	resultID int64
+	// buffered holds updates applied to Redis while the board was loading.
+	buffered []bufferedUpdate
+}
+
+type bufferedUpdate struct {
+	events      []pmodel.RankUpdateEvent
+	maxVersion  int64
+	maxResultID int64
+}
+
+// NewEngine creates an engine evicting contests without updates for idleTTL;
+// a non-positive idleTTL uses defaultIdleTTL.
+func NewEngine(idleTTL time.Duration) *Engine {
+	if idleTTL <= 0 {
+		idleTTL = defaultIdleTTL
+	}
+	return &Engine{
+		boards:  make(map[string]*board),
+		idleTTL: idleTTL,
+		applied: make(map[string]time.Time),
+	}
+}
+
+const defaultIdleTTL = 10 * time.Minute
+
+// Load is an in-flight load of one contest, started by BeginLoad.
+type Load struct {
+	engine    *Engine
+	contestID string
+	board     *board
+}
+
+// BeginLoad reserves contestID for loading. It returns nil when the contest is
+// already loaded or being loaded.
+func (e *Engine) BeginLoad(contestID string) *Load {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	if _, ok := e.boards[contestID]; ok {
+		return nil
+	}
+	b := &board{members: make(map[string]*Entry)}
+	e.boards[contestID] = b
+	return &Load{engine: e, contestID: contestID, board: b}
+}
+
+// Finish installs the loaded entries, replays updates that arrived meanwhile
+// and starts serving the contest. version and resultID are the meta version
+// and seen_result_id read before the entries.
+func (l *Load) Finish(entries []Entry, version, resultID int64) {
+	b := l.board
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	b.list = newSkiplist(time.Now().UnixNano())
+	for i := range entries {
+		entry := entries[i]
+		if entry.MemberID == "" {
+			continue
+		}
+		if old, ok := b.members[entry.MemberID]; ok {
+			b.list.remove(rankKey{score: old.SortScore, member: old.MemberID})
+		}
+		b.members[entry.MemberID] = &entry
+		b.list.insert(rankKey{score: entry.SortScore, member: entry.MemberID})
+	}
+	b.version = version
+	b.resultID = resultID
+	for _, update := range b.buffered {
+		b.apply(update.events, update.maxVersion, update.maxResultID)
+	}
+	b.buffered = nil
+	b.ready = true
+}
+
+// Abort releases the reservation so a later query can retry.
+func (l *Load) Abort() {
+	l.engine.mu.Lock()
+	defer l.engine.mu.Unlock()
+	if l.engine.boards[l.contestID] == l.board {
+		delete(l.engine.boards, l.contestID)
+	}
+}
+
+// Drop forgets a contest, e.g. after Redis was restored from a snapshot.
+func (e *Engine) Drop(contestID string) {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	delete(e.boards, contestID)
+}
+
+// Owned reports whether updates of contestID were applied here within the idle
+// TTL. Contests consumed by another replica are never loaded, since their
+// boards would not see any update.
+func (e *Engine) Owned(contestID string) bool {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+	last, ok := e.applied[contestID]
+	return ok && time.Since(last) < e.idleTTL
+}
+
+// Evict forgets contests without updates for the idle TTL and returns their ids.
+func (e *Engine) Evict(now time.Time) []string {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	var evicted []string
+	for contestID, last := range e.applied {
+		if now.Sub(last) < e.idleTTL {
+			continue
+		}
+		delete(e.applied, contestID)
+		if _, ok := e.boards[contestID]; ok {
+			delete(e.boards, contestID)
+			evicted = append(evicted, contestID)
+		}
+	}
+	for contestID := range e.boards {
+		if _, ok := e.applied[contestID]; !ok {
+			delete(e.boards, contestID)
+			evicted = append(evicted, contestID)
+		}
+	}
+	return evicted
+}
+
+func (e *Engine) board(contestID string) *board {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+	return e.boards[contestID]
+}
+
+// Apply mirrors a batch that was just written to Redis for one contest.
+// maxVersion and maxResultID are the meta watermarks the batch carried.
+func (e *Engine) Apply(contestID string, events []pmodel.RankUpdateEvent, maxVersion, maxResultID int64) {
+	e.mu.Lock()
+	e.applied[contestID] = time.Now()
+	b := e.boards[contestID]
+	e.mu.Unlock()
+	if b == nil {
+		return
+	}
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	if !b.ready {
+		b.buffered = append(b.buffered, bufferedUpdate{events: events, maxVersion: maxVersion, maxResultID: maxResultID})
+		return
+	}
+	b.apply(events, maxVersion, maxResultID)
+}
+
+// apply follows the gates of the Redis apply script: an event replaces the
+// member only if its result id (or, without one, its version) is newer.
+func (b *board) apply(events []pmodel.RankUpdateEvent, maxVersion, maxResultID int64) {
+	for _, event := range events {
+		if event.MemberID == "" {
+			continue
+		}
+		versionNum, err := strconv.ParseInt(event.Version, 10, 64)
+		if err != nil {
+			versionNum = 0
+		}
+		current := b.members[event.MemberID]
+		var currentResultID, currentVersion int64
+		if current != nil {
+			currentResultID = current.ResultID
+			currentVersion = current.VersionNum
+		}
+		shouldApply := false
+		if event.ResultID > 0 {
+			shouldApply = event.ResultID > currentResultID
+		} else if versionNum > 0 {
+			shouldApply = versionNum > currentVersion
+		}
+		if !shouldApply {
+			continue
+		}
+		next := &Entry{
+			MemberID:   event.MemberID,
+			SortScore:  event.SortScore,
+			ScoreTotal: event.ScoreTotal,
+			Penalty:    event.Penalty,
+			ACCount:    event.ACCount,
+			UpdatedAt:  event.UpdatedAt,
+			Version:    event.Version,
+			ResultID:   maxInt64(event.ResultID, currentResultID),
+			VersionNum: maxInt64(versionNum, currentVersion),
+		}
+		if current != nil {
+			next.Cells, next.DetailJSON = current.Cells, current.DetailJSON
+			b.list.remove(rankKey{score: current.SortScore, member: current.MemberID})
+		}
+		next.Cells = mergeCells(next.Cells, event.DetailCells())
+		b.members[event.MemberID] = next
+		b.list.insert(rankKey{score: next.SortScore, member: next.MemberID})
+		if versionNum > b.version {
+			b.version = versionNum
+		}
+	}
+	if maxVersion > b.version {
+		b.version = maxVersion
+	}
+	if maxResultID > b.resultID {
+		b.resultID = maxResultID
+	}
+}
+
+// Page returns a page of a loaded contest; ok is false when the caller should
+// fall back to Redis.
+func (e *Engine) Page(contestID string, page, pageSize int) (types.LeaderboardPayload, bool) {
+	b := e.board(contestID)
+	if b == nil {
+		return types.LeaderboardPayload{}, false
+	}
+	b.mu.RLock()
+	defer b.mu.RUnlock()
+	if !b.ready {
+		return types.LeaderboardPayload{}, false
+	}
+	start := (page-1)*pageSize + 1
+	items := make([]types.LeaderboardEntry, 0, minInt(pageSize, maxInt(0, b.list.length-start+1)))
+	rank := start
+	for node := b.list.at(start); node != nil && len(items) < pageSize; node = node.next[0].node {
+		items = append(items, toLeaderboardEntry(b.members[node.key.member], int64(rank)))
+		rank++
+	}
+	return types.LeaderboardPayload{
+		Items: items,
+		Page: types.PageInfo{
+			Page:     page,
+			PageSize: pageSize,
+			Total:    int64(b.list.length),
+		},
+		Version: formatVersion(b.version),
+	}, true
+}
+
+// Member returns the entry of one member. ok is false when the contest is not
+// loaded; found is false when the member is not ranked.
+func (e *Engine) Member(contestID, memberID string) (entry types.LeaderboardEntry, version string, found, ok bool) {
+	b := e.board(contestID)
+	if b == nil {
+		return types.LeaderboardEntry{}, "", false, false
+	}
+	b.mu.RLock()
+	defer b.mu.RUnlock()
+	if !b.ready {
+		return types.LeaderboardEntry{}, "", false, false
+	}
+	current := b.members[memberID]
+	if current == nil {
+		return types.LeaderboardEntry{}, "", false, true
+	}
+	rank := b.list.rank(rankKey{score: current.SortScore, member: current.MemberID})
+	return toLeaderboardEntry(current, int64(rank)), formatVersion(b.version), true, true
+}
+
+// Entries returns all members of a loaded contest in rank order. ok is false
+// unless the board is exactly at the given meta version and seen result id,
+// so a board that missed or is ahead of Redis is never checkpointed.
+func (e *Engine) Entries(contestID string, version, resultID int64) ([]Entry, bool) {
+	b := e.board(contestID)
+	if b == nil {
+		return nil, false
+	}
+	b.mu.RLock()
+	defer b.mu.RUnlock()
+	if !b.ready || b.version != version || b.resultID != resultID {
+		return nil, false
+	}
+	out := make([]Entry, 0, b.list.length)
+	for node := b.head(); node != nil; node = node.next[0].node {
+		out = append(out, *b.members[node.key.member])
+	}
+	return out, true
+}
+
+func (b *board) head() *skipNode {
+	return b.list.head.next[0].node
+}
+
+func toLeaderboardEntry(entry *Entry, rank int64) types.LeaderboardEntry {
+	return types.LeaderboardEntry{
+		MemberId: entry.MemberID,
+		Rank:     rank,
+		Score:    entry.ScoreTotal,
+		Penalty:  entry.Penalty,
+		Detail:   rankdetail.Detail(entry.Cells, entry.DetailJSON, entry.UpdatedAt),
+	}
+}
+
+// mergeCells returns a new map with the changed cells applied over current.
+func mergeCells(current, changed map[string]string) map[string]string {
+	if len(changed) == 0 {
+		return current
+	}
+	merged := make(map[string]string, len(current)+len(changed))
+	for problemID, cell := range current {
+		merged[problemID] = cell
+	}
+	for problemID, cell := range changed {
+		merged[problemID] = cell
+	}
+	return merged
+}
+
+// formatVersion renders the version like the Redis meta field, which is unset until positive.
+func formatVersion(version int64) string {
+	if version <= 0 {
+		return ""
+	}
+	return strconv.FormatInt(version, 10)
+}
+
+func maxInt64(a, b int64) int64 {
+	if a > b {
+		return a
+	}
+	return b
+}
+
+func minInt(a, b int) int {
+	if a < b {
+		return a
+	}
+	return b
+}
+
+func maxInt(a, b int) int {
+	if a > b {
+		return a
+	}
+	return b
+}
@@ -0,0 +1,160 @@
+package ranking
+
+import "math/rand"
+
+const (
+	skiplistMaxLevel = 32
+	// skiplistBranch gives each level a 1/4 chance of promotion, as Redis zsets do.
+	skiplistBranch = 4
+)
+
+// rankKey orders members like ZREVRANGE: higher sort score first, ties by
+// member id descending.
+type rankKey struct {
+	score  int64
+	member string
+}
+
+func (k rankKey) before(other rankKey) bool {
+	if k.score != other.score {
+		return k.score > other.score
+	}
+	return k.member > other.member
+}
+
+type skipLink struct {
+	node *skipNode
+	// span counts the level-0 steps this link jumps over.
+	span int
+}
+
+type skipNode struct {
+	key  rankKey
+	next []skipLink
+}
+
+// skiplist is an indexable skiplist: every link carries its span, so rank of
+// a key and the node at a rank are both found in O(log n).
+type skiplist struct {
+	head   *skipNode
+	level  int
+	length int
+	rng    *rand.Rand
+}
+
+func newSkiplist(seed int64) *skiplist {
+	return &skiplist{
+		head:  &skipNode{next: make([]skipLink, skiplistMaxLevel)},
+		level: 1,
+		rng:   rand.New(rand.NewSource(seed)),
+	}
+}
+
+func (s *skiplist) randomLevel() int {
+	level := 1
+	for level < skiplistMaxLevel && s.rng.Intn(skiplistBranch) == 0 {
+		level++
+	}
+	return level
+}
+
+// insert adds key, which must not be present.
+func (s *skiplist) insert(key rankKey) {
+	var update [skiplistMaxLevel]*skipNode
+	var rank [skiplistMaxLevel]int
+	x := s.head
+	for i := s.level - 1; i >= 0; i-- {
+		if i < s.level-1 {
+			rank[i] = rank[i+1]
+		}
+		for x.next[i].node != nil && x.next[i].node.key.before(key) {
+			rank[i] += x.next[i].span
+			x = x.next[i].node
+		}
+		update[i] = x
+	}
+	level := s.randomLevel()
+	if level > s.level {
+		for i := s.level; i < level; i++ {
+			rank[i] = 0
+			update[i] = s.head
+			update[i].next[i].span = s.length
+		}
+		s.level = level
+	}
+	node := &skipNode{key: key, next: make([]skipLink, level)}
+	for i := 0; i < level; i++ {
+		node.next[i].node = update[i].next[i].node
+		update[i].next[i].node = node
+		node.next[i].span = update[i].next[i].span - (rank[0] - rank[i])
+		update[i].next[i].span = rank[0] - rank[i] + 1
+	}
+	for i := level; i < s.level; i++ {
+		update[i].next[i].span++
+	}
+	s.length++
+}
+
+// remove deletes key and reports whether it was present.
+func (s *skiplist) remove(key rankKey) bool {
+	var update [skiplistMaxLevel]*skipNode
+	x := s.head
+	for i := s.level - 1; i >= 0; i-- {
+		for x.next[i].node != nil && x.next[i].node.key.before(key) {
+			x = x.next[i].node
+		}
+		update[i] = x
+	}
+	x = x.next[0].node
+	if x == nil || x.key != key {
+		return false
+	}
+	for i := 0; i < s.level; i++ {
+		if update[i].next[i].node == x {
+			update[i].next[i].span += x.next[i].span - 1
+			update[i].next[i].node = x.next[i].node
+		} else {
+			update[i].next[i].span--
+		}
+	}
+	for s.level > 1 && s.head.next[s.level-1].node == nil {
+		s.level--
+	}
+	s.length--
+	return true
+}
+
+// rank returns the 1-based position of key, or 0 if it is absent.
+func (s *skiplist) rank(key rankKey) int {
+	x := s.head
+	rank := 0
+	for i := s.level - 1; i >= 0; i-- {
+		for x.next[i].node != nil && !key.before(x.next[i].node.key) {
+			rank += x.next[i].span
+			x = x.next[i].node
+		}
+		if x != s.head && x.key == key {
+			return rank
+		}
+	}
+	return 0
+}
+
+// at returns the node at the 1-based rank, or nil when out of range.
+func (s *skiplist) at(rank int) *skipNode {
+	if rank <= 0 || rank > s.length {
+		return nil
+	}
+	x := s.head
+	traversed := 0
+	for i := s.level - 1; i >= 0; i-- {
+		for x.next[i].node != nil && traversed+x.next[i].span <= rank {
+			traversed += x.next[i].span
+			x = x.next[i].node
+		}
+		if traversed == rank {
+			return x
+		}
+	}
+	return nil
+}
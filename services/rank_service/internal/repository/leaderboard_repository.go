@@ -10,8 +10,10 @@ import (
 	"strings"
 	"time"
 
+	"fuzoj/pkg/contest/rankdetail"
 	appErr "fuzoj/pkg/errors"
 	"fuzoj/services/rank_service/internal/pmodel"
+	"fuzoj/services/rank_service/internal/ranking"
 	"fuzoj/services/rank_service/internal/types"
 
 	red "github.com/redis/go-redis/v9"
@@ -53,19 +55,20 @@ if currentRecoveryResultId == 0 then
 end
 local currentVersion = tonumber(redis.call("HGET", metaKey, "version") or "0") or 0
 
-local offset = 9
-local stride = 7
+-- Each event is memberId, sortScore, summaryJSON, resultId, version, cellCount,
+-- followed by cellCount (problemId, cellJSON) pairs.
+local cursor = 9
 local applied = 0
 
-for i = 0, eventCount - 1 do
-	local base = offset + i * stride
-	local memberId = ARGV[base + 1] or ""
-	local sortScore = tonumber(ARGV[base + 2]) or 0
-	local summaryJSON = ARGV[base + 3] or ""
-	local problemId = ARGV[base + 4] or ""
-	local detailJSON = ARGV[base + 5] or ""
-	local resultId = tonumber(ARGV[base + 6]) or 0
-	local version = tonumber(ARGV[base + 7]) or 0
+for i = 1, eventCount do
+	local memberId = ARGV[cursor + 1] or ""
+	local sortScore = tonumber(ARGV[cursor + 2]) or 0
+	local summaryJSON = ARGV[cursor + 3] or ""
+	local resultId = tonumber(ARGV[cursor + 4]) or 0
+	local version = tonumber(ARGV[cursor + 5]) or 0
+	local cellCount = tonumber(ARGV[cursor + 6]) or 0
+	local cellBase = cursor + 6
+	cursor = cellBase + cellCount * 2
 
 	local memberKey = detailPrefix .. memberId
 	local memberResultId = tonumber(redis.call("HGET", memberKey, "result_id") or "0") or 0
@@ -83,8 +86,12 @@ for i = 0, eventCount - 1 do
 	if shouldApply and memberId ~= "" then
 		redis.call("ZADD", leaderboardKey, sortScore, memberId)
 		redis.call("HSET", memberKey, "summary", summaryJSON)
-		if problemId ~= "" and detailJSON ~= "" then
-			redis.call("HSET", memberKey, "p:" .. problemId, detailJSON)
+		for c = 1, cellCount do
+			local problemId = ARGV[cellBase + c * 2 - 1] or ""
+			local cellJSON = ARGV[cellBase + c * 2] or ""
+			if problemId ~= "" and cellJSON ~= "" then
+				redis.call("HSET", memberKey, "p:" .. problemId, cellJSON)
+			end
 		end
 		if resultId > memberResultId then
 			redis.call("HSET", memberKey, "result_id", tostring(resultId))
@@ -162,9 +169,8 @@ local version = redis.call("HGET", metaKey, "version") or ""
 local out = {tostring(total), tostring(version)}
 for i = 1, #memberIDs do
 	local memberId = memberIDs[i]
-	local summary = redis.call("HGET", detailPrefix .. memberId, "summary")
 	table.insert(out, memberId)
-	table.insert(out, summary or "")
+	table.insert(out, redis.call("HGETALL", detailPrefix .. memberId))
 end
 
 return out
@@ -175,6 +181,8 @@ type LeaderboardRepository struct {
 	redis    *redis.Redis
 	pageTTL  time.Duration
 	emptyTTL time.Duration
+	// memory is the optional in-process ranking engine for live mode.
+	memory *ranking.Engine
 }
 
 // UpdateApplier applies rank updates.
@@ -229,6 +237,9 @@ func (r *LeaderboardRepository) ApplyUpdates(ctx context.Context, events []pmode
 			logger.Errorf("apply contest updates failed: %v", err)
 			return err
 		}
+		if r.memory != nil {
+			r.memory.Apply(contestID, groupedEvents, metaInfo[contestID].MaxVersion, metaInfo[contestID].MaxResultID)
+		}
 	}
 	return nil
 }
@@ -362,6 +373,12 @@ func (r *LeaderboardRepository) GetPage(ctx context.Context, contestID string, p
 	if pageSize <= 0 {
 		pageSize = 50
 	}
+	if r.memory != nil && mode != "frozen" {
+		if payload, ok := r.memory.Page(contestID, page, pageSize); ok {
+			return payload, nil
+		}
+		r.ensureMemoryBoard(contestID)
+	}
 	version := r.loadVersion(ctx, contestID)
 	cacheKey := pageCacheKey(contestID, mode, page, pageSize, version)
 	cached, err := r.redis.GetCtx(ctx, cacheKey)
@@ -397,7 +414,7 @@ func (r *LeaderboardRepository) GetPage(ctx context.Context, contestID string, p
 			Rank:     int64(page-1)*int64(pageSize) + int64(idx) + 1,
 			Score:    summary.ScoreTotal,
 			Penalty:  summary.Penalty,
-			Detail:   summary.DetailJSON,
+			Detail:   rankdetail.Detail(row.cells, summary.DetailJSON, summary.UpdatedAt),
 		})
 	}
 	if versionFromScript != "" {
@@ -434,6 +451,16 @@ func (r *LeaderboardRepository) GetMember(ctx context.Context, contestID, member
 		logger.Error("contest_id and member_id are required")
 		return types.LeaderboardEntry{}, "", appErr.ValidationError("member_id", "required")
 	}
+	if r.memory != nil && mode != "frozen" {
+		entry, version, found, ok := r.memory.Member(contestID, memberID)
+		if ok {
+			if !found {
+				return types.LeaderboardEntry{}, "", appErr.New(appErr.NotFound).WithMessage("member not found")
+			}
+			return entry, version, nil
+		}
+		r.ensureMemoryBoard(contestID)
+	}
 	rank, err := r.redis.ZrevrankCtx(ctx, leaderboardKeyByMode(contestID, mode), memberID)
 	if err != nil {
 		if errors.Is(err, red.Nil) {
@@ -442,7 +469,7 @@ func (r *LeaderboardRepository) GetMember(ctx context.Context, contestID, member
 		logger.Errorf("load member rank failed: %v", err)
 		return types.LeaderboardEntry{}, "", appErr.Wrapf(err, appErr.CacheError, "load member rank failed")
 	}
-	summary, err := r.loadSummary(ctx, contestID, memberID)
+	summary, cells, err := r.loadSummary(ctx, contestID, memberID)
 	if err != nil {
 		return types.LeaderboardEntry{}, "", err
 	}
@@ -455,34 +482,33 @@ func (r *LeaderboardRepository) GetMember(ctx context.Context, contestID, member
 		Rank:     rank + 1,
 		Score:    summary.ScoreTotal,
 		Penalty:  summary.Penalty,
-		Detail:   summary.DetailJSON,
+		Detail:   rankdetail.Detail(cells, summary.DetailJSON, summary.UpdatedAt),
 	}
 	return entry, version, nil
 }
 
-func (r *LeaderboardRepository) loadSummary(ctx context.Context, contestID, memberID string) (*pmodel.LeaderboardSummary, error) {
+// loadSummary reads the member hash and returns its summary and problem cells.
+func (r *LeaderboardRepository) loadSummary(ctx context.Context, contestID, memberID string) (*pmodel.LeaderboardSummary, map[string]string, error) {
 	if r.redis == nil {
-		return nil, appErr.New(appErr.ServiceUnavailable).WithMessage("redis is not configured")
+		return nil, nil, appErr.New(appErr.ServiceUnavailable).WithMessage("redis is not configured")
 	}
-	val, err := r.redis.HgetCtx(ctx, detailKey(contestID, memberID), "summary")
+	fields, err := r.redis.HgetallCtx(ctx, detailKey(contestID, memberID))
 	if err != nil {
 		if errors.Is(err, red.Nil) {
-			return nil, nil
+			return nil, nil, nil
 		}
-		return nil, appErr.Wrapf(err, appErr.CacheError, "load summary failed")
+		return nil, nil, appErr.Wrapf(err, appErr.CacheError, "load summary failed")
 	}
-	if val == "" {
-		return nil, nil
+	summary, err := decodeSummary(fields["summary"])
+	if err != nil || summary == nil {
+		return nil, nil, err
 	}
-	var summary pmodel.LeaderboardSummary
-	if err := json.Unmarshal([]byte(val), &summary); err != nil {
-		return nil, fmt.Errorf("decode summary failed: %w", err)
-	}
-	return &summary, nil
+	return summary, rankdetail.CellsFromHash(fields), nil
 }
 
 type pageRow struct {
 	summaryJSON string
+	cells       map[string]string
 }
 
 func (r *LeaderboardRepository) loadPageRows(ctx context.Context, contestID, leaderboardKey string, start, stop int64) (int64, string, []pageRow, error) {
@@ -501,13 +527,28 @@ func (r *LeaderboardRepository) loadPageRows(ctx context.Context, contestID, lea
 	version := fmt.Sprint(values[1])
 	rows := make([]pageRow, 0, (len(values)-2)/2)
 	for i := 2; i+1 < len(values); i += 2 {
+		fields := hashFromPairs(values[i+1])
 		rows = append(rows, pageRow{
-			summaryJSON: fmt.Sprint(values[i+1]),
+			summaryJSON: fields["summary"],
+			cells:       rankdetail.CellsFromHash(fields),
 		})
 	}
 	return total, version, rows, nil
 }
 
+// hashFromPairs converts an HGETALL reply returned from a script into a map.
+func hashFromPairs(raw any) map[string]string {
+	pairs, ok := raw.([]any)
+	if !ok {
+		return nil
+	}
+	fields := make(map[string]string, len(pairs)/2)
+	for i := 0; i+1 < len(pairs); i += 2 {
+		fields[fmt.Sprint(pairs[i])] = fmt.Sprint(pairs[i+1])
+	}
+	return fields
+}
+
 func decodeSummary(summaryJSON string) (*pmodel.LeaderboardSummary, error) {
 	if summaryJSON == "" {
 		return nil, nil
@@ -621,7 +662,12 @@ func (r *LeaderboardRepository) RestoreSnapshotEntries(ctx context.Context, cont
 	if len(events) == 0 {
 		return nil
 	}
-	return r.applyContestEventsWithSummary(ctx, contestID, events, filteredEntries, RankUpdateMeta{}, false, true, 0)
+	err := r.applyContestEventsWithSummary(ctx, contestID, events, filteredEntries, RankUpdateMeta{}, false, true, 0)
+	if r.memory != nil {
+		// Restores bypass the ordering gates; reload from Redis on next read.
+		r.memory.Drop(contestID)
+	}
+	return err
 }
 
 // FinalizeSnapshotMeta updates snapshot-related meta fields after all entries are restored.
@@ -632,11 +678,15 @@ func (r *LeaderboardRepository) FinalizeSnapshotMeta(ctx context.Context, contes
 	if contestID == "" {
 		return appErr.ValidationError("contest_id", "required")
 	}
-	return r.applyContestEvents(ctx, contestID, nil, RankUpdateMeta{
+	err := r.applyContestEvents(ctx, contestID, nil, RankUpdateMeta{
 		MaxResultID:  maxResultID,
 		MaxVersion:   maxVersion,
 		MaxUpdatedAt: updatedAt,
 	}, true, false, snapshotAt)
+	if r.memory != nil {
+		r.memory.Drop(contestID)
+	}
+	return err
 }
 
 func (r *LeaderboardRepository) applyContestEvents(ctx context.Context, contestID string, events []pmodel.RankUpdateEvent, meta RankUpdateMeta, applyMeta, forceApply bool, snapshotAt int64) error {
@@ -652,9 +702,9 @@ func (r *LeaderboardRepository) applyContestEventsWithSummary(ctx context.Contex
 		applyRecoveryMeta = true
 	}
 	keys := []string{leaderboardKey(contestID), metaKey(contestID), pendingKey(contestID)}
-	args := make([]any, 0, 9+len(events)*7)
+	args := make([]any, 0, 9+len(events)*8)
 	args = append(args,
-		len(events),
+		0, // event count, set once events are encoded
 		boolToInt(applyMeta),
 		boolToInt(forceApply),
 		meta.MaxResultID,
@@ -664,6 +714,7 @@ func (r *LeaderboardRepository) applyContestEventsWithSummary(ctx context.Contex
 		boolToInt(applyRecoveryMeta),
 		detailPrefixForContest(contestID),
 	)
+	eventCount := 0
 	for i, event := range events {
 		if event.MemberID == "" {
 			continue
@@ -678,7 +729,6 @@ func (r *LeaderboardRepository) applyContestEventsWithSummary(ctx context.Contex
 				ScoreTotal: event.ScoreTotal,
 				Penalty:    event.Penalty,
 				ACCount:    event.ACCount,
-				DetailJSON: event.DetailJSON,
 				UpdatedAt:  event.UpdatedAt,
 				Version:    event.Version,
 			}
@@ -692,16 +742,21 @@ func (r *LeaderboardRepository) applyContestEventsWithSummary(ctx context.Contex
 		if err != nil {
 			versionValue = 0
 		}
+		cells := event.DetailCells()
 		args = append(args,
 			event.MemberID,
 			event.SortScore,
 			summaryJSON,
-			event.ProblemID,
-			event.DetailJSON,
 			event.ResultID,
 			versionValue,
+			len(cells),
 		)
+		for problemID, cell := range cells {
+			args = append(args, problemID, cell)
+		}
+		eventCount++
 	}
+	args[0] = eventCount
 	_, err := r.redis.ScriptRunCtx(ctx, rankApplyScript, keys, args...)
 	if err != nil {
 		return appErr.Wrapf(err, appErr.CacheError, "apply rank updates with script failed")
@@ -4,12 +4,19 @@ import (
 	"context"
 	"database/sql"
 	"errors"
+	"strconv"
+	"strings"
 	"time"
 
+	"fuzoj/pkg/contest/rankdetail"
+
 	"github.com/zeromicro/go-zero/core/stores/sqlx"
 )
 
-const contestMemberSummaryTable = "`contest_member_summary_snapshot`"
+const (
+	contestMemberSummaryTable = "`contest_member_summary_snapshot`"
+	contestMemberProblemTable = "`contest_member_problem_state`"
+)
 
 // MainMemberSummary stores contest member summary rows from contest main table.
 type MainMemberSummary struct {
@@ -76,3 +83,64 @@ func (r *MainSummaryRepository) ListByContestAfterMember(ctx context.Context, co
 	}
 	return out, nil
 }
+
+// ListProblemCells loads the problem cells of members from the problem state rows,
+// keyed by member id then problem id.
+func (r *MainSummaryRepository) ListProblemCells(ctx context.Context, contestID string, memberIDs []string) (map[string]map[string]string, error) {
+	if r == nil || r.conn == nil {
+		return nil, errors.New("main summary repository is not configured")
+	}
+	if contestID == "" || len(memberIDs) == 0 {
+		return nil, nil
+	}
+	var rows []struct {
+		MemberID         string         `db:"member_id"`
+		ProblemID        int64          `db:"problem_id"`
+		Solved           int            `db:"solved"`
+		FirstACAt        sql.NullTime   `db:"first_ac_at"`
+		WrongCount       int            `db:"wrong_count"`
+		Penalty          int64          `db:"penalty"`
+		LastSubmissionID sql.NullString `db:"last_submission_id"`
+		LastSubmissionAt sql.NullTime   `db:"last_submission_at"`
+		LastVerdict      sql.NullString `db:"last_verdict"`
+	}
+	placeholders := strings.TrimSuffix(strings.Repeat("?,", len(memberIDs)), ",")
+	query := "select member_id, problem_id, solved, first_ac_at, wrong_count, penalty, last_submission_id, last_submission_at, last_verdict " +
+		"from " + contestMemberProblemTable + " where contest_id = ? and member_id in (" + placeholders + ")"
+	args := make([]any, 0, len(memberIDs)+1)
+	args = append(args, contestID)
+	for _, memberID := range memberIDs {
+		args = append(args, memberID)
+	}
+	if err := r.conn.QueryRowsCtx(ctx, &rows, query, args...); err != nil {
+		if err == sqlx.ErrNotFound {
+			return nil, nil
+		}
+		return nil, err
+	}
+	out := make(map[string]map[string]string, len(memberIDs))
+	for _, row := range rows {
+		cells := out[row.MemberID]
+		if cells == nil {
+			cells = make(map[string]string)
+			out[row.MemberID] = cells
+		}
+		cells[strconv.FormatInt(row.ProblemID, 10)] = rankdetail.MarshalCell(rankdetail.ProblemDetail{
+			Solved:           row.Solved == 1,
+			WrongCount:       row.WrongCount,
+			FirstACAt:        nullUnix(row.FirstACAt),
+			LastSubmissionAt: nullUnix(row.LastSubmissionAt),
+			LastSubmissionID: row.LastSubmissionID.String,
+			Penalty:          row.Penalty,
+			Verdict:          row.LastVerdict.String,
+		})
+	}
+	return out, nil
+}
+
+func nullUnix(value sql.NullTime) int64 {
+	if !value.Valid || value.Time.IsZero() {
+		return 0
+	}
+	return value.Time.Unix()
+}
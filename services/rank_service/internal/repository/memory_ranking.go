@@ -0,0 +1,181 @@
+package repository
+
+import (
+	"context"
+	"encoding/json"
+	"strconv"
+	"time"
+
+	"fuzoj/pkg/contest/rankdetail"
+	"fuzoj/services/rank_service/internal/pmodel"
+	"fuzoj/services/rank_service/internal/ranking"
+
+	red "github.com/redis/go-redis/v9"
+	"github.com/zeromicro/go-zero/core/logx"
+	"github.com/zeromicro/go-zero/core/stores/redis"
+)
+
+const (
+	memoryLoadTimeout   = 30 * time.Second
+	memoryLoadBatchSize = 500
+)
+
+// SetMemoryEngine serves live pages and member ranks from an in-process
+// ranking engine. Redis keeps receiving every update and is what contests
+// are loaded from, so other readers (rank_ws_service, snapshots) are unaffected.
+//
+// Only contests whose updates this replica consumes are served from memory;
+// every other contest keeps reading Redis.
+func (r *LeaderboardRepository) SetMemoryEngine(engine *ranking.Engine) {
+	r.memory = engine
+}
+
+// EvictIdleMemoryBoards drops in-memory boards of contests without recent
+// updates, such as ended contests or partitions moved to another replica.
+func (r *LeaderboardRepository) EvictIdleMemoryBoards(ctx context.Context) {
+	if r == nil || r.memory == nil {
+		return
+	}
+	for _, contestID := range r.memory.Evict(time.Now()) {
+		logx.WithContext(ctx).Infof("memory leaderboard evicted contest_id=%s", contestID)
+	}
+}
+
+// ensureMemoryBoard starts loading a contest in the background; until it is
+// ready the caller keeps reading Redis.
+func (r *LeaderboardRepository) ensureMemoryBoard(contestID string) {
+	if !r.memory.Owned(contestID) {
+		return
+	}
+	load := r.memory.BeginLoad(contestID)
+	if load == nil {
+		return
+	}
+	go func() {
+		ctx, cancel := context.WithTimeout(context.Background(), memoryLoadTimeout)
+		defer cancel()
+		start := time.Now()
+		entries, version, resultID, err := r.readMemoryBoard(ctx, contestID)
+		if err != nil {
+			logx.WithContext(ctx).Errorf("load memory leaderboard failed contest_id=%s err=%v", contestID, err)
+			load.Abort()
+			return
+		}
+		load.Finish(entries, version, resultID)
+		logx.WithContext(ctx).Infof("memory leaderboard loaded contest_id=%s total=%d cost=%s", contestID, len(entries), time.Since(start))
+	}()
+}
+
+// readMemoryBoard reads every member of a contest. Member ids are read in one
+// call so concurrent rank changes cannot shift members out of a window; updates
+// landing meanwhile are buffered by the engine and replayed.
+func (r *LeaderboardRepository) readMemoryBoard(ctx context.Context, contestID string) ([]ranking.Entry, int64, int64, error) {
+	metaVals, err := r.redis.HmgetCtx(ctx, metaKey(contestID), "version", "seen_result_id", "result_id")
+	if err != nil {
+		return nil, 0, 0, err
+	}
+	version, resultID := MemoryWatermark(metaVals[0], metaVals[1], metaVals[2])
+	memberIDs, err := r.redis.ZrangeCtx(ctx, leaderboardKey(contestID), 0, -1)
+	if err != nil {
+		return nil, 0, 0, err
+	}
+	entries := make([]ranking.Entry, 0, len(memberIDs))
+	for start := 0; start < len(memberIDs); start += memoryLoadBatchSize {
+		end := start + memoryLoadBatchSize
+		if end > len(memberIDs) {
+			end = len(memberIDs)
+		}
+		batch := memberIDs[start:end]
+		cmds := make([]*red.MapStringStringCmd, len(batch))
+		err := r.redis.PipelinedCtx(ctx, func(pipe redis.Pipeliner) error {
+			for i, memberID := range batch {
+				cmds[i] = pipe.HGetAll(ctx, detailKey(contestID, memberID))
+			}
+			return nil
+		})
+		if err != nil {
+			return nil, 0, 0, err
+		}
+		for _, cmd := range cmds {
+			fields := cmd.Val()
+			summary, err := decodeSummary(fields["summary"])
+			if err != nil || summary == nil {
+				continue
+			}
+			entries = append(entries, ranking.Entry{
+				MemberID:   summary.MemberID,
+				SortScore:  summary.SortScore,
+				ScoreTotal: summary.ScoreTotal,
+				Penalty:    summary.Penalty,
+				ACCount:    summary.ACCount,
+				Cells:      rankdetail.CellsFromHash(fields),
+				DetailJSON: summary.DetailJSON,
+				UpdatedAt:  summary.UpdatedAt,
+				Version:    summary.Version,
+				ResultID:   parseHashInt(fields["result_id"]),
+				VersionNum: parseHashInt(fields["version_num"]),
+			})
+		}
+	}
+	return entries, version, resultID, nil
+}
+
+// MemoryWatermark parses the meta version and seen_result_id fields the way
+// the apply script reads them, falling back to result_id for older metas.
+func MemoryWatermark(version, seenResultID, resultID string) (int64, int64) {
+	seen := parseHashInt(seenResultID)
+	if seen == 0 {
+		seen = parseHashInt(resultID)
+	}
+	return parseHashInt(version), seen
+}
+
+// MemorySnapshotEntries returns the ranked entries of a contest held in memory,
+// so snapshots can skip paging through Redis. ok is false unless the board is
+// at exactly the given meta watermark read from Redis.
+func (r *LeaderboardRepository) MemorySnapshotEntries(contestID string, version, seenResultID int64) ([]SnapshotEntry, bool) {
+	if r == nil || r.memory == nil {
+		return nil, false
+	}
+	entries, ok := r.memory.Entries(contestID, version, seenResultID)
+	if !ok {
+		return nil, false
+	}
+	out := make([]SnapshotEntry, 0, len(entries))
+	for i, entry := range entries {
+		summaryJSON, err := json.Marshal(pmodel.LeaderboardSummary{
+			MemberID:   entry.MemberID,
+			SortScore:  entry.SortScore,
+			ScoreTotal: entry.ScoreTotal,
+			Penalty:    entry.Penalty,
+			ACCount:    entry.ACCount,
+			UpdatedAt:  entry.UpdatedAt,
+			Version:    entry.Version,
+		})
+		if err != nil {
+			return nil, false
+		}
+		out = append(out, SnapshotEntry{
+			MemberID:    entry.MemberID,
+			Rank:        int64(i + 1),
+			SortScore:   entry.SortScore,
+			ScoreTotal:  entry.ScoreTotal,
+			Penalty:     entry.Penalty,
+			ACCount:     entry.ACCount,
+			DetailJSON:  rankdetail.Detail(entry.Cells, entry.DetailJSON, entry.UpdatedAt),
+			SummaryJSON: string(summaryJSON),
+		})
+	}
+	return out, true
+}
+
+func parseHashInt(value string) int64 {
+	if value == "" {
+		return 0
+	}
+	parsed, err := strconv.ParseInt(value, 10, 64)
+	if err != nil {
+		return 0
+	}
+	return parsed
+}
@@ -4,6 +4,7 @@ import (
 	"crypto/tls"
 	"fuzoj/services/rank_service/internal/config"
 	"fuzoj/services/rank_service/internal/consumer"
+	"fuzoj/services/rank_service/internal/ranking"
 	"fuzoj/services/rank_service/internal/repository"
 	"fuzoj/services/rank_service/internal/worker"
 
@@ -32,6 +33,13 @@ func NewServiceContext(c config.Config) *ServiceContext {
 	redisClient := redis.MustNewRedis(c.Redis)
 	pubsubClient := newPubSubClient(c.Redis)
 	repo := repository.NewLeaderboardRepository(redisClient, c.Rank.PageCacheTTL, c.Rank.EmptyTTL)
+	if c.Rank.MemoryRanking {
+		if len(c.Kafka.Brokers) > 0 && c.Rank.UpdateTopic != "" {
+			repo.SetMemoryEngine(ranking.NewEngine(c.Rank.MemoryIdleTTL))
+		} else {
+			logx.Error("memory ranking requires the rank update consumer, serving from redis")
+		}
+	}
 	batcher := consumer.NewUpdateBatcher(repo, pubsubClient, c.Rank.BatchSize, c.Rank.BatchInterval, c.Timeouts.MQ)
 	snapshotRepo := repository.NewSnapshotRepository(conn)
 	mainSummaryRepo := repository.NewMainSummaryRepository(conn)
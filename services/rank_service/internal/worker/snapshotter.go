@@ -8,6 +8,7 @@ import (
 	"sync/atomic"
 	"time"
 
+	"fuzoj/pkg/contest/rankdetail"
 	"fuzoj/pkg/contest/score"
 	"fuzoj/services/rank_service/internal/pmodel"
 	"fuzoj/services/rank_service/internal/repository"
@@ -212,6 +213,7 @@ func (s *Snapshotter) run(ctx context.Context) {
 	}
 	defer atomic.StoreInt32(&s.running, 0)
 
+	s.leaderboard.EvictIdleMemoryBoards(ctx)
 	logger := logx.WithContext(ctx)
 	cursor := uint64(0)
 	prefix := repository.MetaPrefix()
@@ -242,7 +244,7 @@ func (s *Snapshotter) run(ctx context.Context) {
 func (s *Snapshotter) snapshotContest(ctx context.Context, contestID string) error {
 	logger := logx.WithContext(ctx)
 	ctxCache := withTimeout(ctx, s.cacheTimeout)
-	metaVals, err := s.redis.HmgetCtx(ctxCache.ctx, repository.MetaKey(contestID), "updated_at", "snapshot_at", "recovery_result_id", "result_id", "version")
+	metaVals, err := s.redis.HmgetCtx(ctxCache.ctx, repository.MetaKey(contestID), "updated_at", "snapshot_at", "recovery_result_id", "result_id", "version", "seen_result_id")
 	ctxCache.cancel()
 	if err != nil {
 		return err
@@ -258,17 +260,27 @@ func (s *Snapshotter) snapshotContest(ctx context.Context, contestID string) err
 		return nil
 	}
 
-	ctxCache = withTimeout(ctx, s.cacheTimeout)
-	total, err := s.redis.ZcardCtx(ctxCache.ctx, repository.LeaderboardKey(contestID))
-	ctxCache.cancel()
-	if err != nil {
-		return err
+	// A contest held by the in-memory ranking engine is checkpointed from memory,
+	// but only when the board is at the meta watermark read above; otherwise it
+	// may have missed updates applied by another replica and Redis is paged.
+	memoryVersion, memoryResultID := repository.MemoryWatermark(metaVals[4], metaVals[5], metaVals[3])
+	memoryEntries, fromMemory := s.leaderboard.MemorySnapshotEntries(contestID, memoryVersion, memoryResultID)
+	var total64 int64
+	if fromMemory {
+		total64 = int64(len(memoryEntries))
+	} else {
+		ctxCache = withTimeout(ctx, s.cacheTimeout)
+		total, err := s.redis.ZcardCtx(ctxCache.ctx, repository.LeaderboardKey(contestID))
+		ctxCache.cancel()
+		if err != nil {
+			return err
+		}
+		total64 = int64(total)
 	}
-	if total == 0 {
+	if total64 == 0 {
 		return nil
 	}
 
-	total64 := int64(total)
 	snapshotAt := time.Now()
 	ctxDB := withTimeout(ctx, s.dbTimeout)
 	snapshotID, err := s.repo.CreateSnapshotMeta(ctxDB.ctx, repository.SnapshotMeta{
@@ -284,8 +296,16 @@ func (s *Snapshotter) snapshotContest(ctx context.Context, contestID string) err
 		return err
 	}
 
+	if fromMemory {
+		for i := range memoryEntries {
+			memoryEntries[i].SnapshotID = snapshotID
+		}
+		if err := s.insertEntries(ctx, memoryEntries); err != nil {
+			return err
+		}
+	}
 	var start int64 = 0
-	for start < total64 {
+	for !fromMemory && start < total64 {
 		stop := start + int64(s.pageSize) - 1
 		ctxCache = withTimeout(ctx, s.cacheTimeout)
 		pairs, err := s.redis.ZrevrangeWithScoresCtx(ctxCache.ctx, repository.LeaderboardKey(contestID), start, stop)
@@ -297,7 +317,7 @@ func (s *Snapshotter) snapshotContest(ctx context.Context, contestID string) err
 			break
 		}
 
-		summaries := make([]*red.StringCmd, len(pairs))
+		hashes := make([]*red.MapStringStringCmd, len(pairs))
 		ctxCache = withTimeout(ctx, s.cacheTimeout)
 		err = s.redis.PipelinedCtx(ctxCache.ctx, func(pipe redis.Pipeliner) error {
 			for i, pair := range pairs {
@@ -305,7 +325,7 @@ func (s *Snapshotter) snapshotContest(ctx context.Context, contestID string) err
 				if memberID == "" {
 					continue
 				}
-				summaries[i] = pipe.HGet(ctxCache.ctx, repository.DetailKey(contestID, memberID), "summary")
+				hashes[i] = pipe.HGetAll(ctxCache.ctx, repository.DetailKey(contestID, memberID))
 			}
 			return nil
 		})
@@ -320,14 +340,15 @@ func (s *Snapshotter) snapshotContest(ctx context.Context, contestID string) err
 			if memberID == "" {
 				continue
 			}
-			cmd := summaries[i]
+			cmd := hashes[i]
 			if cmd == nil {
 				continue
 			}
-			summaryJSON, err := cmd.Result()
-			if err != nil || summaryJSON == "" {
+			fields, err := cmd.Result()
+			if err != nil || fields["summary"] == "" {
 				continue
 			}
+			summaryJSON := fields["summary"]
 			var summary pmodel.LeaderboardSummary
 			if err := json.Unmarshal([]byte(summaryJSON), &summary); err != nil {
 				logger.Errorf("decode rank summary failed: %v", err)
@@ -341,7 +362,7 @@ func (s *Snapshotter) snapshotContest(ctx context.Context, contestID string) err
 				ScoreTotal:  summary.ScoreTotal,
 				Penalty:     summary.Penalty,
 				ACCount:     summary.ACCount,
-				DetailJSON:  summary.DetailJSON,
+				DetailJSON:  rankdetail.Detail(rankdetail.CellsFromHash(fields), summary.DetailJSON, summary.UpdatedAt),
 				SummaryJSON: summaryJSON,
 			})
 		}
@@ -365,7 +386,7 @@ func (s *Snapshotter) snapshotContest(ctx context.Context, contestID string) err
 	})
 	ctxCache.cancel()
 
-	logger.Infof("rank snapshot saved contest_id=%s total=%d", contestID, total)
+	logger.Infof("rank snapshot saved contest_id=%s total=%d from_memory=%v", contestID, total64, fromMemory)
 	return nil
 }
 
@@ -512,9 +533,18 @@ func (s *Snapshotter) verifyContestFromMain(ctx context.Context, contestID strin
 		if len(rows) == 0 {
 			break
 		}
+		var mainCells map[string]map[string]string
+		if s.recovery.VerifyStrict {
+			ctxDB = withTimeout(ctx, s.dbTimeout)
+			mainCells, err = s.mainSummary.ListProblemCells(ctxDB.ctx, contestID, memberIDsOf(rows))
+			ctxDB.cancel()
+			if err != nil {
+				return false, err
+			}
+		}
 		for _, row := range rows {
 			expectedTotal++
-			summary, found, err := s.loadRedisSummary(ctx, contestID, row.MemberID)
+			summary, cells, found, err := s.loadRedisSummary(ctx, contestID, row.MemberID)
 			if err != nil {
 				return false, err
 			}
@@ -527,7 +557,7 @@ func (s *Snapshotter) verifyContestFromMain(ctx context.Context, contestID strin
 			if parseVersion(summary.Version) < row.Version {
 				return false, nil
 			}
-			if s.recovery.VerifyStrict && summary.DetailJSON != row.DetailJSON {
+			if s.recovery.VerifyStrict && !sameCells(cells, mainCells[row.MemberID]) {
 				return false, nil
 			}
 		}
@@ -545,24 +575,45 @@ func (s *Snapshotter) verifyContestFromMain(ctx context.Context, contestID strin
 	return int64(total) == expectedTotal, nil
 }
 
-func (s *Snapshotter) loadRedisSummary(ctx context.Context, contestID, memberID string) (pmodel.LeaderboardSummary, bool, error) {
+func (s *Snapshotter) loadRedisSummary(ctx context.Context, contestID, memberID string) (pmodel.LeaderboardSummary, map[string]string, bool, error) {
 	ctxCache := withTimeout(ctx, s.cacheTimeout)
-	raw, err := s.redis.HgetCtx(ctxCache.ctx, repository.DetailKey(contestID, memberID), "summary")
+	fields, err := s.redis.HgetallCtx(ctxCache.ctx, repository.DetailKey(contestID, memberID))
 	ctxCache.cancel()
 	if err != nil {
 		if err == red.Nil {
-			return pmodel.LeaderboardSummary{}, false, nil
+			return pmodel.LeaderboardSummary{}, nil, false, nil
 		}
-		return pmodel.LeaderboardSummary{}, false, err
+		return pmodel.LeaderboardSummary{}, nil, false, err
 	}
+	raw := fields["summary"]
 	if raw == "" {
-		return pmodel.LeaderboardSummary{}, false, nil
+		return pmodel.LeaderboardSummary{}, nil, false, nil
 	}
 	var summary pmodel.LeaderboardSummary
 	if err := json.Unmarshal([]byte(raw), &summary); err != nil {
-		return pmodel.LeaderboardSummary{}, false, err
+		return pmodel.LeaderboardSummary{}, nil, false, err
+	}
+	return summary, rankdetail.CellsFromHash(fields), true, nil
+}
+
+func memberIDsOf(rows []repository.MainMemberSummary) []string {
+	out := make([]string, 0, len(rows))
+	for _, row := range rows {
+		out = append(out, row.MemberID)
 	}
-	return summary, true, nil
+	return out
+}
+
+func sameCells(a, b map[string]string) bool {
+	if len(a) != len(b) {
+		return false
+	}
+	for problemID, cell := range a {
+		if other, ok := b[problemID]; !ok || other != cell {
+			return false
+		}
+	}
+	return true
 }
 
 func (s *Snapshotter) rebuildContestFromMain(ctx context.Context, contestID string) error {
@@ -593,6 +644,12 @@ func (s *Snapshotter) rebuildContestFromMain(ctx context.Context, contestID stri
 		if len(rows) == 0 {
 			break
 		}
+		ctxDB = withTimeout(ctx, s.dbTimeout)
+		cells, err := s.mainSummary.ListProblemCells(ctxDB.ctx, contestID, memberIDsOf(rows))
+		ctxDB.cancel()
+		if err != nil {
+			return err
+		}
 		for _, row := range rows {
 			version := row.Version
 			if version <= 0 {
@@ -606,6 +663,7 @@ func (s *Snapshotter) rebuildContestFromMain(ctx context.Context, contestID stri
 				Penalty:    row.PenaltyTotal,
 				ACCount:    row.ACCount,
 				DetailJSON: row.DetailJSON,
+				Cells:      cells[row.MemberID],
 				Version:    strconv.FormatInt(version, 10),
 				ResultID:   0,
 				UpdatedAt:  row.UpdatedAt.Unix(),
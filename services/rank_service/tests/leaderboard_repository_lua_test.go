@@ -3,6 +3,7 @@ package tests
 import (
 	"context"
 	"encoding/json"
+	"strings"
 	"testing"
 	"time"
 
@@ -325,6 +326,71 @@ func TestLeaderboardRepository_GetPageBypassesStaleEmptyCacheAfterUpdate(t *test
 	}
 }
 
+func TestLeaderboardRepository_ApplyUpdates_MergesProblemCells(t *testing.T) {
+	repo, cache := newLeaderboardRepoForTest(t)
+	ctx := context.Background()
+
+	if err := repo.ApplyUpdates(ctx, []pmodel.RankUpdateEvent{
+		{
+			ContestID:     "c1",
+			MemberID:      "m1",
+			ProblemID:     "101",
+			ProblemDetail: `{"solved":true,"wrong_count":0}`,
+			SortScore:     10,
+			ScoreTotal:    1,
+			Version:       "1",
+			ResultID:      1,
+			UpdatedAt:     100,
+		},
+		{
+			ContestID:     "c1",
+			MemberID:      "m1",
+			ProblemID:     "102",
+			ProblemDetail: `{"solved":false,"wrong_count":2}`,
+			SortScore:     10,
+			ScoreTotal:    1,
+			Version:       "2",
+			ResultID:      2,
+			UpdatedAt:     101,
+		},
+	}); err != nil {
+		t.Fatalf("apply updates failed: %v", err)
+	}
+
+	summary, err := cache.HgetCtx(ctx, repository.DetailKey("c1", "m1"), "summary")
+	if err != nil {
+		t.Fatalf("load summary failed: %v", err)
+	}
+	if strings.Contains(summary, "detail_json") {
+		t.Fatalf("expected summary without detail, got %s", summary)
+	}
+
+	entry, _, err := repo.GetMember(ctx, "c1", "m1", "")
+	if err != nil {
+		t.Fatalf("get member failed: %v", err)
+	}
+	var detail struct {
+		Problems map[string]struct {
+			Solved     bool `json:"solved"`
+			WrongCount int  `json:"wrong_count"`
+		} `json:"problems"`
+	}
+	if err := json.Unmarshal([]byte(entry.Detail), &detail); err != nil {
+		t.Fatalf("decode detail failed: %v", err)
+	}
+	if len(detail.Problems) != 2 || !detail.Problems["101"].Solved || detail.Problems["102"].WrongCount != 2 {
+		t.Fatalf("unexpected member detail: %s", entry.Detail)
+	}
+
+	page, err := repo.GetPage(ctx, "c1", 1, 50, "")
+	if err != nil {
+		t.Fatalf("get page failed: %v", err)
+	}
+	if len(page.Items) != 1 || page.Items[0].Detail != entry.Detail {
+		t.Fatalf("expected page detail to match member detail, got %+v", page.Items)
+	}
+}
+
 func newLeaderboardRepoForTest(t *testing.T) (*repository.LeaderboardRepository, *redis.Redis) {
 	t.Helper()
 	mini := miniredis.RunT(t)
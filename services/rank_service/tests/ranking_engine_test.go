@@ -0,0 +1,174 @@
+package tests
+
+import (
+	"math/rand"
+	"sort"
+	"strconv"
+	"strings"
+	"testing"
+	"time"
+
+	"fuzoj/services/rank_service/internal/pmodel"
+	"fuzoj/services/rank_service/internal/ranking"
+)
+
+func loadedEngine(t *testing.T, contestID string, entries []ranking.Entry, version int64) *ranking.Engine {
+	t.Helper()
+	engine := ranking.NewEngine(time.Minute)
+	load := engine.BeginLoad(contestID)
+	if load == nil {
+		t.Fatalf("expected load reservation")
+	}
+	load.Finish(entries, version, version)
+	return engine
+}
+
+func TestRankingEngine_MatchesSortedReference(t *testing.T) {
+	engine := loadedEngine(t, "c1", nil, 0)
+	rng := rand.New(rand.NewSource(1))
+	scores := map[string]int64{}
+	for i := 1; i <= 2000; i++ {
+		memberID := "m" + strconv.Itoa(rng.Intn(300))
+		sortScore := int64(rng.Intn(50))
+		scores[memberID] = sortScore
+		engine.Apply("c1", []pmodel.RankUpdateEvent{{
+			ContestID:  "c1",
+			MemberID:   memberID,
+			SortScore:  sortScore,
+			ScoreTotal: sortScore,
+			ResultID:   int64(i),
+			Version:    strconv.Itoa(i),
+		}}, int64(i), int64(i))
+	}
+
+	expected := make([]string, 0, len(scores))
+	for memberID := range scores {
+		expected = append(expected, memberID)
+	}
+	// ZREVRANGE order: score descending, then member id descending.
+	sort.Slice(expected, func(i, j int) bool {
+		if scores[expected[i]] != scores[expected[j]] {
+			return scores[expected[i]] > scores[expected[j]]
+		}
+		return expected[i] > expected[j]
+	})
+
+	pageSize := 7
+	for page := 1; (page-1)*pageSize < len(expected); page++ {
+		payload, ok := engine.Page("c1", page, pageSize)
+		if !ok {
+			t.Fatalf("expected loaded contest")
+		}
+		if payload.Page.Total != int64(len(expected)) || payload.Version != "2000" {
+			t.Fatalf("unexpected page info total=%d version=%s", payload.Page.Total, payload.Version)
+		}
+		for i, item := range payload.Items {
+			rank := (page-1)*pageSize + i
+			if item.MemberId != expected[rank] || item.Rank != int64(rank+1) {
+				t.Fatalf("page %d item %d: expected %s at rank %d, got %s at %d", page, i, expected[rank], rank+1, item.MemberId, item.Rank)
+			}
+		}
+	}
+	for rank, memberID := range expected {
+		entry, _, found, ok := engine.Member("c1", memberID)
+		if !ok || !found || entry.Rank != int64(rank+1) {
+			t.Fatalf("expected %s at rank %d, got %+v found=%v", memberID, rank+1, entry, found)
+		}
+	}
+}
+
+func TestRankingEngine_IgnoresStaleUpdates(t *testing.T) {
+	engine := loadedEngine(t, "c1", []ranking.Entry{{MemberID: "m1", SortScore: 10, ScoreTotal: 10, ResultID: 5}}, 5)
+	engine.Apply("c1", []pmodel.RankUpdateEvent{{ContestID: "c1", MemberID: "m1", SortScore: 1, ScoreTotal: 1, ResultID: 4}}, 4, 4)
+	entry, version, found, ok := engine.Member("c1", "m1")
+	if !ok || !found || entry.Score != 10 || version != "5" {
+		t.Fatalf("expected stale update to be ignored, got %+v version=%s", entry, version)
+	}
+}
+
+func TestRankingEngine_MergesProblemCells(t *testing.T) {
+	engine := loadedEngine(t, "c1", []ranking.Entry{{
+		MemberID:  "m1",
+		SortScore: 10,
+		ResultID:  1,
+		Cells:     map[string]string{"101": `{"solved":true}`},
+	}}, 1)
+	engine.Apply("c1", []pmodel.RankUpdateEvent{{
+		ContestID:     "c1",
+		MemberID:      "m1",
+		ProblemID:     "102",
+		ProblemDetail: `{"solved":false}`,
+		SortScore:     10,
+		ResultID:      2,
+	}}, 2, 2)
+	entry, _, found, ok := engine.Member("c1", "m1")
+	if !ok || !found {
+		t.Fatalf("expected member to be ranked")
+	}
+	if !strings.Contains(entry.Detail, `"101":{"solved":true}`) || !strings.Contains(entry.Detail, `"102":{"solved":false}`) {
+		t.Fatalf("expected both problem cells in detail, got %s", entry.Detail)
+	}
+}
+
+func TestRankingEngine_ReplaysUpdatesAppliedWhileLoading(t *testing.T) {
+	engine := ranking.NewEngine(time.Minute)
+	load := engine.BeginLoad("c1")
+	if engine.BeginLoad("c1") != nil {
+		t.Fatalf("expected a single load reservation")
+	}
+	engine.Apply("c1", []pmodel.RankUpdateEvent{{ContestID: "c1", MemberID: "m2", SortScore: 30, ScoreTotal: 30, ResultID: 7}}, 7, 7)
+	if _, ok := engine.Page("c1", 1, 10); ok {
+		t.Fatalf("expected loading contest to fall back")
+	}
+	load.Finish([]ranking.Entry{{MemberID: "m1", SortScore: 20, ScoreTotal: 20, ResultID: 6}}, 6, 6)
+
+	payload, ok := engine.Page("c1", 1, 10)
+	if !ok || len(payload.Items) != 2 || payload.Items[0].MemberId != "m2" || payload.Version != "7" {
+		t.Fatalf("expected buffered update to be replayed, got %+v", payload)
+	}
+}
+
+func TestRankingEngine_EntriesRequireMatchingWatermark(t *testing.T) {
+	engine := loadedEngine(t, "c1", []ranking.Entry{{MemberID: "m1", SortScore: 10, ResultID: 5}}, 5)
+	engine.Apply("c1", []pmodel.RankUpdateEvent{{ContestID: "c1", MemberID: "m2", SortScore: 20, ResultID: 8, Version: "3"}}, 3, 8)
+	if _, ok := engine.Entries("c1", 5, 9); ok {
+		t.Fatalf("expected board behind redis to be rejected")
+	}
+	if _, ok := engine.Entries("c1", 5, 5); ok {
+		t.Fatalf("expected board ahead of redis to be rejected")
+	}
+	entries, ok := engine.Entries("c1", 5, 8)
+	if !ok || len(entries) != 2 || entries[0].MemberID != "m2" {
+		t.Fatalf("expected entries at matching watermark, got %+v ok=%v", entries, ok)
+	}
+}
+
+func TestRankingEngine_OwnershipAndIdleEviction(t *testing.T) {
+	engine := ranking.NewEngine(time.Minute)
+	if engine.Owned("c1") {
+		t.Fatalf("expected contest without updates to be unowned")
+	}
+	engine.Apply("c1", []pmodel.RankUpdateEvent{{ContestID: "c1", MemberID: "m1", SortScore: 1, ResultID: 1}}, 0, 1)
+	if !engine.Owned("c1") {
+		t.Fatalf("expected contest with applied updates to be owned")
+	}
+	load := engine.BeginLoad("c1")
+	if load == nil {
+		t.Fatalf("expected load reservation")
+	}
+	load.Finish(nil, 0, 1)
+
+	if evicted := engine.Evict(time.Now()); len(evicted) != 0 {
+		t.Fatalf("expected active contest to stay, evicted %v", evicted)
+	}
+	evicted := engine.Evict(time.Now().Add(2 * time.Minute))
+	if len(evicted) != 1 || evicted[0] != "c1" {
+		t.Fatalf("expected idle contest to be evicted, got %v", evicted)
+	}
+	if _, ok := engine.Page("c1", 1, 10); ok {
+		t.Fatalf("expected evicted contest to fall back to redis")
+	}
+	if engine.Owned("c1") {
+		t.Fatalf("expected evicted contest to be unowned")
+	}
+}
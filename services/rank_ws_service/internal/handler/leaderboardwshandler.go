@@ -35,6 +35,11 @@ func LeaderboardWSHandler(svcCtx *svc.ServiceContext) http.HandlerFunc {
 			handlerx.WriteError(w, r, err)
 			return
 		}
+		protocol, err := logic.NormalizeLeaderboardProtocol(req.Protocol)
+		if err != nil {
+			handlerx.WriteError(w, r, err)
+			return
+		}
 
 		conn, err := upgrader.Upgrade(w, r, nil)
 		if err != nil {
@@ -54,6 +59,6 @@ func LeaderboardWSHandler(svcCtx *svc.ServiceContext) http.HandlerFunc {
 				}
 			}
 		}()
-		svcCtx.Hub.Subscribe(ctx, req.Id, req.Page, req.PageSize, mode, ws.NewSender(conn))
+		svcCtx.Hub.Subscribe(ctx, req.Id, req.Page, req.PageSize, mode, protocol == logic.LeaderboardProtocolDelta, ws.NewSender(conn))
 	}
 }
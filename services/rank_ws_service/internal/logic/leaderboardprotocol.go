@@ -0,0 +1,21 @@
+package logic
+
+import (
+	appErr "fuzoj/pkg/errors"
+)
+
+const (
+	LeaderboardProtocolJSON  = "json"
+	LeaderboardProtocolDelta = "delta"
+)
+
+// NormalizeLeaderboardProtocol validates the websocket push protocol.
+func NormalizeLeaderboardProtocol(protocol string) (string, error) {
+	if protocol == "" {
+		return LeaderboardProtocolJSON, nil
+	}
+	if protocol == LeaderboardProtocolJSON || protocol == LeaderboardProtocolDelta {
+		return protocol, nil
+	}
+	return "", appErr.ValidationError("protocol", "invalid")
+}
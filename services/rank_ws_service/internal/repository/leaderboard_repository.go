@@ -8,6 +8,7 @@ import (
 	"strconv"
 	"time"
 
+	"fuzoj/pkg/contest/rankdetail"
 	appErr "fuzoj/pkg/errors"
 	"fuzoj/services/rank_ws_service/internal/pmodel"
 	"fuzoj/services/rank_ws_service/internal/types"
@@ -39,9 +40,8 @@ local version = redis.call("HGET", metaKey, "version") or ""
 local out = {tostring(total), tostring(version)}
 for i = 1, #memberIDs do
 	local memberId = memberIDs[i]
-	local summary = redis.call("HGET", detailPrefix .. memberId, "summary")
 	table.insert(out, memberId)
-	table.insert(out, summary or "")
+	table.insert(out, redis.call("HGETALL", detailPrefix .. memberId))
 end
 
 return out
@@ -115,7 +115,7 @@ func (r *LeaderboardRepository) GetPage(ctx context.Context, contestID string, p
 			Rank:     int64(page-1)*int64(pageSize) + int64(idx) + 1,
 			Score:    summary.ScoreTotal,
 			Penalty:  summary.Penalty,
-			Detail:   summary.DetailJSON,
+			Detail:   rankdetail.Detail(row.cells, summary.DetailJSON, summary.UpdatedAt),
 		})
 	}
 	if versionFromScript != "" {
@@ -143,6 +143,7 @@ func (r *LeaderboardRepository) GetPage(ctx context.Context, contestID string, p
 
 type pageRow struct {
 	summaryJSON string
+	cells       map[string]string
 }
 
 func (r *LeaderboardRepository) loadPageRows(ctx context.Context, contestID, leaderboardKey string, start, stop int64) (int64, string, []pageRow, error) {
@@ -161,13 +162,28 @@ func (r *LeaderboardRepository) loadPageRows(ctx context.Context, contestID, lea
 	version := fmt.Sprint(values[1])
 	rows := make([]pageRow, 0, (len(values)-2)/2)
 	for i := 2; i+1 < len(values); i += 2 {
+		fields := hashFromPairs(values[i+1])
 		rows = append(rows, pageRow{
-			summaryJSON: fmt.Sprint(values[i+1]),
+			summaryJSON: fields["summary"],
+			cells:       rankdetail.CellsFromHash(fields),
 		})
 	}
 	return total, version, rows, nil
 }
 
+// hashFromPairs converts an HGETALL reply returned from a script into a map.
+func hashFromPairs(raw any) map[string]string {
+	pairs, ok := raw.([]any)
+	if !ok {
+		return nil
+	}
+	fields := make(map[string]string, len(pairs)/2)
+	for i := 0; i+1 < len(pairs); i += 2 {
+		fields[fmt.Sprint(pairs[i])] = fmt.Sprint(pairs[i+1])
+	}
+	return fields
+}
+
 func decodeSummary(summaryJSON string) (*pmodel.LeaderboardSummary, error) {
 	if summaryJSON == "" {
 		return nil, nil
@@ -8,6 +8,7 @@ type LeaderboardRequest struct {
 	Page     int    `form:"page"`
 	PageSize int    `form:"page_size"`
 	Mode     string `form:"mode"`
+	Protocol string `form:"protocol,optional"`
 }
 
 type LeaderboardEntry struct {
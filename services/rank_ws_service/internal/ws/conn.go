@@ -18,6 +18,10 @@ func (c *wsConn) Send(_ context.Context, payload []byte) error {
 	return c.conn.WriteMessage(websocket.TextMessage, payload)
 }
 
+func (c *wsConn) SendBinary(_ context.Context, payload []byte) error {
+	return c.conn.WriteMessage(websocket.BinaryMessage, payload)
+}
+
 func (c *wsConn) Close() error {
 	return c.conn.Close()
 }
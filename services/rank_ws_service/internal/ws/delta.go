@@ -0,0 +1,108 @@
+package ws
+
+import (
+	"encoding/binary"
+
+	"fuzoj/services/rank_ws_service/internal/types"
+)
+
+// Binary frames of the delta protocol. All integers are varints
+// (encoding/binary), strings are a uvarint length followed by the bytes.
+//
+//	full:  type=1 version total page page_size count {row}
+//	delta: type=2 version base total page page_size
+//	       count {row}                upserted rows (new on the page or changed)
+//	       count {member_id rank}     rank-only moves
+//	       count {member_id}          members that left the page
+//	row:   member_id rank score penalty detail
+//
+// A delta applies only on top of base; the server sends a full frame whenever
+// the client is not known to hold base.
+const (
+	frameTypeFull  byte = 1
+	frameTypeDelta byte = 2
+)
+
+type pageDelta struct {
+	upserts  []types.LeaderboardEntry
+	moves    []types.LeaderboardEntry
+	removals []string
+}
+
+// diffPage compares two versions of the same page by member.
+func diffPage(prev, next types.LeaderboardPayload) pageDelta {
+	before := make(map[string]types.LeaderboardEntry, len(prev.Items))
+	for _, item := range prev.Items {
+		before[item.MemberId] = item
+	}
+	var delta pageDelta
+	for _, item := range next.Items {
+		old, ok := before[item.MemberId]
+		delete(before, item.MemberId)
+		switch {
+		case !ok || old.Score != item.Score || old.Penalty != item.Penalty || old.Detail != item.Detail:
+			delta.upserts = append(delta.upserts, item)
+		case old.Rank != item.Rank:
+			delta.moves = append(delta.moves, item)
+		}
+	}
+	for _, item := range prev.Items {
+		if _, ok := before[item.MemberId]; ok {
+			delta.removals = append(delta.removals, item.MemberId)
+		}
+	}
+	return delta
+}
+
+func encodeFullFrame(payload types.LeaderboardPayload) []byte {
+	buf := make([]byte, 0, 64+len(payload.Items)*48)
+	buf = append(buf, frameTypeFull)
+	buf = appendString(buf, payload.Version)
+	buf = appendPageInfo(buf, payload.Page)
+	buf = binary.AppendUvarint(buf, uint64(len(payload.Items)))
+	for _, item := range payload.Items {
+		buf = appendRow(buf, item)
+	}
+	return buf
+}
+
+func encodeDeltaFrame(base string, next types.LeaderboardPayload, delta pageDelta) []byte {
+	buf := make([]byte, 0, 64+len(delta.upserts)*48+len(delta.moves)*16)
+	buf = append(buf, frameTypeDelta)
+	buf = appendString(buf, next.Version)
+	buf = appendString(buf, base)
+	buf = appendPageInfo(buf, next.Page)
+	buf = binary.AppendUvarint(buf, uint64(len(delta.upserts)))
+	for _, item := range delta.upserts {
+		buf = appendRow(buf, item)
+	}
+	buf = binary.AppendUvarint(buf, uint64(len(delta.moves)))
+	for _, item := range delta.moves {
+		buf = appendString(buf, item.MemberId)
+		buf = binary.AppendVarint(buf, item.Rank)
+	}
+	buf = binary.AppendUvarint(buf, uint64(len(delta.removals)))
+	for _, memberID := range delta.removals {
+		buf = appendString(buf, memberID)
+	}
+	return buf
+}
+
+func appendPageInfo(buf []byte, page types.PageInfo) []byte {
+	buf = binary.AppendVarint(buf, page.Total)
+	buf = binary.AppendUvarint(buf, uint64(page.Page))
+	return binary.AppendUvarint(buf, uint64(page.PageSize))
+}
+
+func appendRow(buf []byte, item types.LeaderboardEntry) []byte {
+	buf = appendString(buf, item.MemberId)
+	buf = binary.AppendVarint(buf, item.Rank)
+	buf = binary.AppendVarint(buf, item.Score)
+	buf = binary.AppendVarint(buf, item.Penalty)
+	return appendString(buf, item.Detail)
+}
+
+func appendString(buf []byte, s string) []byte {
+	buf = binary.AppendUvarint(buf, uint64(len(s)))
+	return append(buf, s...)
+}
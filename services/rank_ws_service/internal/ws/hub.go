@@ -12,6 +12,7 @@ import (
 
 	red "github.com/redis/go-redis/v9"
 	"github.com/zeromicro/go-zero/core/logx"
+	"github.com/zeromicro/go-zero/core/syncx"
 )
 
 const (
@@ -19,13 +20,16 @@ const (
 	snapshotMsgType = "snapshot"
 )
 
-// Hub manages websocket subscriptions.
+// Hub manages websocket subscriptions. Subscriptions to the same page share a
+// pageGroup, so each update loads and encodes a page once per group rather than
+// once per connection.
 type Hub struct {
 	repo       *repository.LeaderboardRepository
 	redis      *red.Client
 	debounce   time.Duration
+	flight     syncx.SingleFlight
 	mu         sync.RWMutex
-	subs       map[string]map[*subscription]struct{}
+	groups     map[string]map[pageKey]*pageGroup
 	pubsubs    map[string]*red.PubSub
 	ctx        context.Context
 	cancelFunc context.CancelFunc
@@ -41,7 +45,8 @@ func NewHub(repo *repository.LeaderboardRepository, redisClient *red.Client, deb
 		repo:       repo,
 		redis:      redisClient,
 		debounce:   debounce,
-		subs:       make(map[string]map[*subscription]struct{}),
+		flight:     syncx.NewSingleFlight(),
+		groups:     make(map[string]map[pageKey]*pageGroup),
 		pubsubs:    make(map[string]*red.PubSub),
 		ctx:        ctx,
 		cancelFunc: cancel,
@@ -62,37 +67,56 @@ func (h *Hub) Close() {
 }
 
 // Subscribe registers a new websocket subscription.
-func (h *Hub) Subscribe(ctx context.Context, contestID string, page, pageSize int, mode string, sender sender) {
-	var sub *subscription
-	sub = newSubscription(contestID, page, pageSize, mode, sender, h.repo, h.debounce, func() {
-		h.removeSub(contestID, sub)
-	})
-	h.addSub(contestID, sub)
-	sub.start(ctx)
+// With deltaProtocol the connection receives binary frames (see delta.go)
+// instead of full JSON pages.
+func (h *Hub) Subscribe(ctx context.Context, contestID string, page, pageSize int, mode string, deltaProtocol bool, sender sender) {
+	key := newPageKey(contestID, page, pageSize, mode)
+	sub := newSubscription(key, deltaProtocol, sender)
+	group := h.addSub(key, sub)
+	sub.onClose = func() {
+		h.removeSub(group, sub)
+	}
+	sub.start(ctx, h.snapshot)
 }
 
-func (h *Hub) addSub(contestID string, sub *subscription) {
+func (h *Hub) addSub(key pageKey, sub *subscription) *pageGroup {
 	h.mu.Lock()
 	defer h.mu.Unlock()
-	if h.subs[contestID] == nil {
-		h.subs[contestID] = make(map[*subscription]struct{})
+	groups := h.groups[key.contestID]
+	if groups == nil {
+		groups = make(map[pageKey]*pageGroup)
+		h.groups[key.contestID] = groups
+	}
+	group := groups[key]
+	if group == nil {
+		group = newPageGroup(h, key)
+		groups[key] = group
+		go group.loop()
 	}
-	h.subs[contestID][sub] = struct{}{}
-	h.ensurePubSubLocked(contestID)
+	group.members[sub] = struct{}{}
+	h.ensurePubSubLocked(key.contestID)
+	return group
 }
 
-func (h *Hub) removeSub(contestID string, sub *subscription) {
+func (h *Hub) removeSub(group *pageGroup, sub *subscription) {
 	h.mu.Lock()
 	defer h.mu.Unlock()
-	if subs := h.subs[contestID]; subs != nil {
-		delete(subs, sub)
-		if len(subs) == 0 {
-			delete(h.subs, contestID)
-			if pubsub := h.pubsubs[contestID]; pubsub != nil {
-				_ = pubsub.Close()
-			}
-			delete(h.pubsubs, contestID)
+	delete(group.members, sub)
+	if len(group.members) > 0 {
+		return
+	}
+	group.stop()
+	contestID := group.key.contestID
+	groups := h.groups[contestID]
+	if groups[group.key] == group {
+		delete(groups, group.key)
+	}
+	if len(groups) == 0 {
+		delete(h.groups, contestID)
+		if pubsub := h.pubsubs[contestID]; pubsub != nil {
+			_ = pubsub.Close()
 		}
+		delete(h.pubsubs, contestID)
 	}
 }
 
@@ -136,19 +160,52 @@ func (h *Hub) listenPubSub(contestID string, pubsub *red.PubSub) {
 
 func (h *Hub) broadcastRefresh(contestID string) {
 	h.mu.RLock()
-	subsMap := h.subs[contestID]
-	if len(subsMap) == 0 {
-		h.mu.RUnlock()
-		return
+	groups := make([]*pageGroup, 0, len(h.groups[contestID]))
+	for _, group := range h.groups[contestID] {
+		groups = append(groups, group)
 	}
-	subs := make([]*subscription, 0, len(subsMap))
-	for sub := range subsMap {
+	h.mu.RUnlock()
+	for _, group := range groups {
+		group.notifyRefresh()
+	}
+}
+
+// members returns the current subscriptions of a group.
+func (h *Hub) members(group *pageGroup) []*subscription {
+	h.mu.RLock()
+	defer h.mu.RUnlock()
+	subs := make([]*subscription, 0, len(group.members))
+	for sub := range group.members {
 		subs = append(subs, sub)
 	}
-	h.mu.RUnlock()
-	for _, sub := range subs {
-		sub.notifyRefresh()
+	return subs
+}
+
+// snapshot loads and encodes a page for a new subscriber. Concurrent joins of
+// the same page and protocol share one load.
+func (h *Hub) snapshot(ctx context.Context, key pageKey, deltaProtocol bool) (outMessage, error) {
+	flightKey := key.String() + "|json"
+	if deltaProtocol {
+		flightKey = key.String() + "|delta"
 	}
+	val, err := h.flight.Do(flightKey, func() (any, error) {
+		payload, err := h.repo.GetPage(ctx, key.contestID, key.page, key.pageSize, key.mode)
+		if err != nil {
+			return nil, err
+		}
+		if deltaProtocol {
+			return outMessage{data: encodeFullFrame(payload), binary: true, version: payload.Version}, nil
+		}
+		data, err := encodeMessage(snapshotMsgType, payload)
+		if err != nil {
+			return nil, err
+		}
+		return outMessage{data: data, version: payload.Version}, nil
+	})
+	if err != nil {
+		return outMessage{}, err
+	}
+	return val.(outMessage), nil
 }
 
 func (h *Hub) isActivePubSub(contestID string, pubsub *red.PubSub) bool {
@@ -164,41 +221,53 @@ func pubsubChannel(contestID string) string {
 
 type sender interface {
 	Send(ctx context.Context, payload []byte) error
+	SendBinary(ctx context.Context, payload []byte) error
 	Close() error
 }
 
+// subscription is one websocket connection. Messages are pre-encoded by its
+// page group; only the latest pending one is kept, so a slow client skips
+// intermediate refreshes instead of holding up the group.
 type subscription struct {
-	contestID string
-	page      int
-	pageSize  int
-	mode      string
-	debounce  time.Duration
-	repo      *repository.LeaderboardRepository
-	sender    sender
-	refreshCh chan struct{}
-	stopCh    chan struct{}
-	onClose   func()
+	key           pageKey
+	deltaProtocol bool
+	sender        sender
+	notifyCh      chan struct{}
+	onClose       func()
+
+	mu      sync.Mutex
+	pending *outMessage
+	// version is what the client holds once every message taken from pending
+	// has been sent; deltas are only chosen against it.
+	version string
+}
+
+type outMessage struct {
+	data    []byte
+	binary  bool
+	version string
 }
 
-func newSubscription(contestID string, page, pageSize int, mode string, sender sender, repo *repository.LeaderboardRepository, debounce time.Duration, onClose func()) *subscription {
+func newSubscription(key pageKey, deltaProtocol bool, sender sender) *subscription {
 	return &subscription{
-		contestID: contestID,
-		page:      page,
-		pageSize:  pageSize,
-		mode:      mode,
-		debounce:  debounce,
-		repo:      repo,
-		sender:    sender,
-		refreshCh: make(chan struct{}, 1),
-		stopCh:    make(chan struct{}),
-		onClose:   onClose,
+		key:           key,
+		deltaProtocol: deltaProtocol,
+		sender:        sender,
+		notifyCh:      make(chan struct{}, 1),
 	}
 }
 
-func (s *subscription) start(ctx context.Context) {
+func (s *subscription) start(ctx context.Context, snapshot func(context.Context, pageKey, bool) (outMessage, error)) {
 	logger := logx.WithContext(ctx)
-	if err := s.sendSnapshot(ctx); err != nil {
+	if msg, err := snapshot(ctx, s.key, s.deltaProtocol); err != nil {
 		logger.Errorf("send rank snapshot failed: %v", err)
+	} else {
+		s.mu.Lock()
+		s.version = msg.version
+		s.mu.Unlock()
+		if err := s.send(ctx, msg); err != nil {
+			logger.Errorf("send rank snapshot failed: %v", err)
+		}
 	}
 	go s.loop(ctx)
 }
@@ -210,67 +279,64 @@ func (s *subscription) loop(ctx context.Context) {
 			s.onClose()
 		}
 	}()
-	var timer *time.Timer
 	for {
 		select {
 		case <-ctx.Done():
 			return
-		case <-s.stopCh:
-			return
-		case <-s.refreshCh:
-			if timer == nil {
-				timer = time.NewTimer(s.debounce)
-			} else {
-				if !timer.Stop() {
-					select {
-					case <-timer.C:
-					default:
-					}
-				}
-				timer.Reset(s.debounce)
+		case <-s.notifyCh:
+			s.mu.Lock()
+			msg := s.pending
+			s.pending = nil
+			if msg != nil {
+				s.version = msg.version
 			}
-		case <-func() <-chan time.Time {
-			if timer == nil {
-				return make(chan time.Time)
+			s.mu.Unlock()
+			if msg == nil {
+				continue
+			}
+			if err := s.send(ctx, *msg); err != nil {
+				return
 			}
-			return timer.C
-		}():
-			_ = s.sendRefresh(ctx)
 		}
 	}
 }
 
-func (s *subscription) notifyRefresh() {
-	select {
-	case s.refreshCh <- struct{}{}:
+// enqueue replaces any message the connection has not picked up yet. Delta
+// subscribers get the delta frame only if they hold its base version.
+func (s *subscription) enqueue(frame *pageFrame) {
+	s.mu.Lock()
+	var msg *outMessage
+	switch {
+	case !s.deltaProtocol:
+		if data := frame.jsonMessage(); data != nil {
+			msg = &outMessage{data: data, version: frame.payload.Version}
+		}
+	case frame.delta != nil && frame.base == s.version:
+		msg = &outMessage{data: frame.deltaFrame(), binary: true, version: frame.payload.Version}
 	default:
+		msg = &outMessage{data: frame.fullFrame(), binary: true, version: frame.payload.Version}
 	}
-}
-
-func (s *subscription) sendSnapshot(ctx context.Context) error {
-	payload, err := s.repo.GetPage(ctx, s.contestID, s.page, s.pageSize, s.mode)
-	if err != nil {
-		return err
+	if msg != nil {
+		s.pending = msg
+	}
+	s.mu.Unlock()
+	select {
+	case s.notifyCh <- struct{}{}:
+	default:
 	}
-	return s.sendMessage(ctx, snapshotMsgType, payload)
 }
 
-func (s *subscription) sendRefresh(ctx context.Context) error {
-	payload, err := s.repo.GetPage(ctx, s.contestID, s.page, s.pageSize, s.mode)
-	if err != nil {
-		return err
+func (s *subscription) send(ctx context.Context, msg outMessage) error {
+	if msg.binary {
+		return s.sender.SendBinary(ctx, msg.data)
 	}
-	return s.sendMessage(ctx, refreshMsgType, payload)
+	return s.sender.Send(ctx, msg.data)
 }
 
-func (s *subscription) sendMessage(ctx context.Context, msgType string, payload types.LeaderboardPayload) error {
+func encodeMessage(msgType string, payload types.LeaderboardPayload) ([]byte, error) {
 	data := map[string]any{
 		"type": msgType,
 		"data": payload,
 	}
-	bytes, err := json.Marshal(data)
-	if err != nil {
-		return err
-	}
-	return s.sender.Send(ctx, bytes)
+	return json.Marshal(data)
 }
@@ -0,0 +1,171 @@
+package ws
+
+import (
+	"context"
+	"strconv"
+	"time"
+
+	"fuzoj/services/rank_ws_service/internal/types"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+const (
+	defaultPage     = 1
+	defaultPageSize = 50
+	// groupFetchTimeout bounds one shared page load.
+	groupFetchTimeout = 5 * time.Second
+)
+
+// pageKey identifies one leaderboard page as subscribers see it.
+type pageKey struct {
+	contestID string
+	mode      string
+	page      int
+	pageSize  int
+}
+
+func newPageKey(contestID string, page, pageSize int, mode string) pageKey {
+	if page <= 0 {
+		page = defaultPage
+	}
+	if pageSize <= 0 {
+		pageSize = defaultPageSize
+	}
+	return pageKey{contestID: contestID, mode: mode, page: page, pageSize: pageSize}
+}
+
+func (k pageKey) String() string {
+	return k.contestID + "|" + k.mode + "|" + strconv.Itoa(k.page) + "|" + strconv.Itoa(k.pageSize)
+}
+
+// pageGroup fans one page out to every subscription showing it. On a debounced
+// refresh it loads the page once, encodes the message once and hands the same
+// bytes to all members. members is guarded by the hub lock.
+type pageGroup struct {
+	hub       *Hub
+	key       pageKey
+	members   map[*subscription]struct{}
+	refreshCh chan struct{}
+	stopCh    chan struct{}
+	// prev is the last broadcast page, owned by loop.
+	prev    types.LeaderboardPayload
+	hasPrev bool
+}
+
+// pageFrame is one group update. Each encoding is built on first use, once for
+// all members, from the group loop only.
+type pageFrame struct {
+	payload types.LeaderboardPayload
+	base    string
+	delta   *pageDelta
+	json    []byte
+	full    []byte
+	diff    []byte
+}
+
+func (f *pageFrame) jsonMessage() []byte {
+	if f.json == nil {
+		data, err := encodeMessage(refreshMsgType, f.payload)
+		if err != nil {
+			logx.Errorf("encode rank page failed: %v", err)
+			return nil
+		}
+		f.json = data
+	}
+	return f.json
+}
+
+func (f *pageFrame) fullFrame() []byte {
+	if f.full == nil {
+		f.full = encodeFullFrame(f.payload)
+	}
+	return f.full
+}
+
+func (f *pageFrame) deltaFrame() []byte {
+	if f.diff == nil {
+		f.diff = encodeDeltaFrame(f.base, f.payload, *f.delta)
+	}
+	return f.diff
+}
+
+func newPageGroup(hub *Hub, key pageKey) *pageGroup {
+	return &pageGroup{
+		hub:       hub,
+		key:       key,
+		members:   make(map[*subscription]struct{}),
+		refreshCh: make(chan struct{}, 1),
+		stopCh:    make(chan struct{}),
+	}
+}
+
+func (g *pageGroup) notifyRefresh() {
+	select {
+	case g.refreshCh <- struct{}{}:
+	default:
+	}
+}
+
+// stop is called with the hub lock held once the last member left.
+func (g *pageGroup) stop() {
+	close(g.stopCh)
+}
+
+func (g *pageGroup) loop() {
+	var timer *time.Timer
+	var timerC <-chan time.Time
+	defer func() {
+		if timer != nil {
+			timer.Stop()
+		}
+	}()
+	for {
+		select {
+		case <-g.hub.ctx.Done():
+			return
+		case <-g.stopCh:
+			return
+		case <-g.refreshCh:
+			if timer == nil {
+				timer = time.NewTimer(g.hub.debounce)
+			} else {
+				if !timer.Stop() {
+					select {
+					case <-timer.C:
+					default:
+					}
+				}
+				timer.Reset(g.hub.debounce)
+			}
+			timerC = timer.C
+		case <-timerC:
+			timerC = nil
+			g.broadcastRefresh()
+		}
+	}
+}
+
+func (g *pageGroup) broadcastRefresh() {
+	ctx, cancel := context.WithTimeout(g.hub.ctx, groupFetchTimeout)
+	defer cancel()
+	payload, err := g.hub.repo.GetPage(ctx, g.key.contestID, g.key.page, g.key.pageSize, g.key.mode)
+	if err != nil {
+		logx.WithContext(ctx).Errorf("load rank page failed: contest=%s page=%d err=%v", g.key.contestID, g.key.page, err)
+		return
+	}
+	if g.hasPrev && payload.Version != "" && payload.Version == g.prev.Version {
+		return
+	}
+	frame := &pageFrame{payload: payload}
+	if g.hasPrev && g.prev.Version != "" {
+		delta := diffPage(g.prev, payload)
+		frame.base = g.prev.Version
+		frame.delta = &delta
+	}
+	g.prev = payload
+	g.hasPrev = true
+	for _, sub := range g.hub.members(g) {
+		sub.enqueue(frame)
+	}
+}
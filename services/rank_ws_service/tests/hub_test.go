@@ -0,0 +1,230 @@
+package tests
+
+import (
+	"bytes"
+	"context"
+	"encoding/binary"
+	"encoding/json"
+	"io"
+	"testing"
+	"time"
+
+	"fuzoj/services/rank_ws_service/internal/repository"
+	"fuzoj/services/rank_ws_service/internal/types"
+	"fuzoj/services/rank_ws_service/internal/ws"
+
+	"github.com/alicebob/miniredis/v2"
+	red "github.com/redis/go-redis/v9"
+	"github.com/zeromicro/go-zero/core/stores/redis"
+)
+
+type recordingSender struct {
+	ch chan []byte
+}
+
+func newRecordingSender() *recordingSender {
+	return &recordingSender{ch: make(chan []byte, 16)}
+}
+
+func (s *recordingSender) Send(_ context.Context, payload []byte) error {
+	s.ch <- payload
+	return nil
+}
+
+func (s *recordingSender) SendBinary(_ context.Context, payload []byte) error {
+	s.ch <- payload
+	return nil
+}
+
+func (s *recordingSender) Close() error {
+	return nil
+}
+
+func (s *recordingSender) next(t *testing.T) []byte {
+	t.Helper()
+	select {
+	case payload := <-s.ch:
+		return payload
+	case <-time.After(2 * time.Second):
+		t.Fatalf("timed out waiting for message")
+		return nil
+	}
+}
+
+type wsMessage struct {
+	Type string                   `json:"type"`
+	Data types.LeaderboardPayload `json:"data"`
+}
+
+func decodeWSMessage(t *testing.T, payload []byte) wsMessage {
+	t.Helper()
+	var msg wsMessage
+	if err := json.Unmarshal(payload, &msg); err != nil {
+		t.Fatalf("decode message failed: %v", err)
+	}
+	return msg
+}
+
+func newHubForTest(t *testing.T) (*ws.Hub, *miniredis.Miniredis, *redis.Redis) {
+	t.Helper()
+	mini := miniredis.RunT(t)
+	cache, err := redis.NewRedis(redis.RedisConf{Host: mini.Addr(), Type: "node"})
+	if err != nil {
+		t.Fatalf("new redis failed: %v", err)
+	}
+	pubsubClient := red.NewClient(&red.Options{Addr: mini.Addr()})
+	t.Cleanup(func() { _ = pubsubClient.Close() })
+	repo := repository.NewLeaderboardRepository(cache, time.Second, time.Second)
+	hub := ws.NewHub(repo, pubsubClient, 10*time.Millisecond)
+	t.Cleanup(hub.Close)
+	return hub, mini, cache
+}
+
+// publishUntilReceived publishes a refresh until sender sees a message; the hub
+// subscribes to the pubsub channel asynchronously.
+func publishUntilReceived(t *testing.T, mini *miniredis.Miniredis, contestID string, sender *recordingSender) []byte {
+	t.Helper()
+	deadline := time.Now().Add(2 * time.Second)
+	for time.Now().Before(deadline) {
+		mini.Publish("contest:lb:pubsub:"+contestID, "refresh")
+		select {
+		case payload := <-sender.ch:
+			return payload
+		case <-time.After(50 * time.Millisecond):
+		}
+	}
+	t.Fatalf("expected refresh after publish")
+	return nil
+}
+
+func TestHub_SharesRefreshAcrossSamePageSubscribers(t *testing.T) {
+	hub, mini, cache := newHubForTest(t)
+
+	if err := seedMember(cache, "c1", "m1", 10, 100, "1"); err != nil {
+		t.Fatalf("seed member failed: %v", err)
+	}
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+
+	// Page 0 and an empty page size normalize to the same page as page 1/50.
+	senders := []*recordingSender{newRecordingSender(), newRecordingSender(), newRecordingSender()}
+	hub.Subscribe(ctx, "c1", 1, 50, "", false, senders[0])
+	hub.Subscribe(ctx, "c1", 0, 0, "", false, senders[1])
+	hub.Subscribe(ctx, "c1", 1, 50, "", false, senders[2])
+	for _, sender := range senders {
+		if msg := decodeWSMessage(t, sender.next(t)); msg.Type != "snapshot" || msg.Data.Version != "1" {
+			t.Fatalf("unexpected snapshot: %+v", msg)
+		}
+	}
+
+	if err := seedMember(cache, "c1", "m1", 20, 200, "2"); err != nil {
+		t.Fatalf("seed updated member failed: %v", err)
+	}
+	first := publishUntilReceived(t, mini, "c1", senders[0])
+	msg := decodeWSMessage(t, first)
+	if msg.Type != "refresh" || msg.Data.Version != "2" || len(msg.Data.Items) != 1 || msg.Data.Items[0].Score != 20 {
+		t.Fatalf("unexpected refresh: %+v", msg)
+	}
+	for _, sender := range senders[1:] {
+		if got := sender.next(t); !bytes.Equal(got, first) {
+			t.Fatalf("expected identical refresh bytes, got %s", got)
+		}
+	}
+}
+
+func TestHub_DeltaProtocolSendsChangedRowsOnly(t *testing.T) {
+	hub, mini, cache := newHubForTest(t)
+	if err := seedMember(cache, "c1", "m1", 10, 100, "1"); err != nil {
+		t.Fatalf("seed member failed: %v", err)
+	}
+	if err := seedMember(cache, "c1", "m2", 5, 50, "1"); err != nil {
+		t.Fatalf("seed member failed: %v", err)
+	}
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+	sender := newRecordingSender()
+	hub.Subscribe(ctx, "c1", 1, 50, "", true, sender)
+	if frame := sender.next(t); frame[0] != 1 {
+		t.Fatalf("expected full frame on subscribe, got type %d", frame[0])
+	}
+
+	// The first refresh of a new group has no base yet and is sent in full.
+	if err := seedMember(cache, "c1", "m2", 6, 60, "2"); err != nil {
+		t.Fatalf("seed member failed: %v", err)
+	}
+	if frame := publishUntilReceived(t, mini, "c1", sender); frame[0] != 1 {
+		t.Fatalf("expected full frame without a base, got type %d", frame[0])
+	}
+
+	// m2 overtakes m1: m2 is upserted, m1 only moves down one rank.
+	if err := seedMember(cache, "c1", "m2", 20, 200, "3"); err != nil {
+		t.Fatalf("seed member failed: %v", err)
+	}
+	frame := publishUntilReceived(t, mini, "c1", sender)
+	delta := decodeDeltaFrame(t, frame)
+	if delta.version != "3" || delta.base != "2" {
+		t.Fatalf("unexpected delta versions: %+v", delta)
+	}
+	if len(delta.upserts) != 1 || delta.upserts[0] != "m2" {
+		t.Fatalf("expected only m2 to be upserted, got %v", delta.upserts)
+	}
+	if delta.moves["m1"] != 2 || len(delta.moves) != 1 || len(delta.removals) != 0 {
+		t.Fatalf("expected m1 to move to rank 2, got moves=%v removals=%v", delta.moves, delta.removals)
+	}
+}
+
+type decodedDelta struct {
+	version  string
+	base     string
+	upserts  []string
+	moves    map[string]int64
+	removals []string
+}
+
+func decodeDeltaFrame(t *testing.T, frame []byte) decodedDelta {
+	t.Helper()
+	if len(frame) == 0 || frame[0] != 2 {
+		t.Fatalf("expected delta frame, got %v", frame)
+	}
+	buf := bytes.NewReader(frame[1:])
+	readUvarint := func() uint64 {
+		v, err := binary.ReadUvarint(buf)
+		if err != nil {
+			t.Fatalf("decode frame failed: %v", err)
+		}
+		return v
+	}
+	readVarint := func() int64 {
+		v, err := binary.ReadVarint(buf)
+		if err != nil {
+			t.Fatalf("decode frame failed: %v", err)
+		}
+		return v
+	}
+	readString := func() string {
+		data := make([]byte, readUvarint())
+		if _, err := io.ReadFull(buf, data); err != nil {
+			t.Fatalf("decode frame failed: %v", err)
+		}
+		return string(data)
+	}
+	out := decodedDelta{version: readString(), base: readString(), moves: map[string]int64{}}
+	readVarint()  // total
+	readUvarint() // page
+	readUvarint() // page size
+	for n := readUvarint(); n > 0; n-- {
+		out.upserts = append(out.upserts, readString())
+		readVarint() // rank
+		readVarint() // score
+		readVarint() // penalty
+		readString() // detail
+	}
+	for n := readUvarint(); n > 0; n-- {
+		memberID := readString()
+		out.moves[memberID] = readVarint()
+	}
+	for n := readUvarint(); n > 0; n-- {
+		out.removals = append(out.removals, readString())
+	}
+	return out
+}
@@ -191,6 +191,10 @@ func (f *fakeStorage) GetObject(ctx context.Context, bucket, objectKey string) (
 	return nil, errors.New("get object not implemented")
 }
 
+func (f *fakeStorage) GetObjectRange(ctx context.Context, bucket, objectKey string, offset, length int64) (storage.ObjectReader, error) {
+	return nil, errors.New("get object range not implemented")
+}
+
 func (f *fakeStorage) PutObject(ctx context.Context, bucket, objectKey string, reader storage.ObjectReader, sizeBytes int64, contentType string) error {
 	if f.putObjectFn == nil {
 		return errors.New("put object not implemented")
@@ -29,6 +29,21 @@ func (f *fakeLogStorage) GetObject(ctx context.Context, bucket, objectKey string
 	return &fakeReader{data: strings.NewReader(content)}, nil
 }
 
+func (f *fakeLogStorage) GetObjectRange(ctx context.Context, bucket, objectKey string, offset, length int64) (storage.ObjectReader, error) {
+	content := ""
+	if f.data != nil {
+		content = f.data[objectKey]
+	}
+	if offset > int64(len(content)) {
+		offset = int64(len(content))
+	}
+	content = content[offset:]
+	if length > 0 && length < int64(len(content)) {
+		content = content[:length]
+	}
+	return &fakeReader{data: strings.NewReader(content)}, nil
+}
+
 func (f *fakeLogStorage) PutObject(ctx context.Context, bucket, objectKey string, reader storage.ObjectReader, sizeBytes int64, contentType string) error {
 	f.putCalls = append(f.putCalls, bucket+"/"+objectKey)
 	if f.data == nil {
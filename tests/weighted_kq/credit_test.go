@@ -0,0 +1,107 @@
+package weighted_kq_test
+
+import (
+	"context"
+	"sync"
+	"sync/atomic"
+	"testing"
+	"time"
+
+	"fuzoj/internal/common/mq/weighted_kq"
+)
+
+type creditHandler struct {
+	mu      sync.Mutex
+	free    int
+	notify  func()
+	running int32
+	peak    int32
+	release chan struct{}
+}
+
+func (h *creditHandler) FreeCredits() int {
+	h.mu.Lock()
+	defer h.mu.Unlock()
+	return h.free
+}
+
+func (h *creditHandler) SetCreditNotifier(notify func()) {
+	h.mu.Lock()
+	h.notify = notify
+	h.mu.Unlock()
+}
+
+func (h *creditHandler) Consume(ctx context.Context, key, value string) error {
+	h.mu.Lock()
+	h.free--
+	h.mu.Unlock()
+	weighted_kq.ClaimCredit(ctx)
+	running := atomic.AddInt32(&h.running, 1)
+	for {
+		peak := atomic.LoadInt32(&h.peak)
+		if running <= peak || atomic.CompareAndSwapInt32(&h.peak, peak, running) {
+			break
+		}
+	}
+	<-h.release
+	atomic.AddInt32(&h.running, -1)
+	h.mu.Lock()
+	h.free++
+	notify := h.notify
+	h.mu.Unlock()
+	if notify != nil {
+		notify()
+	}
+	return nil
+}
+
+func TestDispatcherRespectsHandlerCredits(t *testing.T) {
+	handler := &creditHandler{free: 1, release: make(chan struct{})}
+	d := weighted_kq.NewDispatcher(weighted_kq.DispatcherOptions{
+		Topics:  []string{"topic-a", "topic-b"},
+		Workers: 4,
+		Handler: handler,
+		Policy: weighted_kq.WeightedQueuePolicy{
+			TopicWeights: map[string]int{"topic-a": 2, "topic-b": 1},
+		},
+	})
+	d.Start()
+	defer d.Stop()
+
+	var wg sync.WaitGroup
+	for i := 0; i < 3; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			if err := d.Submit(context.Background(), "topic-a", "k", "v"); err != nil {
+				t.Errorf("submit: %v", err)
+			}
+		}()
+	}
+
+	deadline := time.Now().Add(time.Second)
+	for !topicStats(t, d, "topic-a").Paused && time.Now().Before(deadline) {
+		time.Sleep(time.Millisecond)
+	}
+	if !topicStats(t, d, "topic-a").Paused {
+		t.Fatalf("expected topic-a intake to pause while credits are exhausted")
+	}
+	if stats := d.Stats(); stats.Credits != 0 {
+		t.Fatalf("expected no free credits, got %d", stats.Credits)
+	}
+
+	for i := 0; i < 3; i++ {
+		handler.release <- struct{}{}
+	}
+	wg.Wait()
+	if peak := atomic.LoadInt32(&handler.peak); peak != 1 {
+		t.Fatalf("expected at most 1 concurrent message, got %d", peak)
+	}
+	deadline = time.Now().Add(time.Second)
+	for topicStats(t, d, "topic-a").Paused && time.Now().Before(deadline) {
+		time.Sleep(time.Millisecond)
+	}
+	if topicStats(t, d, "topic-a").Paused {
+		t.Fatalf("expected topic-a intake to resume once credits return")
+	}
+}
@@ -0,0 +1,174 @@
+package weighted_kq_test
+
+import (
+	"bufio"
+	"context"
+	"fmt"
+	"os"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	"fuzoj/internal/common/mq/weighted_kq"
+
+	"github.com/zeromicro/go-zero/core/logx"
+)
+
+// The harness replays a recorded submission mix through the shared dispatcher and
+// reports per-topic wait percentiles. Set WEIGHTED_KQ_MIX to replay another
+// recording with the same "offset_ms,topic,tests" layout.
+const (
+	replaySpeedup  = 100
+	replayTestCost = 20 * time.Millisecond
+	replayWorkers  = 16
+	// replayWindow is the dispatcher's 5s metrics window on the replay clock.
+	replayWindow = 5 * time.Second / replaySpeedup
+)
+
+type replayEvent struct {
+	offset time.Duration
+	topic  string
+	tests  int
+}
+
+func loadReplayMix(tb testing.TB) []replayEvent {
+	path := os.Getenv("WEIGHTED_KQ_MIX")
+	if path == "" {
+		path = "testdata/contest_mix.csv"
+	}
+	file, err := os.Open(path)
+	if err != nil {
+		tb.Fatalf("open replay mix: %v", err)
+	}
+	defer file.Close()
+
+	var events []replayEvent
+	scanner := bufio.NewScanner(file)
+	for scanner.Scan() {
+		line := strings.TrimSpace(scanner.Text())
+		if line == "" || strings.HasPrefix(line, "#") {
+			continue
+		}
+		parts := strings.Split(line, ",")
+		if len(parts) != 3 {
+			tb.Fatalf("invalid replay line: %q", line)
+		}
+		offset, err := strconv.Atoi(parts[0])
+		if err != nil {
+			tb.Fatalf("invalid replay offset: %q", line)
+		}
+		tests, err := strconv.Atoi(parts[2])
+		if err != nil {
+			tb.Fatalf("invalid replay tests: %q", line)
+		}
+		events = append(events, replayEvent{offset: time.Duration(offset) * time.Millisecond, topic: parts[1], tests: tests})
+	}
+	if err := scanner.Err(); err != nil {
+		tb.Fatalf("read replay mix: %v", err)
+	}
+	return events
+}
+
+type replayHandler struct {
+	mu    sync.Mutex
+	waits map[string][]time.Duration
+}
+
+func (h *replayHandler) Consume(ctx context.Context, key, value string) error {
+	parts := strings.SplitN(value, ",", 3)
+	enqueued, _ := strconv.ParseInt(parts[1], 10, 64)
+	tests, _ := strconv.Atoi(parts[2])
+	wait := time.Since(time.Unix(0, enqueued)) * replaySpeedup
+	h.mu.Lock()
+	h.waits[parts[0]] = append(h.waits[parts[0]], wait)
+	h.mu.Unlock()
+	time.Sleep(time.Duration(tests) * replayTestCost / replaySpeedup)
+	return nil
+}
+
+func replayCost(topic, key, value string) int {
+	parts := strings.SplitN(value, ",", 3)
+	tests, _ := strconv.Atoi(parts[2])
+	return tests
+}
+
+func replayMix(b *testing.B, events []replayEvent, policy weighted_kq.WeightedQueuePolicy) map[string][]time.Duration {
+	topics := make([]string, 0, 4)
+	seen := map[string]bool{}
+	for _, event := range events {
+		if !seen[event.topic] {
+			seen[event.topic] = true
+			topics = append(topics, event.topic)
+		}
+	}
+	sort.Strings(topics)
+	handler := &replayHandler{waits: make(map[string][]time.Duration)}
+	// Weights adapt once per metrics window; shrink it along with the replay clock.
+	d := weighted_kq.NewDispatcher(weighted_kq.DispatcherOptions{
+		Topics:        topics,
+		Workers:       replayWorkers,
+		Handler:       handler,
+		Policy:        policy,
+		MetricsWindow: replayWindow,
+	})
+	d.Start()
+	defer d.Stop()
+
+	start := time.Now()
+	var wg sync.WaitGroup
+	for _, event := range events {
+		if delay := time.Until(start.Add(event.offset / replaySpeedup)); delay > 0 {
+			time.Sleep(delay)
+		}
+		wg.Add(1)
+		go func(event replayEvent) {
+			defer wg.Done()
+			value := fmt.Sprintf("%s,%d,%d", event.topic, time.Now().UnixNano(), event.tests)
+			_ = d.Submit(context.Background(), event.topic, "", value)
+		}(event)
+	}
+	wg.Wait()
+	return handler.waits
+}
+
+func reportWaits(b *testing.B, waits map[string][]time.Duration) {
+	topics := make([]string, 0, len(waits))
+	for topic := range waits {
+		topics = append(topics, topic)
+	}
+	sort.Strings(topics)
+	for _, topic := range topics {
+		samples := waits[topic]
+		sort.Slice(samples, func(i, j int) bool { return samples[i] < samples[j] })
+		p50 := samples[len(samples)/2]
+		p99 := samples[(len(samples)*99)/100]
+		b.ReportMetric(float64(p99.Milliseconds()), topic+"-p99-ms")
+		b.Logf("topic=%s count=%d p50=%s p99=%s max=%s", topic, len(samples), p50, p99, samples[len(samples)-1])
+	}
+}
+
+func BenchmarkDispatcherContestMix(b *testing.B) {
+	logx.Disable()
+	events := loadReplayMix(b)
+	cases := []struct {
+		name   string
+		policy weighted_kq.WeightedQueuePolicy
+	}{
+		{name: "unit-cost"},
+		{name: "drr", policy: weighted_kq.WeightedQueuePolicy{Cost: replayCost}},
+		{name: "drr-slo", policy: weighted_kq.WeightedQueuePolicy{
+			Cost:        replayCost,
+			WaitTargets: map[string]time.Duration{"judge.level0": 5 * time.Second / replaySpeedup},
+		}},
+	}
+	for _, tc := range cases {
+		b.Run(tc.name, func(b *testing.B) {
+			for i := 0; i < b.N; i++ {
+				reportWaits(b, replayMix(b, events, tc.policy))
+			}
+		})
+	}
+}
@@ -0,0 +1,98 @@
+package weighted_kq_test
+
+import (
+	"testing"
+	"time"
+
+	"fuzoj/internal/common/mq/weighted_kq"
+)
+
+func newTestDispatcher(weights map[string]int, targets map[string]time.Duration, topics ...string) *weighted_kq.Dispatcher {
+	return weighted_kq.NewDispatcher(weighted_kq.DispatcherOptions{
+		Topics:  topics,
+		Workers: 1,
+		Policy: weighted_kq.WeightedQueuePolicy{
+			TopicWeights: weights,
+			WaitTargets:  targets,
+		},
+	})
+}
+
+func topicStats(t *testing.T, d *weighted_kq.Dispatcher, topic string) weighted_kq.TopicStats {
+	t.Helper()
+	for _, item := range d.Stats().Topics {
+		if item.Topic == topic {
+			return item
+		}
+	}
+	t.Fatalf("missing stats for topic %s", topic)
+	return weighted_kq.TopicStats{}
+}
+
+func repeatWait(wait time.Duration, count int) []time.Duration {
+	out := make([]time.Duration, count)
+	for i := range out {
+		out[i] = wait
+	}
+	return out
+}
+
+func TestNextTaskChargesByCost(t *testing.T) {
+	d := newTestDispatcher(map[string]int{"rejudge": 4, "custom": 4}, nil, "rejudge", "custom")
+	for i := 0; i < 8; i++ {
+		if err := d.Enqueue("rejudge", 4); err != nil {
+			t.Fatalf("enqueue: %v", err)
+		}
+		if err := d.Enqueue("custom", 1); err != nil {
+			t.Fatalf("enqueue: %v", err)
+		}
+	}
+
+	counts := map[string]int{}
+	for i := 0; i < 10; i++ {
+		topic, ok := d.NextTask()
+		if !ok {
+			t.Fatalf("expected a task at step %d", i)
+		}
+		counts[topic]++
+	}
+	if counts["rejudge"] != 2 || counts["custom"] != 8 {
+		t.Fatalf("expected 2 rejudge and 8 custom tasks, got %v", counts)
+	}
+}
+
+func TestNextTaskServesExpensiveTaskEventually(t *testing.T) {
+	d := newTestDispatcher(map[string]int{"a": 1}, nil, "a")
+	if err := d.Enqueue("a", weighted_kq.MaxTaskCost); err != nil {
+		t.Fatalf("enqueue: %v", err)
+	}
+	if _, ok := d.NextTask(); !ok {
+		t.Fatalf("expected expensive task to be dispatched")
+	}
+	if _, ok := d.NextTask(); ok {
+		t.Fatalf("expected empty dispatcher")
+	}
+}
+
+func TestAdjustWeightsFollowsWaitTarget(t *testing.T) {
+	d := newTestDispatcher(
+		map[string]int{"contest": 4, "practice": 2},
+		map[string]time.Duration{"contest": 100 * time.Millisecond},
+		"contest", "practice",
+	)
+	slow := repeatWait(time.Second, 10)
+	d.AdjustWeights(map[string][]time.Duration{"contest": slow, "practice": slow})
+	if got := topicStats(t, d, "contest").Weight; got != 5 {
+		t.Fatalf("expected contest weight to rise to 5, got %d", got)
+	}
+	if got := topicStats(t, d, "practice").Weight; got != 2 {
+		t.Fatalf("expected practice weight without target to stay 2, got %d", got)
+	}
+
+	fast := repeatWait(time.Millisecond, 10)
+	d.AdjustWeights(map[string][]time.Duration{"contest": fast})
+	d.AdjustWeights(map[string][]time.Duration{"contest": fast})
+	if got := topicStats(t, d, "contest").Weight; got != 4 {
+		t.Fatalf("expected contest weight to decay back to 4, got %d", got)
+	}
+}